@@ -0,0 +1,177 @@
+/* Copyright (c) 2015 Radek Micek */
+
+#include "amofinder.h"
+#include "solver.h"
+#include <limits>
+#include <algorithm>
+
+using namespace CMSat;
+
+static const uint32_t no_amo = std::numeric_limits<uint32_t>::max();
+
+AmoFinder::AmoFinder(Solver* _solver) :
+    solver(_solver)
+{
+}
+
+void AmoFinder::add_binary(const Lit lit1, const Lit lit2)
+{
+    //Unit clause or tautology
+    if (lit1.var() == lit2.var()) {
+        const vector<Lit> cl = {lit1, lit2};
+        solver->add_clause_outer(cl);
+        return;
+    }
+
+    pairs.push_back(std::make_pair(~lit1, ~lit2));
+}
+
+uint64_t AmoFinder::edge(const Lit lit1, const Lit lit2)
+{
+    uint64_t x = lit1.toInt();
+    uint64_t y = lit2.toInt();
+    if (x > y)
+        std::swap(x, y);
+
+    return (x << 32) | y;
+}
+
+bool AmoFinder::in_amo(const Lit lit) const
+{
+    return lit.toInt() < amo_of.size() && amo_of[lit.toInt()] != no_amo;
+}
+
+void AmoFinder::set_amo(const Lit lit, const uint32_t at)
+{
+    if (lit.toInt() >= amo_of.size()) {
+        amo_of.resize(lit.toInt()+1, no_amo);
+    }
+    amo_of[lit.toInt()] = at;
+}
+
+void AmoFinder::build_graph()
+{
+    for(const std::pair<Lit, Lit>& p: pairs) {
+        if (!edges.insert(edge(p.first, p.second)).second)
+            continue;
+
+        vector<Lit>& ns1 = neighbours[p.first.toInt()];
+        if (ns1.empty())
+            lits.push_back(p.first);
+        ns1.push_back(p.second);
+
+        vector<Lit>& ns2 = neighbours[p.second.toInt()];
+        if (ns2.empty())
+            lits.push_back(p.second);
+        ns2.push_back(p.first);
+    }
+}
+
+//Literals which are in a binary clause with every literal of a constraint
+void AmoFinder::extend_amos(vector<uint32_t>& changed)
+{
+    for(const Lit lit: lits) {
+        if (in_amo(lit))
+            continue;
+
+        const vector<Lit>& ns = neighbours[lit.toInt()];
+        uint32_t at = no_amo;
+        for(const Lit n: ns) {
+            if (in_amo(n)) {
+                at = amo_of[n.toInt()];
+                break;
+            }
+        }
+        if (at == no_amo)
+            continue;
+
+        size_t num = 0;
+        for(const Lit n: ns) {
+            if (in_amo(n) && amo_of[n.toInt()] == at)
+                num++;
+        }
+        if (num != amos[at].size())
+            continue;
+
+        for(const Lit other: amos[at]) {
+            edges.erase(edge(lit, other));
+        }
+        amos[at].push_back(lit);
+        set_amo(lit, at);
+        if (std::find(changed.begin(), changed.end(), at) == changed.end())
+            changed.push_back(at);
+    }
+}
+
+//Greedily grows a clique from each literal which isn't in a constraint
+void AmoFinder::find_new_amos(vector<uint32_t>& changed)
+{
+    vector<Lit> clique;
+    for(const Lit lit: lits) {
+        if (in_amo(lit))
+            continue;
+
+        clique.clear();
+        clique.push_back(lit);
+        for(const Lit n: neighbours[lit.toInt()]) {
+            if (in_amo(n))
+                continue;
+
+            bool all = true;
+            for(const Lit other: clique) {
+                if (other != lit && !edges.count(edge(n, other))) {
+                    all = false;
+                    break;
+                }
+            }
+            if (all)
+                clique.push_back(n);
+        }
+        if (clique.size() < 2)
+            continue;
+
+        const uint32_t at = amos.size();
+        for(size_t i = 0; i < clique.size(); i++) {
+            set_amo(clique[i], at);
+            for(size_t j = i+1; j < clique.size(); j++) {
+                edges.erase(edge(clique[i], clique[j]));
+            }
+        }
+        amos.push_back(clique);
+        changed.push_back(at);
+    }
+}
+
+bool AmoFinder::flush()
+{
+    if (pairs.empty())
+        return solver->okay();
+
+    build_graph();
+    vector<uint32_t> changed;
+    extend_amos(changed);
+    find_new_amos(changed);
+
+    for(const uint32_t at: changed) {
+        if (!solver->add_at_most_one_outer(amos[at]))
+            break;
+    }
+
+    //Binary clauses between different constraints
+    for(const std::pair<Lit, Lit>& p: pairs) {
+        if (!solver->okay())
+            break;
+
+        if (edges.erase(edge(p.first, p.second))) {
+            const vector<Lit> cl = {~p.first, ~p.second};
+            solver->add_clause_outer(cl);
+        }
+    }
+
+    vector<std::pair<Lit, Lit> >().swap(pairs);
+    std::unordered_set<uint64_t>().swap(edges);
+    std::unordered_map<uint32_t, vector<Lit> >().swap(neighbours);
+    vector<Lit>().swap(lits);
+
+    return solver->okay();
+}
@@ -0,0 +1,60 @@
+/* Copyright (c) 2015 Radek Micek */
+
+#ifndef __AMOFINDER_H__
+#define __AMOFINDER_H__
+
+#include "solvertypes.h"
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace CMSat {
+using namespace CMSat;
+using std::vector;
+
+class Solver;
+
+/**
+@brief Finds at-most-one constraints in binary clauses given by the user
+
+The binary clauses are collected until flush(). Then each clique
+of the implied at-most-one constraints is added to the solver
+as a single constraint. A literal which is in a binary clause with every
+literal of an earlier found constraint extends that constraint --
+this is how the constraints grow in incremental solving.
+The remaining binary clauses are added as they are.
+*/
+class AmoFinder
+{
+public:
+    explicit AmoFinder(Solver* solver);
+
+    void add_binary(const Lit lit1, const Lit lit2);
+    bool flush();
+
+private:
+    Solver* solver;
+
+    //Pairs of literals which can't be both true
+    vector<std::pair<Lit, Lit> > pairs;
+
+    //Constraints found earlier and the constraint of each literal
+    vector<vector<Lit> > amos;
+    vector<uint32_t> amo_of;
+
+    //The graph of the collected pairs
+    std::unordered_set<uint64_t> edges;
+    std::unordered_map<uint32_t, vector<Lit> > neighbours;
+    vector<Lit> lits;
+
+    static uint64_t edge(const Lit lit1, const Lit lit2);
+    bool in_amo(const Lit lit) const;
+    void set_amo(const Lit lit, const uint32_t at);
+    void build_graph();
+    void extend_amos(vector<uint32_t>& changed);
+    void find_new_amos(vector<uint32_t>& changed);
+};
+
+}
+
+#endif //__AMOFINDER_H__
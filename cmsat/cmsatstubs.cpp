@@ -4,15 +4,21 @@
 #include <caml/memory.h>
 #include <caml/alloc.h>
 #include <caml/custom.h>
+#include <caml/fail.h>
 #include <caml/signals.h>
 #include <caml/threads.h>
 
-#ifdef CMSAT_STUBS_LOG
 #include <stdio.h>
-#endif
+#include <string>
+#include <atomic>
 
 #include "solvertypes.h"
 #include "solver.h"
+#include "drat.h"
+#include "amofinder.h"
+#ifdef USE_SQLITE3
+#include "sqlitestats.h"
+#endif
 
 using namespace CMSat;
 
@@ -34,10 +40,28 @@ using namespace CMSat;
 struct WrappedSolver {
   Solver * solver;
   int nVars;
-  bool interrupt;
-
-  WrappedSolver() : nVars(0), interrupt(false) {
+  std::atomic<bool> interrupt;
+  // Snapshots published by the search, read by cmsat_poll_progress.
+  ProgressRing progress;
+  // Proof is written only when drat is not null. The solver owns drat.
+  DratBinary * drat;
+  // Original clauses of the current part of the proof.
+  FILE * cnf;
+  std::string proofPrefix;
+  // Binary clauses from add_at_most_one_clause until the next solve.
+  AmoFinder * amoFinder;
+
+  WrappedSolver() : nVars(0), interrupt(false), drat(0), cnf(0) {
     solver = new Solver(NULL, &interrupt);
+    solver->progress = &progress;
+    amoFinder = new AmoFinder(solver);
+  }
+
+  WrappedSolver(const SolverConf & conf)
+    : nVars(0), interrupt(false), drat(0), cnf(0) {
+    solver = new Solver(&conf, &interrupt);
+    solver->progress = &progress;
+    amoFinder = new AmoFinder(solver);
   }
 
   Var newVar() {
@@ -45,14 +69,154 @@ struct WrappedSolver {
     return nVars++;
   }
 
+  void enableProof() {
+    drat = new DratBinary();
+    delete solver->drup;
+    solver->drup = drat;
+  }
+
+  // Makes sure that the current part of the proof is on the disk.
+  bool flushProof() {
+    return drat->writer.flush() && fflush(cnf) == 0;
+  }
+
   ~WrappedSolver() {
+    delete amoFinder;
+    amoFinder = 0;
     delete solver;
     solver = 0;
+    if (cnf)
+      fclose(cnf);
   }
 };
 
+// Writes the clause in DIMACS format.
+static void write_dimacs(FILE * f, const vector<Lit> & lits) {
+  for (size_t i = 0; i < lits.size(); i++)
+    fprintf(f, "%s%u ", lits[i].sign() ? "-" : "", lits[i].var() + 1);
+  fputs("0\n", f);
+}
+
 #define WrappedSolver_val(v) (*((WrappedSolver **) Data_custom_val(v)))
 
+// Constructors of Cmsat.profile.
+enum Profile {
+  profile_default = 0,
+  profile_incremental = 1,
+  profile_aggressive = 2,
+  profile_low_memory = 3,
+};
+
+// Constructors of Cmsat.restart.
+static const Restart restart_types[] = {
+  restart_type_glue,
+  restart_type_glue_agility,
+  restart_type_geom,
+  restart_type_agility,
+  restart_type_never,
+  restart_type_automatic,
+};
+
+// Constructors of Cmsat.clean.
+static const ClauseCleaningTypes clean_types[] = {
+  clean_glue_based,
+  clean_size_based,
+  clean_sum_activity_based,
+};
+
+// The only cleaning type with nonzero ratio in the default SolverConf.
+static const ClauseCleaningTypes default_clean_type = clean_sum_activity_based;
+
+static void apply_profile(SolverConf & conf, Profile profile) {
+  switch (profile) {
+    case profile_default:
+      break;
+    // Many short incremental calls: simplification whose result
+    // would be invalidated by the clauses of the next domain size
+    // is turned off.
+    case profile_incremental:
+      conf.do_bva = false;
+      conf.doVarElim = false;
+      conf.doProbe = false;
+      conf.doCache = false;
+      conf.doCompHandler = false;
+      conf.simplify_at_startup = false;
+      conf.regularly_simplify_problem = false;
+      break;
+    case profile_aggressive:
+      conf.do_bva = true;
+      conf.doVarElim = true;
+      conf.doProbe = true;
+      conf.doCache = true;
+      conf.simplify_at_startup = true;
+      conf.simplify_at_every_startup = true;
+      conf.full_simplify_at_startup = true;
+      break;
+    case profile_low_memory:
+      conf.do_bva = false;
+      conf.doCache = false;
+      conf.doStamp = false;
+      conf.doSaveMem = true;
+      conf.maxCacheSizeMB = 64;
+      conf.maxOccurIrredMB = 100;
+      conf.maxOccurRedMB = 100;
+      conf.max_temporary_learnt_clauses = 10000;
+      break;
+  }
+}
+
+// Converts Cmsat.config to SolverConf.
+static SolverConf conf_of_value(value configv) {
+  SolverConf conf;
+  value v;
+
+  apply_profile(conf, (Profile) Int_val(Field(configv, 0)));
+
+  // Overrides.
+  v = Field(configv, 1);
+  if (Is_block(v)) conf.do_bva = Bool_val(Field(v, 0));
+  v = Field(configv, 2);
+  if (Is_block(v)) conf.doVarElim = Bool_val(Field(v, 0));
+  v = Field(configv, 3);
+  if (Is_block(v)) conf.doProbe = Bool_val(Field(v, 0));
+  v = Field(configv, 4);
+  if (Is_block(v)) conf.doCache = Bool_val(Field(v, 0));
+  v = Field(configv, 5);
+  if (Is_block(v)) conf.maxCacheSizeMB = Int_val(Field(v, 0));
+  v = Field(configv, 6);
+  if (Is_block(v)) conf.restartType = restart_types[Int_val(Field(v, 0))];
+  v = Field(configv, 7);
+  if (Is_block(v)) {
+    // Only the selected clause cleaning type is used. It keeps
+    // the same ratio of clauses as the default cleaning type.
+    const double ratio = conf.ratio_keep_clauses[default_clean_type];
+    conf.ratio_keep_clauses[clean_glue_based] = 0;
+    conf.ratio_keep_clauses[clean_size_based] = 0;
+    conf.ratio_keep_clauses[clean_sum_activity_based] = 0;
+    conf.ratio_keep_clauses[clean_types[Int_val(Field(v, 0))]] = ratio;
+  }
+  v = Field(configv, 8);
+  if (Is_block(v)) conf.maxMemMB = Int_val(Field(v, 0));
+  v = Field(configv, 9);
+  if (Is_block(v)) {
+    // Checked by cmsat_create_with_config, otherwise the solver
+    // would exit when SQLite support isn't compiled in.
+    conf.doSQL = 2;
+    conf.whichSQL = 3;
+    conf.sqlite_filename = String_val(Field(v, 0));
+  }
+  if (Bool_val(Field(configv, 10))) {
+    // Variables in the proof must be numbered as in OCaml
+    // and every derived clause must be written to the proof.
+    conf.do_bva = false;
+    conf.doRenumberVars = false;
+    conf.doCompHandler = false;
+    conf.doFindXors = false;
+  }
+
+  return conf;
+}
+
 static void cmsat_finalize (value sv) {
   WrappedSolver * ws = WrappedSolver_val(sv);
 
@@ -87,6 +251,27 @@ CAMLprim value cmsat_create(value unit) {
   CAMLreturn (sv);
 }
 
+CAMLprim value cmsat_create_with_config(value configv) {
+  CAMLparam1 (configv);
+  CAMLlocal1 (sv);
+
+#ifndef USE_SQLITE3
+  if (Is_block(Field(configv, 9)))
+    caml_failwith("cmsat_create_with_config: no SQLite support");
+#endif
+
+  WrappedSolver * ws = new WrappedSolver(conf_of_value(configv));
+  if (Bool_val(Field(configv, 10)))
+    ws->enableProof();
+
+  sv = caml_alloc_custom(&cmsat_ops, sizeof(WrappedSolver *), 0, 1);
+  WrappedSolver_val(sv) = ws;
+
+  log("cmsat_create_with_config() = %p\n", (void *)ws->solver);
+
+  CAMLreturn (sv);
+}
+
 CAMLprim value cmsat_new_var(value sv) {
   CAMLparam1 (sv);
 
@@ -116,6 +301,9 @@ CAMLprim value cmsat_add_clause(value sv, value litsv, value lenv) {
   log_lits(lits);
   log(", %d) = ", len);
 
+  if (ws->cnf)
+    write_dimacs(ws->cnf, lits);
+
   bool res = s->add_clause_outer(lits);
 
   log("%d\n", (int)res);
@@ -123,6 +311,33 @@ CAMLprim value cmsat_add_clause(value sv, value litsv, value lenv) {
   CAMLreturn (Val_bool(res));
 }
 
+CAMLprim value cmsat_add_at_most_one_clause(value sv, value litsv) {
+  CAMLparam2 (sv, litsv);
+
+  WrappedSolver * ws = WrappedSolver_val(sv);
+  Solver * s = ws->solver;
+  Lit lit1 = Lit::toLit(Int_val(Field(litsv, 0)));
+  Lit lit2 = Lit::toLit(Int_val(Field(litsv, 1)));
+
+  log("cmsat_add_at_most_one_clause(%p, [%d;%d])\n",
+      (void *)s, lit1.toInt(), lit2.toInt());
+
+  bool res;
+  if (ws->cnf) {
+    // The proof contains only clauses.
+    vector<Lit> lits;
+    lits.push_back(lit1);
+    lits.push_back(lit2);
+    write_dimacs(ws->cnf, lits);
+    res = s->add_clause_outer(lits);
+  } else {
+    ws->amoFinder->add_binary(lit1, lit2);
+    res = s->okay();
+  }
+
+  CAMLreturn (Val_bool(res));
+}
+
 CAMLprim value cmsat_solve(value sv, value assumptsv) {
   CAMLparam2 (sv, assumptsv);
 
@@ -137,6 +352,8 @@ CAMLprim value cmsat_solve(value sv, value assumptsv) {
     assumpts.push_back(Lit::toLit(Int_val(Field(assumptsv, i))));
   }
 
+  ws->amoFinder->flush();
+
   caml_release_runtime_system();
   lbool lb = s->solve_with_assumptions(&assumpts);
   caml_acquire_runtime_system();
@@ -146,6 +363,20 @@ CAMLprim value cmsat_solve(value sv, value assumptsv) {
   if (lb == l_True) res = 0;
   else if (lb == l_False) res = 1;
 
+  // Assumptions are needed to check the proof of unsatisfiability.
+  if (lb == l_False && ws->cnf) {
+    const std::string fname = ws->proofPrefix + ".assumptions";
+    FILE * f = fopen(fname.c_str(), "w");
+    bool ok = f != NULL;
+    if (ok) {
+      for (size_t i = 0; i < assumpts.size(); i++)
+        write_dimacs(f, vector<Lit>(1, assumpts[i]));
+      ok = fclose(f) == 0;
+    }
+    if (!ok || !ws->flushProof())
+      caml_failwith("cmsat_solve: cannot write proof");
+  }
+
   log("cmsat_solve(%p, ", (void *)s);
   log_lits(assumpts);
   log(") = %d\n", res);
@@ -171,15 +402,204 @@ CAMLprim value cmsat_model_value(value sv, value varv) {
   CAMLreturn (Val_int(res));
 }
 
+CAMLprim value cmsat_set_phase(value sv, value varv, value phasev) {
+  CAMLparam3 (sv, varv, phasev);
+
+  WrappedSolver * ws = WrappedSolver_val(sv);
+  ws->solver->set_polarity_outer(Int_val(varv), Bool_val(phasev));
+
+  CAMLreturn (Val_unit);
+}
+
+CAMLprim value cmsat_get_phase(value sv, value varv) {
+  CAMLparam2 (sv, varv);
+
+  WrappedSolver * ws = WrappedSolver_val(sv);
+
+  CAMLreturn (Val_bool(ws->solver->get_polarity_outer(Int_val(varv))));
+}
+
+CAMLprim value cmsat_set_activity(value sv, value varv, value activityv) {
+  CAMLparam3 (sv, varv, activityv);
+
+  WrappedSolver * ws = WrappedSolver_val(sv);
+  ws->solver->set_activity_outer(Int_val(varv), Double_val(activityv));
+
+  CAMLreturn (Val_unit);
+}
+
+CAMLprim value cmsat_get_activity(value sv, value varv) {
+  CAMLparam2 (sv, varv);
+
+  WrappedSolver * ws = WrappedSolver_val(sv);
+
+  CAMLreturn (caml_copy_double(ws->solver->get_activity_outer(Int_val(varv))));
+}
+
+CAMLprim value cmsat_set_frozen(value sv, value varv, value frozenv) {
+  CAMLparam3 (sv, varv, frozenv);
+
+  WrappedSolver * ws = WrappedSolver_val(sv);
+  ws->solver->set_frozen_outer(Int_val(varv), Bool_val(frozenv));
+
+  CAMLreturn (Val_unit);
+}
+
+CAMLprim value cmsat_add_learnt(value sv, value litsv, value lenv) {
+  CAMLparam3 (sv, litsv, lenv);
+
+  WrappedSolver * ws = WrappedSolver_val(sv);
+  Solver * s = ws->solver;
+  int len = Int_val(lenv);
+
+  // Literals.
+  vector<Lit> lits;
+  lits.reserve(len);
+  for (int i = 0; i < len; i++) {
+    lits.push_back(Lit::toLit(Int_val(Field(litsv, i))));
+  }
+
+  log("cmsat_add_learnt(%p, ", (void *)s);
+  log_lits(lits);
+  log(", %d) = ", len);
+
+  bool res = s->add_red_clause_outer(lits);
+
+  log("%d\n", (int)res);
+
+  CAMLreturn (Val_bool(res));
+}
+
+CAMLprim value cmsat_export_learnts(value sv, value maxlenv, value maxgluev) {
+  CAMLparam3 (sv, maxlenv, maxgluev);
+  CAMLlocal3 (resv, litsv, consv);
+
+  WrappedSolver * ws = WrappedSolver_val(sv);
+  Solver * s = ws->solver;
+
+  const vector<vector<Lit> > learnts =
+    s->get_learnts_outside(Int_val(maxlenv), Int_val(maxgluev));
+
+  resv = Val_emptylist;
+  for (size_t i = 0; i < learnts.size(); i++) {
+    const vector<Lit> & lits = learnts[i];
+    litsv = caml_alloc(lits.size(), 0);
+    for (size_t j = 0; j < lits.size(); j++)
+      Store_field(litsv, j, Val_int(lits[j].toInt()));
+    consv = caml_alloc(2, 0);
+    Store_field(consv, 0, litsv);
+    Store_field(consv, 1, resv);
+    resv = consv;
+  }
+
+  log("cmsat_export_learnts(%p, %d, %d) = %d\n",
+      (void *)s, Int_val(maxlenv), Int_val(maxgluev), (int)learnts.size());
+
+  CAMLreturn (resv);
+}
+
 CAMLprim value cmsat_interrupt(value sv) {
   CAMLparam1 (sv);
 
   WrappedSolver * ws = WrappedSolver_val(sv);
-  ws->interrupt = true;
+  ws->interrupt.store(true, std::memory_order_relaxed);
 
   log("cmsat_interrupt(%p)\n", (void *)s);
 
   CAMLreturn (Val_unit);
 }
 
+CAMLprim value cmsat_clear_interrupt(value sv) {
+  CAMLparam1 (sv);
+
+  WrappedSolver * ws = WrappedSolver_val(sv);
+  ws->interrupt.store(false, std::memory_order_relaxed);
+
+  log("cmsat_clear_interrupt(%p)\n", (void *)ws->solver);
+
+  CAMLreturn (Val_unit);
+}
+
+// Can be called by another thread while the solver is searching.
+CAMLprim value cmsat_poll_progress(value sv) {
+  CAMLparam1 (sv);
+  CAMLlocal3 (resv, snapv, consv);
+
+  WrappedSolver * ws = WrappedSolver_val(sv);
+  ProgressSnapshot snaps[ProgressRing::capacity];
+  size_t n = ws->progress.poll(snaps);
+
+  // List of Sh.progress records, the oldest snapshot first.
+  resv = Val_emptylist;
+  for (size_t i = n; i > 0; i--) {
+    snapv = caml_alloc_tuple(3);
+    Store_field(snapv, 0, Val_long(snaps[i-1].conflicts));
+    Store_field(snapv, 1, Val_long(snaps[i-1].decisions));
+    Store_field(snapv, 2, Val_long(snaps[i-1].depth));
+    consv = caml_alloc(2, 0);
+    Store_field(consv, 0, snapv);
+    Store_field(consv, 1, resv);
+    resv = consv;
+  }
+
+  log("cmsat_poll_progress(%p) = %d\n", (void *)ws->solver, (int)n);
+
+  CAMLreturn (resv);
+}
+
+CAMLprim value cmsat_add_stats_tag(value sv, value namev, value tagv) {
+  CAMLparam3 (sv, namev, tagv);
+
+  WrappedSolver * ws = WrappedSolver_val(sv);
+  ws->solver->add_sql_tag(String_val(namev), String_val(tagv));
+
+  CAMLreturn (Val_unit);
+}
+
+CAMLprim value cmsat_stats_supported(value unit) {
+  CAMLparam1 (unit);
+
+#ifdef USE_SQLITE3
+  CAMLreturn (Val_true);
+#else
+  CAMLreturn (Val_false);
+#endif
+}
+
+CAMLprim value cmsat_delete_stats(value dbv, value configv, value problemv) {
+  CAMLparam3 (dbv, configv, problemv);
+
+#ifdef USE_SQLITE3
+  if (!SQLiteStats::delete_stats(
+        String_val(dbv), String_val(configv), String_val(problemv)))
+    caml_failwith("cmsat_delete_stats");
+#else
+  caml_failwith("cmsat_delete_stats: no SQLite support");
+#endif
+
+  CAMLreturn (Val_unit);
+}
+
+CAMLprim value cmsat_start_proof(value sv, value prefixv) {
+  CAMLparam2 (sv, prefixv);
+
+  WrappedSolver * ws = WrappedSolver_val(sv);
+  if (!ws->drat)
+    caml_failwith("cmsat_start_proof: proof is not enabled");
+
+  const std::string prefix = String_val(prefixv);
+  if (ws->cnf && fclose(ws->cnf) != 0) {
+    ws->cnf = 0;
+    caml_failwith("cmsat_start_proof: cannot write proof");
+  }
+  ws->cnf = fopen((prefix + ".cnf").c_str(), "w");
+  if (!ws->cnf || !ws->drat->writer.open(prefix + ".drat"))
+    caml_failwith("cmsat_start_proof: cannot open proof");
+  ws->proofPrefix = prefix;
+
+  log("cmsat_start_proof(%p, %s)\n", (void *)ws->solver, prefix.c_str());
+
+  CAMLreturn (Val_unit);
+}
+
 } // extern "C" {
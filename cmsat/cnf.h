@@ -32,6 +32,7 @@
 #include "drup.h"
 #include "clauseallocator.h"
 #include "varupdatehelper.h"
+#include <atomic>
 
 namespace CMSat {
 using namespace CMSat;
@@ -64,7 +65,7 @@ public:
         uint64_t redLits = 0;
     };
 
-    CNF(const SolverConf *_conf, bool* _needToInterrupt) :
+    CNF(const SolverConf *_conf, std::atomic<bool>* _needToInterrupt) :
         minNumVars(0)
     {
         if (_conf != NULL) {
@@ -75,8 +76,7 @@ public:
             needToInterrupt = _needToInterrupt;
             needToInterrupt_is_foreign = true;
         } else {
-            needToInterrupt = new bool;
-            *needToInterrupt = false;
+            needToInterrupt = new std::atomic<bool>(false);
             needToInterrupt_is_foreign = false;
         }
     }
@@ -133,20 +133,20 @@ public:
 
     bool must_interrupt_asap() const
     {
-        return *needToInterrupt;
+        return needToInterrupt->load(std::memory_order_relaxed);
     }
 
     void set_must_interrupt_asap()
     {
-        *needToInterrupt = true;
+        needToInterrupt->store(true, std::memory_order_relaxed);
     }
 
     void unset_must_interrupt_asap()
     {
-        *needToInterrupt = false;
+        needToInterrupt->store(false, std::memory_order_relaxed);
     }
 
-    bool* get_must_interrupt_asap_ptr()
+    std::atomic<bool>* get_must_interrupt_asap_ptr()
     {
         return needToInterrupt;
     }
@@ -256,7 +256,7 @@ protected:
     vector<lbool> assigns;
 
 private:
-    bool *needToInterrupt; ///<Interrupt cleanly ASAP if true
+    std::atomic<bool> *needToInterrupt; ///<Interrupt cleanly ASAP if true
     void enlarge_minimal_datastructs(size_t n = 1);
     void enlarge_nonminimial_datastructs(size_t n = 1);
     void swapVars(const Var which, const int off_by = 0);
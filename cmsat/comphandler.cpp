@@ -99,7 +99,9 @@ void CompHandler::createRenumbering(const vector<Var>& vars)
 bool CompHandler::assumpsInsideComponent(const vector<Var>& vars)
 {
     for(Var var: vars) {
-        if (solver->var_inside_assumptions(var)) {
+        if (solver->var_inside_assumptions(var)
+            || solver->in_at_most_one(var)
+        ) {
             return true;
         }
     }
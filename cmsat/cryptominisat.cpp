@@ -38,7 +38,7 @@ static const bool print_thread_start_and_finish = false;
 
 namespace CMSat {
     struct CMSatPrivateData {
-        explicit CMSatPrivateData(bool* _interrupt_asap) {
+        explicit CMSatPrivateData(std::atomic<bool>* _interrupt_asap) {
             cls = 0;
             vars_to_add = 0;
             inter = _interrupt_asap;
@@ -57,7 +57,7 @@ namespace CMSat {
         vector<Solver*> solvers;
         SharedData *shared_data;
         int which_solved;
-        bool* inter;
+        std::atomic<bool>* inter;
         unsigned cls;
         unsigned vars_to_add;
         vector<Lit> cls_lits;
@@ -93,7 +93,7 @@ struct DataForThread
     lbool* ret;
 };
 
-SATSolver::SATSolver(void* config, bool* interrupt_asap)
+SATSolver::SATSolver(void* config, std::atomic<bool>* interrupt_asap)
 {
     data = new CMSatPrivateData(interrupt_asap);
     data->solvers.push_back(new Solver((SolverConf*) config, data->inter));
@@ -26,6 +26,7 @@ THE SOFTWARE.
 #include <vector>
 #include <iostream>
 #include <utility>
+#include <atomic>
 #include "solvertypesmini.h"
 
 namespace CMSat {
@@ -33,7 +34,7 @@ namespace CMSat {
     class SATSolver
     {
     public:
-        SATSolver(void* config = NULL, bool* interrupt_asap = NULL);
+        SATSolver(void* config = NULL, std::atomic<bool>* interrupt_asap = NULL);
         ~SATSolver();
         void set_num_threads(unsigned n);
         unsigned nVars() const;
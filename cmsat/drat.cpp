@@ -0,0 +1,115 @@
+/* Copyright (c) 2015 Radek Micek */
+
+#include "drat.h"
+
+using namespace CMSat;
+
+DratWriter::DratWriter()
+{
+    buf.reserve(buf_size);
+    pending.reserve(buf_size);
+}
+
+DratWriter::~DratWriter()
+{
+    close();
+    if (thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mu);
+            stop = true;
+        }
+        cond.notify_all();
+        thread.join();
+    }
+}
+
+bool DratWriter::open(const std::string& fname)
+{
+    if (!close()) {
+        return false;
+    }
+
+    file = std::fopen(fname.c_str(), "wb");
+    if (file == NULL) {
+        return false;
+    }
+    failed = false;
+
+    if (!thread.joinable()) {
+        thread = std::thread(&DratWriter::run, this);
+    }
+
+    return true;
+}
+
+bool DratWriter::close()
+{
+    if (file == NULL) {
+        buf.clear();
+        return true;
+    }
+
+    wait_written();
+    const bool ok = !failed && std::fclose(file) == 0;
+    file = NULL;
+
+    return ok;
+}
+
+bool DratWriter::flush()
+{
+    if (file == NULL) {
+        return false;
+    }
+
+    wait_written();
+    return !failed && std::fflush(file) == 0;
+}
+
+void DratWriter::hand_over()
+{
+    if (file == NULL) {
+        buf.clear();
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mu);
+    cond.wait(lock, [this] { return pending.empty(); });
+    buf.swap(pending);
+    lock.unlock();
+    cond.notify_all();
+}
+
+void DratWriter::wait_written()
+{
+    if (!buf.empty()) {
+        hand_over();
+    }
+
+    std::unique_lock<std::mutex> lock(mu);
+    cond.wait(lock, [this] { return pending.empty(); });
+}
+
+void DratWriter::run()
+{
+    std::unique_lock<std::mutex> lock(mu);
+    for (;;) {
+        cond.wait(lock, [this] { return stop || !pending.empty(); });
+        if (pending.empty()) {
+            return;
+        }
+
+        //The solver doesn't touch the pending buffer nor the file
+        //until the buffer is empty
+        lock.unlock();
+        if (std::fwrite(pending.data(), 1, pending.size(), file)
+            != pending.size()
+        ) {
+            failed = true;
+        }
+        lock.lock();
+
+        pending.clear();
+        cond.notify_all();
+    }
+}
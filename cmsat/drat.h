@@ -0,0 +1,222 @@
+/* Copyright (c) 2015 Radek Micek */
+
+#ifndef __DRAT_H__
+#define __DRAT_H__
+
+#include "drup.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace CMSat {
+using namespace CMSat;
+
+/**
+@brief Writes a binary DRAT proof to a file from a separate thread
+
+The solver only appends bytes to an in-memory buffer. Full buffers are
+handed over to the writer thread, so the solver waits for the disk
+only when it produces the proof faster than the disk can store it.
+
+Literals are encoded as in drat-trim: 2*(var+1)+sign
+as a variable-length integer with 7 bits per byte.
+*/
+class DratWriter
+{
+public:
+    DratWriter();
+    ~DratWriter();
+
+    /// Finishes the current file and continues the proof in the new file.
+    bool open(const std::string& fname);
+    /// Waits until the whole proof is written and closes the file.
+    bool close();
+    /// Waits until the whole proof is written to the file.
+    bool flush();
+
+    void add_lit(const Lit lit)
+    {
+        uint32_t x = lit.toInt() + 2;
+        while (x > 127) {
+            put((x & 127) | 128);
+            x >>= 7;
+        }
+        put(x);
+    }
+
+    void start_add()
+    {
+        put('a');
+    }
+
+    void start_del()
+    {
+        put('d');
+    }
+
+    void end()
+    {
+        put(0);
+    }
+
+private:
+    void put(const unsigned char c)
+    {
+        buf.push_back(c);
+        if (buf.size() >= buf_size) {
+            hand_over();
+        }
+    }
+
+    void hand_over();
+    void wait_written();
+    void run();
+
+    static const size_t buf_size = 1 << 20;
+
+    std::vector<unsigned char> buf;
+    std::vector<unsigned char> pending;
+    FILE* file = NULL;
+    bool stop = false;
+    bool failed = false;
+    std::thread thread;
+    std::mutex mu;
+    std::condition_variable cond;
+};
+
+/**
+@brief DRUP interface which writes a binary DRAT proof
+
+Clauses and delayed deletions are handled in the same way as by DrupFile.
+*/
+struct DratBinary: public Drup
+{
+    DratWriter writer;
+
+    bool enabled() override
+    {
+        return true;
+    }
+
+    bool something_delayed() override
+    {
+        return delete_filled;
+    }
+
+    void forget_delay() override
+    {
+        todel.clear();
+        must_delete_next = false;
+        delete_filled = false;
+    }
+
+    Drup& operator<<(const Lit lit) override
+    {
+        if (must_delete_next) {
+            todel.push_back(lit);
+        } else {
+            start_clause();
+            writer.add_lit(lit);
+        }
+
+        return *this;
+    }
+
+    Drup& operator<<(const Clause& cl) override
+    {
+        if (must_delete_next) {
+            for(const Lit lit: cl) {
+                todel.push_back(lit);
+            }
+        } else {
+            start_clause();
+            for(const Lit lit: cl) {
+                writer.add_lit(lit);
+            }
+        }
+
+        return *this;
+    }
+
+    Drup& operator<<(const vector<Lit>& lits) override
+    {
+        if (must_delete_next) {
+            todel.insert(todel.end(), lits.begin(), lits.end());
+        } else {
+            start_clause();
+            for(const Lit lit: lits) {
+                writer.add_lit(lit);
+            }
+        }
+
+        return *this;
+    }
+
+    Drup& operator<<(const DrupFlag flag) override
+    {
+        switch (flag)
+        {
+            case DrupFlag::fin:
+                if (must_delete_next) {
+                    delete_filled = true;
+                } else {
+                    start_clause();
+                    writer.end();
+                    in_clause = false;
+                }
+                must_delete_next = false;
+                break;
+
+            case DrupFlag::deldelay:
+                assert(!delete_filled);
+                assert(todel.empty());
+                delete_filled = false;
+
+                must_delete_next = true;
+                break;
+
+            case DrupFlag::findelay:
+                assert(delete_filled);
+                writer.start_del();
+                for(const Lit lit: todel) {
+                    writer.add_lit(lit);
+                }
+                writer.end();
+                todel.clear();
+                delete_filled = false;
+                break;
+
+            case DrupFlag::del:
+                todel.clear();
+                delete_filled = false;
+
+                must_delete_next = false;
+                writer.start_del();
+                in_clause = true;
+                break;
+        }
+
+        return *this;
+    }
+
+private:
+    void start_clause()
+    {
+        if (!in_clause) {
+            writer.start_add();
+            in_clause = true;
+        }
+    }
+
+    vector<Lit> todel;
+    bool delete_filled = false;
+    bool must_delete_next = false;
+    bool in_clause = false;
+};
+
+}
+
+#endif //__DRAT_H__
@@ -24,7 +24,7 @@
 
 using namespace CMSat;
 
-HyperEngine::HyperEngine(const SolverConf *_conf, bool* _needToInterrupt) :
+HyperEngine::HyperEngine(const SolverConf *_conf, std::atomic<bool>* _needToInterrupt) :
     PropEngine(_conf, _needToInterrupt)
     , stampingTime(0)
 {
@@ -87,6 +87,10 @@ Lit HyperEngine::propagate_bfs(const uint64_t timeout)
 
         }
         propStats.bogoProps += ws.size()*4;
+
+        ret = prop_amo_with_ancestor_info(p, confl);
+        if (ret == PROP_FAIL)
+            return analyzeFail(confl);
     }
 
     //Propagate binary redundant
@@ -1036,6 +1040,40 @@ PropResult HyperEngine::prop_bin_with_ancestor_info(
 }
 
 
+//Like irredundant binary clauses but without transitive reduction,
+//since the binary clauses don't exist
+PropResult HyperEngine::prop_amo_with_ancestor_info(
+    const Lit p
+    , PropBy& confl
+) {
+    for(const uint32_t at: amo_watches[p.toInt()]) {
+        const vector<Lit>& amo = amo_constraints[at];
+        propStats.bogoProps += amo.size()/4 + 1;
+
+        for(const Lit lit: amo) {
+            const lbool val = value(lit);
+            if (val == l_False || lit == p)
+                continue;
+
+            if (val == l_True) {
+                lastConflictCausedBy = ConflCausedBy::binirred;
+                failBinLit = ~lit;
+                confl = amo_reason(p);
+                return PROP_FAIL;
+            }
+
+            #ifdef STATS_NEEDED
+            propStats.propsBinIrred++;
+            #endif
+
+            enqueue_with_acestor_info(~lit, p, false);
+            varData[lit.var()].reason = amo_reason(p);
+        }
+    }
+
+    return PROP_NOTHING;
+}
+
 PropResult HyperEngine::prop_normal_cl_with_ancestor_info(
     watch_subarray_const::const_iterator i
     , watch_subarray::iterator &j
@@ -36,7 +36,7 @@ using namespace CMSat;
 
 class HyperEngine : public PropEngine {
 public:
-    HyperEngine(const SolverConf *_conf, bool* _needToInterrupt);
+    HyperEngine(const SolverConf *_conf, std::atomic<bool>* _needToInterrupt);
     size_t print_stamp_mem(size_t totalMem) const;
     size_t mem_used() const;
     size_t mem_used_stamp() const;
@@ -88,6 +88,10 @@ private:
         , watch_subarray::const_iterator k
         , PropBy& confl
     );
+    PropResult prop_amo_with_ancestor_info(
+        const Lit p
+        , PropBy& confl
+    );
     PropResult prop_tri_clause_with_acestor_info(
         watch_subarray_const::const_iterator i
         , const Lit lit1
@@ -20,6 +20,8 @@
 */
 
 #include "intree.h"
+
+#include <algorithm>
 #include "solver.h"
 #include "varreplacer.h"
 #include "clausecleaner.h"
@@ -149,6 +151,11 @@ bool InTree::intree_probe()
     fill_roots();
     randomize_roots();
 
+    //Roots whose implications may have changed go first
+    std::stable_partition(roots.begin(), roots.end(), [&](const Lit lit) {
+        return solver->var_touched(lit.var());
+    });
+
     //Let's enqueue all ~root -s.
     for(Lit lit: roots) {
         enqueue(~lit, lit_Undef, false);
@@ -316,6 +316,7 @@ vector<Var> Prober::randomize_possible_choices()
     for(size_t i = 0; i < solver->nVars(); i++) {
         if (solver->value(i) == l_Undef
             && solver->varData[i].removed == Removed::none
+            && (!solver->conf.probe_touched_only || solver->var_touched(i))
         ) {
             poss_choice.push_back(i);
         }
@@ -402,6 +403,9 @@ bool Prober::probe()
         ) {
             goto end;
         }
+
+        //Cached implications of var stay valid until new clauses touch it
+        solver->untouch_var(var);
     }
 
 end:
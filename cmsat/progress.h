@@ -0,0 +1,103 @@
+/* Copyright (c) 2015 Radek Micek */
+
+#ifndef __PROGRESS_H__
+#define __PROGRESS_H__
+
+#include <atomic>
+#include <cstdint>
+
+namespace CMSat {
+
+struct ProgressSnapshot
+{
+    uint64_t conflicts;
+    uint64_t decisions;
+    uint64_t depth;
+};
+
+/**
+@brief Lock-free ring buffer of progress snapshots
+
+The search thread publishes snapshots and another thread reads them
+without stopping the search. Each slot is guarded by a sequence number
+which is odd while the slot is being written, so the reader skips
+snapshots which were overwritten while it was copying them.
+When the reader doesn't keep up the oldest snapshots are lost.
+*/
+class ProgressRing
+{
+public:
+    static const uint64_t capacity = 64;
+    //The searcher publishes a snapshot after this many conflicts
+    static const uint64_t interval = 256;
+
+    ProgressRing() :
+        head(0)
+        , tail(0)
+    {
+        for(Slot& s: slots) {
+            s.seq.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    ProgressRing(const ProgressRing&) = delete;
+    ProgressRing& operator=(const ProgressRing&) = delete;
+
+    //Called only by the search thread
+    void publish(uint64_t conflicts, uint64_t decisions, uint64_t depth)
+    {
+        const uint64_t i = head.load(std::memory_order_relaxed);
+        Slot& s = slots[i % capacity];
+        s.seq.store(2*i + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        s.conflicts.store(conflicts, std::memory_order_relaxed);
+        s.decisions.store(decisions, std::memory_order_relaxed);
+        s.depth.store(depth, std::memory_order_relaxed);
+        s.seq.store(2*i + 2, std::memory_order_release);
+        head.store(i + 1, std::memory_order_release);
+    }
+
+    //Called only by the reader. Copies the snapshots published since
+    //the previous call (oldest first, at most capacity) to out
+    //and returns their number.
+    size_t poll(ProgressSnapshot* out)
+    {
+        const uint64_t h = head.load(std::memory_order_acquire);
+        if (h - tail > capacity)
+            tail = h - capacity;
+
+        size_t n = 0;
+        for(; tail < h; tail++) {
+            const Slot& s = slots[tail % capacity];
+            const uint64_t seq = s.seq.load(std::memory_order_acquire);
+            ProgressSnapshot snap;
+            snap.conflicts = s.conflicts.load(std::memory_order_relaxed);
+            snap.decisions = s.decisions.load(std::memory_order_relaxed);
+            snap.depth = s.depth.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq == 2*tail + 2
+                && s.seq.load(std::memory_order_relaxed) == seq
+            ) {
+                out[n++] = snap;
+            }
+        }
+        return n;
+    }
+
+private:
+    struct Slot
+    {
+        std::atomic<uint64_t> seq;
+        std::atomic<uint64_t> conflicts;
+        std::atomic<uint64_t> decisions;
+        std::atomic<uint64_t> depth;
+    };
+
+    Slot slots[capacity];
+    std::atomic<uint64_t> head; ///<Number of published snapshots
+    uint64_t tail; ///<Number of snapshots seen by the reader
+};
+
+}
+
+#endif //__PROGRESS_H__
@@ -47,7 +47,7 @@ using std::endl;
 @brief Sets a sane default config and allocates handler classes
 */
 PropEngine::PropEngine(
-    const SolverConf* _conf, bool* _needToInterrupt
+    const SolverConf* _conf, std::atomic<bool>* _needToInterrupt
 ) :
         CNF(_conf, _needToInterrupt)
         , qhead(0)
@@ -62,6 +62,7 @@ PropEngine::~PropEngine()
 void PropEngine::new_var(const bool bva, Var orig_outer)
 {
     CNF::new_var(bva, orig_outer);
+    amo_watches.resize(watches.size());
     //TODO
     //trail... update x->whatever
 }
@@ -69,6 +70,7 @@ void PropEngine::new_var(const bool bva, Var orig_outer)
 void PropEngine::new_vars(size_t n)
 {
     CNF::new_vars(n);
+    amo_watches.resize(watches.size());
     //TODO
     //trail... update x->whatever
 }
@@ -76,6 +78,8 @@ void PropEngine::new_vars(size_t n)
 void PropEngine::save_on_var_memory()
 {
     CNF::save_on_var_memory();
+    amo_watches.resize(watches.size());
+    amo_watches.shrink_to_fit();
 }
 
 
@@ -256,6 +260,39 @@ inline bool PropEngine::propBinaryClause(
     return true;
 }
 
+template<bool update_bogoprops>
+inline bool PropEngine::prop_at_most_one(const Lit p, PropBy& confl)
+{
+    for(const uint32_t at: amo_watches[p.toInt()]) {
+        const vector<Lit>& amo = amo_constraints[at];
+        if (update_bogoprops) {
+            propStats.bogoProps += amo.size()/4 + 1;
+        }
+
+        for(const Lit lit: amo) {
+            const lbool val = value(lit);
+            if (val == l_False || lit == p)
+                continue;
+
+            if (val == l_Undef) {
+                #ifdef STATS_NEEDED
+                propStats.propsBinIrred++;
+                #endif
+
+                enqueue<update_bogoprops>(~lit, amo_reason(p));
+            } else {
+                lastConflictCausedBy = ConflCausedBy::binirred;
+                confl = amo_reason(p);
+                failBinLit = ~lit;
+                qhead = trail.size();
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
 void PropEngine::update_glue(Clause& c)
 {
     if (c.red()
@@ -749,6 +786,10 @@ PropBy PropEngine::propagateAnyOrder()
         }
         ws.shrink_(end-j);
 
+        if (confl.isNULL()) {
+            prop_at_most_one<update_bogoprops>(p, confl);
+        }
+
         qhead++;
     }
 
@@ -833,6 +874,9 @@ void PropEngine::updateVars(
     , const vector<uint32_t>& interToOuter
     , const vector<uint32_t>& interToOuter2
 ) {
+    //Must use the values before they are renumbered
+    clean_amo_constraints();
+
     updateArray(varData, interToOuter);
     #ifdef STATS_NEEDED
     updateArray(varDataLT, interToOuter);
@@ -856,6 +900,54 @@ void PropEngine::updateVars(
         if (!watches[i].empty())
             updateWatch(watches[i], outerToInter);
     }
+
+    for(vector<Lit>& amo: amo_constraints) {
+        for(Lit& lit: amo) {
+            lit = getUpdatedLit(lit, outerToInter);
+        }
+    }
+    attach_amo_constraints();
+}
+
+//Removes the literals set at level 0 and the satisfied constraints
+void PropEngine::clean_amo_constraints()
+{
+    assert(decisionLevel() == 0);
+
+    size_t j = 0;
+    for(size_t i = 0; i < amo_constraints.size(); i++) {
+        vector<Lit>& amo = amo_constraints[i];
+        bool satisfied = false;
+        size_t k = 0;
+        for(const Lit lit: amo) {
+            const lbool val = value(lit);
+            if (val == l_True) {
+                satisfied = true;
+            } else if (val == l_Undef) {
+                amo[k++] = lit;
+            }
+        }
+        amo.resize(k);
+
+        if (!satisfied && amo.size() > 1) {
+            amo_constraints[j++].swap(amo);
+        }
+    }
+    amo_constraints.resize(j);
+}
+
+void PropEngine::attach_amo_constraints()
+{
+    for(vector<uint32_t>& ws: amo_watches) {
+        ws.clear();
+    }
+    amo_watches.resize(watches.size());
+
+    for(size_t i = 0; i < amo_constraints.size(); i++) {
+        for(const Lit lit: amo_constraints[i]) {
+            amo_watches[lit.toInt()].push_back(i);
+        }
+    }
 }
 
 inline void PropEngine::updateWatch(
@@ -944,6 +1036,10 @@ PropBy PropEngine::propagateBinFirst(
                 continue;
             } //end CLAUSE
         }
+
+        if (confl.isNULL()) {
+            prop_at_most_one(p, confl);
+        }
     }
 
     PropResult ret = PROP_NOTHING;
@@ -1074,6 +1170,29 @@ bool PropEngine::propagate_occur()
                     return false;
             }
         }
+
+        if (!propagate_at_most_one_occur(p))
+            return false;
+    }
+
+    return true;
+}
+
+bool PropEngine::propagate_at_most_one_occur(const Lit p)
+{
+    for(const uint32_t at: amo_watches[p.toInt()]) {
+        for(const Lit lit: amo_constraints[at]) {
+            const lbool val = value(lit);
+            if (val == l_False || lit == p)
+                continue;
+
+            if (val == l_True) {
+                ok = false;
+                return false;
+            }
+
+            enqueue(~lit);
+        }
     }
 
     return true;
@@ -79,7 +79,7 @@ public:
     //
     PropEngine(
         const SolverConf* _conf
-        , bool* _needToInterrupt
+        , std::atomic<bool>* _needToInterrupt
     );
     ~PropEngine();
 
@@ -100,6 +100,7 @@ public:
     void enqueue(const Lit p, const PropBy from = PropBy());
     void new_decision_level();
     bool update_polarity_and_activity = true;
+    bool in_at_most_one(const Var var) const;
 
 protected:
     virtual Lit find_good_blocked_lit(const Clause& c) const  = 0;
@@ -119,6 +120,14 @@ protected:
     uint32_t            qhead;            ///< Head of queue (as index into the trail)
     Lit                 failBinLit;       ///< Used to store which watches[lit] we were looking through when conflict occured
 
+    //At-most-one constraints. They are propagated as if they were
+    //binary clauses between each pair of their literals
+    vector<vector<Lit> >      amo_constraints;
+    vector<vector<uint32_t> > amo_watches;      ///< Indices of the at-most-one constraints containing the literal
+    PropBy amo_reason(const Lit p) const;
+    void clean_amo_constraints();
+    void attach_amo_constraints();
+
     template<bool update_bogoprops>
     PropBy propagateAnyOrder();
     PropBy propagateBinFirst(
@@ -203,6 +212,14 @@ protected:
         mem += trail.capacity()*sizeof(Lit);
         mem += trail_lim.capacity()*sizeof(uint32_t);
         mem += toClear.capacity()*sizeof(Lit);
+        mem += amo_constraints.capacity()*sizeof(vector<Lit>);
+        for(const vector<Lit>& amo: amo_constraints) {
+            mem += amo.capacity()*sizeof(Lit);
+        }
+        mem += amo_watches.capacity()*sizeof(vector<uint32_t>);
+        for(const vector<uint32_t>& ws: amo_watches) {
+            mem += ws.capacity()*sizeof(uint32_t);
+        }
         return mem;
     }
 
@@ -217,6 +234,9 @@ private:
         , const Lit p
         , PropBy& confl
     ); ///<Propagate 2-long clause
+    template<bool update_bogoprops = true>
+    bool prop_at_most_one(const Lit p, PropBy& confl);
+    bool propagate_at_most_one_occur(const Lit p);
 
     ///Propagate 3-long clause
     PropResult propTriHelperSimple(
@@ -274,6 +294,20 @@ inline void PropEngine::new_decision_level()
     #endif
 }
 
+inline bool PropEngine::in_at_most_one(const Var var) const
+{
+    return !amo_watches[Lit(var, false).toInt()].empty()
+        || !amo_watches[Lit(var, true).toInt()].empty();
+}
+
+//The implied binary clauses are not in the watchlists, so they are marked
+//like hyper-binary clauses which were not added. Transitive reduction then
+//never tries to remove them.
+inline PropBy PropEngine::amo_reason(const Lit p) const
+{
+    return PropBy(~p, false, true, true);
+}
+
 inline uint32_t PropEngine::decisionLevel() const
 {
     return trail_lim.size();
@@ -52,7 +52,7 @@ using std::endl;
 /**
 @brief Sets a sane default config and allocates handler classes
 */
-Searcher::Searcher(const SolverConf *_conf, Solver* _solver, bool* _needToInterrupt) :
+Searcher::Searcher(const SolverConf *_conf, Solver* _solver, std::atomic<bool>* _needToInterrupt) :
         HyperEngine(
             _conf
             , _needToInterrupt
@@ -1501,6 +1501,8 @@ void Searcher::attach_and_enqueue_learnt_clause(Clause* cl)
             //Long learnt
             cl->stats.resolutions = resolutions;
             stats.learntLongs++;
+            stats.learntGlues[std::min<size_t>(
+                cl->stats.glue, stats.learntGlues.size()-1)]++;
             solver->attachClause(*cl);
             enqueue(learnt_clause[0], PropBy(cl_alloc.get_offset(cl)));
 
@@ -1591,6 +1593,9 @@ bool Searcher::handle_conflict(const PropBy confl)
     resolutions.clear();
     stats.conflStats.numConflicts++;
     params.conflictsDoneThisRestart++;
+    if (progress && sumConflicts() % ProgressRing::interval == 0) {
+        progress->publish(sumConflicts(), sumDecisions(), decisionLevel());
+    }
     if (conf.doPrintConflDot)
         create_graphviz_confl_graph(confl);
 
@@ -1951,8 +1956,19 @@ void Searcher::restore_order_heap()
 
 void Searcher::reduce_db_if_needed()
 {
+    //Check memory budget now and then
+    bool near_mem_limit = false;
+    if (conf.maxMemMB
+        && stats.conflStats.numConflicts >= next_mem_check_confl
+    ) {
+        next_mem_check_confl = stats.conflStats.numConflicts + conf.memCheckEveryConfl;
+        near_mem_limit = solver->degrade_if_near_mem_limit();
+    }
+
     //Check if we should do DBcleaning
-    if (num_red_cls_reducedb > conf.max_temporary_learnt_clauses) {
+    if (num_red_cls_reducedb > conf.max_temporary_learnt_clauses
+        || near_mem_limit
+    ) {
         if (conf.verbosity >= 3) {
             cout
             << "c "
@@ -2177,6 +2193,9 @@ lbool Searcher::solve(const uint64_t _maxConfls)
     }
 
     end:
+    if (progress) {
+        progress->publish(sumConflicts(), sumDecisions(), decisionLevel());
+    }
     finish_up_solve(status);
 
     return status;
@@ -2557,6 +2576,11 @@ uint64_t Searcher::sumConflicts() const
     return solver->sumStats.conflStats.numConflicts + stats.conflStats.numConflicts;
 }
 
+uint64_t Searcher::sumDecisions() const
+{
+    return solver->sumStats.decisions + stats.decisions;
+}
+
 uint64_t Searcher::sumRestarts() const
 {
     return stats.numRestarts + solver->get_stats().numRestarts;
@@ -34,6 +34,8 @@
 #include "hyperengine.h"
 #include "MersenneTwister.h"
 #include "minisat_rnd.h"
+#include "progress.h"
+#include <array>
 
 namespace CMSat {
 
@@ -62,7 +64,7 @@ struct VariableVariance
 class Searcher : public HyperEngine
 {
     public:
-        Searcher(const SolverConf* _conf, Solver* solver, bool* _needToInterrupt);
+        Searcher(const SolverConf* _conf, Solver* solver, std::atomic<bool>* _needToInterrupt);
         virtual ~Searcher();
 
         //History
@@ -208,6 +210,7 @@ class Searcher : public HyperEngine
         void     printBaseStats() const;
         void     print_clause_stats() const;
         uint64_t sumConflicts() const;
+        uint64_t sumDecisions() const;
         uint64_t sumRestarts() const;
         const Hist& getHistory() const;
 
@@ -255,6 +258,9 @@ class Searcher : public HyperEngine
                 learntBins += other.learntBins;
                 learntTris += other.learntTris;
                 learntLongs += other.learntLongs;
+                for(size_t i = 0; i < learntGlues.size(); i++) {
+                    learntGlues[i] += other.learntGlues[i];
+                }
                 otfSubsumed += other.otfSubsumed;
                 otfSubsumedImplicit += other.otfSubsumedImplicit;
                 otfSubsumedLong += other.otfSubsumedLong;
@@ -312,6 +318,9 @@ class Searcher : public HyperEngine
                 learntBins -= other.learntBins;
                 learntTris -= other.learntTris;
                 learntLongs -= other.learntLongs;
+                for(size_t i = 0; i < learntGlues.size(); i++) {
+                    learntGlues[i] -= other.learntGlues[i];
+                }
                 otfSubsumed -= other.otfSubsumed;
                 otfSubsumedImplicit -= other.otfSubsumedImplicit;
                 otfSubsumedLong -= other.otfSubsumedLong;
@@ -557,6 +566,9 @@ class Searcher : public HyperEngine
             uint64_t learntBins = 0;
             uint64_t learntTris = 0;
             uint64_t learntLongs = 0;
+            //Glue distribution of the long learnt clauses,
+            //the last bucket contains all higher glues
+            std::array<uint64_t, 31> learntGlues{};
             uint64_t otfSubsumed = 0;
             uint64_t otfSubsumedImplicit = 0;
             uint64_t otfSubsumedLong = 0;
@@ -593,6 +605,9 @@ class Searcher : public HyperEngine
         template<bool also_insert_varorder = true>
         void cancelUntil(uint32_t level); ///<Backtrack until a certain level.
 
+        ///If not NULL, snapshots of the search are published there (not owned)
+        ProgressRing* progress = NULL;
+
     protected:
         void new_var(const bool bva, const Var orig_outer) override;
         void new_vars(const size_t n) override;
@@ -773,6 +788,7 @@ class Searcher : public HyperEngine
 
     private:
         bool blocked_restart = false;
+        uint64_t next_mem_check_confl = 0;
         void check_blocking_restart();
         bool must_consolidate_mem = false;
         void print_solution_varreplace_status() const;
@@ -716,6 +716,8 @@ bool Simplifier::can_eliminate_var(const Var var) const
     if (solver->value(var) != l_Undef
         || solver->varData[var].removed != Removed::none
         ||  solver->var_inside_assumptions(var)
+        || solver->varData[var].frozen
+        || solver->in_at_most_one(var)
     ) {
         return false;
     }
@@ -1066,6 +1068,19 @@ bool Simplifier::uneliminate(Var var)
         << " on var " << var+1
         << endl;
         #endif
+
+        //The clause was deleted from the proof when the var was eliminated,
+        //put it back with the RAT literal first
+        if (solver->drup->enabled()) {
+            const Lit blockedOn = blockedClauses[at].blockedOn;
+            (*solver->drup) << blockedOn;
+            for(const Lit lit: blockedClauses[at].lits) {
+                if (lit != blockedOn) {
+                    (*solver->drup) << lit;
+                }
+            }
+            (*solver->drup) << fin;
+        }
         solver->addClause(blockedClauses[at].lits);
         if (!solver->okay())
             return false;
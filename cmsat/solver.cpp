@@ -74,7 +74,7 @@ using std::endl;
 
 //#define DEBUG_TRI_SORTED_SANITY
 
-Solver::Solver(const SolverConf *_conf, bool* _needToInterrupt) :
+Solver::Solver(const SolverConf *_conf, std::atomic<bool>* _needToInterrupt) :
     Searcher(_conf, this, _needToInterrupt)
 {
     parse_sql_option();
@@ -146,7 +146,7 @@ void Solver::parse_sql_option()
 
         if (conf.whichSQL == 3) {
             #if defined(USE_SQLITE3)
-            sqlStats = new SQLiteStats();
+            sqlStats = new SQLiteStats(conf.sqlite_filename);
             #else
             if (conf.doSQL == 2) {
                 std::cerr << "SQLite support was not compiled in, cannot use it. Exiting."
@@ -160,7 +160,7 @@ void Solver::parse_sql_option()
             #if defined(USE_MYSQL)
             sqlStats = new MySQLStats();
             #elif defined(USE_SQLITE3)
-            sqlStats = new SQLiteStats();
+            sqlStats = new SQLiteStats(conf.sqlite_filename);
             #else
             if (conf.doSQL == 2) {
                 std::cerr << "Neither MySQL nor SQLite support was compiled in"
@@ -172,7 +172,7 @@ void Solver::parse_sql_option()
 
         if (conf.whichSQL == 1) {
             #if defined(USE_SQLITE3)
-            sqlStats = new SQLiteStats();
+            sqlStats = new SQLiteStats(conf.sqlite_filename);
             #elif defined(USE_MYSQL)
             sqlStats = new MySQLStats();
             #else
@@ -954,6 +954,64 @@ void Solver::renumber_variables()
     //backed up activities and then rebuilt at the start of Searcher
 }
 
+//Progressively switches off memory-hungry parts as the process
+//nears conf.maxMemMB. Returns true if the clause database
+//should be cleaned right away
+bool Solver::degrade_if_near_mem_limit()
+{
+    if (conf.maxMemMB == 0) {
+        return false;
+    }
+
+    double vm_usage;
+    const double usedMB = (double)memUsedTotal(vm_usage)/(1024.0*1024.0);
+    const double ratio = usedMB/(double)conf.maxMemMB;
+    if (ratio < 0.6) {
+        return false;
+    }
+
+    if (conf.verbosity >= 2) {
+        cout
+        << "c [mem-limit] used " << (size_t)usedMB << " MB of " << conf.maxMemMB << " MB"
+        << endl;
+    }
+
+    //Shrink the cache first
+    if (conf.doCache) {
+        conf.maxCacheSizeMB = std::max(conf.maxCacheSizeMB/2, 1U);
+        if (ratio >= 0.7
+            || implCache.mem_used()/(1024UL*1024UL) > conf.maxCacheSizeMB
+        ) {
+            implCache.free();
+            vector<LitReachData> tmp;
+            litReachable.swap(tmp);
+            conf.doCache = false;
+        }
+    }
+
+    if (ratio >= 0.7 && conf.doStamp) {
+        stamp.freeMem();
+        conf.doStamp = false;
+    }
+
+    //Occurrence lists of the simplifier
+    if (ratio >= 0.8) {
+        conf.perform_occur_based_simp = false;
+        conf.do_bva = false;
+        conf.maxOccurIrredMB = std::max(conf.maxOccurIrredMB/2, 1U);
+        conf.maxOccurRedMB = std::max(conf.maxOccurRedMB/2, 1U);
+    }
+
+    //Learnt clauses are the rest
+    if (ratio >= 0.9) {
+        conf.max_temporary_learnt_clauses =
+            std::max(conf.max_temporary_learnt_clauses/2, 1000U);
+        return true;
+    }
+
+    return false;
+}
+
 void Solver::check_switchoff_limits_newvar(size_t n)
 {
     if (conf.doStamp
@@ -1568,6 +1626,7 @@ lbool Solver::simplify_problem(const bool startup)
         << "c Solver::simplify_problem() called"
         << endl;
     }
+    degrade_if_near_mem_limit();
 
     if (conf.doFindComps
         && false
@@ -2373,6 +2432,81 @@ vector<Lit> Solver::get_zero_assigned_lits() const
     return lits;
 }
 
+//Zero-level assignments, equivalent literals and redundant clauses
+//with at most max_size literals and glue at most max_glue
+//in the outside numbering. Clauses with BVA variables are skipped.
+vector<vector<Lit> > Solver::get_learnts_outside(
+    const uint32_t max_size
+    , const uint32_t max_glue
+) const {
+    assert(decisionLevel() == 0);
+
+    vector<vector<Lit> > ret;
+    if (!okay() || max_size == 0) {
+        return ret;
+    }
+
+    for(const Lit lit: get_zero_assigned_lits()) {
+        ret.push_back(vector<Lit>(1, lit));
+    }
+    if (max_size < 2 || max_glue < 2) {
+        return ret;
+    }
+
+    for(const auto& p: get_all_binary_xors()) {
+        ret.push_back(vector<Lit>{p.first, ~p.second});
+        ret.push_back(vector<Lit>{~p.first, p.second});
+    }
+
+    const vector<Var> outer_to_outside = build_outer_to_without_bva_map();
+    vector<Lit> lits;
+    auto add_inter = [&](const vector<Lit>& inter_lits) {
+        lits.clear();
+        for(const Lit lit: inter_lits) {
+            const Lit outer = map_inter_to_outer(lit);
+            const Var var = outer_to_outside[outer.var()];
+            if (var == var_Undef) {
+                return;
+            }
+            lits.push_back(Lit(var, outer.sign()));
+        }
+        ret.push_back(lits);
+    };
+
+    //Redundant binary and tertiary clauses are only in the watchlists
+    size_t wsLit = 0;
+    for (watch_array::const_iterator
+        it = watches.begin(), end = watches.end()
+        ; it != end
+        ; ++it, wsLit++
+    ) {
+        const Lit lit = Lit::toLit(wsLit);
+        watch_subarray_const ws = *it;
+        for (watch_subarray_const::const_iterator
+            it2 = ws.begin(), end2 = ws.end()
+            ; it2 != end2
+            ; it2++
+        ) {
+            if (it2->isBinary() && it2->red() && lit < it2->lit2()) {
+                add_inter(vector<Lit>{lit, it2->lit2()});
+            } else if (it2->isTri() && it2->red() && lit < it2->lit2()
+                && max_size >= 3 && max_glue >= 3
+            ) {
+                add_inter(vector<Lit>{lit, it2->lit2(), it2->lit3()});
+            }
+        }
+    }
+
+    for(const ClOffset offset: longRedCls) {
+        const Clause* cl = cl_alloc.ptr(offset);
+        if (cl->size() <= max_size && cl->stats.glue <= max_glue) {
+            add_inter(vector<Lit>(cl->begin(), cl->end()));
+        }
+    }
+
+    return ret;
+}
+
 void Solver::print_all_clauses() const
 {
     for(vector<ClOffset>::const_iterator
@@ -3170,9 +3304,186 @@ bool Solver::add_clause_outer(const vector<Lit>& lits)
     }
     check_too_large_variable_number(lits);
     back_number_from_outside_to_outer(lits);
+    touch_vars_outer(back_number_from_outside_to_outer_tmp);
     return addClause(back_number_from_outside_to_outer_tmp);
 }
 
+//Adds a clause implied by the problem as a redundant clause,
+//so it can be removed by the clause cleaning
+bool Solver::add_red_clause_outer(const vector<Lit>& lits)
+{
+    if (!ok) {
+        return false;
+    }
+
+    //The clause can't be derived in the proof
+    if (drup->enabled()) {
+        return true;
+    }
+
+    check_too_large_variable_number(lits);
+    back_number_from_outside_to_outer(lits);
+    vector<Lit> ps = back_number_from_outside_to_outer_tmp;
+    if (!addClauseHelper(ps)) {
+        return false;
+    }
+
+    std::sort(ps.begin(), ps.end());
+    Clause* cl = add_clause_int(
+        ps
+        , true //redundant
+        , ClauseStats() //glue will be the size
+        , true //yes, attach
+        , NULL
+        , false
+    );
+    if (cl != NULL) {
+        ClOffset offset = cl_alloc.get_offset(cl);
+        longRedCls.push_back(offset);
+    }
+
+    return ok;
+}
+
+//At most one of the literals is true. A constraint already in the solver
+//whose literals are all among the given ones is extended
+bool Solver::add_at_most_one_outer(const vector<Lit>& lits)
+{
+    if (!ok) {
+        return false;
+    }
+
+    //The proof must contain the binary clauses
+    if (drup->enabled()) {
+        for(size_t i = 0; i < lits.size(); i++) {
+            for(size_t j = i+1; j < lits.size(); j++) {
+                const vector<Lit> bin = {~lits[i], ~lits[j]};
+                if (!add_clause_outer(bin))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    check_too_large_variable_number(lits);
+    back_number_from_outside_to_outer(lits);
+    touch_vars_outer(back_number_from_outside_to_outer_tmp);
+    vector<Lit> ps = back_number_from_outside_to_outer_tmp;
+    if (!addClauseHelper(ps)) {
+        return false;
+    }
+
+    //Variables may repeat after the replacement of equivalent literals
+    bool repeated = false;
+    for(const Lit lit: ps) {
+        if (seen[lit.toInt()] || seen[(~lit).toInt()]) {
+            repeated = true;
+        }
+        seen[lit.toInt()] = 1;
+    }
+    for(const Lit lit: ps) {
+        seen[lit.toInt()] = 0;
+    }
+    if (repeated) {
+        for(size_t i = 0; i < ps.size() && ok; i++) {
+            for(size_t j = i+1; j < ps.size() && ok; j++) {
+                const vector<Lit> bin = {~ps[i], ~ps[j]};
+                add_clause_int(bin);
+            }
+        }
+        return ok;
+    }
+
+    //Literals set at level 0
+    Lit true_lit = lit_Undef;
+    size_t j = 0;
+    for(const Lit lit: ps) {
+        const lbool val = value(lit);
+        if (val == l_True) {
+            if (true_lit != lit_Undef) {
+                ok = false;
+                return false;
+            }
+            true_lit = lit;
+        } else if (val == l_Undef) {
+            ps[j++] = lit;
+        }
+    }
+    ps.resize(j);
+    if (true_lit != lit_Undef) {
+        for(const Lit lit: ps) {
+            enqueue(~lit);
+        }
+        ok = propagate().isNULL();
+        return ok;
+    }
+    if (ps.size() < 2) {
+        return true;
+    }
+
+    //Find the constraint to extend
+    for(const Lit lit: ps) {
+        seen[lit.toInt()] = 1;
+    }
+    uint32_t at = amo_constraints.size();
+    for(size_t i = 0; i < ps.size() && at == amo_constraints.size(); i++) {
+        for(const uint32_t at2: amo_watches[ps[i].toInt()]) {
+            bool subsumed = true;
+            for(const Lit lit: amo_constraints[at2]) {
+                if (!seen[lit.toInt()]) {
+                    subsumed = false;
+                    break;
+                }
+            }
+            if (subsumed) {
+                at = at2;
+                break;
+            }
+        }
+    }
+    if (at == amo_constraints.size()) {
+        amo_constraints.push_back(vector<Lit>());
+    }
+
+    vector<Lit>& amo = amo_constraints[at];
+    for(const Lit lit: amo) {
+        seen[lit.toInt()] = 0;
+    }
+    for(const Lit lit: ps) {
+        if (seen[lit.toInt()]) {
+            seen[lit.toInt()] = 0;
+            amo.push_back(lit);
+            amo_watches[lit.toInt()].push_back(at);
+        }
+    }
+
+    return true;
+}
+
+void Solver::touch_vars_outer(const vector<Lit>& lits)
+{
+    for(const Lit lit: lits) {
+        if (lit.var() < touched_outer.size()) {
+            touched_outer[lit.var()] = true;
+        }
+    }
+}
+
+bool Solver::var_touched(const Var inter) const
+{
+    const Var outer = map_inter_to_outer(inter);
+    return outer >= touched_outer.size() || touched_outer[outer];
+}
+
+void Solver::untouch_var(const Var inter)
+{
+    const Var outer = map_inter_to_outer(inter);
+    if (outer >= touched_outer.size()) {
+        touched_outer.resize(nVarsOuter(), true);
+    }
+    touched_outer[outer] = false;
+}
+
 bool Solver::add_xor_clause_outer(const vector<Var>& vars, bool rhs)
 {
     if (!ok) {
@@ -3192,6 +3503,44 @@ bool Solver::add_xor_clause_outer(const vector<Var>& vars, bool rhs)
     return ok;
 }
 
+void Solver::set_polarity_outer(const Var var, const bool polarity)
+{
+    const Var inter = map_outer_to_inter(map_to_with_bva(Lit(var, false))).var();
+    if (inter < varData.size()) {
+        varData[inter].polarity = polarity;
+    }
+}
+
+bool Solver::get_polarity_outer(const Var var) const
+{
+    const Var inter = map_outer_to_inter(map_to_with_bva(Lit(var, false))).var();
+    return inter < varData.size() && varData[inter].polarity;
+}
+
+void Solver::set_activity_outer(const Var var, const double act)
+{
+    //The order heap is rebuilt from the activities at the start of search
+    const Var inter = map_outer_to_inter(map_to_with_bva(Lit(var, false))).var();
+    if (inter < activities.size()) {
+        activities[inter] = act;
+    }
+}
+
+double Solver::get_activity_outer(const Var var) const
+{
+    const Var inter = map_outer_to_inter(map_to_with_bva(Lit(var, false))).var();
+    return inter < activities.size() ? activities[inter] : 0;
+}
+
+void Solver::set_frozen_outer(const Var var, const bool frozen)
+{
+    //Eliminated variables are uneliminated when they appear in a new clause
+    const Var inter = map_outer_to_inter(map_to_with_bva(Lit(var, false))).var();
+    if (inter < varData.size()) {
+        varData[inter].frozen = frozen;
+    }
+}
+
 void Solver::check_too_large_variable_number(const vector<Lit>& lits) const
 {
     for (const Lit lit: lits) {
@@ -75,7 +75,7 @@ class LitReachData {
 class Solver : public Searcher
 {
     public:
-        Solver(const SolverConf *_conf = NULL, bool* _needToInterrupt = NULL);
+        Solver(const SolverConf *_conf = NULL, std::atomic<bool>* _needToInterrupt = NULL);
         ~Solver() override;
 
         void add_sql_tag(const string& tagname, const string& tag);
@@ -83,7 +83,23 @@ class Solver : public Searcher
         void new_external_var();
         void new_external_vars(size_t n);
         bool add_clause_outer(const vector<Lit>& lits);
+        bool add_at_most_one_outer(const vector<Lit>& lits);
         bool add_xor_clause_outer(const vector<Var>& vars, bool rhs);
+        void set_polarity_outer(const Var var, const bool polarity);
+        bool get_polarity_outer(const Var var) const;
+        void set_activity_outer(const Var var, const double act);
+        double get_activity_outer(const Var var) const;
+        void set_frozen_outer(const Var var, const bool frozen);
+        bool add_red_clause_outer(const vector<Lit>& lits);
+        vector<vector<Lit> > get_learnts_outside(
+            const uint32_t max_size
+            , const uint32_t max_glue
+        ) const;
+        bool degrade_if_near_mem_limit();
+
+        //Vars whose implications may have changed since they were last probed
+        bool var_touched(const Var inter) const;
+        void untouch_var(const Var inter);
 
         lbool solve_with_assumptions(const vector<Lit>* _assumptions = NULL);
         void  set_shared_data(SharedData* shared_data, uint32_t thread_num);
@@ -268,6 +284,10 @@ class Solver : public Searcher
         }
         void check_switchoff_limits_newvar(size_t n = 1);
         vector<Lit> outside_assumptions;
+
+        //Indexed by outer var. Vars beyond the end are new, hence touched
+        vector<char> touched_outer;
+        void touch_vars_outer(const vector<Lit>& lits);
         void checkDecisionVarCorrectness() const;
 
         //Stats printing
@@ -377,6 +397,13 @@ inline const Solver::SolveStats& Solver::get_solve_stats() const
 
 inline void Solver::add_sql_tag(const string& tagname, const string& tag)
 {
+    //Tags may change between solve() calls (e.g. domain size)
+    for(auto& t: sql_tags) {
+        if (t.first == tagname) {
+            t.second = tag;
+            return;
+        }
+    }
     sql_tags.push_back(std::make_pair(tagname, tag));
 }
 
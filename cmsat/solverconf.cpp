@@ -87,6 +87,8 @@ SolverConf::SolverConf() :
         //Limits
         , maxTime          (std::numeric_limits<double>::max())
         , maxConfl         (std::numeric_limits<long>::max())
+        , maxMemMB         (0)
+        , memCheckEveryConfl(5000)
 
         //Agilities
         , agilityG                  (0.9999)
@@ -104,7 +106,7 @@ SolverConf::SolverConf() :
         , rewardShortenedClauseWithConfl(3)
 
         //SQL
-        , doSQL          (1)
+        , doSQL          (0) //Turned on by cmsat_create_with_config
         , whichSQL       (0)
         , dump_individual_search_time(false)
         , sqlite_filename ("cryptominisat.sqlite")
@@ -150,6 +152,7 @@ SolverConf::SolverConf() :
         //Probing
         , doProbe          (true)
         , doIntreeProbe    (true)
+        , probe_touched_only(true)
         , probe_bogoprops_time_limitM  (800ULL)
         , intree_time_limitM(400ULL)
         , intree_scc_varreplace_time_limitM(30ULL)
@@ -189,6 +189,8 @@ class SolverConf
         //Limits
         double   maxTime;
         long maxConfl;
+        unsigned maxMemMB; ///<Memory budget of the process. 0 means no limit
+        unsigned memCheckEveryConfl;
 
         //Agility
         double    agilityG; ///See paper by Armin Biere on agilities
@@ -252,6 +254,7 @@ class SolverConf
         //Probing
         int      doProbe;
         int      doIntreeProbe;
+        int      probe_touched_only; ///<Probe only vars in clauses added since they were last probed
         unsigned long long   probe_bogoprops_time_limitM;
         unsigned long long   intree_time_limitM;
         unsigned long long intree_scc_varreplace_time_limitM;
@@ -0,0 +1,359 @@
+/*
+ * CryptoMiniSat
+ *
+ * Copyright (c) 2009-2014, Mate Soos. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation
+ * version 2.0 of the License.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301  USA
+*/
+
+#ifdef USE_SQLITE3
+
+#include "sqlitestats.h"
+#include "solver.h"
+#include <sqlite3.h>
+
+using namespace CMSat;
+using std::cerr;
+using std::endl;
+
+//Must be same as the schema created by scripts/report.ml
+static const char* create_schema =
+    "CREATE TABLE IF NOT EXISTS solver_stats ("
+    "  config_name   TEXT  NOT NULL,"
+    "  problem       TEXT  NOT NULL,"
+    "  run_id        INT   NOT NULL,"
+    "  solve_call    INT   NOT NULL,"
+    "  max_size      INT   NULL,"
+    "  status        TEXT  NOT NULL,"
+    "  search_time   REAL  NOT NULL,"
+    "  conflicts     INT   NOT NULL,"
+    "  decisions     INT   NOT NULL,"
+    "  propagations  INT   NOT NULL,"
+    "  restarts      INT   NOT NULL,"
+    "  reduce_dbs    INT   NOT NULL,"
+    "  learnt_units  INT   NOT NULL,"
+    "  learnt_bins   INT   NOT NULL,"
+    "  learnt_tris   INT   NOT NULL,"
+    "  learnt_longs  INT   NOT NULL,"
+    "  CONSTRAINT PK_solver_stats"
+    "    PRIMARY KEY (config_name, problem, run_id, solve_call)"
+    ");"
+    "CREATE TABLE IF NOT EXISTS solver_glue ("
+    "  config_name   TEXT  NOT NULL,"
+    "  problem       TEXT  NOT NULL,"
+    "  run_id        INT   NOT NULL,"
+    "  solve_call    INT   NOT NULL,"
+    "  glue          INT   NOT NULL,"
+    "  clauses       INT   NOT NULL,"
+    "  CONSTRAINT PK_solver_glue"
+    "    PRIMARY KEY (config_name, problem, run_id, solve_call, glue)"
+    ");"
+    "CREATE TABLE IF NOT EXISTS solver_phase ("
+    "  config_name   TEXT  NOT NULL,"
+    "  problem       TEXT  NOT NULL,"
+    "  run_id        INT   NOT NULL,"
+    "  solve_call    INT   NOT NULL,"
+    "  phase         TEXT  NOT NULL,"
+    "  calls         INT   NOT NULL,"
+    "  time          REAL  NOT NULL,"
+    "  time_outs     INT   NOT NULL,"
+    "  CONSTRAINT PK_solver_phase"
+    "    PRIMARY KEY (config_name, problem, run_id, solve_call, phase)"
+    ");";
+
+bool SQLiteStats::delete_stats(
+    const std::string& filename
+    , const std::string& config_name
+    , const std::string& problem
+) {
+    sqlite3* db = NULL;
+    bool ok = sqlite3_open(filename.c_str(), &db) == SQLITE_OK;
+    if (ok) {
+        sqlite3_busy_timeout(db, 60*1000);
+        ok = sqlite3_exec(db, create_schema, NULL, NULL, NULL) == SQLITE_OK
+            && sqlite3_exec(db, "BEGIN", NULL, NULL, NULL) == SQLITE_OK;
+    }
+
+    const char* tables[] = {"solver_stats", "solver_glue", "solver_phase"};
+    for(const char* table: tables) {
+        if (!ok) {
+            break;
+        }
+        const string sql = string("DELETE FROM ") + table
+            + " WHERE config_name = ? AND problem = ?";
+        sqlite3_stmt* stmt = NULL;
+        ok = sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, NULL) == SQLITE_OK;
+        if (ok) {
+            sqlite3_bind_text(stmt, 1, config_name.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(stmt, 2, problem.c_str(), -1, SQLITE_TRANSIENT);
+            ok = sqlite3_step(stmt) == SQLITE_DONE;
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    if (ok) {
+        ok = sqlite3_exec(db, "COMMIT", NULL, NULL, NULL) == SQLITE_OK;
+    }
+    if (!ok) {
+        cerr << "c ERROR: SQLite: " << sqlite3_errmsg(db) << endl;
+    }
+    sqlite3_close(db);
+    return ok;
+}
+
+SQLiteStats::SQLiteStats(const std::string& _filename) :
+    filename(_filename)
+{
+}
+
+SQLiteStats::~SQLiteStats()
+{
+    sqlite3_finalize(stmt_solve);
+    sqlite3_finalize(stmt_glue);
+    sqlite3_finalize(stmt_phase);
+    if (db) {
+        sqlite3_close(db);
+    }
+}
+
+bool SQLiteStats::exec(const char* sql)
+{
+    char* err = NULL;
+    if (sqlite3_exec(db, sql, NULL, NULL, &err) != SQLITE_OK) {
+        cerr << "c ERROR: SQLite: " << (err ? err : "unknown error") << endl;
+        sqlite3_free(err);
+        return false;
+    }
+    return true;
+}
+
+bool SQLiteStats::setup(const Solver* _solver)
+{
+    solver = _solver;
+    getRandomID();
+
+    if (sqlite3_open(filename.c_str(), &db) != SQLITE_OK) {
+        cerr << "c ERROR: Cannot open SQLite database " << filename
+        << ": " << sqlite3_errmsg(db) << endl;
+        return false;
+    }
+    //Solvers of the components of one problem may write at the same time
+    sqlite3_busy_timeout(db, 60*1000);
+
+    if (!exec(create_schema)) {
+        return false;
+    }
+
+    const char* sql_solve =
+        "INSERT INTO solver_stats"
+        " (config_name, problem, run_id, solve_call, max_size, status,"
+        "  search_time, conflicts, decisions, propagations, restarts,"
+        "  reduce_dbs, learnt_units, learnt_bins, learnt_tris, learnt_longs)"
+        " VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+    const char* sql_glue =
+        "INSERT INTO solver_glue"
+        " (config_name, problem, run_id, solve_call, glue, clauses)"
+        " VALUES (?, ?, ?, ?, ?, ?)";
+    const char* sql_phase =
+        "INSERT INTO solver_phase"
+        " (config_name, problem, run_id, solve_call, phase,"
+        "  calls, time, time_outs)"
+        " VALUES (?, ?, ?, ?, ?, ?, ?, ?)";
+    if (sqlite3_prepare_v2(db, sql_solve, -1, &stmt_solve, NULL) != SQLITE_OK
+        || sqlite3_prepare_v2(db, sql_glue, -1, &stmt_glue, NULL) != SQLITE_OK
+        || sqlite3_prepare_v2(db, sql_phase, -1, &stmt_phase, NULL) != SQLITE_OK
+    ) {
+        cerr << "c ERROR: SQLite: " << sqlite3_errmsg(db) << endl;
+        return false;
+    }
+
+    return true;
+}
+
+string SQLiteStats::get_tag(const string& name) const
+{
+    for(const auto& tag: solver->get_sql_tags()) {
+        if (tag.first == name) {
+            return tag.second;
+        }
+    }
+    return string();
+}
+
+void SQLiteStats::bind_key(sqlite3_stmt* stmt, const uint32_t call) const
+{
+    sqlite3_reset(stmt);
+    sqlite3_bind_text(stmt, 1, get_tag("config_name").c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, 2, get_tag("problem").c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int64(stmt, 3, runID);
+    sqlite3_bind_int64(stmt, 4, call);
+}
+
+bool SQLiteStats::write_solve_stats(lbool status)
+{
+    const uint32_t call = solver->get_solve_stats().num_solve_calls;
+    const Searcher::Stats stats = solver->sumStats - last_stats;
+    const PropStats prop_stats = solver->sumPropStats - last_prop_stats;
+
+    bind_key(stmt_solve, call);
+    const string max_size = get_tag("max_size");
+    if (max_size.empty()) {
+        sqlite3_bind_null(stmt_solve, 5);
+    } else {
+        sqlite3_bind_int64(stmt_solve, 5, std::stoll(max_size));
+    }
+    const char* status_str =
+        status == l_True ? "sat" : (status == l_False ? "unsat" : "unknown");
+    sqlite3_bind_text(stmt_solve, 6, status_str, -1, SQLITE_STATIC);
+    sqlite3_bind_double(stmt_solve, 7, stats.cpu_time);
+    sqlite3_bind_int64(stmt_solve, 8, stats.conflStats.numConflicts);
+    sqlite3_bind_int64(stmt_solve, 9, stats.decisions);
+    sqlite3_bind_int64(stmt_solve, 10, prop_stats.propagations);
+    sqlite3_bind_int64(stmt_solve, 11, stats.numRestarts);
+    sqlite3_bind_int64(stmt_solve, 12, reduce_dbs);
+    sqlite3_bind_int64(stmt_solve, 13, stats.learntUnits);
+    sqlite3_bind_int64(stmt_solve, 14, stats.learntBins);
+    sqlite3_bind_int64(stmt_solve, 15, stats.learntTris);
+    sqlite3_bind_int64(stmt_solve, 16, stats.learntLongs);
+    if (sqlite3_step(stmt_solve) != SQLITE_DONE) {
+        return false;
+    }
+
+    //Glue distribution of the long clauses learnt in this call
+    for(size_t glue = 0; glue < stats.learntGlues.size(); glue++) {
+        if (stats.learntGlues[glue] == 0) {
+            continue;
+        }
+        bind_key(stmt_glue, call);
+        sqlite3_bind_int64(stmt_glue, 5, glue);
+        sqlite3_bind_int64(stmt_glue, 6, stats.learntGlues[glue]);
+        if (sqlite3_step(stmt_glue) != SQLITE_DONE) {
+            return false;
+        }
+    }
+
+    for(const auto& phase: phases) {
+        bind_key(stmt_phase, call);
+        sqlite3_bind_text(stmt_phase, 5, phase.first.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int64(stmt_phase, 6, phase.second.calls);
+        sqlite3_bind_double(stmt_phase, 7, phase.second.time);
+        sqlite3_bind_int64(stmt_phase, 8, phase.second.time_outs);
+        if (sqlite3_step(stmt_phase) != SQLITE_DONE) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void SQLiteStats::finishup(lbool status)
+{
+    if (!exec("BEGIN")) {
+        return;
+    }
+    if (write_solve_stats(status)) {
+        exec("COMMIT");
+    } else {
+        cerr << "c ERROR: SQLite: " << sqlite3_errmsg(db) << endl;
+        exec("ROLLBACK");
+    }
+
+    phases.clear();
+    reduce_dbs = 0;
+    last_stats = solver->sumStats;
+    last_prop_stats = solver->sumPropStats;
+}
+
+void SQLiteStats::time_passed(
+    const Solver*
+    , const string& name
+    , double time_passed
+    , bool time_out
+    , double
+) {
+    PhaseStats& phase = phases[name];
+    phase.calls++;
+    phase.time += time_passed;
+    phase.time_outs += time_out;
+}
+
+void SQLiteStats::time_passed_min(
+    const Solver*
+    , const string& name
+    , double time_passed
+) {
+    PhaseStats& phase = phases[name];
+    phase.calls++;
+    phase.time += time_passed;
+}
+
+void SQLiteStats::reduceDB(
+    const ClauseUsageStats&
+    , const ClauseUsageStats&
+    , const CleaningStats&
+    , const Solver*
+) {
+    reduce_dbs++;
+}
+
+//Per restart and memory statistics are not stored,
+//solver_stats contains their sums for each solve() call.
+
+void SQLiteStats::restart(
+    const PropStats&
+    , const Searcher::Stats&
+    , const Solver*
+    , const Searcher*
+) {
+}
+
+void SQLiteStats::mem_used(
+    const Solver*
+    , const string&
+    , const double
+    , uint64_t
+) {
+}
+
+#ifdef STATS_NEEDED_EXTRA
+void SQLiteStats::clauseSizeDistrib(
+    uint64_t
+    , const vector<uint32_t>&
+) {
+}
+
+void SQLiteStats::clauseGlueDistrib(
+    uint64_t
+    , const vector<uint32_t>&
+) {
+}
+
+void SQLiteStats::clauseSizeGlueScatter(
+    uint64_t
+    , boost::multi_array<uint32_t, 2>&
+) {
+}
+
+void SQLiteStats::varDataDump(
+    const Solver*
+    , const Searcher*
+    , const vector<Var>&
+    , const vector<VarData>&
+) {
+}
+#endif
+
+#endif //USE_SQLITE3
@@ -0,0 +1,150 @@
+/*
+ * CryptoMiniSat
+ *
+ * Copyright (c) 2009-2014, Mate Soos. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation
+ * version 2.0 of the License.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301  USA
+*/
+
+#ifndef __SQLITESTATS_H__
+#define __SQLITESTATS_H__
+
+#include "sqlstats.h"
+#include <map>
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+namespace CMSat {
+
+/**
+@brief Writes statistics of each solve() call to a SQLite database
+
+One row of the table solver_stats is written per solve() call, together
+with the glue distribution of the long clauses learnt in the call (solver_glue)
+and the time spent in each simplification phase (solver_phase).
+The rows are identified by the tags "config_name", "problem" and
+"max_size" of the solver, so they can be joined with the results
+of the benchmark scripts which are stored in the same database.
+*/
+class SQLiteStats: public SQLStats
+{
+public:
+    explicit SQLiteStats(const std::string& filename);
+    ~SQLiteStats() override;
+
+    //Deletes the statistics of the previous runs
+    //of the same configuration on the same problem
+    static bool delete_stats(
+        const std::string& filename
+        , const std::string& config_name
+        , const std::string& problem
+    );
+
+    void restart(
+        const PropStats& thisPropStats
+        , const Searcher::Stats& thisStats
+        , const Solver* solver
+        , const Searcher* searcher
+    ) override;
+
+    void time_passed(
+        const Solver* solver
+        , const string& name
+        , double time_passed
+        , bool time_out
+        , double percent_time_remain
+    ) override;
+
+    void time_passed_min(
+        const Solver* solver
+        , const string& name
+        , double time_passed
+    ) override;
+
+    void mem_used(
+        const Solver* solver
+        , const string& name
+        , const double given_time
+        , uint64_t mem_used_mb
+    ) override;
+
+    #ifdef STATS_NEEDED_EXTRA
+    void clauseSizeDistrib(
+        uint64_t sumConflicts
+        , const vector<uint32_t>& sizes
+    ) override;
+
+    void clauseGlueDistrib(
+        uint64_t sumConflicts
+        , const vector<uint32_t>& glues
+    ) override;
+
+    void clauseSizeGlueScatter(
+        uint64_t sumConflicts
+        , boost::multi_array<uint32_t, 2>& sizeAndGlue
+    ) override;
+
+    void varDataDump(
+        const Solver* solver
+        , const Searcher* search
+        , const vector<Var>& varsToDump
+        , const vector<VarData>& varData
+    ) override;
+    #endif
+
+    void reduceDB(
+        const ClauseUsageStats& irredStats
+        , const ClauseUsageStats& redStats
+        , const CleaningStats& clean
+        , const Solver* solver
+    ) override;
+
+    bool setup(const Solver* solver) override;
+    void finishup(lbool status) override;
+
+private:
+    struct PhaseStats
+    {
+        uint64_t calls = 0;
+        double time = 0;
+        uint64_t time_outs = 0;
+    };
+
+    bool exec(const char* sql);
+    string get_tag(const string& name) const;
+    void bind_key(sqlite3_stmt* stmt, const uint32_t call) const;
+    bool write_solve_stats(lbool status);
+
+    const std::string filename;
+    sqlite3* db = NULL;
+    sqlite3_stmt* stmt_solve = NULL;
+    sqlite3_stmt* stmt_glue = NULL;
+    sqlite3_stmt* stmt_phase = NULL;
+    const Solver* solver = NULL;
+
+    //Collected since the end of the previous solve() call
+    std::map<string, PhaseStats> phases;
+    uint64_t reduce_dbs = 0;
+
+    //Totals at the end of the previous solve() call
+    Searcher::Stats last_stats;
+    PropStats last_prop_stats;
+};
+
+} //end namespace
+
+#endif //__SQLITESTATS_H__
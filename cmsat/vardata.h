@@ -79,6 +79,7 @@ struct VarData
         , polarity(false)
         , is_decision(true)
         , is_bva(false)
+        , frozen(false)
     {}
 
     ///contains the decision level at which the assignment was made.
@@ -97,6 +98,9 @@ struct VarData
     bool polarity;
     bool is_decision;
     bool is_bva;
+
+    ///Frozen variables may appear in future clauses, so they are not eliminated
+    bool frozen;
 };
 
 }
@@ -938,6 +938,13 @@ bool VarReplacer::replace(
 
     assert(val1 == l_Undef && val2 == l_Undef);
 
+    //At-most-one constraints are not updated, so their literals stay
+    if (solver->in_at_most_one(lit1.var())
+        || solver->in_at_most_one(lit2.var())
+    ) {
+        return true;
+    }
+
     const Lit lit1_outer = solver->map_inter_to_outer(lit1);
     const Lit lit2_outer = solver->map_inter_to_outer(lit2);
     return update_table_and_reversetable(lit1_outer, lit2_outer);
@@ -8,11 +8,19 @@
 #include <caml/threads.h>
 
 #include <vector>
+#include <set>
+#include <map>
+#include <atomic>
 
 #include <gecode/int.hh>
 #include <gecode/search.hh>
 
+#include "liftedclause.hh"
+#include "matrixelement.hh"
+#include "sortsymmetry.hh"
+
 using namespace Gecode;
+using namespace Crossbow;
 
 struct bool_var {
   int id;
@@ -30,9 +38,81 @@ struct int_var_array {
   int id;
 };
 
+// Constructors of Gecode.branching.
+enum Branching {
+  branch_size = 0,
+  branch_afc = 1,
+  branch_activity = 2,
+  branch_lnh = 3,
+};
+
+// Space explored by the search engine. The engine clones it often
+// so it holds only the variables needed for the solutions
+// and for restarts.
 class GecodeForCrossbow : public Space {
 
 private:
+  BoolVarArray boolValues;
+  IntVarArray intValues;
+
+public:
+  GecodeForCrossbow() {
+  }
+
+  GecodeForCrossbow(bool share, GecodeForCrossbow & g) : Space(share, g) {
+    boolValues.update(*this, share, g.boolValues);
+    intValues.update(*this, share, g.intValues);
+  }
+
+  virtual Space * copy(bool share) {
+    return new GecodeForCrossbow(share, *this);
+  }
+
+  void setValues(const BoolVarArgs & boolVars, const IntVarArgs & intVars) {
+    boolValues = BoolVarArray(*this, boolVars);
+    intValues = IntVarArray(*this, intVars);
+  }
+
+  // Restart-based search calls this with the last solution
+  // before it restarts, so each solution is found only once.
+  virtual void constrain(const Space & _last) {
+    const GecodeForCrossbow & last =
+      static_cast<const GecodeForCrossbow &>(_last);
+
+    BoolVarArgs pos;
+    BoolVarArgs neg;
+    for (int i = 0; i < boolValues.size(); i++) {
+      if (last.boolValues[i].val())
+        neg << boolValues[i];
+      else
+        pos << boolValues[i];
+    }
+    for (int i = 0; i < intValues.size(); i++) {
+      BoolVar b(*this, 0, 1);
+      rel(*this, intValues[i], IRT_NQ, last.intValues[i].val(), b);
+      pos << b;
+    }
+
+    Gecode::clause(*this, BOT_OR, pos, neg, 1);
+  }
+
+  int getBoolValue(bool_var v) {
+    return boolValues[v.id].val();
+  }
+
+  int getIntValue(int_var v) {
+    return intValues[v.id].val();
+  }
+};
+
+// Creates the variables and posts the constraints to a new space.
+// The arrays of the model are needed only until the search starts,
+// so they are kept here and not in the space.
+class GecodeForCrossbowBuilder {
+
+private:
+  GecodeForCrossbow * space;
+
   BoolVarArgs boolVars;
   IntVarArgs intVars;
 
@@ -56,45 +136,68 @@ private:
       return tmpIntVars[-v.id - 1];
   }
 
-  BoolVarArray boolValues;
-  IntVarArray intValues;
+  // Variables restricted by LNH in the order in which LNH
+  // processed them.
+  IntVarArgs lnhVars;
+  std::set<int> lnhIds;
 
-public:
-  GecodeForCrossbow() {
+  void addLnhVar(int_var v) {
+    if (lnhIds.insert(v.id).second)
+      lnhVars << intVar(v);
   }
 
-  GecodeForCrossbow(bool share, GecodeForCrossbow & g) : Space(share, g) {
-    boolValues.update(*this, share, g.boolValues);
-    intValues.update(*this, share, g.intValues);
+  // Tuple sets of extensional constraints indexed by their tuples
+  // followed by their arity. Constraints with the same tuples
+  // share one tuple set.
+  std::map<std::vector<int>, TupleSet> tupleSets;
+
+  // Variable selection for the given branching strategy.
+  // The decay applies to AFC and activity.
+  static IntVarBranch varBranch(Branching branching, double decay) {
+    switch (branching) {
+    case branch_afc:
+      return INT_VAR_AFC_SIZE_MAX(decay);
+    case branch_activity:
+      return INT_VAR_ACTIVITY_SIZE_MAX(decay);
+    default:
+      return INT_VAR_SIZE_MIN();
+    }
   }
 
-  virtual Space * copy(bool share) {
-    return new GecodeForCrossbow(share, *this);
+public:
+  GecodeForCrossbowBuilder() : space(new GecodeForCrossbow()) {
+  }
+
+  ~GecodeForCrossbowBuilder() {
+    if (space) {
+      delete space;
+      space = 0;
+    }
   }
 
   bool_var newBoolVar() {
     bool_var v;
     v.id = boolVars.size();
-    boolVars << BoolVar(*this, 0, 1);
+    boolVars << BoolVar(*space, 0, 1);
     return v;
   }
 
   int_var newIntVar(int domSize) {
     int_var v;
     v.id = intVars.size();
-    intVars << IntVar(*this, 0, domSize-1);
+    intVars << IntVar(*space, 0, domSize-1);
     return v;
   }
 
   bool_var newTmpBoolVar() {
-    tmpBoolVars << BoolVar(*this, 0, 1);
+    tmpBoolVars << BoolVar(*space, 0, 1);
     bool_var v;
     v.id = -tmpBoolVars.size();
     return v;
   }
 
   int_var newTmpIntVar(int domSize) {
-    tmpIntVars << IntVar(*this, 0, domSize-1);
+    tmpIntVars << IntVar(*space, 0, domSize-1);
     int_var v;
     v.id = -tmpIntVars.size();
     return v;
@@ -141,33 +244,65 @@ public:
       x[i] = intVar(vars[i]);
     }
 
-    Gecode::linear(*this, a, x, IRT_EQ, c);
+    Gecode::linear(*space, a, x, IRT_EQ, c);
   }
 
   void boolElement(bool_var_array arr, int_var idx, bool_var y) {
-    element(*this, boolVarArrays[arr.id], intVar(idx), boolVar(y));
+    element(*space, boolVarArrays[arr.id], intVar(idx), boolVar(y));
   }
 
   void intElement(int_var_array arr, int_var idx, int_var y) {
-    element(*this, intVarArrays[arr.id], intVar(idx), intVar(y));
+    element(*space, intVarArrays[arr.id], intVar(idx), intVar(y));
+  }
+
+  void boolMatrixElement(bool_var_array arr, std::vector<int_var> & idxs,
+                         std::vector<int> & coefs, int c, bool_var y) {
+    if (space->failed())
+      return;
+    IntVarArgs xs(idxs.size());
+    for (unsigned int i = 0; i < idxs.size(); i++) {
+      xs[i] = intVar(idxs[i]);
+    }
+    Home home(*space);
+    ViewArray<Int::IntView> x(home, xs);
+    ViewArray<Int::BoolView> table(home, boolVarArrays[arr.id]);
+    GECODE_ES_FAIL(BoolMatrixElement::post(home, x, table, IntArgs(coefs),
+                                           c, boolVar(y)));
+  }
+
+  void intMatrixElement(int_var_array arr, std::vector<int_var> & idxs,
+                        std::vector<int> & coefs, int c, int_var y) {
+    if (space->failed())
+      return;
+    IntVarArgs xs(idxs.size());
+    for (unsigned int i = 0; i < idxs.size(); i++) {
+      xs[i] = intVar(idxs[i]);
+    }
+    Home home(*space);
+    ViewArray<Int::IntView> x(home, xs);
+    ViewArray<Int::IntView> table(home, intVarArrays[arr.id]);
+    GECODE_ES_FAIL(IntMatrixElement::post(home, x, table, IntArgs(coefs),
+                                          c, intVar(y)));
   }
 
   void eqVarVar(int_var x, int_var x2, bool_var y) {
-    rel(*this, intVar(x), IRT_EQ, intVar(x2), boolVar(y));
+    rel(*space, intVar(x), IRT_EQ, intVar(x2), boolVar(y));
   }
 
   void eqVarConst(int_var x, int c, bool_var y) {
-    rel(*this, intVar(x), IRT_EQ, c, boolVar(y));
+    rel(*space, intVar(x), IRT_EQ, c, boolVar(y));
   }
 
   void lowerEq(int_var x, int c) {
-    rel(*this, intVar(x), IRT_LQ, c);
+    rel(*space, intVar(x), IRT_LQ, c);
+    addLnhVar(x);
   }
 
   void precede(std::vector<int_var> & vars, std::vector<int> & consts) {
     IntVarArgs xs(vars.size());
     for (unsigned int i = 0; i < vars.size(); i++) {
       xs[i] = intVar(vars[i]);
+      addLnhVar(vars[i]);
     }
 
     IntArgs cs(consts.size());
@@ -175,7 +310,7 @@ public:
       cs[i] = consts[i];
     }
 
-    Gecode::precede(*this, xs, cs);
+    Gecode::precede(*space, xs, cs);
   }
 
   void clause(std::vector<bool_var> & pos, std::vector<bool_var> & neg) {
@@ -189,7 +324,7 @@ public:
       n[i] = boolVar(neg[i]);
     }
 
-    Gecode::clause(*this, BOT_OR, p, n, 1);
+    Gecode::clause(*space, BOT_OR, p, n, 1);
   }
 
   void allDifferent(std::vector<int_var> & vars) {
@@ -198,27 +333,68 @@ public:
       x[i] = intVar(vars[i]);
     }
 
-    distinct(*this, x);
+    distinct(*space, x);
   }
 
-  /* No variables should be created after this call. */
-  void endSpec() {
-    boolValues = BoolVarArray(*this, boolVars);
-    intValues = IntVarArray(*this, intVars);
+  void extensional(std::vector<int_var> & vars, std::vector<int> & tuples) {
+    const int arity = vars.size();
+    assert (arity > 0 && tuples.size() % arity == 0);
+
+    IntVarArgs x(arity);
+    for (int i = 0; i < arity; i++) {
+      x[i] = intVar(vars[i]);
+    }
 
-    branch(*this, intValues, INT_VAR_SIZE_MIN(), INT_VAL_MIN());
-    branch(*this, boolValues, INT_VAR_SIZE_MIN(), INT_VAL_MIN());
+    std::vector<int> key(tuples);
+    key.push_back(arity);
+    std::map<std::vector<int>, TupleSet>::iterator it = tupleSets.find(key);
+    if (it == tupleSets.end()) {
+      TupleSet ts;
+      IntArgs t(arity);
+      for (unsigned int i = 0; i < tuples.size(); i += arity) {
+        for (int j = 0; j < arity; j++) {
+          t[j] = tuples[i + j];
+        }
+        ts.add(t);
+      }
+      ts.finalize();
+      it = tupleSets.insert(std::make_pair(key, ts)).first;
+    }
 
-    branch(*this, tmpIntVars, INT_VAR_SIZE_MIN(), INT_VAL_MIN());
-    branch(*this, tmpBoolVars, INT_VAR_SIZE_MIN(), INT_VAL_MIN());
+    Gecode::extensional(*space, x, it->second);
   }
 
-  int getBoolValue(bool_var v) {
-    return boolValues[v.id].val();
+  void liftedClause(LiftedClauseSpec & spec) {
+    LiftedClause::post(*space, boolVarArrays, intVarArrays, spec);
   }
 
-  int getIntValue(int_var v) {
-    return intValues[v.id].val();
+  /* Posts the branchings and returns the space which is then owned
+     by the caller. The builder must be deleted after this call.
+     The symmetries of syms (if any) are broken by LDSB.
+  */
+  GecodeForCrossbow * endSpec(Branching branching, double decay,
+                              const SortSymmetrySpec * syms) {
+    GecodeForCrossbow & home = *space;
+    home.setValues(boolVars, intVars);
+
+    // Cells restricted by LNH are assigned first in the order
+    // of LNH so the precedence constraints propagate early.
+    if (branching == branch_lnh)
+      branch(home, lnhVars, INT_VAR_NONE(), INT_VAL_MIN());
+
+    IntVarBranch vars = varBranch(branching, decay);
+
+    if (syms)
+      branchWithSortSymmetries(home, intVars, vars, *syms);
+    else
+      branch(home, intVars, vars, INT_VAL_MIN());
+    branch(home, boolVars, vars, INT_VAL_MIN());
+
+    branch(home, tmpIntVars, vars, INT_VAL_MIN());
+    branch(home, tmpBoolVars, vars, INT_VAL_MIN());
+
+    space = 0;
+    return &home;
   }
 };
 
@@ -247,45 +423,216 @@ public:
 #define log_coefs(coefs)
 #endif
 
+struct ProgressSnapshot {
+  unsigned long int conflicts;
+  unsigned long int decisions;
+  unsigned long int depth;
+};
+
+// Lock-free ring buffer of progress snapshots. The search publishes
+// snapshots and another thread reads them without stopping the search.
+// Each slot is guarded by a sequence number which is odd while the slot
+// is being written, so the reader skips snapshots which were overwritten
+// while it was copying them. The oldest snapshots are lost
+// when the reader doesn't keep up.
+struct ProgressRing {
+  static const unsigned long int capacity = 64;
+
+  struct Slot {
+    std::atomic<unsigned long int> seq;
+    std::atomic<unsigned long int> conflicts;
+    std::atomic<unsigned long int> decisions;
+    std::atomic<unsigned long int> depth;
+  };
+
+  Slot slots[capacity];
+  // Number of published snapshots.
+  std::atomic<unsigned long int> head;
+  // Number of snapshots seen by the reader.
+  unsigned long int tail;
+  // Workers of the parallel search publish one at a time.
+  std::atomic_flag publishing;
+
+  ProgressRing() : head(0), tail(0) {
+    publishing.clear();
+    for (unsigned long int i = 0; i < capacity; i++)
+      slots[i].seq.store(0, std::memory_order_relaxed);
+  }
+
+  // Skips the snapshot when another thread is publishing.
+  void publish(const Search::Statistics & s) {
+    if (publishing.test_and_set(std::memory_order_acquire))
+      return;
+    const unsigned long int i = head.load(std::memory_order_relaxed);
+    Slot & slot = slots[i % capacity];
+    slot.seq.store(2*i + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.conflicts.store(s.fail, std::memory_order_relaxed);
+    slot.decisions.store(s.node, std::memory_order_relaxed);
+    slot.depth.store(s.depth, std::memory_order_relaxed);
+    slot.seq.store(2*i + 2, std::memory_order_release);
+    head.store(i + 1, std::memory_order_release);
+    publishing.clear(std::memory_order_release);
+  }
+
+  // Called only by the reader. Copies the snapshots published since
+  // the previous call (oldest first, at most capacity) to out
+  // and returns their number.
+  unsigned long int poll(ProgressSnapshot * out) {
+    const unsigned long int h = head.load(std::memory_order_acquire);
+    if (h - tail > capacity)
+      tail = h - capacity;
+    unsigned long int n = 0;
+    for (; tail < h; tail++) {
+      const Slot & slot = slots[tail % capacity];
+      const unsigned long int seq = slot.seq.load(std::memory_order_acquire);
+      ProgressSnapshot snap;
+      snap.conflicts = slot.conflicts.load(std::memory_order_relaxed);
+      snap.decisions = slot.decisions.load(std::memory_order_relaxed);
+      snap.depth = slot.depth.load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (seq == 2*tail + 2 && slot.seq.load(std::memory_order_relaxed) == seq)
+        out[n++] = snap;
+    }
+    return n;
+  }
+};
+
 struct Interrupt : public Search::Stop {
-  bool _stop;
+  // Set by other threads.
+  std::atomic<bool> _stop;
+  ProgressRing progress;
+
+  // A snapshot is published after this many nodes.
+  static const unsigned long int progress_interval = 1024;
+
+  Interrupt() : _stop(false) {
+  }
+
+  // The parallel search calls this from every worker
+  // with the statistics of the worker.
+  virtual bool stop(const Search::Statistics & s, const Search::Options &) {
+    if (s.node % progress_interval == 0)
+      progress.publish(s);
+    return _stop.load(std::memory_order_relaxed);
+  }
+};
 
-  Interrupt() {
-    _stop = false;
+// Restart-based search deletes its stop object. This one forwards
+// to the stop object owned by GecodeSolver.
+struct StopRef : public Search::Stop {
+  Search::Stop * s;
+
+  explicit StopRef(Search::Stop * s) : s(s) {
+  }
+
+  virtual bool stop(const Search::Statistics & st, const Search::Options & o) {
+    return s->stop(st, o);
   }
+};
 
-  virtual bool stop(const Search::Statistics &, const Search::Options &) {
-    return _stop;
+// Constructors of Gecode.restart.
+enum Restart {
+  restart_none = 0,
+  restart_luby = 1,
+  restart_geom = 2,
+};
+
+// Gecode.config.
+struct SearchConfig {
+  Restart restart;
+  unsigned long int restartScale;
+  double restartBase;
+  unsigned int nogoodsLimit;
+  Branching branching;
+  double decay;
+  bool lifted;
+  bool ldsb;
+  unsigned int commitDistance;
+  unsigned int adaptiveDistance;
+  bool extensional;
+
+  SearchConfig()
+    : restart(restart_none), restartScale(100), restartBase(1.5),
+      nogoodsLimit(128), branching(branch_size), decay(1.0), lifted(true),
+      ldsb(false), commitDistance(Search::Config::c_d),
+      adaptiveDistance(Search::Config::a_d), extensional(false) {
   }
 };
 
 struct GecodeSolver {
   int nthreads;
-  GecodeForCrossbow * g;
+  SearchConfig conf;
+  // Deleted when the search starts.
+  GecodeForCrossbowBuilder * builder;
   GecodeForCrossbow * lastSolution;
-  DFS<GecodeForCrossbow> * dfs;
+  Search::EngineBase<GecodeForCrossbow> * engine;
   Interrupt * stop;
+  // Tables declared by gecode_symmetric_table. Spaces refer to them
+  // so they are destroyed after the engine.
+  SortSymmetrySpec symmetries;
+  // Statistics of the engine before the last call to gecode_solve.
+  Search::Statistics statsBefore;
 
-  GecodeSolver(int nthreads) {
+  GecodeSolver(int nthreads, const SearchConfig & conf) {
     this->nthreads = nthreads;
-    this->g = new GecodeForCrossbow();
+    this->conf = conf;
+    this->builder = new GecodeForCrossbowBuilder();
     this->lastSolution = 0;
-    this->dfs = 0;
-    this->stop = 0;
+    this->engine = 0;
+    this->stop = new Interrupt();
+  }
+
+  // Creates the search engine for the space of the builder.
+  // The builder and the space are deleted.
+  void startSearch() {
+    const bool ldsb = conf.ldsb && !symmetries.tables.empty();
+    GecodeForCrossbow * g =
+      builder->endSpec(conf.branching, conf.decay, ldsb ? &symmetries : 0);
+    delete builder;
+    builder = 0;
+
+    Search::Options opts;
+    opts.stop = stop;
+    opts.threads = nthreads;
+    opts.c_d = conf.commitDistance;
+    opts.a_d = conf.adaptiveDistance;
+
+    if (conf.restart == restart_none) {
+      engine = new DFS<GecodeForCrossbow>(g, opts);
+    } else {
+      // The engine owns the stop object and the cutoff.
+      opts.stop = new StopRef(stop);
+      if (conf.restart == restart_luby)
+        opts.cutoff = Search::Cutoff::luby(conf.restartScale);
+      else
+        opts.cutoff =
+          Search::Cutoff::geometric(conf.restartScale, conf.restartBase);
+      // Parallel DFS takes no-goods only from the path of its first
+      // worker which is not sound when other workers have stolen
+      // alternatives from it - solutions are lost.
+      if (opts.expand().threads <= 1.0)
+        opts.nogoods_limit = conf.nogoodsLimit;
+      else
+        opts.nogoods_limit = 0;
+      engine = new RBS<DFS, GecodeForCrossbow>(g, opts);
+    }
+
+    delete g;
   }
 
   ~GecodeSolver() {
-    if (g) {
-      delete g;
-      g = 0;
+    if (builder) {
+      delete builder;
+      builder = 0;
     }
     if (lastSolution) {
       delete lastSolution;
       lastSolution = 0;
     }
-    if (dfs) {
-      delete dfs;
-      dfs = 0;
+    if (engine) {
+      delete engine;
+      engine = 0;
     }
     if (stop) {
       delete stop;
@@ -320,12 +667,23 @@ static struct custom_operations gecode_ops = {
 
 extern "C" {
 
+CAMLprim value gecode_default_distances(value unit) {
+  CAMLparam1 (unit);
+  CAMLlocal1 (resv);
+
+  resv = caml_alloc_tuple(2);
+  Store_field(resv, 0, Val_int(Search::Config::c_d));
+  Store_field(resv, 1, Val_int(Search::Config::a_d));
+
+  CAMLreturn (resv);
+}
+
 CAMLprim value gecode_create(value nthreadsv) {
   CAMLparam1 (nthreadsv);
   CAMLlocal1 (gv);
 
   int nthreads = Int_val(nthreadsv);
-  GecodeSolver * g = new GecodeSolver(nthreads);
+  GecodeSolver * g = new GecodeSolver(nthreads, SearchConfig());
 
   gv = caml_alloc_custom(&gecode_ops, sizeof(GecodeSolver *), 0, 1);
   Solver_val(gv) = g;
@@ -335,6 +693,34 @@ CAMLprim value gecode_create(value nthreadsv) {
   CAMLreturn (gv);
 }
 
+CAMLprim value gecode_create_with_config(value nthreadsv, value configv) {
+  CAMLparam2 (nthreadsv, configv);
+  CAMLlocal1 (gv);
+
+  SearchConfig conf;
+  conf.restart = (Restart) Int_val(Field(configv, 0));
+  conf.restartScale = Long_val(Field(configv, 1));
+  conf.restartBase = Double_val(Field(configv, 2));
+  conf.nogoodsLimit = Int_val(Field(configv, 3));
+  conf.branching = (Branching) Int_val(Field(configv, 4));
+  conf.decay = Double_val(Field(configv, 5));
+  conf.lifted = Bool_val(Field(configv, 6));
+  conf.ldsb = Bool_val(Field(configv, 7));
+  conf.commitDistance = Int_val(Field(configv, 8));
+  conf.adaptiveDistance = Int_val(Field(configv, 9));
+  conf.extensional = Bool_val(Field(configv, 10));
+
+  int nthreads = Int_val(nthreadsv);
+  GecodeSolver * g = new GecodeSolver(nthreads, conf);
+
+  gv = caml_alloc_custom(&gecode_ops, sizeof(GecodeSolver *), 0, 1);
+  Solver_val(gv) = g;
+
+  log("gecode_create_with_config(%d) = %p\n", nthreads, (void *)g);
+
+  CAMLreturn (gv);
+}
+
 CAMLprim value gecode_destroy(value gv) {
   CAMLparam1 (gv);
 
@@ -355,7 +741,7 @@ CAMLprim value gecode_new_bool_var(value gv) {
   CAMLparam1 (gv);
 
   GecodeSolver * g = Solver_val(gv);
-  bool_var var = g->g->newBoolVar();
+  bool_var var = g->builder->newBoolVar();
 
   CAMLreturn (Val_int(var.id));
 }
@@ -364,7 +750,7 @@ CAMLprim value gecode_new_int_var(value gv, value dom_sizev) {
   CAMLparam2 (gv, dom_sizev);
 
   GecodeSolver * g = Solver_val(gv);
-  int_var var = g->g->newIntVar(Int_val(dom_sizev));
+  int_var var = g->builder->newIntVar(Int_val(dom_sizev));
 
   CAMLreturn (Val_int(var.id));
 }
@@ -373,7 +759,7 @@ CAMLprim value gecode_new_tmp_bool_var(value gv) {
   CAMLparam1 (gv);
 
   GecodeSolver * g = Solver_val(gv);
-  bool_var var = g->g->newTmpBoolVar();
+  bool_var var = g->builder->newTmpBoolVar();
 
   CAMLreturn (Val_int(var.id));
 }
@@ -382,7 +768,7 @@ CAMLprim value gecode_new_tmp_int_var(value gv, value dom_sizev) {
   CAMLparam2 (gv, dom_sizev);
 
   GecodeSolver * g = Solver_val(gv);
-  int_var var = g->g->newTmpIntVar(Int_val(dom_sizev));
+  int_var var = g->builder->newTmpIntVar(Int_val(dom_sizev));
 
   CAMLreturn (Val_int(var.id));
 }
@@ -411,7 +797,7 @@ CAMLprim value gecode_new_bool_var_array(value gv, value varsv) {
   std::vector<bool_var> vars;
   bool_var_vector_of_value(vars, varsv);
 
-  bool_var_array arr = g->g->newBoolVarArray(vars);
+  bool_var_array arr = g->builder->newBoolVarArray(vars);
 
   CAMLreturn (Val_int(arr.id));
 }
@@ -424,7 +810,7 @@ CAMLprim value gecode_new_int_var_array(value gv, value varsv) {
   std::vector<int_var> vars;
   int_var_vector_of_value(vars, varsv);
 
-  int_var_array arr = g->g->newIntVarArray(vars);
+  int_var_array arr = g->builder->newIntVarArray(vars);
 
   CAMLreturn (Val_int(arr.id));
 }
@@ -444,7 +830,7 @@ CAMLprim value gecode_linear(value gv, value varsv, value coefsv, value cv) {
 
   int c = Int_val(cv);
 
-  g->g->linear(vars, coefs, c);
+  g->builder->linear(vars, coefs, c);
 
   log("gecode_linear(%p, ", (void *)g);
   log_vars(vars);
@@ -469,7 +855,7 @@ CAMLprim value gecode_bool_element(value gv, value arrv, value xv, value yv) {
   bool_var y;
   y.id = Int_val(yv);
 
-  g->g->boolElement(arr, x, y);
+  g->builder->boolElement(arr, x, y);
 
   log("gecode_bool_element(%p, %d, %d, %d)\n", (void *)g, arr.id, x.id, y.id);
 
@@ -490,13 +876,95 @@ CAMLprim value gecode_int_element(value gv, value arrv, value xv, value yv) {
   int_var y;
   y.id = Int_val(yv);
 
-  g->g->intElement(arr, x, y);
+  g->builder->intElement(arr, x, y);
 
   log("gecode_int_element(%p, %d, %d, %d)\n", (void *)g, arr.id, x.id, y.id);
 
   CAMLreturn (Val_unit);
 }
 
+CAMLprim value gecode_bool_matrix_element(
+  value gv, value arrv, value idxsv, value coefsv, value cv, value yv) {
+
+  CAMLparam5 (gv, arrv, idxsv, coefsv, cv);
+  CAMLxparam1 (yv);
+
+  GecodeSolver * g = Solver_val(gv);
+
+  bool_var_array arr;
+  arr.id = Int_val(arrv);
+
+  std::vector<int_var> idxs;
+  int_var_vector_of_value(idxs, idxsv);
+
+  std::vector<int> coefs;
+  for (unsigned int i = 0; i < Wosize_val(coefsv); i++) {
+    coefs.push_back(Int_val(Field(coefsv, i)));
+  }
+
+  int c = Int_val(cv);
+
+  bool_var y;
+  y.id = Int_val(yv);
+
+  g->builder->boolMatrixElement(arr, idxs, coefs, c, y);
+
+  log("gecode_bool_matrix_element(%p, %d, ", (void *)g, arr.id);
+  log_vars(idxs);
+  log(", ");
+  log_coefs(coefs);
+  log(", %d, %d)\n", c, y.id);
+
+  CAMLreturn (Val_unit);
+}
+
+CAMLprim value gecode_bool_matrix_element_bytecode(value * argv, int argn) {
+  (void) argn;
+  return gecode_bool_matrix_element(argv[0], argv[1], argv[2], argv[3],
+                                    argv[4], argv[5]);
+}
+
+CAMLprim value gecode_int_matrix_element(
+  value gv, value arrv, value idxsv, value coefsv, value cv, value yv) {
+
+  CAMLparam5 (gv, arrv, idxsv, coefsv, cv);
+  CAMLxparam1 (yv);
+
+  GecodeSolver * g = Solver_val(gv);
+
+  int_var_array arr;
+  arr.id = Int_val(arrv);
+
+  std::vector<int_var> idxs;
+  int_var_vector_of_value(idxs, idxsv);
+
+  std::vector<int> coefs;
+  for (unsigned int i = 0; i < Wosize_val(coefsv); i++) {
+    coefs.push_back(Int_val(Field(coefsv, i)));
+  }
+
+  int c = Int_val(cv);
+
+  int_var y;
+  y.id = Int_val(yv);
+
+  g->builder->intMatrixElement(arr, idxs, coefs, c, y);
+
+  log("gecode_int_matrix_element(%p, %d, ", (void *)g, arr.id);
+  log_vars(idxs);
+  log(", ");
+  log_coefs(coefs);
+  log(", %d, %d)\n", c, y.id);
+
+  CAMLreturn (Val_unit);
+}
+
+CAMLprim value gecode_int_matrix_element_bytecode(value * argv, int argn) {
+  (void) argn;
+  return gecode_int_matrix_element(argv[0], argv[1], argv[2], argv[3],
+                                   argv[4], argv[5]);
+}
+
 CAMLprim value gecode_eq_var_var(value gv, value xv, value x2v, value yv) {
   CAMLparam4 (gv, xv, x2v, yv);
 
@@ -511,7 +979,7 @@ CAMLprim value gecode_eq_var_var(value gv, value xv, value x2v, value yv) {
   bool_var y;
   y.id = Int_val(yv);
 
-  g->g->eqVarVar(x, x2, y);
+  g->builder->eqVarVar(x, x2, y);
 
   log("gecode_eq_var_var(%p, %d, %d, %d)\n", (void *)g, x.id, x2.id, y.id);
 
@@ -531,7 +999,7 @@ CAMLprim value gecode_eq_var_const(value gv, value xv, value cv, value yv) {
   bool_var y;
   y.id = Int_val(yv);
 
-  g->g->eqVarConst(x, c, y);
+  g->builder->eqVarConst(x, c, y);
 
   log("gecode_eq_var_const(%p, %d, %d, %d)\n", (void *)g, x.id, c, y.id);
 
@@ -548,7 +1016,7 @@ CAMLprim value gecode_lower_eq(value gv, value xv, value cv) {
 
   int c = Int_val(cv);
 
-  g->g->lowerEq(x, c);
+  g->builder->lowerEq(x, c);
 
   log("gecode_lower_eq(%p, %d, %d)\n", (void *)g, x.id, c);
 
@@ -568,7 +1036,7 @@ CAMLprim value gecode_precede(value gv, value varsv, value constsv) {
     consts.push_back(Int_val(Field(constsv, i)));
   }
 
-  g->g->precede(vars, consts);
+  g->builder->precede(vars, consts);
 
   log("gecode_precede(%p, ", (void *)g);
   log_vars(vars);
@@ -590,7 +1058,7 @@ CAMLprim value gecode_clause(value gv, value posv, value negv) {
   std::vector<bool_var> neg;
   bool_var_vector_of_value(neg, negv);
 
-  g->g->clause(pos, neg);
+  g->builder->clause(pos, neg);
 
   log("gecode_clause(%p, ", (void *)g);
   log_vars(pos);
@@ -609,7 +1077,7 @@ CAMLprim value gecode_all_different(value gv, value varsv) {
   std::vector<int_var> vars;
   int_var_vector_of_value(vars, varsv);
 
-  g->g->allDifferent(vars);
+  g->builder->allDifferent(vars);
 
   log("gecode_all_different(%p, ", (void *)g);
   log_vars(vars);
@@ -618,43 +1086,201 @@ CAMLprim value gecode_all_different(value gv, value varsv) {
   CAMLreturn (Val_unit);
 }
 
-CAMLprim value gecode_solve(value gv) {
+CAMLprim value gecode_extensional(value gv, value varsv, value tuplesv) {
+  CAMLparam3 (gv, varsv, tuplesv);
+
+  GecodeSolver * g = Solver_val(gv);
+
+  std::vector<int_var> vars;
+  int_var_vector_of_value(vars, varsv);
+
+  std::vector<int> tuples;
+  for (unsigned int i = 0; i < Wosize_val(tuplesv); i++) {
+    tuples.push_back(Int_val(Field(tuplesv, i)));
+  }
+
+  g->builder->extensional(vars, tuples);
+
+  log("gecode_extensional(%p, ", (void *)g);
+  log_vars(vars);
+  log(", %d tuples)\n", (int) (tuples.size() / vars.size()));
+
+  CAMLreturn (Val_unit);
+}
+
+CAMLprim value gecode_extensional_clauses(value gv) {
   CAMLparam1 (gv);
 
   GecodeSolver * g = Solver_val(gv);
 
-  if (!g->dfs) {
-    g->g->endSpec();
+  CAMLreturn (Val_bool(g->conf.extensional));
+}
+
+// Finds or adds the table for the array of CSP variables.
+static int lifted_table(LiftedClauseSpec & spec, bool isBool, value cellv) {
+  const int array = Int_val(Field(cellv, 0));
+  for (unsigned int i = 0; i < spec->tables.size(); i++) {
+    const LiftedTable & t = spec->tables[i];
+    if (t.isBool == isBool && t.array == array)
+      return i;
+  }
+
+  LiftedTable t;
+  t.isBool = isBool;
+  t.array = array;
+  t.offset = 0;
+  value sizesv = Field(cellv, 2);
+  for (unsigned int i = 0; i < Wosize_val(sizesv); i++) {
+    t.argSizes.push_back(Int_val(Field(sizesv, i)));
+  }
+  spec->tables.push_back(t);
+  return spec->tables.size() - 1;
+}
 
-    Interrupt * interrupt = new Interrupt();
-    g->stop = interrupt;
+// Converts Csp_solver.lifted_cell.
+static void lifted_cell_of_value(
+  LiftedClauseSpec & spec, bool isBool, value cellv,
+  LiftedCell & cell, int atom, bool second) {
 
-    Search::Options opts;
-    opts.stop = interrupt;
-    opts.threads = g->nthreads;
+  cell.table = lifted_table(spec, isBool, cellv);
+  value argsv = Field(cellv, 1);
+  for (unsigned int i = 0; i < Wosize_val(argsv); i++) {
+    cell.args.push_back(Int_val(Field(argsv, i)));
+  }
+  spec->tables[cell.table].uses.push_back(std::make_pair(atom, second));
+}
 
-    DFS<GecodeForCrossbow> * dfs = new DFS<GecodeForCrossbow>(g->g, opts);
-    g->dfs = dfs;
+// Converts Csp_solver.lifted_atom.
+static void lifted_atoms_of_value(
+  LiftedClauseSpec & spec, bool sign, value atomsv) {
+
+  for (unsigned int i = 0; i < Wosize_val(atomsv); i++) {
+    value atomv = Field(atomsv, i);
+    const int idx = spec->atoms.size();
+    spec->atoms.push_back(LiftedAtom());
+    LiftedAtom & atom = spec->atoms.back();
+    atom.kind = (LiftedAtom::Kind) Tag_val(atomv);
+    atom.sign = sign;
+    atom.var = -1;
+    const bool isBool = atom.kind == LiftedAtom::pred;
+    lifted_cell_of_value(spec, isBool, Field(atomv, 0), atom.cell, idx, false);
+    if (atom.kind == LiftedAtom::eq_var) {
+      atom.var = Int_val(Field(atomv, 1));
+    } else if (atom.kind == LiftedAtom::eq_cells) {
+      value cell2v = Field(atomv, 1);
+      lifted_cell_of_value(spec, false, cell2v, atom.cell2, idx, true);
+    }
+  }
+}
 
-    delete g->g;
-    g->g = 0;
+static void var_pairs_of_value(
+  std::vector<std::pair<int, int> > & pairs, value pairsv) {
+
+  for (unsigned int i = 0; i < Wosize_val(pairsv); i++) {
+    value pv = Field(pairsv, i);
+    pairs.push_back(
+      std::make_pair(Int_val(Field(pv, 0)), Int_val(Field(pv, 1))));
   }
+}
+
+CAMLprim value gecode_lifted_clause(
+  value gv, value var_sizesv, value var_eqsv, value var_ineqsv,
+  value posv, value negv) {
+
+  CAMLparam5 (gv, var_sizesv, var_eqsv, var_ineqsv, posv);
+  CAMLxparam1 (negv);
+
+  GecodeSolver * g = Solver_val(gv);
+
+  LiftedClauseSpec spec;
+  spec.init();
+  for (unsigned int i = 0; i < Wosize_val(var_sizesv); i++) {
+    spec->varSizes.push_back(Int_val(Field(var_sizesv, i)));
+  }
+  var_pairs_of_value(spec->varEqs, var_eqsv);
+  var_pairs_of_value(spec->varIneqs, var_ineqsv);
+  lifted_atoms_of_value(spec, true, posv);
+  lifted_atoms_of_value(spec, false, negv);
+
+  g->builder->liftedClause(spec);
+
+  log("gecode_lifted_clause(%p, %d vars, %d atoms)\n", (void *)g,
+      (int) spec->varSizes.size(), (int) spec->atoms.size());
+
+  CAMLreturn (Val_unit);
+}
+
+CAMLprim value gecode_lifted_clause_bytecode(value * argv, int argn) {
+  (void) argn;
+  return gecode_lifted_clause(argv[0], argv[1], argv[2], argv[3], argv[4],
+                              argv[5]);
+}
+
+CAMLprim value gecode_lifted_clauses(value gv) {
+  CAMLparam1 (gv);
+
+  GecodeSolver * g = Solver_val(gv);
+
+  CAMLreturn (Val_bool(g->conf.lifted));
+}
+
+CAMLprim value gecode_symmetric_table(
+  value gv, value cellsv, value sortsv, value sizesv) {
+
+  CAMLparam4 (gv, cellsv, sortsv, sizesv);
+
+  GecodeSolver * g = Solver_val(gv);
+
+  SymmetricTable t;
+  for (unsigned int i = 0; i < Wosize_val(cellsv); i++) {
+    t.cells.push_back(Int_val(Field(cellsv, i)));
+  }
+  for (unsigned int i = 0; i < Wosize_val(sortsv); i++) {
+    t.sorts.push_back(Int_val(Field(sortsv, i)));
+    t.sizes.push_back(Int_val(Field(sizesv, i)));
+  }
+
+  g->symmetries.addTable(t);
+
+  log("gecode_symmetric_table(%p, %d cells, arity %d)\n", (void *)g,
+      (int) t.cells.size(), (int) t.sorts.size() - 1);
+
+  CAMLreturn (Val_unit);
+}
+
+CAMLprim value gecode_symmetric_tables(value gv) {
+  CAMLparam1 (gv);
+
+  GecodeSolver * g = Solver_val(gv);
+
+  CAMLreturn (Val_bool(g->conf.ldsb));
+}
+
+CAMLprim value gecode_solve(value gv) {
+  CAMLparam1 (gv);
+
+  GecodeSolver * g = Solver_val(gv);
+
+  if (!g->engine)
+    g->startSearch();
 
   if (g->lastSolution) {
     delete g->lastSolution;
     g->lastSolution = 0;
   }
 
-  g->stop->_stop = false;
+  g->stop->_stop.store(false, std::memory_order_relaxed);
+  g->statsBefore = g->engine->statistics();
 
   caml_release_runtime_system();
-  g->lastSolution = g->dfs->next();
+  g->lastSolution = g->engine->next();
+  g->stop->progress.publish(g->engine->statistics());
   caml_acquire_runtime_system();
 
   int result = 2;
   if (g->lastSolution)
     result = 0;
-  else if (!g->dfs->stopped())
+  else if (!g->engine->stopped())
     result = 1;
 
   log("gecode_solve(%p) = %d\n", (void *)g, result);
@@ -667,13 +1293,72 @@ CAMLprim value gecode_interrupt(value gv) {
 
   GecodeSolver * g = Solver_val(gv);
 
-  g->stop->_stop = true;
+  g->stop->_stop.store(true, std::memory_order_relaxed);
 
   log("gecode_interrupt(%p)\n", (void *)g);
 
   CAMLreturn (Val_unit);
 }
 
+// Can be called by another thread while the solver is searching.
+CAMLprim value gecode_poll_progress(value gv) {
+  CAMLparam1 (gv);
+  CAMLlocal3 (resv, snapv, consv);
+
+  GecodeSolver * g = Solver_val(gv);
+
+  ProgressSnapshot snaps[ProgressRing::capacity];
+  unsigned long int n = g->stop->progress.poll(snaps);
+
+  // List of Sh.progress records, the oldest snapshot first.
+  resv = Val_emptylist;
+  for (unsigned long int i = n; i > 0; i--) {
+    snapv = caml_alloc_tuple(3);
+    Store_field(snapv, 0, Val_long(snaps[i-1].conflicts));
+    Store_field(snapv, 1, Val_long(snaps[i-1].decisions));
+    Store_field(snapv, 2, Val_long(snaps[i-1].depth));
+    consv = caml_alloc(2, 0);
+    Store_field(consv, 0, snapv);
+    Store_field(consv, 1, resv);
+    resv = consv;
+  }
+
+  log("gecode_poll_progress(%p) = %lu\n", (void *)g, n);
+
+  CAMLreturn (resv);
+}
+
+CAMLprim value gecode_last_stats(value gv) {
+  CAMLparam1 (gv);
+  CAMLlocal1 (statsv);
+
+  GecodeSolver * g = Solver_val(gv);
+
+  // Counters of the engine are cumulative so the counters
+  // from the previous calls are subtracted. Depth is the maximum.
+  Search::Statistics stats;
+  if (g->engine) {
+    const Search::Statistics now = g->engine->statistics();
+    stats.fail = now.fail - g->statsBefore.fail;
+    stats.node = now.node - g->statsBefore.node;
+    stats.propagate = now.propagate - g->statsBefore.propagate;
+    stats.restart = now.restart - g->statsBefore.restart;
+    stats.nogood = now.nogood - g->statsBefore.nogood;
+    stats.depth = now.depth;
+  }
+
+  // Record Gecode.stats.
+  statsv = caml_alloc_tuple(6);
+  Store_field(statsv, 0, Val_long(stats.fail));
+  Store_field(statsv, 1, Val_long(stats.node));
+  Store_field(statsv, 2, Val_long(stats.propagate));
+  Store_field(statsv, 3, Val_long(stats.depth));
+  Store_field(statsv, 4, Val_long(stats.restart));
+  Store_field(statsv, 5, Val_long(stats.nogood));
+
+  CAMLreturn (statsv);
+}
+
 CAMLprim value gecode_bool_value(value gv, value varv) {
   CAMLparam2 (gv, varv);
 
@@ -0,0 +1,462 @@
+/* Copyright (c) 2015 Radek Micek */
+
+#ifndef __LIFTEDCLAUSE_HH__
+#define __LIFTEDCLAUSE_HH__
+
+#include <vector>
+#include <utility>
+
+#include <gecode/int.hh>
+
+namespace Crossbow {
+
+using namespace Gecode;
+
+// Cell s(x_0, ..., x_k) of a lifted clause where x_i are clause variables.
+struct LiftedCell {
+  // Index into LiftedClauseSpec::tables.
+  int table;
+  // Indices of clause variables.
+  std::vector<int> args;
+};
+
+struct LiftedAtom {
+  enum Kind {
+    // p(x_0, ..., x_k).
+    pred = 0,
+    // f(x_0, ..., x_k) = y.
+    eq_var = 1,
+    // f(x_0, ..., x_k) = g(y_0, ..., y_l).
+    eq_cells = 2,
+  };
+
+  Kind kind;
+  bool sign;
+  LiftedCell cell;
+  // Clause variable y for eq_var.
+  int var;
+  // Second cell for eq_cells.
+  LiftedCell cell2;
+};
+
+// Cells of one symbol. Cells of boolean tables are stored in a view array
+// of BoolViews and cells of integral tables in a view array of IntViews.
+struct LiftedTable {
+  bool isBool;
+  // Id of the array of CSP variables with the cells.
+  int array;
+  // Position of the first cell in the view array.
+  int offset;
+  // Domain sizes of the arguments of the symbol.
+  std::vector<int> argSizes;
+  // Atoms which contain the table: the index of the atom
+  // and whether the table is the second cell of eq_cells.
+  std::vector<std::pair<int, bool> > uses;
+};
+
+// Clause template shared by all copies of the propagator.
+class LiftedClauseSpec : public SharedHandle {
+public:
+  class Spec : public SharedHandle::Object {
+  public:
+    std::vector<int> varSizes;
+    // Instances where these variables are equal are skipped.
+    std::vector<std::pair<int, int> > varEqs;
+    // Instances where these variables are not equal are skipped.
+    std::vector<std::pair<int, int> > varIneqs;
+    std::vector<LiftedAtom> atoms;
+    std::vector<LiftedTable> tables;
+
+    virtual SharedHandle::Object * copy(void) const {
+      return new Spec(*this);
+    }
+  };
+
+  // Creates a handle without a template.
+  LiftedClauseSpec() {
+  }
+
+  LiftedClauseSpec(const LiftedClauseSpec & s) : SharedHandle(s) {
+  }
+
+  LiftedClauseSpec & operator =(const LiftedClauseSpec & s) {
+    SharedHandle::operator =(s);
+    return *this;
+  }
+
+  // Creates an empty template.
+  void init() {
+    object(new Spec());
+  }
+
+  Spec * operator ->(void) const {
+    return static_cast<Spec *>(object());
+  }
+};
+
+// Propagates all instances of a lifted clause. An instance is checked
+// only when one of its cells changes: the advisors of the cells
+// queue them and the propagator enumerates the instances
+// which contain the queued cells. When exactly one literal
+// of an instance is not false the literal is made true.
+class LiftedClause : public Propagator {
+protected:
+  // Advisor for the cell at the position i where cells of integral
+  // tables follow cells of boolean tables.
+  class Index : public Advisor {
+  public:
+    int i;
+
+    Index(Space & home, Propagator & p, Council<Index> & c, int i)
+      : Advisor(home, p, c), i(i) {
+    }
+
+    Index(Space & home, bool share, Index & a)
+      : Advisor(home, share, a), i(a.i) {
+    }
+  };
+
+  ViewArray<Int::BoolView> b;
+  ViewArray<Int::IntView> x;
+  Council<Index> c;
+  LiftedClauseSpec spec;
+
+  // Cells changed since the last propagation.
+  int * queue;
+  int queueSize;
+  // Nonzero for the queued cells.
+  char * queued;
+  // All instances are checked by the first propagation.
+  bool checkAll;
+
+  // Values of clause variables.
+  int * values;
+  // Nonzero for the clause variables with a value.
+  char * fixed;
+
+  int cells() const {
+    return b.size() + x.size();
+  }
+
+  void allocate(Space & home) {
+    queue = home.alloc<int>(cells());
+    queued = home.alloc<char>(cells());
+    for (int i = 0; i < cells(); i++)
+      queued[i] = 0;
+    queueSize = 0;
+    const int nvars = spec->varSizes.size();
+    values = home.alloc<int>(nvars);
+    fixed = home.alloc<char>(nvars);
+  }
+
+  LiftedClause(Home home, ViewArray<Int::BoolView> & b0,
+               ViewArray<Int::IntView> & x0, const LiftedClauseSpec & s)
+    : Propagator(home), b(b0), x(x0), c(home), spec(s), checkAll(true) {
+    allocate(home);
+    for (int i = 0; i < b.size(); i++)
+      if (!b[i].assigned())
+        b[i].subscribe(home, *new (home) Index(home, *this, c, i));
+    for (int i = 0; i < x.size(); i++)
+      if (!x[i].assigned())
+        x[i].subscribe(home, *new (home) Index(home, *this, c, b.size() + i));
+    home.notice(*this, AP_DISPOSE);
+    Int::IntView::schedule(home, *this, Int::ME_INT_VAL);
+  }
+
+  LiftedClause(Space & home, bool share, LiftedClause & p)
+    : Propagator(home, share, p), checkAll(p.checkAll) {
+    b.update(home, share, p.b);
+    x.update(home, share, p.x);
+    c.update(home, share, p.c);
+    spec.update(home, share, p.spec);
+    allocate(home);
+    for (int i = 0; i < p.queueSize; i++) {
+      queue[queueSize++] = p.queue[i];
+      queued[p.queue[i]] = 1;
+    }
+  }
+
+  // Index of the cell in the table for the values of clause variables.
+  int rank(const LiftedCell & cell) const {
+    const LiftedTable & t = spec->tables[cell.table];
+    int r = 0;
+    for (unsigned int i = 0; i < cell.args.size(); i++)
+      r = r * t.argSizes[i] + values[cell.args[i]];
+    return t.offset + r;
+  }
+
+  // Sets the arguments of the cell to the values for the cell
+  // at the position r in the table. Returns false when the values
+  // are inconsistent with the values which are already set.
+  bool unrank(const LiftedCell & cell, int r) {
+    const LiftedTable & t = spec->tables[cell.table];
+    for (int i = cell.args.size() - 1; i >= 0; i--) {
+      const int v = r % t.argSizes[i];
+      r /= t.argSizes[i];
+      const int var = cell.args[i];
+      if (v >= spec->varSizes[var])
+        return false;
+      if (fixed[var] && values[var] != v)
+        return false;
+      values[var] = v;
+      fixed[var] = 1;
+    }
+    return true;
+  }
+
+  // Returns 1 when the atom is true, 0 when it is false
+  // and -1 when its value is unknown.
+  int status(const LiftedAtom & atom) const {
+    switch (atom.kind) {
+    case LiftedAtom::pred: {
+      Int::BoolView v = b[rank(atom.cell)];
+      return v.assigned() ? v.val() : -1;
+    }
+    case LiftedAtom::eq_var: {
+      Int::IntView v = x[rank(atom.cell)];
+      const int val = values[atom.var];
+      if (!v.in(val))
+        return 0;
+      return v.assigned() ? 1 : -1;
+    }
+    default: {
+      const int i = rank(atom.cell);
+      const int j = rank(atom.cell2);
+      Int::IntView v = x[i];
+      Int::IntView w = x[j];
+      // Cells of commutative symbols share variables.
+      if (same(v, w))
+        return 1;
+      if (v.assigned() && w.assigned())
+        return v.val() == w.val();
+      if (v.assigned())
+        return w.in(v.val()) ? -1 : 0;
+      if (w.assigned())
+        return v.in(w.val()) ? -1 : 0;
+      if (v.max() < w.min() || w.max() < v.min())
+        return 0;
+      return -1;
+    }
+    }
+  }
+
+  // Makes the literal of the atom true.
+  ExecStatus satisfy(Space & home, const LiftedAtom & atom) {
+    switch (atom.kind) {
+    case LiftedAtom::pred:
+      GECODE_ME_CHECK(b[rank(atom.cell)].eq(home, atom.sign ? 1 : 0));
+      break;
+    case LiftedAtom::eq_var: {
+      Int::IntView v = x[rank(atom.cell)];
+      if (atom.sign)
+        GECODE_ME_CHECK(v.eq(home, values[atom.var]));
+      else
+        GECODE_ME_CHECK(v.nq(home, values[atom.var]));
+      break;
+    }
+    default: {
+      // Nothing is done until one of the cells is assigned.
+      Int::IntView v = x[rank(atom.cell)];
+      Int::IntView w = x[rank(atom.cell2)];
+      if (!v.assigned())
+        std::swap(v, w);
+      if (!v.assigned())
+        break;
+      if (atom.sign)
+        GECODE_ME_CHECK(w.eq(home, v.val()));
+      else
+        GECODE_ME_CHECK(w.nq(home, v.val()));
+      break;
+    }
+    }
+    return ES_OK;
+  }
+
+  // Checks the instance for the values of clause variables.
+  ExecStatus instance(Space & home) {
+    const std::vector<std::pair<int, int> > & eqs = spec->varEqs;
+    for (unsigned int i = 0; i < eqs.size(); i++)
+      if (values[eqs[i].first] == values[eqs[i].second])
+        return ES_OK;
+    const std::vector<std::pair<int, int> > & ineqs = spec->varIneqs;
+    for (unsigned int i = 0; i < ineqs.size(); i++)
+      if (values[ineqs[i].first] != values[ineqs[i].second])
+        return ES_OK;
+
+    const std::vector<LiftedAtom> & atoms = spec->atoms;
+    int unknown = -1;
+    for (unsigned int i = 0; i < atoms.size(); i++) {
+      int st = status(atoms[i]);
+      if (st >= 0 && !atoms[i].sign)
+        st = 1 - st;
+      if (st == 1)
+        return ES_OK;
+      if (st == -1) {
+        if (unknown >= 0)
+          return ES_OK;
+        unknown = i;
+      }
+    }
+    if (unknown < 0)
+      return ES_FAILED;
+    return satisfy(home, atoms[unknown]);
+  }
+
+  // Checks all instances where the clause variables
+  // without a value take all values.
+  ExecStatus instances(Space & home) {
+    const int nvars = spec->varSizes.size();
+    Region r(home);
+    int * freeVars = r.alloc<int>(nvars);
+    int nfree = 0;
+    for (int i = 0; i < nvars; i++) {
+      if (!fixed[i]) {
+        freeVars[nfree++] = i;
+        values[i] = 0;
+      }
+    }
+    while (true) {
+      GECODE_ES_CHECK(instance(home));
+      // Next assignment of free variables.
+      int j = nfree - 1;
+      for (; j >= 0; j--) {
+        const int var = freeVars[j];
+        if (values[var] + 1 < spec->varSizes[var]) {
+          values[var]++;
+          break;
+        }
+        values[var] = 0;
+      }
+      if (j < 0)
+        return ES_OK;
+    }
+  }
+
+  // Checks the instances which contain the cell.
+  ExecStatus changed(Space & home, int cell) {
+    const bool isBool = cell < b.size();
+    const int pos = isBool ? cell : cell - b.size();
+    const int nvars = spec->varSizes.size();
+    for (unsigned int t = 0; t < spec->tables.size(); t++) {
+      const LiftedTable & table = spec->tables[t];
+      if (table.isBool != isBool || pos < table.offset)
+        continue;
+      for (unsigned int u = 0; u < table.uses.size(); u++) {
+        const LiftedAtom & atom = spec->atoms[table.uses[u].first];
+        const LiftedCell & c =
+          table.uses[u].second ? atom.cell2 : atom.cell;
+        int size = 1;
+        for (unsigned int i = 0; i < c.args.size(); i++)
+          size *= table.argSizes[i];
+        if (pos >= table.offset + size)
+          continue;
+        for (int i = 0; i < nvars; i++)
+          fixed[i] = 0;
+        if (unrank(c, pos - table.offset))
+          GECODE_ES_CHECK(instances(home));
+      }
+    }
+    return ES_OK;
+  }
+
+public:
+  static ExecStatus post(Home home, ViewArray<Int::BoolView> & b,
+                         ViewArray<Int::IntView> & x,
+                         const LiftedClauseSpec & spec) {
+    (void) new (home) LiftedClause(home, b, x, spec);
+    return ES_OK;
+  }
+
+  // Posts the clause over the cells in the arrays.
+  // Offsets of the tables are set by this function.
+  static void post(Home home, const std::vector<BoolVarArgs> & boolArrays,
+                   const std::vector<IntVarArgs> & intArrays,
+                   LiftedClauseSpec & spec) {
+    if (home.failed())
+      return;
+    BoolVarArgs bs;
+    IntVarArgs xs;
+    for (unsigned int i = 0; i < spec->tables.size(); i++) {
+      LiftedTable & t = spec->tables[i];
+      if (t.isBool) {
+        t.offset = bs.size();
+        bs << boolArrays[t.array];
+      } else {
+        t.offset = xs.size();
+        xs << intArrays[t.array];
+      }
+    }
+    ViewArray<Int::BoolView> b(home, bs);
+    ViewArray<Int::IntView> x(home, xs);
+    GECODE_ES_FAIL(post(home, b, x, spec));
+  }
+
+  virtual Propagator * copy(Space & home, bool share) {
+    return new (home) LiftedClause(home, share, *this);
+  }
+
+  virtual PropCost cost(const Space &, const ModEventDelta &) const {
+    return PropCost::linear(PropCost::HI, queueSize + 1);
+  }
+
+  virtual ExecStatus advise(Space & home, Advisor & a0, const Delta &) {
+    Index & a = static_cast<Index &>(a0);
+    const int i = a.i;
+    if (!queued[i]) {
+      queued[i] = 1;
+      queue[queueSize++] = i;
+    }
+    const bool assigned =
+      i < b.size() ? b[i].assigned() : x[i - b.size()].assigned();
+    if (assigned)
+      a.dispose(home, c);
+    return ES_NOFIX;
+  }
+
+  virtual ExecStatus propagate(Space & home, const ModEventDelta &) {
+    if (checkAll) {
+      checkAll = false;
+      for (int i = 0; i < queueSize; i++)
+        queued[queue[i]] = 0;
+      queueSize = 0;
+      const int nvars = spec->varSizes.size();
+      for (int i = 0; i < nvars; i++)
+        fixed[i] = 0;
+      GECODE_ES_CHECK(instances(home));
+    }
+    // Satisfying literals queues more cells.
+    while (queueSize > 0) {
+      const int cell = queue[--queueSize];
+      queued[cell] = 0;
+      GECODE_ES_CHECK(changed(home, cell));
+    }
+    // All cells are assigned and all instances were checked.
+    if (c.empty())
+      return home.ES_SUBSUMED(*this);
+    return ES_FIX;
+  }
+
+  virtual size_t dispose(Space & home) {
+    home.ignore(*this, AP_DISPOSE);
+    for (Advisors<Index> as(c); as(); ++as) {
+      const int i = as.advisor().i;
+      if (i < b.size())
+        b[i].cancel(home, as.advisor());
+      else
+        x[i - b.size()].cancel(home, as.advisor());
+    }
+    c.dispose(home);
+    const int nvars = spec->varSizes.size();
+    home.free<int>(queue, cells());
+    home.free<char>(queued, cells());
+    home.free<int>(values, nvars);
+    home.free<char>(fixed, nvars);
+    spec.~LiftedClauseSpec();
+    (void) Propagator::dispose(home);
+    return sizeof(*this);
+  }
+};
+
+}
+
+#endif // __LIFTEDCLAUSE_HH__
@@ -0,0 +1,225 @@
+/* Copyright (c) 2015 Radek Micek */
+
+#ifndef __MATRIXELEMENT_HH__
+#define __MATRIXELEMENT_HH__
+
+#include <algorithm>
+
+#include <gecode/int.hh>
+#include <gecode/int/rel.hh>
+#include <gecode/int/bool.hh>
+
+namespace Crossbow {
+
+using namespace Gecode;
+
+// Equality of a cell and the result after all indices are assigned.
+inline ExecStatus matrix_element_eq(Home home, Int::IntView x,
+                                    Int::IntView y) {
+  return Int::Rel::EqDom<Int::IntView, Int::IntView>::post(home, x, y);
+}
+
+inline ExecStatus matrix_element_eq(Home home, Int::BoolView x,
+                                    Int::BoolView y) {
+  return Int::Bool::Eq<Int::BoolView, Int::BoolView>::post(home, x, y);
+}
+
+// Domain consistent propagator for
+// table[coefs[0] * x[0] + ... + coefs[n-1] * x[n-1] + c] = y.
+//
+// Cells reachable from the domains of x at the time of posting
+// are stored in the array cells which is indexed by the values of x
+// in mixed radix (the last index is least significant).
+// The cells are not pruned until all indices are assigned.
+// Then the propagator is replaced by equality of the cell and y.
+template<class View, PropCond pc>
+class MatrixElement : public Propagator {
+protected:
+  ViewArray<Int::IntView> x;
+  ViewArray<View> cells;
+  View y;
+  // Number of values of x[i] is radix[i].
+  int * radix;
+  // Nonzero for the positions in cells which are inside the table.
+  char * valid;
+
+  MatrixElement(Home home, ViewArray<Int::IntView> & x0,
+                ViewArray<View> & cells0, View y0,
+                int * radix0, char * valid0)
+    : Propagator(home), x(x0), cells(cells0), y(y0),
+      radix(radix0), valid(valid0) {
+    x.subscribe(home, *this, Int::PC_INT_DOM);
+    for (int i = 0; i < cells.size(); i++)
+      if (valid[i])
+        cells[i].subscribe(home, *this, pc);
+    y.subscribe(home, *this, pc);
+  }
+
+  MatrixElement(Space & home, bool share, MatrixElement & p)
+    : Propagator(home, share, p) {
+    x.update(home, share, p.x);
+    cells.update(home, share, p.cells);
+    y.update(home, share, p.y);
+    radix = home.alloc<int>(x.size());
+    for (int i = 0; i < x.size(); i++)
+      radix[i] = p.radix[i];
+    valid = home.alloc<char>(cells.size());
+    for (int i = 0; i < cells.size(); i++)
+      valid[i] = p.valid[i];
+  }
+
+  int rank(const int * values) const {
+    int r = 0;
+    for (int i = 0; i < x.size(); i++)
+      r = r * radix[i] + values[i];
+    return r;
+  }
+
+  // Sets values to the next combination of the values of x.
+  // Returns false after the last combination.
+  bool next(int * values) const {
+    for (int i = x.size() - 1; i >= 0; i--) {
+      do {
+        values[i]++;
+      } while (values[i] <= x[i].max() && !x[i].in(values[i]));
+      if (values[i] <= x[i].max())
+        return true;
+      values[i] = x[i].min();
+    }
+    return false;
+  }
+
+public:
+  static ExecStatus post(Home home, ViewArray<Int::IntView> & x,
+                         ViewArray<View> & table, const IntArgs & coefs,
+                         int c, View y) {
+    int size = 1;
+    for (int i = 0; i < x.size(); i++) {
+      GECODE_ME_CHECK(x[i].gq(home, 0));
+      size *= x[i].max() + 1;
+    }
+
+    Space & space = home;
+    Region region(space);
+    int * radix = space.alloc<int>(x.size());
+    int * values = region.alloc<int>(x.size());
+    for (int i = 0; i < x.size(); i++) {
+      radix[i] = x[i].max() + 1;
+      values[i] = 0;
+    }
+
+    ViewArray<View> cells(home, size);
+    char * valid = space.alloc<char>(size);
+    for (int r = 0; r < size; r++) {
+      int idx = c;
+      for (int i = 0; i < x.size(); i++)
+        idx += coefs[i] * values[i];
+      valid[r] = idx >= 0 && idx < table.size();
+      // Invalid positions refer to an arbitrary cell
+      // which the propagator doesn't subscribe to.
+      cells[r] = table[valid[r] ? idx : 0];
+      for (int i = x.size() - 1; i >= 0 && ++values[i] == radix[i]; i--)
+        values[i] = 0;
+    }
+
+    (void) new (home) MatrixElement(home, x, cells, y, radix, valid);
+    return ES_OK;
+  }
+
+  virtual Propagator * copy(Space & home, bool share) {
+    return new (home) MatrixElement(home, share, *this);
+  }
+
+  virtual PropCost cost(const Space &, const ModEventDelta &) const {
+    return PropCost::linear(PropCost::HI, cells.size());
+  }
+
+  virtual ExecStatus propagate(Space & home, const ModEventDelta &) {
+    Region region(home);
+    int * values = region.alloc<int>(x.size());
+    // Supported values of x[i] start at offsets[i].
+    int * offsets = region.alloc<int>(x.size());
+    int nsupported = 0;
+    for (int i = 0; i < x.size(); i++) {
+      values[i] = x[i].min();
+      offsets[i] = nsupported;
+      nsupported += radix[i];
+    }
+    char * supported = region.alloc<char>(nsupported);
+    for (int i = 0; i < nsupported; i++)
+      supported[i] = 0;
+    const int ymin = y.min();
+    const int ymax = y.max();
+    char * ysupported = region.alloc<char>(ymax - ymin + 1);
+    for (int k = ymin; k <= ymax; k++)
+      ysupported[k - ymin] = 0;
+
+    // A combination of indices is supported when its cell
+    // has a common value with y.
+    do {
+      const int r = rank(values);
+      if (!valid[r])
+        continue;
+      const View cell = cells[r];
+      bool sup = false;
+      const int hi = std::min(cell.max(), ymax);
+      for (int k = std::max(cell.min(), ymin); k <= hi; k++) {
+        if (cell.in(k) && y.in(k)) {
+          ysupported[k - ymin] = 1;
+          sup = true;
+        }
+      }
+      if (sup) {
+        for (int i = 0; i < x.size(); i++)
+          supported[offsets[i] + values[i]] = 1;
+      }
+    } while (next(values));
+
+    // Indices may be cells of the table so pruning them
+    // can remove support of other combinations.
+    bool modified = false;
+    bool assigned = true;
+    for (int i = 0; i < x.size(); i++) {
+      const int lo = x[i].min();
+      const int hi = x[i].max();
+      for (int v = lo; v <= hi; v++) {
+        if (!supported[offsets[i] + v] && x[i].in(v)) {
+          GECODE_ME_CHECK(x[i].nq(home, v));
+          modified = true;
+        }
+      }
+      assigned = assigned && x[i].assigned();
+    }
+    for (int k = ymin; k <= ymax; k++) {
+      if (!ysupported[k - ymin] && y.in(k)) {
+        GECODE_ME_CHECK(y.nq(home, k));
+        modified = true;
+      }
+    }
+
+    if (assigned) {
+      for (int i = 0; i < x.size(); i++)
+        values[i] = x[i].val();
+      const View cell = cells[rank(values)];
+      GECODE_REWRITE(*this, matrix_element_eq(home(*this), cell, y));
+    }
+    return modified ? ES_NOFIX : ES_FIX;
+  }
+
+  virtual size_t dispose(Space & home) {
+    x.cancel(home, *this, Int::PC_INT_DOM);
+    for (int i = 0; i < cells.size(); i++)
+      if (valid[i])
+        cells[i].cancel(home, *this, pc);
+    y.cancel(home, *this, pc);
+    (void) Propagator::dispose(home);
+    return sizeof(*this);
+  }
+};
+
+typedef MatrixElement<Int::IntView, Int::PC_INT_DOM> IntMatrixElement;
+typedef MatrixElement<Int::BoolView, Int::PC_BOOL_VAL> BoolMatrixElement;
+
+}
+
+#endif
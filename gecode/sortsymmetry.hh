@@ -0,0 +1,211 @@
+/* Copyright (c) 2015 Radek Micek */
+
+#ifndef __SORTSYMMETRY_HH__
+#define __SORTSYMMETRY_HH__
+
+#include <vector>
+#include <utility>
+
+#include <gecode/int.hh>
+#include <gecode/int/ldsb.hh>
+#include <gecode/int/branch.hh>
+
+namespace Crossbow {
+
+using namespace Gecode;
+
+// Table of a function symbol.
+struct SymmetricTable {
+  // Sorts of the arguments and of the result.
+  std::vector<int> sorts;
+  // Domain sizes of the arguments and of the result.
+  std::vector<int> sizes;
+  // Ids of integral CSP variables for the cells (the last argument
+  // is least significant). Temporary variables have negative ids.
+  std::vector<int> cells;
+};
+
+// Permuting the domain elements of a sort maps a model to a model
+// when the cells are permuted together with the values. So the values
+// of a sort are not interchangeable on their own - the cells with these
+// values as arguments must move too.
+class SortSymmetrySpec {
+public:
+  std::vector<SymmetricTable> tables;
+  // Domain size of each sort.
+  std::vector<int> sortSizes;
+  // For each non-temporary integral CSP variable the table and the rank
+  // of one of its cells. The table is -1 for variables which aren't cells.
+  std::vector<std::pair<int, int> > cellOf;
+
+  void addTable(const SymmetricTable & t) {
+    const int table = tables.size();
+    tables.push_back(t);
+    for (unsigned int i = 0; i < t.sorts.size(); i++) {
+      if (t.sorts[i] >= (int) sortSizes.size())
+        sortSizes.resize(t.sorts[i] + 1, 0);
+      sortSizes[t.sorts[i]] = std::max(sortSizes[t.sorts[i]], t.sizes[i]);
+    }
+    for (unsigned int r = 0; r < t.cells.size(); r++) {
+      const int var = t.cells[r];
+      if (var < 0)
+        continue;
+      if (var >= (int) cellOf.size())
+        cellOf.resize(var + 1, std::make_pair(-1, 0));
+      if (cellOf[var].first < 0)
+        cellOf[var] = std::make_pair(table, (int) r);
+    }
+  }
+
+  bool isCell(int var) const {
+    return var < (int) cellOf.size() && cellOf[var].first >= 0;
+  }
+
+  // Computes the arguments of the cell represented by var.
+  const SymmetricTable & args(int var, std::vector<int> & a) const {
+    const SymmetricTable & t = tables[cellOf[var].first];
+    int rank = cellOf[var].second;
+    a.resize(t.sorts.size() - 1);
+    for (int i = a.size() - 1; i >= 0; i--) {
+      a[i] = rank % t.sizes[i];
+      rank /= t.sizes[i];
+    }
+    return t;
+  }
+};
+
+// Symmetric group of the domain elements of one sort for LDSB.
+// An element stops being interchangeable when a decision
+// of the left branch contains it as an argument or as the value.
+class SortSymmetryImp : public Int::LDSB::SymmetryImp<Int::IntView> {
+protected:
+  typedef Int::LDSB::Literal Literal;
+
+  // Owned by the solver which outlives all spaces.
+  const SortSymmetrySpec * spec;
+  int sort;
+  int size;
+  // Nonzero for the interchangeable elements.
+  char * unused;
+
+  static int swap(int x, int e, int f) {
+    return x == e ? f : x == f ? e : x;
+  }
+
+public:
+  SortSymmetryImp(Space & home, const SortSymmetrySpec * spec, int sort)
+    : spec(spec), sort(sort), size(spec->sortSizes[sort]) {
+    unused = home.alloc<char>(size);
+    for (int e = 0; e < size; e++)
+      unused[e] = 1;
+  }
+
+  SortSymmetryImp(Space & home, const SortSymmetryImp & s)
+    : spec(s.spec), sort(s.sort), size(s.size) {
+    unused = home.alloc<char>(size);
+    for (int e = 0; e < size; e++)
+      unused[e] = s.unused[e];
+  }
+
+  // Images of the literal under the transpositions of an element
+  // of the literal with another interchangeable element.
+  virtual ArgArray<Literal> symmetric(Literal l,
+                                      const ViewArray<Int::IntView> &) const {
+    std::vector<Literal> lits;
+    if (spec->isCell(l._variable)) {
+      std::vector<int> a;
+      const SymmetricTable & t = spec->args(l._variable, a);
+      const int arity = a.size();
+      // Elements of the literal: the arguments followed by the value.
+      a.push_back(l._value);
+      for (int i = 0; i <= arity; i++) {
+        const int e = a[i];
+        if (t.sorts[i] != sort || e >= size || !unused[e])
+          continue;
+        bool seen = false;
+        for (int j = 0; j < i; j++)
+          seen = seen || (t.sorts[j] == sort && a[j] == e);
+        if (seen)
+          continue;
+        for (int f = 0; f < size; f++) {
+          if (f == e || !unused[f])
+            continue;
+          int rank = 0;
+          for (int j = 0; j < arity; j++) {
+            const int x = t.sorts[j] == sort ? swap(a[j], e, f) : a[j];
+            rank = rank * t.sizes[j] + x;
+          }
+          const int var = t.cells[rank];
+          if (var >= 0) {
+            const int v = t.sorts[arity] == sort
+              ? swap(l._value, e, f) : l._value;
+            lits.push_back(Literal(var, v));
+          }
+        }
+      }
+    }
+    ArgArray<Literal> result(lits.size());
+    for (unsigned int i = 0; i < lits.size(); i++)
+      result[i] = lits[i];
+    return result;
+  }
+
+  virtual void update(Literal l) {
+    // A decision outside of the tables may be asymmetric.
+    if (!spec->isCell(l._variable)) {
+      for (int e = 0; e < size; e++)
+        unused[e] = 0;
+      return;
+    }
+    std::vector<int> a;
+    const SymmetricTable & t = spec->args(l._variable, a);
+    a.push_back(l._value);
+    for (unsigned int i = 0; i < a.size(); i++)
+      if (t.sorts[i] == sort && a[i] < size)
+        unused[a[i]] = 0;
+  }
+
+  virtual Int::LDSB::SymmetryImp<Int::IntView> * copy(Space & home,
+                                                      bool) const {
+    return new (home) SortSymmetryImp(home, *this);
+  }
+
+  virtual size_t dispose(Space & home) {
+    home.free<char>(unused, size);
+    return sizeof(*this);
+  }
+};
+
+// Branches on x (the non-temporary integral CSP variables in the order
+// of their ids) with the smallest value first and LDSB for every sort
+// with at least two elements.
+inline void branchWithSortSymmetries(Home home, const IntVarArgs & x,
+                                     IntVarBranch vars,
+                                     const SortSymmetrySpec & spec) {
+  if (home.failed())
+    return;
+  Space & space = home;
+  vars.expand(home, x);
+  ViewArray<Int::IntView> xv(home, x);
+  ViewSel<Int::IntView> * vs[1] = { Int::Branch::viewselint(space, vars) };
+
+  int nsyms = 0;
+  for (unsigned int s = 0; s < spec.sortSizes.size(); s++)
+    if (spec.sortSizes[s] >= 2)
+      nsyms++;
+  Int::LDSB::SymmetryImp<Int::IntView> ** syms =
+    space.alloc<Int::LDSB::SymmetryImp<Int::IntView> *>(nsyms);
+  int i = 0;
+  for (unsigned int s = 0; s < spec.sortSizes.size(); s++)
+    if (spec.sortSizes[s] >= 2)
+      syms[i++] = new (space) SortSymmetryImp(space, &spec, s);
+
+  Int::LDSB::LDSBBrancher<Int::IntView, 1, int, 2>::post(
+    home, xv, vs,
+    Int::Branch::valselcommitint(space, x.size(), INT_VAL_MIN()),
+    syms, nsyms, NULL, NULL);
+}
+
+}
+
+#endif
@@ -7,6 +7,8 @@
 #include <caml/signals.h>
 #include <caml/threads.h>
 
+#include <sys/time.h>
+
 #ifdef JOSAT_STUBS_LOG
 #include <stdio.h>
 #endif
@@ -40,7 +42,35 @@ using namespace Josat;
 #define log_lits(v)
 #endif
 
-#define Solver_val(v) (*((Solver **) Data_custom_val(v)))
+// Statistics of the last call to solve.
+struct SolveStats {
+  uint64_t conflicts;
+  uint64_t decisions;
+  uint64_t propagations;
+  uint64_t learntLits;
+  uint64_t restarts;
+  double wallTime;
+};
+
+// Contents of the custom block.
+struct StubSolver {
+  Solver * solver;
+  // Budgets for each call to solve. Negative value means no budget.
+  int64_t confBudget;
+  int64_t propBudget;
+  SolveStats stats;
+  // Snapshots published by the search, read by josat_poll_progress.
+  ProgressRing * progress;
+};
+
+#define Stub_val(v) ((StubSolver *) Data_custom_val(v))
+#define Solver_val(v) (Stub_val(v)->solver)
+
+static double wall_time() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (double)tv.tv_sec + (double)tv.tv_usec / 1000000;
+}
 
 static void josat_finalize(value sv) {
   Solver * s = Solver_val(sv);
@@ -48,6 +78,7 @@ static void josat_finalize(value sv) {
   log("josat_finalize(%p)\n", s);
 
   delete s;
+  delete Stub_val(sv)->progress;
 }
 
 static struct custom_operations josat_ops = {
@@ -67,8 +98,14 @@ CAMLprim value josat_create(value unit) {
 
   Solver * s = new Solver();
 
-  sv = caml_alloc_custom(&josat_ops, sizeof(Solver *), 0, 1);
-  Solver_val(sv) = s;
+  sv = caml_alloc_custom(&josat_ops, sizeof(StubSolver), 0, 1);
+  StubSolver * stub = Stub_val(sv);
+  stub->solver = s;
+  stub->confBudget = -1;
+  stub->propBudget = -1;
+  stub->stats = SolveStats();
+  stub->progress = new ProgressRing();
+  s->progress = stub->progress;
 
   log("josat_create() = %p\n", s);
 
@@ -158,10 +195,33 @@ CAMLprim value josat_solve(value sv, value assumptsv) {
     assumpts.push(toLit(Int_val(Field(assumptsv, i))));
   }
 
+  StubSolver * stub = Stub_val(sv);
+  s->budgetOff();
+  if (stub->confBudget >= 0)
+    s->setConfBudget(stub->confBudget);
+  if (stub->propBudget >= 0)
+    s->setPropBudget(stub->propBudget);
+
+  const uint64_t conflicts = s->conflicts;
+  const uint64_t decisions = s->decisions;
+  const uint64_t propagations = s->propagations;
+  const uint64_t learntLits = s->tot_literals;
+  const uint64_t starts = s->starts;
+  const double start = wall_time();
+
   caml_release_runtime_system();
   int res = toInt(s->solveLimited(assumpts));
   caml_acquire_runtime_system();
 
+  SolveStats & stats = stub->stats;
+  stats.conflicts = s->conflicts - conflicts;
+  stats.decisions = s->decisions - decisions;
+  stats.propagations = s->propagations - propagations;
+  stats.learntLits = s->tot_literals - learntLits;
+  // The first start isn't a restart.
+  stats.restarts = s->starts > starts ? s->starts - starts - 1 : 0;
+  stats.wallTime = wall_time() - start;
+
   // Normalize lbool.
   if (res != 0 && res != 1)
     res = 2;
@@ -173,6 +233,154 @@ CAMLprim value josat_solve(value sv, value assumptsv) {
   CAMLreturn (Val_int(res));
 }
 
+CAMLprim value josat_set_conf_budget(value sv, value budgetv) {
+  CAMLparam2 (sv, budgetv);
+
+  Stub_val(sv)->confBudget = Long_val(budgetv);
+
+  log("josat_set_conf_budget(%p, %ld)\n", Solver_val(sv), Long_val(budgetv));
+
+  CAMLreturn (Val_unit);
+}
+
+CAMLprim value josat_set_prop_budget(value sv, value budgetv) {
+  CAMLparam2 (sv, budgetv);
+
+  Stub_val(sv)->propBudget = Long_val(budgetv);
+
+  log("josat_set_prop_budget(%p, %ld)\n", Solver_val(sv), Long_val(budgetv));
+
+  CAMLreturn (Val_unit);
+}
+
+CAMLprim value josat_last_stats(value sv) {
+  CAMLparam1 (sv);
+  CAMLlocal1 (statsv);
+
+  const SolveStats & stats = Stub_val(sv)->stats;
+
+  // Record Sat_solver.stats.
+  statsv = caml_alloc_tuple(6);
+  Store_field(statsv, 0, Val_long(stats.conflicts));
+  Store_field(statsv, 1, Val_long(stats.decisions));
+  Store_field(statsv, 2, Val_long(stats.propagations));
+  Store_field(statsv, 3, Val_long(stats.learntLits));
+  Store_field(statsv, 4, Val_long(stats.restarts));
+  Store_field(statsv, 5, caml_copy_double(stats.wallTime));
+
+  CAMLreturn (statsv);
+}
+
+CAMLprim value josat_set_phase(value sv, value varv, value phasev) {
+  CAMLparam3 (sv, varv, phasev);
+
+  Solver * s = Solver_val(sv);
+  s->setPhase(Int_val(varv), Bool_val(phasev));
+
+  CAMLreturn (Val_unit);
+}
+
+CAMLprim value josat_get_phase(value sv, value varv) {
+  CAMLparam2 (sv, varv);
+
+  Solver * s = Solver_val(sv);
+
+  CAMLreturn (Val_bool(s->phase(Int_val(varv))));
+}
+
+CAMLprim value josat_set_activity(value sv, value varv, value activityv) {
+  CAMLparam3 (sv, varv, activityv);
+
+  Solver * s = Solver_val(sv);
+  s->setActivity(Int_val(varv), Double_val(activityv));
+
+  CAMLreturn (Val_unit);
+}
+
+CAMLprim value josat_get_activity(value sv, value varv) {
+  CAMLparam2 (sv, varv);
+
+  Solver * s = Solver_val(sv);
+
+  CAMLreturn (caml_copy_double(s->varActivity(Int_val(varv))));
+}
+
+CAMLprim value josat_add_learnt(value sv, value litsv, value lenv) {
+  CAMLparam3 (sv, litsv, lenv);
+
+  Solver * s = Solver_val(sv);
+  int len = Int_val(lenv);
+
+  // Literals.
+  vec<Lit> lits;
+  lits.capacity(len);
+  for (int i = 0; i < len; i++) {
+    lits.push(toLit(Int_val(Field(litsv, i))));
+  }
+
+  log("josat_add_learnt(%p, ", s);
+  log_lits(lits);
+  log(", %d) = ", len);
+
+  bool res = s->addLearnt(lits);
+
+  log("%d\n", (int)res);
+
+  CAMLreturn (Val_bool(res));
+}
+
+static value cons_lits(value tailv, const Lit * lits, int len) {
+  CAMLparam1 (tailv);
+  CAMLlocal2 (litsv, consv);
+
+  litsv = caml_alloc(len, 0);
+  for (int i = 0; i < len; i++)
+    Store_field(litsv, i, Val_int(toInt(lits[i])));
+  consv = caml_alloc(2, 0);
+  Store_field(consv, 0, litsv);
+  Store_field(consv, 1, tailv);
+
+  CAMLreturn (consv);
+}
+
+// The solver doesn't compute glue of the learnt clauses
+// so the length of the clause is used instead.
+CAMLprim value josat_export_learnts(value sv, value maxlenv, value maxgluev) {
+  CAMLparam3 (sv, maxlenv, maxgluev);
+  CAMLlocal1 (resv);
+
+  Solver * s = Solver_val(sv);
+  int maxLen = Int_val(maxlenv);
+  if (Int_val(maxgluev) < maxLen)
+    maxLen = Int_val(maxgluev);
+
+  resv = Val_emptylist;
+
+  // Learnt units.
+  for (Var v = 0; v < s->nVars(); v++) {
+    if (s->value(v) != l_Undef) {
+      Lit lit = mkLit(v, s->value(v) == l_False);
+      resv = cons_lits(resv, &lit, 1);
+    }
+  }
+
+  vec<Lit> lits;
+  for (int i = 0; i < s->nLearnts(); i++) {
+    const Clause & c = s->learnt(i);
+    if (c.size() <= maxLen) {
+      lits.clear();
+      for (int j = 0; j < c.size(); j++)
+        lits.push(c[j]);
+      resv = cons_lits(resv, &lits[0], lits.size());
+    }
+  }
+
+  log("josat_export_learnts(%p, %d, %d)\n",
+      s, Int_val(maxlenv), Int_val(maxgluev));
+
+  CAMLreturn (resv);
+}
+
 CAMLprim value josat_model_value(value sv, value varv) {
   CAMLparam2 (sv, varv);
 
@@ -224,4 +432,30 @@ CAMLprim value josat_clear_interrupt(value sv) {
   CAMLreturn (Val_unit);
 }
 
+// Can be called by another thread while the solver is searching.
+CAMLprim value josat_poll_progress(value sv) {
+  CAMLparam1 (sv);
+  CAMLlocal3 (resv, snapv, consv);
+
+  ProgressSnapshot snaps[ProgressRing::capacity];
+  int n = Stub_val(sv)->progress->poll(snaps);
+
+  // List of Sh.progress records, the oldest snapshot first.
+  resv = Val_emptylist;
+  for (int i = n - 1; i >= 0; i--) {
+    snapv = caml_alloc_tuple(3);
+    Store_field(snapv, 0, Val_long(snaps[i].conflicts));
+    Store_field(snapv, 1, Val_long(snaps[i].decisions));
+    Store_field(snapv, 2, Val_long(snaps[i].depth));
+    consv = caml_alloc(2, 0);
+    Store_field(consv, 0, snapv);
+    Store_field(consv, 1, resv);
+    resv = consv;
+  }
+
+  log("josat_poll_progress(%p) = %d\n", Solver_val(sv), n);
+
+  CAMLreturn (resv);
+}
+
 } // extern "C" {
@@ -66,6 +66,7 @@ Solver::Solver() :
   , rnd_init_act     (opt_rnd_init_act)
   , garbage_frac     (opt_garbage_frac)
   , min_learnts_lim  (opt_min_learnts_lim)
+  , progress         (NULL)
   , restart_first    (opt_restart_first)
   , restart_inc      (opt_restart_inc)
 
@@ -84,6 +85,7 @@ Solver::Solver() :
   , dec_vars(0), num_clauses(0), num_learnts(0), clauses_literals(0), learnts_literals(0), max_literals(0), tot_literals(0)
 
   , watches            (WatcherDeleted(ca))
+  , watches_bin        (WatcherDeleted(ca))
   , order_heap         (VarOrderLt(activity))
   , ok                 (true)
   , cla_inc            (1)
@@ -125,6 +127,8 @@ Var Solver::newVar(lbool upol, bool dvar, bool valueVar)
 
     watches  .init(mkLit(v, false));
     watches  .init(mkLit(v, true ));
+    watches_bin.init(mkLit(v, false));
+    watches_bin.init(mkLit(v, true ));
     assigns  .insert(v, l_Undef);
     vardata  .insert(v, mkVarData(CRef_Undef, 0));
     activity .insert(v, rnd_init_act ? drand(random_seed) * 0.00001 : 0);
@@ -239,7 +243,7 @@ void Solver::detachSingleValueConstraint(CRef cr, bool strict) {
         svc_watches[var(c[i])] = CRef_Undef;
 }
 
-bool Solver::addClause_(vec<Lit>& ps)
+bool Solver::addClause_(vec<Lit>& ps, bool learnt)
 {
     assert(decisionLevel() == 0);
     if (!ok) return false;
@@ -260,8 +264,12 @@ bool Solver::addClause_(vec<Lit>& ps)
         uncheckedEnqueue(ps[0]);
         return ok = (propagate() == CRef_Undef);
     }else{
-        CRef cr = ca.alloc(ps, false);
-        clauses.push(cr);
+        CRef cr = ca.alloc(ps, learnt);
+        if (learnt){
+            learnts.push(cr);
+            claBumpActivity(ca[cr]);
+        }else
+            clauses.push(cr);
         attachClause(cr);
     }
 
@@ -288,8 +296,13 @@ void Solver::attachClause(CRef cr){
         (c.single_value_constraint() &&
             value(c[1]) == l_True &&
             !value_var[var(c[1])]));
-    watches[~c[0]].push(Watcher(cr, c[1]));
-    watches[~c[1]].push(Watcher(cr, c[0]));
+    if (binWatched(c)) {
+        watches_bin[~c[0]].push(Watcher(cr, c[1]));
+        watches_bin[~c[1]].push(Watcher(cr, c[0]));
+    } else {
+        watches[~c[0]].push(Watcher(cr, c[1]));
+        watches[~c[1]].push(Watcher(cr, c[0]));
+    }
     if (c.learnt()) num_learnts++, learnts_literals += c.size();
     else            num_clauses++, clauses_literals += c.size();
 }
@@ -299,13 +312,15 @@ void Solver::detachClause(CRef cr, bool strict){
     const Clause& c = ca[cr];
     assert(c.size() > 1);
     
+    OccLists<Lit, vec<Watcher>, WatcherDeleted, MkIndexLit>& ws = binWatched(c) ? watches_bin : watches;
+
     // Strict or lazy detaching:
     if (strict){
-        remove(watches[~c[0]], Watcher(cr, c[1]));
-        remove(watches[~c[1]], Watcher(cr, c[0]));
+        remove(ws[~c[0]], Watcher(cr, c[1]));
+        remove(ws[~c[1]], Watcher(cr, c[0]));
     }else{
-        watches.smudge(~c[0]);
-        watches.smudge(~c[1]);
+        ws.smudge(~c[0]);
+        ws.smudge(~c[1]);
     }
 
     if (c.learnt()) num_learnts--, learnts_literals -= c.size();
@@ -318,10 +333,10 @@ void Solver::removeClause(CRef cr) {
 
     // Locked clause may be removed only when removing clauses satisfied
     // on decision level 0.
-    assert(!locked(c) || level(var(c[0])) == 0);
+    assert(!locked(c) || level(var(impliedLit(c))) == 0);
 
     // Don't leave pointers to free'd memory!
-    if (locked(c)) vardata[var(c[0])].reason = CRef_Undef;
+    if (locked(c)) vardata[var(impliedLit(c))].reason = CRef_Undef;
 
     if (c.single_value_constraint()) {
 
@@ -689,6 +704,21 @@ CRef Solver::propagate()
             }
         }
 
+        // Binary clauses - the other literal is in the watcher,
+        // there is no need to inspect the clause.
+        vec<Watcher>&  wbin = watches_bin.lookup(p);
+        for (int k = 0; k < wbin.size(); k++) {
+            Lit imp = wbin[k].blocker;
+            if (value(imp) == l_False) {
+                confl = wbin[k].cref;
+                // Empty propagation queue.
+                qhead = trail.size();
+                goto AfterPropagation;
+            }
+            else if (value(imp) == l_Undef)
+                uncheckedEnqueue(imp, wbin[k].cref);
+        }
+
         vec<Watcher>&  ws  = watches.lookup(p);
         Watcher        *i, *j, *end;
 
@@ -815,11 +845,24 @@ void Solver::removeSatisfied(vec<CRef>& cs)
         else{
             // Trim clause:
             assert(value(c[0]) == l_Undef && value(c[1]) == l_Undef);
+
+            // Clause which becomes binary must be moved to binary watches.
+            int nfalse = 0;
+            for (int k = 2; k < c.size(); k++)
+                if (value(c[k]) == l_False)
+                    nfalse++;
+            const bool becomesBinary = nfalse > 0 && c.size() - nfalse == 2;
+            if (becomesBinary)
+                detachClause(cs[i], true);
+
             for (int k = 2; k < c.size(); k++)
                 if (value(c[k]) == l_False){
                     c[k--] = c[c.size()-1];
                     c.pop();
                 }
+
+            if (becomesBinary)
+                attachClause(cs[i]);
             cs[j++] = cs[i];
         }
     }
@@ -934,6 +977,8 @@ lbool Solver::search(int nof_conflicts)
         if (confl != CRef_Undef){
             // CONFLICT
             conflicts++; conflictC++;
+            if (progress && conflicts % ProgressRing::interval == 0)
+                progress->publish(conflicts, decisions, decisionLevel());
             if (decisionLevel() == 0) return l_False;
 
             learnt_clause.clear();
@@ -1085,6 +1130,7 @@ lbool Solver::solve_()
     }else if (status == l_False && conflict.size() == 0)
         ok = false;
 
+    if (progress) progress->publish(conflicts, decisions, decisionLevel());
     cancelUntil(0);
     return status;
 }
@@ -1117,12 +1163,16 @@ void Solver::relocAll(ClauseAllocator& to)
     // All watchers:
     //
     watches.cleanAll();
+    watches_bin.cleanAll();
     for (int v = 0; v < nVars(); v++)
         for (int s = 0; s < 2; s++){
             Lit p = mkLit(v, s);
             vec<Watcher>& ws = watches[p];
             for (int j = 0; j < ws.size(); j++)
                 ca.reloc(ws[j].cref, to);
+            vec<Watcher>& wbin = watches_bin[p];
+            for (int j = 0; j < wbin.size(); j++)
+                ca.reloc(wbin[j].cref, to);
         }
 
     // Single value constraint watchers:
@@ -1216,6 +1266,16 @@ void Solver::checkWatches() {
             assert(c.size() >= 2);
             assert(c.mark() || c[0] == ~p || c[1] == ~p);
         }
+
+        vec<Watcher> & wbin = watches_bin[p];
+
+        for (Watcher * w = (Watcher*)wbin, * end = w + wbin.size(); w != end; w++) {
+            CRef cr = w->cref;
+            Clause & c = ca[cr];
+
+            assert(c.mark() || binWatched(c));
+            assert(c.mark() || (c[0] == ~p && c[1] == w->blocker) || (c[1] == ~p && c[0] == w->blocker));
+        }
     }
 
     // Assert that each watched value variable really occurs
@@ -1265,8 +1325,13 @@ void Solver::checkClauseWatches(CRef cr) {
     assert(c.size() >= 2);
     assert(!c.mark());
 
-    checkClauseIsWatched(cr, watches[~c[0]]);
-    checkClauseIsWatched(cr, watches[~c[1]]);
+    if (binWatched(c)) {
+        checkClauseIsWatched(cr, watches_bin[~c[0]]);
+        checkClauseIsWatched(cr, watches_bin[~c[1]]);
+    } else {
+        checkClauseIsWatched(cr, watches[~c[0]]);
+        checkClauseIsWatched(cr, watches[~c[1]]);
+    }
 
     if (c.single_value_constraint()) {
         for (int i = 0; i < c.size(); i++) {
@@ -28,6 +28,7 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #include "josat/mtl/IntMap.h"
 #include "josat/utils/Options.h"
 #include "josat/core/SolverTypes.h"
+#include "josat/core/Progress.h"
 
 
 namespace Josat {
@@ -57,8 +58,10 @@ public:
     bool    addClause (Lit p, Lit q);                           // Add a binary clause to the solver. 
     bool    addClause (Lit p, Lit q, Lit r);                    // Add a ternary clause to the solver. 
     bool    addClause (Lit p, Lit q, Lit r, Lit s);             // Add a quaternary clause to the solver. 
-    bool    addClause_(      vec<Lit>& ps);                     // Add a clause to the solver without making superflous internal copy. Will
+    bool    addClause_(      vec<Lit>& ps, bool learnt = false); // Add a clause to the solver without making superflous internal copy. Will
                                                                 // change the passed vector 'ps'.
+    bool    addLearnt (const vec<Lit>& ps);                     // Add a clause implied by the problem as a learnt clause. It may be
+                                                                // removed by the clause database reduction.
 
     // Add constraint which guarantees that at least one of the given
     // variables will be true and no two value variables in the constraint
@@ -109,6 +112,10 @@ public:
     // 
     void    setPolarity    (Var v, lbool b); // Declare which polarity the decision heuristic should use for a variable. Requires mode 'polarity_user'.
     void    setDecisionVar (Var v, bool b);  // Declare if a variable should be eligible for selection in the decision heuristic.
+    void    setPhase       (Var v, bool b);  // Set the saved phase of a variable. Phase saving may change it later.
+    bool    phase          (Var v) const;    // The saved phase of a variable.
+    void    setActivity    (Var v, double a);// Set the activity of a variable used by the decision heuristic.
+    double  varActivity    (Var v) const;    // The activity of a variable.
 
     // Read state:
     //
@@ -119,6 +126,7 @@ public:
     int     nAssigns   ()      const;       // The current number of assigned literals.
     int     nClauses   ()      const;       // The current number of original clauses.
     int     nLearnts   ()      const;       // The current number of learnt clauses.
+    const Clause& learnt (int i) const;     // The i-th learnt clause.
     int     nVars      ()      const;       // The current number of variables.
     int     nFreeVars  ()      const;
     void    printStats ()      const;       // Print some current statistics to standard output.
@@ -156,6 +164,7 @@ public:
     bool      rnd_init_act;       // Initialize variable activities with a small random value.
     double    garbage_frac;       // The fraction of wasted memory allowed before a garbage collection is triggered.
     int       min_learnts_lim;    // Minimum number to set the learnts limit to.
+    ProgressRing* progress;       // If not NULL, snapshots of the search are published there (not owned).
 
     int       restart_first;      // The initial restart limit.                                                                (default 100)
     double    restart_inc;        // The factor with which the restart limit is multiplied in each restart.                    (default 1.5)
@@ -227,6 +236,8 @@ protected:
     VMap<VarData>       vardata;          // Stores reason and level for each variable.
     OccLists<Lit, vec<Watcher>, WatcherDeleted, MkIndexLit>
                         watches;          // 'watches[lit]' is a list of constraints watching 'lit' (will go there if literal becomes true).
+    OccLists<Lit, vec<Watcher>, WatcherDeleted, MkIndexLit>
+                        watches_bin;      // 'watches_bin[lit]' is a list of binary clauses watching 'lit'. The blocker is the other literal.
 
     // In which single value constraint is variable watched.
     VMap<CRef> svc_watches;
@@ -264,7 +275,7 @@ protected:
     //
     int64_t             conflict_budget;    // -1 means no budget.
     int64_t             propagation_budget; // -1 means no budget.
-    bool                asynch_interrupt;
+    bool                asynch_interrupt;   // Accessed atomically, set by other threads.
 
     // Main internal methods:
     //
@@ -307,6 +318,8 @@ protected:
     bool     isRemoved        (CRef cr) const;         // Test if a clause has been removed.
     bool     locked           (const Clause& c) const; // Returns TRUE if a clause is a reason for some implication in the current state.
     bool     satisfied        (const Clause& c) const; // Returns TRUE if a clause is satisfied in the current state.
+    bool     binWatched       (const Clause& c) const; // Returns TRUE if a clause is watched in 'watches_bin'.
+    Lit      impliedLit       (const Clause& c) const; // Literal which may be implied by a clause.
 
     // Attach single value constraint to watcher lists.
     void attachSingleValueConstraint(CRef cr);
@@ -369,9 +382,20 @@ inline int  Solver::level (Var x) const { return vardata[x].level; }
 inline Var Solver::reason_svc(Var x) const { return vardata[x].reason_svc; }
 
 inline CRef Solver::getAntecedent(Lit p) {
-    if (reason_svc(var(p)) == var_Undef)
-        return reason(var(p));
-    else {
+    if (reason_svc(var(p)) == var_Undef) {
+        CRef cr = reason(var(p));
+        // Binary clauses are propagated without moving the implied
+        // literal to 0th position.
+        if (cr != CRef_Undef) {
+            Clause& c = ca[cr];
+            if (c.size() == 2 && var(c[0]) != var(p)) {
+                Lit q = c[1];
+                c[1] = c[0];
+                c[0] = q;
+            }
+        }
+        return cr;
+    } else {
         // 0th literal is p, but in algorithms it is not needed.
         ca[svc_implicit_clause][1] = mkLit(reason_svc(var(p)), lsign_Neg);
         return svc_implicit_clause;
@@ -410,6 +434,7 @@ inline void Solver::checkGarbage(double gf){
 // NOTE: enqueue does not set the ok flag! (only public methods do)
 inline bool     Solver::enqueue         (Lit p, CRef from)      { return value(p) != l_Undef ? value(p) != l_False : (uncheckedEnqueue(p, from), true); }
 inline bool     Solver::addClause       (const vec<Lit>& ps)    { ps.copyTo(add_tmp); return addClause_(add_tmp); }
+inline bool     Solver::addLearnt       (const vec<Lit>& ps)    { ps.copyTo(add_tmp); return addClause_(add_tmp, true); }
 inline bool     Solver::addEmptyClause  ()                      { add_tmp.clear(); return addClause_(add_tmp); }
 inline bool     Solver::addClause       (Lit p)                 { add_tmp.clear(); add_tmp.push(p); return addClause_(add_tmp); }
 inline bool     Solver::addClause       (Lit p, Lit q)          { add_tmp.clear(); add_tmp.push(p); add_tmp.push(q); return addClause_(add_tmp); }
@@ -417,7 +442,9 @@ inline bool     Solver::addClause       (Lit p, Lit q, Lit r)   { add_tmp.clear(
 inline bool     Solver::addClause       (Lit p, Lit q, Lit r, Lit s){ add_tmp.clear(); add_tmp.push(p); add_tmp.push(q); add_tmp.push(r); add_tmp.push(s); return addClause_(add_tmp); }
 
 inline bool     Solver::isRemoved       (CRef cr)         const { return ca[cr].mark() == 1; }
-inline bool     Solver::locked          (const Clause& c) const { return value(c[0]) == l_True && reason(var(c[0])) != CRef_Undef && ca.lea(reason(var(c[0]))) == &c; }
+inline bool     Solver::locked          (const Clause& c) const { Lit p = impliedLit(c); return value(p) == l_True && reason(var(p)) != CRef_Undef && ca.lea(reason(var(p))) == &c; }
+inline bool     Solver::binWatched      (const Clause& c) const { return c.size() == 2 && !c.single_value_constraint(); }
+inline Lit      Solver::impliedLit      (const Clause& c) const { return !binWatched(c) || value(c[0]) == l_True ? c[0] : c[1]; }
 inline void     Solver::newDecisionLevel()                      { trail_lim.push(trail.size()); }
 
 inline int      Solver::decisionLevel ()      const   { return trail_lim.size(); }
@@ -429,10 +456,20 @@ inline lbool    Solver::modelValue    (Lit p) const   { return model[var(p)] ^ s
 inline int      Solver::nAssigns      ()      const   { return trail.size(); }
 inline int      Solver::nClauses      ()      const   { return num_clauses; }
 inline int      Solver::nLearnts      ()      const   { return num_learnts; }
+inline const Clause& Solver::learnt     (int i) const   { return ca[learnts[i]]; }
 inline int      Solver::nVars         ()      const   { return next_var; }
 // TODO: nFreeVars() is not quite correct, try to calculate right instead of adapting it like below:
 inline int      Solver::nFreeVars     ()      const   { return (int)dec_vars - (trail_lim.size() == 0 ? trail.size() : trail_lim[0]); }
 inline void     Solver::setPolarity   (Var v, lbool b){ user_pol[v] = b; }
+inline void     Solver::setPhase      (Var v, bool b) { polarity[v] = !b; }
+inline bool     Solver::phase         (Var v) const   { return !polarity[v]; }
+inline void     Solver::setActivity   (Var v, double a)
+{
+    activity[v] = a;
+    if (order_heap.inHeap(v))
+        order_heap.update(v);
+}
+inline double   Solver::varActivity   (Var v) const   { return activity[v]; }
 inline void     Solver::setDecisionVar(Var v, bool b) 
 { 
     if      ( b && !decision[v]) dec_vars++;
@@ -443,11 +480,11 @@ inline void     Solver::setDecisionVar(Var v, bool b)
 }
 inline void     Solver::setConfBudget(int64_t x){ conflict_budget    = conflicts    + x; }
 inline void     Solver::setPropBudget(int64_t x){ propagation_budget = propagations + x; }
-inline void     Solver::interrupt(){ asynch_interrupt = true; }
-inline void     Solver::clearInterrupt(){ asynch_interrupt = false; }
+inline void     Solver::interrupt(){ __atomic_store_n(&asynch_interrupt, true, __ATOMIC_RELAXED); }
+inline void     Solver::clearInterrupt(){ __atomic_store_n(&asynch_interrupt, false, __ATOMIC_RELAXED); }
 inline void     Solver::budgetOff(){ conflict_budget = propagation_budget = -1; }
 inline bool     Solver::withinBudget() const {
-    return !asynch_interrupt &&
+    return !__atomic_load_n(&asynch_interrupt, __ATOMIC_RELAXED) &&
            (conflict_budget    < 0 || conflicts < (uint64_t)conflict_budget) &&
            (propagation_budget < 0 || propagations < (uint64_t)propagation_budget); }
 
@@ -0,0 +1,142 @@
+/* Copyright (c) 2015 Radek Micek */
+
+#include "minisat/mtl/XAlloc.h"
+#include "minisat/core/Drat.h"
+
+using namespace Minisat;
+
+DratWriter::DratWriter()
+  : buf          ((unsigned char*)xrealloc(NULL, buf_cap))
+  , buf_size     (0)
+  , pending      ((unsigned char*)xrealloc(NULL, buf_cap))
+  , pending_size (0)
+  , out          (NULL)
+  , stop         (false)
+  , failed       (false)
+  , started      (false)
+{
+    pthread_mutex_init(&mutex, NULL);
+    pthread_cond_init(&cond, NULL);
+}
+
+
+DratWriter::~DratWriter()
+{
+    close();
+    if (started){
+        pthread_mutex_lock(&mutex);
+        stop = true;
+        pthread_cond_broadcast(&cond);
+        pthread_mutex_unlock(&mutex);
+        pthread_join(thread, NULL);
+    }
+    pthread_cond_destroy(&cond);
+    pthread_mutex_destroy(&mutex);
+    free(buf);
+    free(pending);
+}
+
+
+bool DratWriter::open(const char* file)
+{
+    if (!close())
+        return false;
+
+    out = fopen(file, "wb");
+    if (out == NULL)
+        return false;
+    failed = false;
+
+    if (!started){
+        if (pthread_create(&thread, NULL, runThread, this) != 0){
+            fclose(out);
+            out = NULL;
+            return false; }
+        started = true;
+    }
+    return true;
+}
+
+
+bool DratWriter::close()
+{
+    if (out == NULL){
+        buf_size = 0;
+        return true; }
+
+    waitWritten();
+    bool ok = !failed && fclose(out) == 0;
+    out = NULL;
+    return ok;
+}
+
+
+bool DratWriter::flush()
+{
+    if (out == NULL)
+        return false;
+
+    waitWritten();
+    return !failed && fflush(out) == 0;
+}
+
+
+void DratWriter::handOver()
+{
+    // Nothing is written before the first file is opened.
+    if (out == NULL){
+        buf_size = 0;
+        return; }
+
+    pthread_mutex_lock(&mutex);
+    while (pending_size > 0)
+        pthread_cond_wait(&cond, &mutex);
+    unsigned char* tmp = pending;
+    pending      = buf;
+    pending_size = buf_size;
+    buf          = tmp;
+    buf_size     = 0;
+    pthread_cond_broadcast(&cond);
+    pthread_mutex_unlock(&mutex);
+}
+
+
+void DratWriter::waitWritten()
+{
+    if (buf_size > 0)
+        handOver();
+
+    pthread_mutex_lock(&mutex);
+    while (pending_size > 0)
+        pthread_cond_wait(&cond, &mutex);
+    pthread_mutex_unlock(&mutex);
+}
+
+
+void DratWriter::run()
+{
+    pthread_mutex_lock(&mutex);
+    for (;;){
+        while (!stop && pending_size == 0)
+            pthread_cond_wait(&cond, &mutex);
+        if (pending_size == 0)
+            break;
+
+        // The solver doesn't touch the pending buffer nor the file until it's written:
+        pthread_mutex_unlock(&mutex);
+        bool ok = fwrite(pending, 1, pending_size, out) == (size_t)pending_size;
+        pthread_mutex_lock(&mutex);
+
+        if (!ok) failed = true;
+        pending_size = 0;
+        pthread_cond_broadcast(&cond);
+    }
+    pthread_mutex_unlock(&mutex);
+}
+
+
+void* DratWriter::runThread(void* writer)
+{
+    ((DratWriter*)writer)->run();
+    return NULL;
+}
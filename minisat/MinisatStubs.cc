@@ -4,12 +4,15 @@
 #include <caml/memory.h>
 #include <caml/alloc.h>
 #include <caml/custom.h>
+#include <caml/fail.h>
 #include <caml/signals.h>
 #include <caml/threads.h>
 
-#ifdef MINISAT_STUBS_LOG
+#include <sys/time.h>
 #include <stdio.h>
-#endif
+#include <stdlib.h>
+#include <string.h>
+#include <string>
 
 #include "minisat/core/SolverTypes.h"
 #include "minisat/core/Solver.h"
@@ -31,14 +34,61 @@ using namespace Minisat;
 #define log_lits(v)
 #endif
 
-#define Solver_val(v) (*((Solver **) Data_custom_val(v)))
+// Statistics of the last call to solve.
+struct SolveStats {
+  uint64_t conflicts;
+  uint64_t decisions;
+  uint64_t propagations;
+  uint64_t learntLits;
+  uint64_t restarts;
+  double wallTime;
+};
+
+// Contents of the custom block.
+struct StubSolver {
+  Solver * solver;
+  // Budgets for each call to solve. Negative value means no budget.
+  int64_t confBudget;
+  int64_t propBudget;
+  SolveStats stats;
+  // Snapshots published by the search, read by minisat_poll_progress.
+  ProgressRing * progress;
+  // Proof is written only when drat is not null.
+  DratWriter * drat;
+  // Original clauses of the current part of the proof.
+  FILE * cnf;
+  // Allocated by malloc. The custom block can be moved so it can't contain std::string.
+  char * proofPrefix;
+};
+
+#define Stub_val(v) ((StubSolver *) Data_custom_val(v))
+#define Solver_val(v) (Stub_val(v)->solver)
+
+static double wall_time() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (double)tv.tv_sec + (double)tv.tv_usec / 1000000;
+}
+
+// Writes the clause in DIMACS format.
+static void write_dimacs(FILE * f, const vec<Lit> & lits) {
+  for (int i = 0; i < lits.size(); i++)
+    fprintf(f, "%s%d ", sign(lits[i]) ? "-" : "", var(lits[i]) + 1);
+  fputs("0\n", f);
+}
 
 static void minisat_finalize (value sv) {
-  Solver * s = Solver_val(sv);
+  StubSolver * stub = Stub_val(sv);
+  Solver * s = stub->solver;
 
   log("minisat_finalize(%p)\n", s);
 
   delete s;
+  delete stub->progress;
+  delete stub->drat;
+  if (stub->cnf)
+    fclose(stub->cnf);
+  free(stub->proofPrefix);
 }
 
 static struct custom_operations minisat_ops = {
@@ -58,8 +108,17 @@ CAMLprim value minisat_create(value unit) {
 
   Solver * s = new Solver();
 
-  sv = caml_alloc_custom(&minisat_ops, sizeof(Solver *), 0, 1);
-  Solver_val(sv) = s;
+  sv = caml_alloc_custom(&minisat_ops, sizeof(StubSolver), 0, 1);
+  StubSolver * stub = Stub_val(sv);
+  stub->solver = s;
+  stub->confBudget = -1;
+  stub->propBudget = -1;
+  stub->stats = SolveStats();
+  stub->progress = new ProgressRing();
+  s->progress = stub->progress;
+  stub->drat = NULL;
+  stub->cnf = NULL;
+  stub->proofPrefix = NULL;
 
   log("minisat_create() = %p\n", s);
 
@@ -94,6 +153,9 @@ CAMLprim value minisat_add_clause(value sv, value litsv, value lenv) {
   log_lits(lits);
   log(", %d) = ", len);
 
+  if (Stub_val(sv)->cnf)
+    write_dimacs(Stub_val(sv)->cnf, lits);
+
   bool res = s->addClause_(lits);
 
   log("%d\n", (int)res);
@@ -114,14 +176,54 @@ CAMLprim value minisat_solve(value sv, value assumptsv) {
     assumpts.push(toLit(Int_val(Field(assumptsv, i))));
   }
 
+  StubSolver * stub = Stub_val(sv);
+  s->budgetOff();
+  if (stub->confBudget >= 0)
+    s->setConfBudget(stub->confBudget);
+  if (stub->propBudget >= 0)
+    s->setPropBudget(stub->propBudget);
+
+  const uint64_t conflicts = s->conflicts;
+  const uint64_t decisions = s->decisions;
+  const uint64_t propagations = s->propagations;
+  const uint64_t learntLits = s->tot_literals;
+  const uint64_t starts = s->starts;
+  const double start = wall_time();
+
   caml_release_runtime_system();
   int res = toInt(s->solveLimited(assumpts));
   caml_acquire_runtime_system();
 
+  SolveStats & stats = stub->stats;
+  stats.conflicts = s->conflicts - conflicts;
+  stats.decisions = s->decisions - decisions;
+  stats.propagations = s->propagations - propagations;
+  stats.learntLits = s->tot_literals - learntLits;
+  // The first start isn't a restart.
+  stats.restarts = s->starts > starts ? s->starts - starts - 1 : 0;
+  stats.wallTime = wall_time() - start;
+
   // Normalize lbool.
   if (res != 0 && res != 1)
     res = 2;
 
+  // Assumptions are needed to check the proof of unsatisfiability.
+  if (res == 1 && stub->cnf) {
+    const std::string fname = std::string(stub->proofPrefix) + ".assumptions";
+    FILE * f = fopen(fname.c_str(), "w");
+    bool ok = f != NULL;
+    if (ok) {
+      vec<Lit> unit(1);
+      for (int i = 0; i < assumpts.size(); i++) {
+        unit[0] = assumpts[i];
+        write_dimacs(f, unit);
+      }
+      ok = fclose(f) == 0;
+    }
+    if (!ok || !stub->drat->flush() || fflush(stub->cnf) != 0)
+      caml_failwith("minisat_solve: cannot write proof");
+  }
+
   log("minisat_solve(%p, ", s);
   log_lits(assumpts);
   log(") = %d\n", res);
@@ -129,6 +231,160 @@ CAMLprim value minisat_solve(value sv, value assumptsv) {
   CAMLreturn (Val_int(res));
 }
 
+CAMLprim value minisat_set_conf_budget(value sv, value budgetv) {
+  CAMLparam2 (sv, budgetv);
+
+  Stub_val(sv)->confBudget = Long_val(budgetv);
+
+  log("minisat_set_conf_budget(%p, %ld)\n", Solver_val(sv), Long_val(budgetv));
+
+  CAMLreturn (Val_unit);
+}
+
+CAMLprim value minisat_set_prop_budget(value sv, value budgetv) {
+  CAMLparam2 (sv, budgetv);
+
+  Stub_val(sv)->propBudget = Long_val(budgetv);
+
+  log("minisat_set_prop_budget(%p, %ld)\n", Solver_val(sv), Long_val(budgetv));
+
+  CAMLreturn (Val_unit);
+}
+
+CAMLprim value minisat_last_stats(value sv) {
+  CAMLparam1 (sv);
+  CAMLlocal1 (statsv);
+
+  const SolveStats & stats = Stub_val(sv)->stats;
+
+  // Record Sat_solver.stats.
+  statsv = caml_alloc_tuple(6);
+  Store_field(statsv, 0, Val_long(stats.conflicts));
+  Store_field(statsv, 1, Val_long(stats.decisions));
+  Store_field(statsv, 2, Val_long(stats.propagations));
+  Store_field(statsv, 3, Val_long(stats.learntLits));
+  Store_field(statsv, 4, Val_long(stats.restarts));
+  Store_field(statsv, 5, caml_copy_double(stats.wallTime));
+
+  CAMLreturn (statsv);
+}
+
+CAMLprim value minisat_set_phase(value sv, value varv, value phasev) {
+  CAMLparam3 (sv, varv, phasev);
+
+  Solver * s = Solver_val(sv);
+  s->setPhase(Int_val(varv), Bool_val(phasev));
+
+  CAMLreturn (Val_unit);
+}
+
+CAMLprim value minisat_get_phase(value sv, value varv) {
+  CAMLparam2 (sv, varv);
+
+  Solver * s = Solver_val(sv);
+
+  CAMLreturn (Val_bool(s->phase(Int_val(varv))));
+}
+
+CAMLprim value minisat_set_activity(value sv, value varv, value activityv) {
+  CAMLparam3 (sv, varv, activityv);
+
+  Solver * s = Solver_val(sv);
+  s->setActivity(Int_val(varv), Double_val(activityv));
+
+  CAMLreturn (Val_unit);
+}
+
+CAMLprim value minisat_get_activity(value sv, value varv) {
+  CAMLparam2 (sv, varv);
+
+  Solver * s = Solver_val(sv);
+
+  CAMLreturn (caml_copy_double(s->varActivity(Int_val(varv))));
+}
+
+CAMLprim value minisat_add_learnt(value sv, value litsv, value lenv) {
+  CAMLparam3 (sv, litsv, lenv);
+
+  Solver * s = Solver_val(sv);
+  int len = Int_val(lenv);
+
+  // Literals.
+  vec<Lit> lits;
+  lits.capacity(len);
+  for (int i = 0; i < len; i++) {
+    lits.push(toLit(Int_val(Field(litsv, i))));
+  }
+
+  log("minisat_add_learnt(%p, ", s);
+  log_lits(lits);
+  log(", %d) = ", len);
+
+  // Imported clauses can't be derived in the proof.
+  if (Stub_val(sv)->drat) {
+    log("%d\n", 1);
+    CAMLreturn (Val_true);
+  }
+
+  bool res = s->addLearnt(lits);
+
+  log("%d\n", (int)res);
+
+  CAMLreturn (Val_bool(res));
+}
+
+static value cons_lits(value tailv, const Lit * lits, int len) {
+  CAMLparam1 (tailv);
+  CAMLlocal2 (litsv, consv);
+
+  litsv = caml_alloc(len, 0);
+  for (int i = 0; i < len; i++)
+    Store_field(litsv, i, Val_int(toInt(lits[i])));
+  consv = caml_alloc(2, 0);
+  Store_field(consv, 0, litsv);
+  Store_field(consv, 1, tailv);
+
+  CAMLreturn (consv);
+}
+
+// The solver doesn't compute glue of the learnt clauses
+// so the length of the clause is used instead.
+CAMLprim value minisat_export_learnts(value sv, value maxlenv, value maxgluev) {
+  CAMLparam3 (sv, maxlenv, maxgluev);
+  CAMLlocal1 (resv);
+
+  Solver * s = Solver_val(sv);
+  int maxLen = Int_val(maxlenv);
+  if (Int_val(maxgluev) < maxLen)
+    maxLen = Int_val(maxgluev);
+
+  resv = Val_emptylist;
+
+  // Learnt units.
+  for (Var v = 0; v < s->nVars(); v++) {
+    if (s->value(v) != l_Undef) {
+      Lit lit = mkLit(v, s->value(v) == l_False);
+      resv = cons_lits(resv, &lit, 1);
+    }
+  }
+
+  vec<Lit> lits;
+  for (int i = 0; i < s->nLearnts(); i++) {
+    const Clause & c = s->learnt(i);
+    if (c.size() <= maxLen) {
+      lits.clear();
+      for (int j = 0; j < c.size(); j++)
+        lits.push(c[j]);
+      resv = cons_lits(resv, &lits[0], lits.size());
+    }
+  }
+
+  log("minisat_export_learnts(%p, %d, %d)\n",
+      s, Int_val(maxlenv), Int_val(maxgluev));
+
+  CAMLreturn (resv);
+}
+
 CAMLprim value minisat_model_value(value sv, value varv) {
   CAMLparam2 (sv, varv);
 
@@ -167,4 +423,59 @@ CAMLprim value minisat_clear_interrupt(value sv) {
   CAMLreturn (Val_unit);
 }
 
+// Can be called by another thread while the solver is searching.
+CAMLprim value minisat_poll_progress(value sv) {
+  CAMLparam1 (sv);
+  CAMLlocal3 (resv, snapv, consv);
+
+  ProgressSnapshot snaps[ProgressRing::capacity];
+  int n = Stub_val(sv)->progress->poll(snaps);
+
+  // List of Sh.progress records, the oldest snapshot first.
+  resv = Val_emptylist;
+  for (int i = n - 1; i >= 0; i--) {
+    snapv = caml_alloc_tuple(3);
+    Store_field(snapv, 0, Val_long(snaps[i].conflicts));
+    Store_field(snapv, 1, Val_long(snaps[i].decisions));
+    Store_field(snapv, 2, Val_long(snaps[i].depth));
+    consv = caml_alloc(2, 0);
+    Store_field(consv, 0, snapv);
+    Store_field(consv, 1, resv);
+    resv = consv;
+  }
+
+  log("minisat_poll_progress(%p) = %d\n", Solver_val(sv), n);
+
+  CAMLreturn (resv);
+}
+
+CAMLprim value minisat_start_proof(value sv, value prefixv) {
+  CAMLparam2 (sv, prefixv);
+
+  StubSolver * stub = Stub_val(sv);
+  Solver * s = stub->solver;
+
+  if (!stub->drat) {
+    if (s->nVars() > 0)
+      caml_failwith("minisat_start_proof: solver already used");
+    stub->drat = new DratWriter();
+    s->drat = stub->drat;
+  }
+
+  const std::string prefix = String_val(prefixv);
+  if (stub->cnf && fclose(stub->cnf) != 0) {
+    stub->cnf = NULL;
+    caml_failwith("minisat_start_proof: cannot write proof");
+  }
+  stub->cnf = fopen((prefix + ".cnf").c_str(), "w");
+  if (!stub->cnf || !stub->drat->open((prefix + ".drat").c_str()))
+    caml_failwith("minisat_start_proof: cannot open proof");
+  free(stub->proofPrefix);
+  stub->proofPrefix = strdup(prefix.c_str());
+
+  log("minisat_start_proof(%p, %s)\n", s, prefix.c_str());
+
+  CAMLreturn (Val_unit);
+}
+
 } // extern "C" {
@@ -67,6 +67,8 @@ Solver::Solver() :
   , rnd_init_act     (opt_rnd_init_act)
   , garbage_frac     (opt_garbage_frac)
   , min_learnts_lim  (opt_min_learnts_lim)
+  , drat             (NULL)
+  , progress         (NULL)
   , restart_first    (opt_restart_first)
   , restart_inc      (opt_restart_inc)
 
@@ -85,6 +87,7 @@ Solver::Solver() :
   , dec_vars(0), num_clauses(0), num_learnts(0), clauses_literals(0), learnts_literals(0), max_literals(0), tot_literals(0)
 
   , watches            (WatcherDeleted(ca))
+  , watches_bin        (WatcherDeleted(ca))
   , order_heap         (VarOrderLt(activity))
   , ok                 (true)
   , cla_inc            (1)
@@ -127,6 +130,8 @@ Var Solver::newVar(lbool upol, bool dvar)
 
     watches  .init(mkLit(v, false));
     watches  .init(mkLit(v, true ));
+    watches_bin.init(mkLit(v, false));
+    watches_bin.init(mkLit(v, true ));
     assigns  .insert(v, l_Undef);
     vardata  .insert(v, mkVarData(CRef_Undef, 0));
     activity .insert(v, rnd_init_act ? drand(random_seed) * 0.00001 : 0);
@@ -151,13 +156,14 @@ void Solver::releaseVar(Lit l)
 }
 
 
-bool Solver::addClause_(vec<Lit>& ps)
+bool Solver::addClause_(vec<Lit>& ps, bool learnt)
 {
     assert(decisionLevel() == 0);
     if (!ok) return false;
 
     // Check if clause is satisfied and remove false/duplicate literals:
     sort(ps);
+    if (drat) ps.copyTo(drat_tmp);
     Lit p; int i, j;
     for (i = j = 0, p = lit_Undef; i < ps.size(); i++)
         if (value(ps[i]) == l_True || ps[i] == ~p)
@@ -166,14 +172,26 @@ bool Solver::addClause_(vec<Lit>& ps)
             ps[j++] = p = ps[i];
     ps.shrink(i - j);
 
+    // The proof contains only the simplified clause:
+    if (drat && i != j){
+        drat->add(ps);
+        drat->remove(drat_tmp);
+    }
+
     if (ps.size() == 0)
         return ok = false;
     else if (ps.size() == 1){
         uncheckedEnqueue(ps[0]);
-        return ok = (propagate() == CRef_Undef);
+        ok = (propagate() == CRef_Undef);
+        if (drat && !ok) drat->addEmpty();
+        return ok;
     }else{
-        CRef cr = ca.alloc(ps, false);
-        clauses.push(cr);
+        CRef cr = ca.alloc(ps, learnt);
+        if (learnt){
+            learnts.push(cr);
+            claBumpActivity(ca[cr]);
+        }else
+            clauses.push(cr);
         attachClause(cr);
     }
 
@@ -184,8 +202,13 @@ bool Solver::addClause_(vec<Lit>& ps)
 void Solver::attachClause(CRef cr){
     const Clause& c = ca[cr];
     assert(c.size() > 1);
-    watches[~c[0]].push(Watcher(cr, c[1]));
-    watches[~c[1]].push(Watcher(cr, c[0]));
+    if (c.size() == 2){
+        watches_bin[~c[0]].push(Watcher(cr, c[1]));
+        watches_bin[~c[1]].push(Watcher(cr, c[0]));
+    }else{
+        watches[~c[0]].push(Watcher(cr, c[1]));
+        watches[~c[1]].push(Watcher(cr, c[0]));
+    }
     if (c.learnt()) num_learnts++, learnts_literals += c.size();
     else            num_clauses++, clauses_literals += c.size();
 }
@@ -195,13 +218,15 @@ void Solver::detachClause(CRef cr, bool strict){
     const Clause& c = ca[cr];
     assert(c.size() > 1);
     
+    OccLists<Lit, vec<Watcher>, WatcherDeleted, MkIndexLit>& ws = c.size() == 2 ? watches_bin : watches;
+
     // Strict or lazy detaching:
     if (strict){
-        remove(watches[~c[0]], Watcher(cr, c[1]));
-        remove(watches[~c[1]], Watcher(cr, c[0]));
+        remove(ws[~c[0]], Watcher(cr, c[1]));
+        remove(ws[~c[1]], Watcher(cr, c[0]));
     }else{
-        watches.smudge(~c[0]);
-        watches.smudge(~c[1]);
+        ws.smudge(~c[0]);
+        ws.smudge(~c[1]);
     }
 
     if (c.learnt()) num_learnts--, learnts_literals -= c.size();
@@ -211,9 +236,12 @@ void Solver::detachClause(CRef cr, bool strict){
 
 void Solver::removeClause(CRef cr) {
     Clause& c = ca[cr];
+    if (drat) drat->remove(c);
     detachClause(cr);
     // Don't leave pointers to free'd memory!
-    if (locked(c)) vardata[var(c[0])].reason = CRef_Undef;
+    if (locked(c)){
+        Lit implied = c.size() != 2 || value(c[0]) == l_True ? c[0] : c[1];
+        vardata[var(implied)].reason = CRef_Undef; }
     c.mark(1); 
     ca.free(cr);
 }
@@ -326,7 +354,7 @@ void Solver::analyze(CRef confl, vec<Lit>& out_learnt, int& out_btlevel)
         // Select next clause to look at:
         while (!seen[var(trail[index--])]);
         p     = trail[index+1];
-        confl = reason(var(p));
+        confl = orderedReason(var(p));
         seen[var(p)] = 0;
         pathC--;
 
@@ -349,7 +377,7 @@ void Solver::analyze(CRef confl, vec<Lit>& out_learnt, int& out_btlevel)
             if (reason(x) == CRef_Undef)
                 out_learnt[j++] = out_learnt[i];
             else{
-                Clause& c = ca[reason(var(out_learnt[i]))];
+                Clause& c = ca[orderedReason(x)];
                 for (int k = 1; k < c.size(); k++)
                     if (!seen[var(c[k])] && level(var(c[k])) > 0){
                         out_learnt[j++] = out_learnt[i];
@@ -391,7 +419,7 @@ bool Solver::litRedundant(Lit p)
     assert(seen[var(p)] == seen_undef || seen[var(p)] == seen_source);
     assert(reason(var(p)) != CRef_Undef);
 
-    Clause*               c     = &ca[reason(var(p))];
+    Clause*               c     = &ca[orderedReason(var(p))];
     vec<ShrinkStackElem>& stack = analyze_stack;
     stack.clear();
 
@@ -420,7 +448,7 @@ bool Solver::litRedundant(Lit p)
             stack.push(ShrinkStackElem(i, p));
             i  = 0;
             p  = l;
-            c  = &ca[reason(var(p))];
+            c  = &ca[orderedReason(var(p))];
         }else{
             // Finished with current element 'p' and reason 'c':
             if (seen[var(p)] == seen_undef){
@@ -434,7 +462,7 @@ bool Solver::litRedundant(Lit p)
             // Continue with top element on stack:
             i  = stack.last().i;
             p  = stack.last().l;
-            c  = &ca[reason(var(p))];
+            c  = &ca[orderedReason(var(p))];
 
             stack.pop();
         }
@@ -470,7 +498,7 @@ void Solver::analyzeFinal(Lit p, LSet& out_conflict)
                 assert(level(x) > 0);
                 out_conflict.insert(~trail[i]);
             }else{
-                Clause& c = ca[reason(x)];
+                Clause& c = ca[orderedReason(x)];
                 for (int j = 1; j < c.size(); j++)
                     if (level(var(c[j])) > 0)
                         seen[var(c[j])] = 1;
@@ -510,9 +538,24 @@ CRef Solver::propagate()
 
     while (qhead < trail.size()){
         Lit            p   = trail[qhead++];     // 'p' is enqueued fact to propagate.
+        num_props++;
+
+        // Binary clauses first -- the other literal is in the watcher, no need to inspect the clause:
+        vec<Watcher>&  wbin = watches_bin.lookup(p);
+        for (int k = 0; k < wbin.size(); k++){
+            Lit imp = wbin[k].blocker;
+            if (value(imp) == l_False){
+                confl = wbin[k].cref;
+                qhead = trail.size();
+                break;
+            }else if (value(imp) == l_Undef)
+                uncheckedEnqueue(imp, wbin[k].cref);
+        }
+        if (confl != CRef_Undef)
+            break;
+
         vec<Watcher>&  ws  = watches.lookup(p);
         Watcher        *i, *j, *end;
-        num_props++;
 
         for (i = j = (Watcher*)ws, end = i + ws.size();  i != end;){
             // Try to avoid inspecting the clause:
@@ -608,11 +651,33 @@ void Solver::removeSatisfied(vec<CRef>& cs)
         else{
             // Trim clause:
             assert(value(c[0]) == l_Undef && value(c[1]) == l_Undef);
+            if (drat){
+                drat_tmp.clear();
+                for (int k = 0; k < c.size(); k++)
+                    drat_tmp.push(c[k]);
+            }
+
+            // Clause which becomes binary must be moved to binary watches.
+            int nfalse = 0;
+            for (int k = 2; k < c.size(); k++)
+                if (value(c[k]) == l_False)
+                    nfalse++;
+            const bool becomesBinary = nfalse > 0 && c.size() - nfalse == 2;
+            if (becomesBinary)
+                detachClause(cs[i], true);
+
             for (int k = 2; k < c.size(); k++)
                 if (value(c[k]) == l_False){
                     c[k--] = c[c.size()-1];
                     c.pop();
                 }
+
+            if (becomesBinary)
+                attachClause(cs[i]);
+            if (drat && c.size() < drat_tmp.size()){
+                drat->add(c);
+                drat->remove(drat_tmp);
+            }
             cs[j++] = cs[i];
         }
     }
@@ -642,8 +707,9 @@ bool Solver::simplify()
 {
     assert(decisionLevel() == 0);
 
-    if (!ok || propagate() != CRef_Undef)
-        return ok = false;
+    if (!ok || propagate() != CRef_Undef){
+        if (drat && ok) drat->addEmpty();
+        return ok = false; }
 
     if (nAssigns() == simpDB_assigns || (simpDB_props > 0))
         return true;
@@ -712,11 +778,16 @@ lbool Solver::search(int nof_conflicts)
         if (confl != CRef_Undef){
             // CONFLICT
             conflicts++; conflictC++;
-            if (decisionLevel() == 0) return l_False;
+            if (progress && conflicts % ProgressRing::interval == 0)
+                progress->publish(conflicts, decisions, decisionLevel());
+            if (decisionLevel() == 0){
+                if (drat) drat->addEmpty();
+                return l_False; }
 
             learnt_clause.clear();
             analyze(confl, learnt_clause, backtrack_level);
             cancelUntil(backtrack_level);
+            if (drat) drat->add(learnt_clause);
 
             if (learnt_clause.size() == 1){
                 uncheckedEnqueue(learnt_clause[0]);
@@ -879,6 +950,7 @@ lbool Solver::solve_()
     }else if (status == l_False && conflict.size() == 0)
         ok = false;
 
+    if (progress) progress->publish(conflicts, decisions, decisionLevel());
     cancelUntil(0);
     return status;
 }
@@ -1010,12 +1082,16 @@ void Solver::relocAll(ClauseAllocator& to)
     // All watchers:
     //
     watches.cleanAll();
+    watches_bin.cleanAll();
     for (int v = 0; v < nVars(); v++)
         for (int s = 0; s < 2; s++){
             Lit p = mkLit(v, s);
             vec<Watcher>& ws = watches[p];
             for (int j = 0; j < ws.size(); j++)
                 ca.reloc(ws[j].cref, to);
+            vec<Watcher>& wbin = watches_bin[p];
+            for (int j = 0; j < wbin.size(); j++)
+                ca.reloc(wbin[j].cref, to);
         }
 
     // All reasons:
@@ -0,0 +1,66 @@
+/* Copyright (c) 2015 Radek Micek */
+
+#ifndef Minisat_Drat_h
+#define Minisat_Drat_h
+
+#include <stdio.h>
+#include <pthread.h>
+
+#include "minisat/core/SolverTypes.h"
+
+namespace Minisat {
+
+//=================================================================================================
+// DratWriter -- binary DRAT proof written to a file by a separate thread:
+//
+// The solver only appends bytes to a buffer. Full buffers are handed over to the writer thread,
+// so the solver waits for the disk only when it produces the proof faster than the disk can
+// store it. Literals are encoded as in drat-trim.
+
+class DratWriter {
+public:
+    DratWriter();
+    ~DratWriter();
+
+    bool open (const char* file);   // Finish the current file and continue the proof in the new file.
+    bool close();                   // Wait until the whole proof is written and close the file.
+    bool flush();                   // Wait until the whole proof is written to the file.
+
+    template<class Lits>
+    void add   (const Lits& c) { put('a'); for (int i = 0; i < c.size(); i++) putLit(c[i]); put(0); }
+    template<class Lits>
+    void remove(const Lits& c) { put('d'); for (int i = 0; i < c.size(); i++) putLit(c[i]); put(0); }
+    void addEmpty()            { put('a'); put(0); }
+
+private:
+    enum { buf_cap = 1 << 20 };
+
+    unsigned char*  buf;            // Buffer filled by the solver.
+    int             buf_size;
+    unsigned char*  pending;        // Buffer written by the thread.
+    int             pending_size;
+    FILE*           out;
+    bool            stop;
+    bool            failed;
+    bool            started;
+    pthread_t       thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t  cond;
+
+    void put     (unsigned char c) { buf[buf_size++] = c; if (buf_size == buf_cap) handOver(); }
+    void putLit  (Lit p)           { unsigned x = toInt(p) + 2; while (x > 127){ put((x & 127) | 128); x >>= 7; } put(x); }
+    void handOver();
+    void waitWritten();
+    void run     ();
+
+    static void* runThread(void* writer);
+
+    // Don't allow copying:
+    DratWriter(const DratWriter&);
+    DratWriter& operator=(const DratWriter&);
+};
+
+//=================================================================================================
+}
+
+#endif
@@ -0,0 +1,79 @@
+/* Copyright (c) 2015 Radek Micek */
+
+#ifndef Minisat_Progress_h
+#define Minisat_Progress_h
+
+#include "minisat/mtl/IntTypes.h"
+
+namespace Minisat {
+
+//=================================================================================================
+// ProgressRing -- lock-free ring buffer of progress snapshots:
+//
+// The search thread publishes snapshots and another thread reads them without stopping the search.
+// Each slot is guarded by a sequence number which is odd while the slot is being written, so the
+// reader skips snapshots which were overwritten while it was copying them. When the reader
+// doesn't keep up the oldest snapshots are lost.
+
+struct ProgressSnapshot {
+    uint64_t conflicts;
+    uint64_t decisions;
+    uint64_t depth;
+};
+
+class ProgressRing {
+public:
+    enum { capacity = 64 };
+    enum { interval = 256 };        // The solver publishes a snapshot after this many conflicts.
+
+    ProgressRing() : head(0), tail(0) { for (int i = 0; i < capacity; i++) slots[i].seq = 0; }
+
+    // Called only by the search thread.
+    void publish(uint64_t conflicts, uint64_t decisions, uint64_t depth) {
+        uint64_t i = __atomic_load_n(&head, __ATOMIC_RELAXED);
+        Slot&    s = slots[i % capacity];
+        __atomic_store_n(&s.seq, 2*i + 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        __atomic_store_n(&s.snap.conflicts, conflicts, __ATOMIC_RELAXED);
+        __atomic_store_n(&s.snap.decisions, decisions, __ATOMIC_RELAXED);
+        __atomic_store_n(&s.snap.depth,     depth,     __ATOMIC_RELAXED);
+        __atomic_store_n(&s.seq, 2*i + 2, __ATOMIC_RELEASE);
+        __atomic_store_n(&head, i + 1, __ATOMIC_RELEASE); }
+
+    // Called only by the reader. Copies the snapshots published since the previous call
+    // (oldest first, at most 'capacity') to 'out' and returns their number.
+    int poll(ProgressSnapshot* out) {
+        uint64_t h = __atomic_load_n(&head, __ATOMIC_ACQUIRE);
+        if (h - tail > capacity) tail = h - capacity;
+        int n = 0;
+        for (; tail < h; tail++){
+            Slot&            s   = slots[tail % capacity];
+            uint64_t         seq = __atomic_load_n(&s.seq, __ATOMIC_ACQUIRE);
+            ProgressSnapshot snap;
+            snap.conflicts = __atomic_load_n(&s.snap.conflicts, __ATOMIC_RELAXED);
+            snap.decisions = __atomic_load_n(&s.snap.decisions, __ATOMIC_RELAXED);
+            snap.depth     = __atomic_load_n(&s.snap.depth,     __ATOMIC_RELAXED);
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (seq == 2*tail + 2 && __atomic_load_n(&s.seq, __ATOMIC_RELAXED) == seq)
+                out[n++] = snap; }
+        return n; }
+
+private:
+    struct Slot {
+        uint64_t         seq;
+        ProgressSnapshot snap;
+    };
+
+    Slot     slots[capacity];
+    uint64_t head;                  // Number of published snapshots.
+    uint64_t tail;                  // Number of snapshots seen by the reader.
+
+    // Don't allow copying:
+    ProgressRing(const ProgressRing&);
+    ProgressRing& operator=(const ProgressRing&);
+};
+
+//=================================================================================================
+}
+
+#endif
@@ -95,6 +95,8 @@ let with_db ?mode file f =
   BatPervasives.with_dispose
     ~dispose:(Sqlite3.db_close %> expect "with_db" true)
     (fun db ->
+      (* Solvers may write to the report at the same time. *)
+      Sqlite3.busy_timeout db (60 * 1000);
       exec db "PRAGMA foreign_keys = ON";
       exec db "BEGIN";
       let x = f db in
@@ -134,6 +136,12 @@ module D = struct
 
   let to_opt_int = lift_to to_int
 
+  (* SQLite returns integers for REAL columns when the value is integral. *)
+  let to_float = function
+    | FLOAT f -> f
+    | INT i -> Int64.to_float i
+    | _ -> failwith "to_float"
+
 end
 
 (* ************************************************************************ *)
@@ -159,7 +167,7 @@ let sql_create_schema = "
   CREATE TABLE result (
     config_name  TEXT  NOT NULL,
     problem      TEXT  NOT NULL,
-    time         INT   NOT NULL,
+    time_ms      INT   NOT NULL,
     mem_peak     INT   NOT NULL,
     exit_status  TEXT  NOT NULL,
     model_size   INT   NULL,
@@ -170,9 +178,78 @@ let sql_create_schema = "
   )
 "
 
+(* Statistics of CryptoMiniSat written by crossbow --solver-stats.
+   Crossbow creates these tables too so they must be same
+   as in cmsat/sqlitestats.cpp.
+*)
+let sql_create_solver_stats_schema = "
+  CREATE TABLE IF NOT EXISTS solver_stats (
+    config_name   TEXT  NOT NULL,
+    problem       TEXT  NOT NULL,
+    run_id        INT   NOT NULL,
+    solve_call    INT   NOT NULL,
+    max_size      INT   NULL,
+    status        TEXT  NOT NULL,
+    search_time   REAL  NOT NULL,
+    conflicts     INT   NOT NULL,
+    decisions     INT   NOT NULL,
+    propagations  INT   NOT NULL,
+    restarts      INT   NOT NULL,
+    reduce_dbs    INT   NOT NULL,
+    learnt_units  INT   NOT NULL,
+    learnt_bins   INT   NOT NULL,
+    learnt_tris   INT   NOT NULL,
+    learnt_longs  INT   NOT NULL,
+    CONSTRAINT PK_solver_stats
+      PRIMARY KEY (config_name, problem, run_id, solve_call)
+  );
+
+  CREATE TABLE IF NOT EXISTS solver_glue (
+    config_name   TEXT  NOT NULL,
+    problem       TEXT  NOT NULL,
+    run_id        INT   NOT NULL,
+    solve_call    INT   NOT NULL,
+    glue          INT   NOT NULL,
+    clauses       INT   NOT NULL,
+    CONSTRAINT PK_solver_glue
+      PRIMARY KEY (config_name, problem, run_id, solve_call, glue)
+  );
+
+  CREATE TABLE IF NOT EXISTS solver_phase (
+    config_name   TEXT  NOT NULL,
+    problem       TEXT  NOT NULL,
+    run_id        INT   NOT NULL,
+    solve_call    INT   NOT NULL,
+    phase         TEXT  NOT NULL,
+    calls         INT   NOT NULL,
+    time          REAL  NOT NULL,
+    time_outs     INT   NOT NULL,
+    CONSTRAINT PK_solver_phase
+      PRIMARY KEY (config_name, problem, run_id, solve_call, phase)
+  )
+"
+
+(* Older reports store whole seconds in the column time of the table result.
+   Renames the column to time_ms and converts the values to milliseconds.
+*)
+let migrate_schema db =
+  let has_time_column =
+    query db "PRAGMA table_info(result)"
+    |> List.exists
+        (function
+          | _ :: name :: _ -> D.to_string name = "time"
+          | [] | [_] -> false) in
+  if has_time_column then begin
+    exec db "ALTER TABLE result RENAME COLUMN time TO time_ms";
+    exec db "UPDATE result SET time_ms = time_ms * 1000"
+  end
+
 let create_schema_if_not_exists db =
   if not (has_schema db) then
     exec db sql_create_schema
+  else
+    migrate_schema db;
+  exec db sql_create_solver_stats_schema
 
 
 module Config = struct
@@ -266,7 +343,7 @@ module Result = struct
 
   type t = {
     problem : string;
-    time : int;
+    time_ms : int;
     mem_peak : int;
     exit_status : exit_status;
     model_size : int option;
@@ -293,31 +370,36 @@ module Result = struct
       | None -> failwith "check_config_exists"
       | Some _ -> ()
 
-  let insert report config_name res =
+  let insert_list report config_name results =
     let sql = "
       INSERT INTO result
-        (config_name, problem, time, mem_peak, exit_status, model_size)
+        (config_name, problem, time_ms, mem_peak, exit_status, model_size)
       VALUES (?, ?, ?, ?, ?, ?)
     " in
     with_db report
       (fun db ->
-        exec_first db
-          ~data:[
-            D.of_string config_name;
-            D.of_string res.problem;
-            D.of_int res.time;
-            D.of_int res.mem_peak;
-            D.of_sexp (sexp_of_exit_status res.exit_status);
-            D.of_opt_int res.model_size;
-          ]
-          sql)
+        List.iter
+          (fun res ->
+            exec_first db
+              ~data:[
+                D.of_string config_name;
+                D.of_string res.problem;
+                D.of_int res.time_ms;
+                D.of_int res.mem_peak;
+                D.of_sexp (sexp_of_exit_status res.exit_status);
+                D.of_opt_int res.model_size;
+              ]
+              sql)
+          results)
+
+  let insert report config_name res = insert_list report config_name [res]
 
   let result_of_row row =
     match row with
-      | [problem; time; mem_peak; exit_status; model_size] ->
+      | [problem; time_ms; mem_peak; exit_status; model_size] ->
           {
             problem = D.to_string problem;
-            time = D.to_int time;
+            time_ms = D.to_int time_ms;
             mem_peak = D.to_int mem_peak;
             exit_status = D.to_sexp exit_status |> exit_status_of_sexp;
             model_size = D.to_opt_int model_size;
@@ -327,7 +409,7 @@ module Result = struct
   let get' db config_name problem =
     check_config_exists db config_name;
     let sql = "
-      SELECT problem, time, mem_peak, exit_status, model_size FROM result
+      SELECT problem, time_ms, mem_peak, exit_status, model_size FROM result
       WHERE config_name = ? AND problem = ?
     " in
     let rows =
@@ -346,13 +428,129 @@ module Result = struct
 
   let list report config_name =
     let sql = "
-      SELECT problem, time, mem_peak, exit_status, model_size FROM result
+      SELECT problem, time_ms, mem_peak, exit_status, model_size FROM result
       WHERE config_name = ? ORDER BY problem
     " in
     with_db report
       (fun db ->
         check_config_exists db config_name;
+        migrate_schema db;
         query_first db ~data:[D.of_string config_name] sql
         |> BatList.map result_of_row)
 
 end
+
+
+module Solver_stats = struct
+
+  type status =
+    | Sat
+    | Unsat
+    | Unknown
+
+  type t = {
+    problem : string;
+    run_id : int;
+    solve_call : int;
+    max_size : int option;
+    status : status;
+    search_time : float;
+    conflicts : int;
+    decisions : int;
+    propagations : int;
+    restarts : int;
+    reduce_dbs : int;
+    learnts : int;
+    glues : (int * int) list;
+    phases : (string * float) list;
+  }
+
+  let status_of_string = function
+    | "sat" -> Sat
+    | "unsat" -> Unsat
+    | "unknown" -> Unknown
+    | _ -> failwith "status_of_string"
+
+  let has_solver_stats db =
+    let sql = "
+      SELECT COUNT(*) FROM sqlite_master
+      WHERE type = 'table' AND name = 'solver_stats'
+    " in
+    query db sql = [[D.of_int 1]]
+
+  (* Rows of [sql] grouped by the first three columns
+     (problem, run_id, solve_call).
+  *)
+  let group_by_call db config_name sql row_to_item =
+    let groups = Hashtbl.create 100 in
+    query_first db ~data:[D.of_string config_name] sql
+    |> List.iter
+        (function
+          | problem :: run_id :: solve_call :: row ->
+              let key =
+                D.to_string problem, D.to_int run_id, D.to_int solve_call in
+              let items = try Hashtbl.find groups key with Not_found -> [] in
+              Hashtbl.replace groups key (row_to_item row :: items)
+          | _ -> failwith "group_by_call");
+    fun key -> try List.rev (Hashtbl.find groups key) with Not_found -> []
+
+  let list report config_name =
+    let sql = "
+      SELECT problem, run_id, solve_call, max_size, status, search_time,
+        conflicts, decisions, propagations, restarts, reduce_dbs,
+        learnt_units + learnt_bins + learnt_tris + learnt_longs
+      FROM solver_stats
+      WHERE config_name = ? ORDER BY problem, run_id, solve_call
+    " in
+    let sql_glues = "
+      SELECT problem, run_id, solve_call, glue, clauses FROM solver_glue
+      WHERE config_name = ? ORDER BY glue
+    " in
+    let sql_phases = "
+      SELECT problem, run_id, solve_call, phase, time FROM solver_phase
+      WHERE config_name = ? ORDER BY phase
+    " in
+    with_db report
+      (fun db ->
+        if not (has_solver_stats db) then
+          []
+        else
+          let glues =
+            group_by_call db config_name sql_glues
+              (function
+                | [glue; clauses] -> D.to_int glue, D.to_int clauses
+                | _ -> failwith "list") in
+          let phases =
+            group_by_call db config_name sql_phases
+              (function
+                | [phase; time] -> D.to_string phase, D.to_float time
+                | _ -> failwith "list") in
+          query_first db ~data:[D.of_string config_name] sql
+          |> BatList.map
+              (function
+                | [problem; run_id; solve_call; max_size; status;
+                   search_time; conflicts; decisions; propagations;
+                   restarts; reduce_dbs; learnts] ->
+                    let key =
+                      D.to_string problem,
+                      D.to_int run_id,
+                      D.to_int solve_call in
+                    {
+                      problem = D.to_string problem;
+                      run_id = D.to_int run_id;
+                      solve_call = D.to_int solve_call;
+                      max_size = D.to_opt_int max_size;
+                      status = D.to_string status |> status_of_string;
+                      search_time = D.to_float search_time;
+                      conflicts = D.to_int conflicts;
+                      decisions = D.to_int decisions;
+                      propagations = D.to_int propagations;
+                      restarts = D.to_int restarts;
+                      reduce_dbs = D.to_int reduce_dbs;
+                      learnts = D.to_int learnts;
+                      glues = glues key;
+                      phases = phases key;
+                    }
+                | _ -> failwith "list"))
+
+end
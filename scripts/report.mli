@@ -17,7 +17,8 @@ module Config : sig
      is in the report [report].
 
      The report [report] will be created if it doesn't exist or
-     if it's an empty file.
+     if it's an empty file. A report from older versions of the scripts
+     with whole seconds in the column [time] is migrated to [time_ms].
 
      Raises [Failure] if [report] contains a different configuration
      with the same name as [config].
@@ -52,8 +53,8 @@ module Result : sig
 
   type t = {
     problem : string;
-    time : int;
-    (** In seconds. *)
+    time_ms : int;
+    (** CPU time in milliseconds. *)
     mem_peak : int;
     (** In mebibytes. *)
     exit_status : exit_status;
@@ -73,6 +74,15 @@ module Result : sig
   *)
   val insert : string -> string -> t -> unit
 
+  (** [insert_list report config_name results] inserts the results
+     [results] to the configuration named [config_name]
+     in one transaction.
+
+     Raises [Sqlite3.Error] if the report doesn't exist.
+     Raises [Failure] if the configuration doesn't exist.
+  *)
+  val insert_list : string -> string -> t list -> unit
+
   (** [get report config_name prob] returns a result for the problem [prob]
      from the configuration named [config_name].
 
@@ -90,3 +100,52 @@ module Result : sig
   val list : string -> string -> t list
 
 end
+
+
+(** Statistics of CryptoMiniSat written by [crossbow --solver-stats]
+   to the report. Each item contains statistics of one call
+   of the solver (i.e. one domain size).
+*)
+module Solver_stats : sig
+
+  type status =
+    | Sat
+    | Unsat
+    | Unknown
+    (** The solver was interrupted. *)
+
+  type t = {
+    problem : string;
+    run_id : int;
+    (** Random identifier of the solver instance. Problems split
+       into more components have more instances.
+    *)
+    solve_call : int;
+    max_size : int option;
+    status : status;
+    search_time : float;
+    (** CPU time of the search without simplifications (in seconds). *)
+    conflicts : int;
+    decisions : int;
+    propagations : int;
+    restarts : int;
+    reduce_dbs : int;
+    (** Number of cleanings of learnt clauses. *)
+    learnts : int;
+    glues : (int * int) list;
+    (** Number of the long clauses with the given glue
+       learnt in the call. Glues above 30 are counted as 30.
+    *)
+    phases : (string * float) list;
+    (** CPU time spent in each simplification phase (in seconds). *)
+  }
+
+  (** [list report config_name] returns the statistics for
+     the configuration named [config_name] sorted by the problem.
+     Returns an empty list when the report contains no statistics.
+
+     Raises [Sqlite3.Error] if the report doesn't exist.
+  *)
+  val list : string -> string -> t list
+
+end
@@ -82,6 +82,7 @@ end
 
 module Cfg = Report.Config
 module Res = Report.Result
+module SS = Report.Solver_stats
 
 (** A problem is considered solved iff the model size is known
    and exit code is zero.
@@ -93,6 +94,21 @@ let is_solved r =
   r.Res.exit_status = Res.Exit_code 0 &&
   r.Res.model_size <> None
 
+(** Milliseconds formatted as seconds for the tables. *)
+let secs ms = sprintf "%.1f" (float ms /. 1000.)
+
+(** Problem name without directory and extension. *)
+let short_problem_name r =
+  let chop_ext name =
+    (* Filename.chop_extension raises Invalid_argument
+       if the name doesn't contain an extension.
+    *)
+    try Filename.chop_extension name
+    with Invalid_argument _ -> name in
+  r.Res.problem
+  |> Filename.basename
+  |> chop_ext
+
 type cfg_name = string
 
 type grp_name = string
@@ -227,7 +243,8 @@ let plot
 
   let graph_step = 10 in
   let count_solved_problems results time_secs =
-    let is_solved_in_time r = is_solved r && r.Res.time < time_secs in
+    let is_solved_in_time r =
+      is_solved r && r.Res.time_ms < time_secs * 1000 in
     results
     |> List.filter is_solved_in_time
     |> List.length in
@@ -310,7 +327,7 @@ let table_times
   let nproblems = res_one |> List.hd |> snd |> List.length in
   let show_result best_time r =
     let detail =
-      let time = sprintf "time (s): %d" r.Res.time in
+      let time = sprintf "time (ms): %d" r.Res.time_ms in
       let mem_peak = sprintf "memory peak (MiB): %d" r.Res.mem_peak in
       let exit_status =
         sprintf "exit status: %s"
@@ -329,9 +346,10 @@ let table_times
         | Res.Out_of_time -> Latex.unimp label_out_of_time
         | Res.Out_of_memory -> Latex.unimp label_out_of_memory
         | Res.Exit_code 0 when is_solved r ->
-            if r.Res.time = best_time
-            then Latex.imp_int r.Res.time
-            else Latex.unimp_int r.Res.time
+            (* Times which are shown equal are all best. *)
+            if secs r.Res.time_ms = secs best_time
+            then Latex.imp (secs r.Res.time_ms)
+            else Latex.unimp (secs r.Res.time_ms)
         | Res.Exit_code _ -> Latex.unimp label_error in
     Latex.pdf_tooltip ~detail basic_info in
   let get_results_for_problem pr =
@@ -340,21 +358,10 @@ let table_times
       res_one in
   for pr = 0 to nproblems - 1 do
     let res_for_prob = get_results_for_problem pr in
-    let prob_name =
-      let chop_ext name =
-        (* Filename.chop_extension raises Invalid_argument
-           if the name doesn't contain an extension.
-        *)
-        try Filename.chop_extension name
-        with Invalid_argument _ -> name in
-      res_for_prob
-      |> List.hd
-      |> (fun r -> r.Res.problem)
-      |> Filename.basename
-      |> chop_ext in
+    let prob_name = short_problem_name (List.hd res_for_prob) in
     let best_time =
       res_for_prob
-      |> BatList.map (fun r -> if is_solved r then r.Res.time else max_int)
+      |> BatList.map (fun r -> if is_solved r then r.Res.time_ms else max_int)
       |> BatList.min in
     let row =
       Latex.unimp prob_name ::
@@ -524,16 +531,16 @@ let table_hypothesis_tests o (res_all : Res_all.t) =
     let signs =
       BatList.map2
         (fun r r2 ->
-          let t, t2 = r.Res.time, r2.Res.time in
+          let t, t2 = r.Res.time_ms, r2.Res.time_ms in
           (* Both configurations succeeded. *)
           if is_solved r && is_solved r2 then
             t - t2
           (* Only the first configuration succeeded. *)
           else if is_solved r then
             (* Since the second configuration failed it isn't known how
-               fast it is. It's only known that it uses t2 or more seconds.
+               fast it is. It's only known that it uses t2 or more milliseconds.
                So the first configuration can be proclaimed faster
-               than the second only when it uses less than t2 seconds
+               than the second only when it uses less than t2 milliseconds
                (otherwise it can be as fast as the second or even slower).
             *)
             if t < t2 then -1 else 0
@@ -578,6 +585,92 @@ let table_hypothesis_tests o (res_all : Res_all.t) =
 
   Latex.Table.footer o
 
+(** Correlates statistics of CryptoMiniSat with the results.
+   Configurations without statistics (i.e. not run
+   by [run_crossbow --solver-stats]) are skipped.
+
+Generates a table like this for each configuration:
+
+ Config  | Time  | Max.    | Con-    | Mprops | Mean  | Simpl.
+ name    | in s  | domain  | flicts  | per s  | glue  | time
+         |       | size    |         |        |       | in s
+---------------------------------------------------------------
+ Problem | time  | size    | count   | count  | glue  | time
+---------------------------------------------------------------
+
+where the statistics of all domain sizes are summed
+and the glue is the mean glue of the long clauses
+learnt by the solver.
+*)
+let tables_solver_stats
+    o
+    ~label_out_of_time
+    ~label_out_of_memory
+    ~label_error
+    ~labels_solver_stats
+    report
+    (res_all : Res_all.t) =
+
+  let show_time r =
+    match r.Res.exit_status with
+      | Res.Out_of_time -> Latex.unimp label_out_of_time
+      | Res.Out_of_memory -> Latex.unimp label_out_of_memory
+      | Res.Exit_code 0 when is_solved r -> Latex.unimp (secs r.Res.time_ms)
+      | Res.Exit_code _ -> Latex.unimp label_error in
+  let show_float f = Latex.unimp (sprintf "%.2f" f) in
+
+  let row r (stats : SS.t list) =
+    let sum f = List.fold_left (fun acc s -> acc + f s) 0 stats in
+    let sum_float f = List.fold_left (fun acc s -> acc +. f s) 0. stats in
+    let search_time = sum_float (fun s -> s.SS.search_time) in
+    let mprops_per_sec =
+      if search_time > 0.
+      then float (sum (fun s -> s.SS.propagations)) /. search_time /. 1e6
+      else 0. in
+    let glue_clauses =
+      sum (fun s -> List.fold_left (fun acc (_, n) -> acc + n) 0 s.SS.glues) in
+    let glue_sum =
+      sum
+        (fun s ->
+          List.fold_left (fun acc (glue, n) -> acc + glue * n) 0 s.SS.glues) in
+    let mean_glue =
+      if glue_clauses > 0
+      then float glue_sum /. float glue_clauses
+      else 0. in
+    let simpl_time =
+      sum_float
+        (fun s -> List.fold_left (fun acc (_, t) -> acc +. t) 0. s.SS.phases) in
+    let max_size =
+      match BatList.filter_map (fun s -> s.SS.max_size) stats with
+        | [] -> Latex.unimp "?"
+        | sizes -> Latex.unimp_int (BatList.max sizes) in
+    [
+      Latex.unimp (short_problem_name r);
+      show_time r;
+      max_size;
+      Latex.unimp_int (sum (fun s -> s.SS.conflicts));
+      show_float mprops_per_sec;
+      show_float mean_glue;
+      show_float simpl_time;
+    ] in
+
+  Res_all.combine_results_for_all_groups res_all
+  |> List.iter
+      (fun (cfg_name, results) ->
+        let stats_by_problem = Hashtbl.create 100 in
+        SS.list report cfg_name
+        |> List.iter (fun s -> Hashtbl.add stats_by_problem s.SS.problem s);
+        if Hashtbl.length stats_by_problem > 0 then begin
+          Latex.Table.header o (cfg_name :: labels_solver_stats);
+          List.iter
+            (fun r ->
+              Hashtbl.find_all stats_by_problem r.Res.problem
+              |> row r
+              |> Latex.Table.row o)
+            results;
+          Latex.Table.footer o
+        end)
+
 (* ************************************************************************ *)
 (* Reading of input *)
 
@@ -706,6 +799,7 @@ type lang_data = {
   label_total : string;
   label_x : string;
   label_y : string;
+  labels_solver_stats : string list;
   caption_all_groups : string;
   caption_one_group : string -> string;
 }
@@ -719,6 +813,10 @@ let lang_en = {
   label_total = "Total";
   label_x = "Time (s)";
   label_y = "No. of solved problems";
+  labels_solver_stats = [
+    "Time (s)"; "Max. domain size"; "Conflicts"; "Mprops/s";
+    "Mean glue"; "Simpl. time (s)";
+  ];
   caption_all_groups = "All problem groups together";
   caption_one_group = sprintf "Problem group %s";
 }
@@ -732,6 +830,10 @@ let lang_cs = {
   label_total = "Celkem";
   label_x = "Čas (s)";
   label_y = "Počet vyřešených problémů";
+  labels_solver_stats = [
+    "Čas (s)"; "Max. velikost domény"; "Konflikty"; "Mprop./s";
+    "Průměrný glue"; "Čas zjednodušení (s)";
+  ];
   caption_all_groups = "Všechny skupiny problémů dohromady";
   caption_one_group = sprintf "Skupina problémů %s";
 }
@@ -745,6 +847,7 @@ type output_type =
   | Counts
   | Plots
   | Hypothesis_tests
+  | Solver_stats
 
 let main
     output_type
@@ -793,6 +896,15 @@ let main
               max_time
               res_all
         | Hypothesis_tests -> table_hypothesis_tests o res_all
+        | Solver_stats ->
+            tables_solver_stats
+              o
+              ~label_out_of_time:lang.label_out_of_time
+              ~label_out_of_memory:lang.label_out_of_memory
+              ~label_error:lang.label_error
+              ~labels_solver_stats:lang.labels_solver_stats
+              report
+              res_all
       end;
       Latex.Doc.footer o)
     output
@@ -803,12 +915,13 @@ module Term = Cmdliner.Term
 let output_type =
   let doc =
     "Which output is desired. " ^
-    "One of: times, counts, plots, hypothesis_tests" in
+    "One of: times, counts, plots, hypothesis_tests, solver_stats" in
   let types = [
     "times", Times;
     "counts", Counts;
     "plots", Plots;
     "hypothesis_tests", Hypothesis_tests;
+    "solver_stats", Solver_stats;
   ] in
   Arg.(required & pos 0 (some & enum types) None & info []
          ~docv:"OUTPUT-TYPE" ~doc)
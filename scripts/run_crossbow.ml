@@ -10,19 +10,24 @@ let main
     (* Required command-line arguments. *)
     report config_name problems out_dir
     (* Optional command-line arguments. *)
-    exe opts max_time max_mem =
-  let each_problem file =
+    exe solver_stats opts max_time max_mem jobs =
+  let each_problem job file =
     let model_file =
       Shared.file_in_dir out_dir (Shared.file_name file ^ ".m.mod") in
     let args =
       Array.concat
         [
           Array.of_list opts;
+          (* Statistics are written to the report itself. *)
+          (if solver_stats then
+             [| "--solver-stats"; report;
+                "--solver-stats-config"; config_name |]
+           else [| |]);
           [| "--output-file"; model_file |];
           [| file |];
         ] in
-    let time, mem_peak, exit_status =
-      RS.run_solver max_time max_mem exe args in
+    let time_ms, mem_peak, exit_status =
+      RS.run_solver job max_time max_mem exe args in
     let model_size =
       match exit_status with
         | R.Exit_code _ when Sys.file_exists model_file ->
@@ -40,10 +45,10 @@ let main
         | R.Out_of_time
         | R.Out_of_memory
         | R.Exit_code _ -> None in
-    { R.problem = file; R.time; R.mem_peak; R.exit_status; R.model_size } in
+    { R.problem = file; R.time_ms; R.mem_peak; R.exit_status; R.model_size } in
 
   RS.shared_main report config_name "crossbow"
-    opts max_time max_mem
+    opts max_time max_mem jobs
     problems each_problem
 
 let exe =
@@ -51,9 +56,16 @@ let exe =
   Arg.(value & opt string (Shared.file_in_program_dir "crossbow") &
          info ["exe"] ~docv:"FILE" ~doc)
 
+let solver_stats =
+  let doc =
+    "Store statistics of CryptoMiniSat for each problem and domain size " ^
+    "in the report. Crossbow must be compiled with SQLite support." in
+  Arg.(value & flag & info ["solver-stats"] ~doc)
+
 let main_t =
   Term.(pure main $ RS.report $ RS.config_name $ RS.problems $ RS.out_dir $
-          exe $ RS.opts $ RS.max_time $ RS.max_mem)
+          exe $ solver_stats $ RS.opts $ RS.max_time $ RS.max_mem $
+          RS.jobs)
 
 let info =
   Term.info "run_crossbow" ~version:RS.version
@@ -12,9 +12,9 @@ let main
     (* Required command-line arguments. *)
     report config_name problems out_dir
     (* Optional command-line arguments. *)
-    exe tptp_to_ladr_exe base_dir opts max_time max_mem =
+    exe tptp_to_ladr_exe base_dir opts max_time max_mem jobs =
 
-  let each_problem file =
+  let each_problem job file =
     (* Convert from TPTP to LADR. *)
     let in_tptp = BatFile.with_temporary_out (fun _ name -> name) in
     Tptp.File.write in_tptp (Tptp.File.read ~base_dir file);
@@ -43,7 +43,7 @@ let main
         ] in
     let output_file =
       Shared.file_in_dir out_dir (Shared.file_name file ^ ".out") in
-    let time, mem_peak, exit_status =
+    let time_ms, mem_peak, exit_status =
       BatPervasives.with_dispose
         ~dispose:close_in
         (fun inp ->
@@ -51,7 +51,7 @@ let main
             ~dispose:close_out
             (fun out ->
               RS.run_solver_ex
-                max_time max_mem exe args
+                job max_time max_mem exe args
                 (Unix.descr_of_in_channel inp)
                 (Unix.descr_of_out_channel out)
                 (Unix.descr_of_out_channel stderr))
@@ -84,10 +84,10 @@ let main
         | R.Out_of_time
         | R.Out_of_memory
         | R.Exit_code _ -> None in
-    { R.problem = file; R.time; R.mem_peak; R.exit_status; R.model_size } in
+    { R.problem = file; R.time_ms; R.mem_peak; R.exit_status; R.model_size } in
 
   RS.shared_main report config_name "mace4"
-    opts max_time max_mem
+    opts max_time max_mem jobs
     problems each_problem
 
 let exe =
@@ -107,7 +107,8 @@ let base_dir =
 let main_t =
   Term.(pure main $ RS.report $ RS.config_name $ RS.problems $ RS.out_dir $
           exe $ tptp_to_ladr_exe $ base_dir $
-          RS.opts $ RS.max_time $ RS.max_mem)
+          RS.opts $ RS.max_time $ RS.max_mem $
+          RS.jobs)
 
 let info =
   Term.info "run_mace4" ~version:RS.version
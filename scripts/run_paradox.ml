@@ -10,8 +10,8 @@ let main
     (* Required command-line arguments. *)
     report config_name problems out_dir
     (* Optional command-line arguments. *)
-    exe opts max_time max_mem =
-  let each_problem file =
+    exe opts max_time max_mem jobs =
+  let each_problem job file =
     let output_file =
       Shared.file_in_dir out_dir (Shared.file_name file ^ ".out") in
     let args =
@@ -21,12 +21,12 @@ let main
           [| "--tstp"; "--model" |];
           [| file |];
         ] in
-    let time, mem_peak, exit_status =
+    let time_ms, mem_peak, exit_status =
       BatPervasives.with_dispose
         ~dispose:close_out
         (fun out ->
           RS.run_solver_ex
-            max_time max_mem exe args
+            job max_time max_mem exe args
             (Unix.descr_of_in_channel stdin)
             (Unix.descr_of_out_channel out)
             (Unix.descr_of_out_channel stderr))
@@ -51,10 +51,10 @@ let main
         | R.Out_of_time
         | R.Out_of_memory
         | R.Exit_code _ -> None in
-    { R.problem = file; R.time; R.mem_peak; R.exit_status; R.model_size } in
+    { R.problem = file; R.time_ms; R.mem_peak; R.exit_status; R.model_size } in
 
   RS.shared_main report config_name "paradox"
-    opts max_time max_mem
+    opts max_time max_mem jobs
     problems each_problem
 
 let exe =
@@ -64,7 +64,8 @@ let exe =
 
 let main_t =
   Term.(pure main $ RS.report $ RS.config_name $ RS.problems $ RS.out_dir $
-          exe $ RS.opts $ RS.max_time $ RS.max_mem)
+          exe $ RS.opts $ RS.max_time $ RS.max_mem $
+          RS.jobs)
 
 let info =
   Term.info "run_paradox" ~version:RS.version
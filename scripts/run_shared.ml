@@ -6,9 +6,13 @@ module Term = Cmdliner.Term
 module Cfg = Report.Config
 module Res = Report.Result
 
+let print_banner () =
+  Printf.fprintf stderr "\n%s\n" (BatString.repeat " -" 39);
+  Printf.fprintf stderr "%s\n" (BatString.repeat "' " 39)
+
 let shared_main
     report config_name solver
-    opts max_time max_mem
+    opts max_time max_mem jobs
     problems f =
   BatOption.may
     (fun max_time ->
@@ -22,6 +26,9 @@ let shared_main
         failwith "invalid memory limit")
     max_mem;
 
+  if jobs < 1 then
+    failwith "invalid number of jobs";
+
   let problems = Shared.read_problems_of_file problems in
 
   Cfg.ensure report {
@@ -32,35 +39,92 @@ let shared_main
     Cfg.max_mem;
   };
 
+  (* Problems which are already in the report are skipped. *)
+  let solved = Hashtbl.create 1024 in
+  List.iter
+    (fun res -> Hashtbl.replace solved res.Res.problem ())
+    (Res.list report config_name);
+  let queue = Queue.create () in
   List.iter
     (fun file ->
-      Printf.fprintf stderr "\n%s\n" (BatString.repeat " -" 39);
-      Printf.fprintf stderr "%s\n" (BatString.repeat "' " 39);
-      if Res.get report config_name file = None then begin
-        Printf.fprintf stderr "Solving (%s): %s\n" config_name file;
-        flush stderr;
-        let res = f file in
-        Res.insert report config_name res;
-        Printf.fprintf stderr
-          "\nTIME (s): %d  MEM PEAK (MiB): %d  MODEL SIZE: %s\n"
-          res.Res.time
-          res.Res.mem_peak
-          (BatOption.map_default string_of_int "no model" res.Res.model_size);
-        Printf.fprintf stderr
-          "EXIT: %s\n"
-          (match res.Res.exit_status with
-            | Res.Out_of_time -> "out of time"
-            | Res.Out_of_memory -> "out of memory"
-            | Res.Exit_code i -> string_of_int i);
-        flush stderr
-      end else begin
+      if Hashtbl.mem solved file then begin
+        print_banner ();
         Printf.fprintf stderr "Skipping (%s): %s\n" config_name file;
         flush stderr
-      end)
-    problems
+      end else
+        Queue.add file queue)
+    problems;
+
+  (* Protects [queue], [results], [error] and [stderr]. *)
+  let lock = Mutex.create () in
+  let with_lock f =
+    Mutex.lock lock;
+    BatPervasives.finally (fun () -> Mutex.unlock lock) f () in
+  (* Results which haven't been inserted to the report yet. *)
+  let results = ref [] in
+  let error = ref None in
+  (* The batch is cleared before inserting so a failed batch
+     isn't inserted again.
+  *)
+  let insert_results () =
+    let batch = List.rev !results in
+    results := [];
+    if batch <> [] then
+      Res.insert_list report config_name batch in
+
+  let rec worker job =
+    let next =
+      with_lock (fun () ->
+        if !error <> None || Queue.is_empty queue
+        then None
+        else Some (Queue.pop queue)) in
+    match next with
+      | None -> ()
+      | Some file ->
+          with_lock (fun () ->
+            print_banner ();
+            Printf.fprintf stderr "Solving (%s): %s\n" config_name file;
+            flush stderr);
+          match (try `Result (f job file) with e -> `Error e) with
+            | `Error e ->
+                with_lock (fun () ->
+                  if !error = None then
+                    error := Some e)
+            | `Result res ->
+                with_lock (fun () ->
+                  Printf.fprintf stderr
+                    "\n%s\nTIME (ms): %d  MEM PEAK (MiB): %d  MODEL SIZE: %s\n"
+                    file
+                    res.Res.time_ms
+                    res.Res.mem_peak
+                    (BatOption.map_default
+                       string_of_int "no model" res.Res.model_size);
+                  Printf.fprintf stderr
+                    "EXIT: %s\n"
+                    (match res.Res.exit_status with
+                      | Res.Out_of_time -> "out of time"
+                      | Res.Out_of_memory -> "out of memory"
+                      | Res.Exit_code i -> string_of_int i);
+                  flush stderr;
+                  (* Results are inserted in batches so the jobs
+                     don't wait for the report too often.
+                  *)
+                  results := res :: !results;
+                  if List.length !results >= jobs then
+                    try insert_results ()
+                    with e -> if !error = None then error := Some e);
+                worker job in
+
+  BatList.init jobs (fun job -> Thread.create worker job)
+  |> List.iter Thread.join;
+  (* The first error is reported even when inserting fails. *)
+  begin try insert_results ()
+  with e -> if !error = None then error := Some e
+  end;
+  BatOption.may raise !error
 
 let run_solver_ex
-    max_time max_mem solver args
+    job max_time max_mem solver args
     new_stdin new_stdout new_stderr =
 
   let cgroup = "/crossbow-prover" in
@@ -69,13 +133,14 @@ let run_solver_ex
     (args |> Array.to_list |> String.concat " ");
   flush stderr;
   Shared.run_with_limits
+    ~job
     cgroup max_time max_mem
     solver args
     new_stdin new_stdout new_stderr
 
-let run_solver max_time max_mem solver args =
+let run_solver job max_time max_mem solver args =
   run_solver_ex
-    max_time max_mem solver args
+    job max_time max_mem solver args
     (Unix.descr_of_in_channel stdin)
     (Unix.descr_of_out_channel stdout)
     (Unix.descr_of_out_channel stderr)
@@ -94,6 +159,13 @@ let max_mem =
   Arg.(value & opt (some int) None &
          info ["max-mem"] ~docv:"MAX-MEM" ~doc)
 
+let jobs =
+  let doc =
+    "Number of problems solved in parallel. Each job has its own " ^
+    "control group. Output of the solvers running in parallel " ^
+    "is interleaved." in
+  Arg.(value & opt int 1 & info ["jobs"] ~docv:"N" ~doc)
+
 let report =
   let doc =
     "Report where the results will be stored. Report is a SQLite database." in
@@ -48,6 +48,9 @@ let file_in_program_dir file =
   |> Path.map_name (fun _ -> file)
   |> Path.to_ustring
 
+(* Mount point of the cgroup file system. *)
+let cgroup_base = "/sys/fs/cgroup/"
+
 module Cg = struct
 
   (* Resource controllers aka subsystems. *)
@@ -160,6 +163,14 @@ module Cg = struct
       |]
     |> ignore
 
+  (* Reads the parameter [p] directly from the cgroup file system.
+     It's much cheaper than [get] which runs an executable.
+  *)
+  let read cg p =
+    let ctrl = BatString.split p "." |> fst in
+    BatFile.with_file_in (cgroup_base ^ ctrl ^ cg ^ "/" ^ p)
+      (BatIO.read_line %> BatString.trim %> int_of_string)
+
   let set_and_verify cg p v =
     set cg p v;
     let real_v = get cg p in
@@ -189,7 +200,7 @@ let div_ceil x y =
   then x / y
   else x / y + 1
 
-let s_of_ns ns = div_ceil ns (1000 * 1000 * 1000)
+let ms_of_ns ns = div_ceil ns (1000 * 1000)
 
 let mib_to_b mib = mib * (1024 * 1024)
 let mib_of_b b = div_ceil b (1024 * 1024)
@@ -225,20 +236,22 @@ module Cg_stats = struct
     check_zero Mem.Memsw.max_usage_in_bytes
 
   let read cg =
-    let cpu_usage = Cg.get cg Cpu.usage in
+    let cpu_usage = Cg.read cg Cpu.usage in
 
-    let mem_failcnt = Cg.get cg Mem.Memsw.failcnt in
-    let mem_max_usage = Cg.get cg Mem.Memsw.max_usage_in_bytes in
+    let mem_failcnt = Cg.read cg Mem.Memsw.failcnt in
+    let mem_max_usage = Cg.read cg Mem.Memsw.max_usage_in_bytes in
 
-    let time = cpu_usage |> s_of_ns in
+    let time_ms = cpu_usage |> ms_of_ns in
     let mem_peak = mem_max_usage |> mib_of_b in
     let mem_failure = mem_failcnt > 0 in
-    time, mem_peak, mem_failure
+    time_ms, mem_peak, mem_failure
 
 end
 
+(* Interval between two checks of a running process (in seconds). *)
+let poll_interval = 0.1
+
 let list_pids_in_cgroups controllers cg =
-  let cgroup_base = "/sys/fs/cgroup/" in
   let pid_of_string = int_of_string in
   controllers
   |> BatList.enum
@@ -264,17 +277,24 @@ let kill_all_in_cgroups controllers cg =
               (* The process with [pid] doesn't exist. *)
               with Unix.Unix_error (Unix.ESRCH, _, _) -> ())
             pids;
-          Unix.sleep 1;
+          Thread.delay poll_interval;
           loop () in
   loop ()
 
 let run_with_limits
+    ?(job = 0)
     cgroup max_time max_mem
     prog args
     new_stdin new_stdout new_stderr =
 
   let controllers = [Cg.Ctrl.Cpuacct.id; Cg.Ctrl.Memory.id] in
-  let cgroup = cgroup ^ "/crossbow-run_with_limits" in
+  let parent = cgroup ^ "/crossbow-run_with_limits" in
+  let cgroup = Printf.sprintf "%s/job-%d" parent job in
+
+  (* The parent is shared by the jobs running in parallel
+     so it isn't deleted. Creating existing cgroup is fine.
+  *)
+  Cg.create controllers parent;
 
   (* Delete cgroups. Deleting nonexistent cgroup results in error
      so cgroups are created before deletition.
@@ -285,7 +305,8 @@ let run_with_limits
   Cg.create controllers cgroup;
   Cg_stats.setup_cgroup cgroup ~max_mem;
 
-  let max_time = BatOption.default max_int max_time in
+  let max_time_ms =
+    BatOption.map_default (fun secs -> secs * 1000) max_int max_time in
   let max_mem = BatOption.default max_int max_mem in
 
   let pid =
@@ -294,10 +315,10 @@ let run_with_limits
       new_stdin new_stdout new_stderr in
 
   let rec wait () =
-    Unix.sleep 1;
+    Thread.delay poll_interval;
     let res, proc_status = Unix.waitpid [Unix.WNOHANG] pid in
     (* [Cg_stats.read] should be called after [Unix.waitpid]. *)
-    let time, mem_peak, mem_failure = Cg_stats.read cgroup in
+    let time_ms, mem_peak, mem_failure = Cg_stats.read cgroup in
 
     if res = -1 then
       failwith "run_with_limits: error when waiting"
@@ -305,7 +326,7 @@ let run_with_limits
     (* The process hasn't terminated yet. *)
     else if res = 0 then begin
       (* Kill the process if the time limit is exceeded. *)
-      if time > max_time then begin
+      if time_ms > max_time_ms then begin
         try
           Unix.kill pid Sys.sigkill
         (* The process with [pid] doesn't exist. *)
@@ -320,7 +341,7 @@ let run_with_limits
           failwith "run_with_limits: memory limit exceeded - impossible";
         match proc_status with
           | Unix.WSIGNALED i when i = Sys.sigkill ->
-              if time > max_time then
+              if time_ms > max_time_ms then
                 Report.Result.Out_of_time
               else if mem_failure then
                 Report.Result.Out_of_memory
@@ -337,11 +358,11 @@ let run_with_limits
               (* The time limit has been exceeded but the process terminated
                  before [run_with_limits] managed to kill it.
               *)
-              if time > max_time then
+              if time_ms > max_time_ms then
                 Report.Result.Out_of_time
               else
                 Report.Result.Exit_code code in
-      time, mem_peak, exit_status in
+      time_ms, mem_peak, exit_status in
 
   let res = wait () in
 
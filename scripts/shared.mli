@@ -19,20 +19,24 @@ val file_in_dir : string -> string -> string
 *)
 val file_in_program_dir : string -> string
 
-(** [run_with_limits cgroup max_time max_mem prog args
+(** [run_with_limits ~job cgroup max_time max_mem prog args
    new_stdin new_stdout new_stderr] executes a program in file [prog]
    with arguments [args], CPU time limit [max_time] (in seconds)
    and memory limit [max_mem] (in mebibytes).
 
    [cgroup] is a relative path to control groups in [cpuacct] controller
-   and [memory] controller.
+   and [memory] controller. The program runs in the subgroup
+   [crossbow-run_with_limits/job-<job>] of [cgroup] so programs
+   with different [job] (by default [0]) can run in parallel.
+   The state of the program is checked 10 times per second.
 
-   Returns [(time, mem_peak, exit_status)].
-   [time] is the number of CPU seconds consumed by [prog].
+   Returns [(time_ms, mem_peak, exit_status)].
+   [time_ms] is the CPU time in milliseconds consumed by [prog].
    [mem_peak] is the maximal amount of memory (in mebibytes)
    which was allocated by the program and its children.
 *)
 val run_with_limits :
+  ?job:int ->
   string -> int option -> int option ->
   string -> string array ->
   Unix.file_descr -> Unix.file_descr -> Unix.file_descr ->
@@ -4,6 +4,7 @@ open OUnit2
 
 module Cfg = Report.Config
 module Res = Report.Result
+module SS = Report.Solver_stats
 
 let assert_raises_failure f =
   try
@@ -63,7 +64,7 @@ let test_config test_ctx =
 
 let result_monoid = {
   Res.problem = "monoid";
-  Res.time = 5;
+  Res.time_ms = 5123;
   Res.mem_peak = 5000;
   Res.exit_status = Res.Exit_code 0;
   Res.model_size = Some 5;
@@ -71,7 +72,7 @@ let result_monoid = {
 
 let result_monoid2 = {
   Res.problem = "monoid";
-  Res.time = 25;
+  Res.time_ms = 25004;
   Res.mem_peak = 8000;
   Res.exit_status = Res.Exit_code 0;
   Res.model_size = None;
@@ -79,7 +80,7 @@ let result_monoid2 = {
 
 let result_loop = {
   Res.problem = "loop";
-  Res.time = 120;
+  Res.time_ms = 120001;
   Res.mem_peak = 9000;
   Res.exit_status = Res.Out_of_time;
   Res.model_size = None;
@@ -115,6 +116,25 @@ let test_result test_ctx =
       [result_monoid2]
       (Res.list r config2.Cfg.name))
 
+let test_result_insert_list test_ctx =
+  with_report (fun r ->
+    Cfg.ensure r config;
+
+    Res.insert_list r config.Cfg.name [];
+    Res.insert_list r config.Cfg.name [result_monoid; result_loop];
+    assert_equal
+      [result_loop; result_monoid]
+      (Res.list r config.Cfg.name);
+
+    (* Nothing is inserted when one result exists. *)
+    Cfg.ensure r config2;
+    Res.insert r config2.Cfg.name result_loop;
+    assert_raises_failure (fun () ->
+      Res.insert_list r config2.Cfg.name [result_monoid2; result_loop]);
+    assert_equal
+      [result_loop]
+      (Res.list r config2.Cfg.name))
+
 let test_result_functions_need_config_in_report test_ctx =
   with_report (fun r ->
     (* Create schema but don't insert config. *)
@@ -151,13 +171,111 @@ let test_report_created_only_by_ensure test_ctx =
     Cfg.ensure r config';
     assert_equal true (Sys.file_exists r))
 
+(* Inserts rows like crossbow --solver-stats. *)
+let insert_solver_stats r sql =
+  let db = Sqlite3.db_open r in
+  assert_equal Sqlite3.Rc.OK (Sqlite3.exec db sql);
+  assert_equal true (Sqlite3.db_close db)
+
+let test_solver_stats test_ctx =
+  with_report (fun r ->
+    Cfg.ensure r config;
+    assert_equal [] (SS.list r config.Cfg.name);
+
+    insert_solver_stats r "
+      INSERT INTO solver_stats VALUES
+        ('aa', 'monoid', 7, 1, 1, 'unsat', 0.5, 10, 20, 300, 1, 0, 1, 2, 3, 4),
+        ('aa', 'monoid', 7, 2, 2, 'sat', 1, 30, 40, 500, 2, 1, 0, 0, 0, 5),
+        ('bb', 'monoid', 8, 1, 1, 'unknown', 2.5, 1, 1, 1, 0, 0, 0, 0, 0, 0);
+      INSERT INTO solver_glue VALUES
+        ('aa', 'monoid', 7, 2, 4, 10),
+        ('aa', 'monoid', 7, 2, 2, 3);
+      INSERT INTO solver_phase VALUES
+        ('aa', 'monoid', 7, 1, 'probe', 2, 0.25, 1);
+    ";
+
+    let stats = {
+      SS.problem = "monoid";
+      SS.run_id = 7;
+      SS.solve_call = 1;
+      SS.max_size = Some 1;
+      SS.status = SS.Unsat;
+      SS.search_time = 0.5;
+      SS.conflicts = 10;
+      SS.decisions = 20;
+      SS.propagations = 300;
+      SS.restarts = 1;
+      SS.reduce_dbs = 0;
+      SS.learnts = 10;
+      SS.glues = [];
+      SS.phases = ["probe", 0.25];
+    } in
+    let stats2 = {
+      stats with
+        SS.solve_call = 2;
+        SS.max_size = Some 2;
+        SS.status = SS.Sat;
+        SS.search_time = 1.;
+        SS.conflicts = 30;
+        SS.decisions = 40;
+        SS.propagations = 500;
+        SS.restarts = 2;
+        SS.reduce_dbs = 1;
+        SS.learnts = 5;
+        SS.glues = [2, 3; 4, 10];
+        SS.phases = [];
+    } in
+    assert_equal [stats; stats2] (SS.list r config.Cfg.name))
+
+let test_old_report_migrated test_ctx =
+  with_report (fun r ->
+    (* Report with whole seconds in the column time. *)
+    let db = Sqlite3.db_open r in
+    assert_equal Sqlite3.Rc.OK (Sqlite3.exec db "
+      CREATE TABLE config (
+        config_name  TEXT  NOT NULL,
+        solver       TEXT  NOT NULL,
+        opts         TEXT  NOT NULL,
+        max_time     INT   NULL,
+        max_mem      INT   NULL,
+        CONSTRAINT PK_config PRIMARY KEY (config_name)
+      );
+      CREATE TABLE result (
+        config_name  TEXT  NOT NULL,
+        problem      TEXT  NOT NULL,
+        time         INT   NOT NULL,
+        mem_peak     INT   NOT NULL,
+        exit_status  TEXT  NOT NULL,
+        model_size   INT   NULL,
+        CONSTRAINT PK_result PRIMARY KEY (config_name, problem)
+      );
+      INSERT INTO config VALUES ('aa', 'solver', '(--opt)', 60, NULL);
+      INSERT INTO result VALUES ('aa', 'monoid', 25, 8000, '0', NULL);
+    ");
+    assert_equal true (Sqlite3.db_close db);
+
+    let config = {
+      config with
+        Cfg.opts = ["--opt"];
+        Cfg.max_time = Some 60;
+        Cfg.max_mem = None;
+    } in
+    let result = { result_monoid2 with Res.time_ms = 25000 } in
+    assert_equal [result] (Res.list r config.Cfg.name);
+    (* Migrated only once. *)
+    Cfg.ensure r config;
+    assert_equal (Some result) (Res.get r config.Cfg.name "monoid"))
+
 let suite =
   "Report suite" >:::
     [
       "Config" >:: test_config;
       "Result" >:: test_result;
+      "Result.insert_list" >:: test_result_insert_list;
       "functions from Result raise if configuration doesn't exist" >::
         test_result_functions_need_config_in_report;
       "only Config.ensure creates report" >::
         test_report_created_only_by_ensure;
+      "Solver_stats" >:: test_solver_stats;
+      "old report migrated" >:: test_old_report_migrated;
     ]
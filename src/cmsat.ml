@@ -6,19 +6,157 @@ type var = int
 
 type lit = int
 
+type profile =
+  | Default
+  | Incremental
+  | Aggressive
+  | Low_memory
+
+type restart =
+  | Restart_glue
+  | Restart_glue_agility
+  | Restart_geom
+  | Restart_agility
+  | Restart_never
+  | Restart_auto
+
+type clean =
+  | Clean_glue
+  | Clean_size
+  | Clean_activity
+
+type config = {
+  profile : profile;
+  bva : bool option;
+  var_elim : bool option;
+  probe : bool option;
+  cache : bool option;
+  max_cache_size_mb : int option;
+  restart : restart option;
+  clean : clean option;
+  max_mem_mb : int option;
+  stats_db : string option;
+  proof : bool;
+}
+
+let default_config = {
+  profile = Default;
+  bva = None;
+  var_elim = None;
+  probe = None;
+  cache = None;
+  max_cache_size_mb = None;
+  restart = None;
+  clean = None;
+  max_mem_mb = None;
+  stats_db = None;
+  proof = false;
+}
+
+let profiles = [
+  "default", Default;
+  "incremental", Incremental;
+  "aggressive", Aggressive;
+  "low-memory", Low_memory;
+]
+
+let override config opt =
+  let key, v =
+    try BatString.split opt "="
+    with Not_found -> failwith ("Cmsat.override: missing value: " ^ opt) in
+  let parse_enum values =
+    try List.assoc v values
+    with Not_found ->
+      failwith (Printf.sprintf "Cmsat.override: invalid value for %s: %s"
+                  key v) in
+  let parse_bool () = parse_enum ["true", true; "false", false] in
+  let parse_int () =
+    try int_of_string v
+    with Failure _ ->
+      failwith (Printf.sprintf "Cmsat.override: invalid value for %s: %s"
+                  key v) in
+  let parse_int_at_least min =
+    let i = parse_int () in
+    if i < min then
+      failwith (Printf.sprintf "Cmsat.override: invalid value for %s: %s"
+                  key v);
+    i in
+  match key with
+    | "bva" -> { config with bva = Some (parse_bool ()) }
+    | "var-elim" -> { config with var_elim = Some (parse_bool ()) }
+    | "probe" -> { config with probe = Some (parse_bool ()) }
+    | "cache" -> { config with cache = Some (parse_bool ()) }
+    | "max-cache-size-mb" ->
+        { config with max_cache_size_mb = Some (parse_int_at_least 0) }
+    | "restart" ->
+        let restarts = [
+          "glue", Restart_glue;
+          "glue-agility", Restart_glue_agility;
+          "geom", Restart_geom;
+          "agility", Restart_agility;
+          "never", Restart_never;
+          "auto", Restart_auto;
+        ] in
+        { config with restart = Some (parse_enum restarts) }
+    | "clean" ->
+        let cleans = [
+          "glue", Clean_glue;
+          "size", Clean_size;
+          "activity", Clean_activity;
+        ] in
+        { config with clean = Some (parse_enum cleans) }
+    | "max-mem-mb" ->
+        { config with max_mem_mb = Some (parse_int_at_least 1) }
+    | _ -> failwith ("Cmsat.override: unknown option: " ^ key)
+
 external create : unit -> t = "cmsat_create"
 
+external create_with_config : config -> t = "cmsat_create_with_config"
+
 external new_var : t -> var = "cmsat_new_var"
 
 external add_clause : t -> (lit, [> `R]) Earray.t -> int -> bool =
   "cmsat_add_clause"
 
+external add_at_most_one_clause : t -> (lit, [> `R]) Earray.t -> bool =
+  "cmsat_add_at_most_one_clause"
+
 external solve : t -> (lit, [> `R]) Earray.t -> Sh.lbool = "cmsat_solve"
 
+external set_phase : t -> var -> bool -> unit = "cmsat_set_phase"
+
+external get_phase : t -> var -> bool = "cmsat_get_phase"
+
+external set_activity : t -> var -> float -> unit = "cmsat_set_activity"
+
+external get_activity : t -> var -> float = "cmsat_get_activity"
+
+external add_learnt : t -> (lit, [> `R]) Earray.t -> int -> bool =
+  "cmsat_add_learnt"
+
+external export_learnts : t -> int -> int -> (lit, [`R]) Earray.t list =
+  "cmsat_export_learnts"
+
+external set_frozen : t -> var -> bool -> unit = "cmsat_set_frozen"
+
 external model_value : t -> var -> Sh.lbool = "cmsat_model_value"
 
 external interrupt : t -> unit = "cmsat_interrupt"
 
+external clear_interrupt : t -> unit = "cmsat_clear_interrupt"
+
+external poll_progress : t -> Sh.progress list = "cmsat_poll_progress"
+
+external add_stats_tag : t -> string -> string -> unit =
+  "cmsat_add_stats_tag"
+
+external stats_supported : unit -> bool = "cmsat_stats_supported"
+
+external delete_stats : string -> string -> string -> unit =
+  "cmsat_delete_stats"
+
+external start_proof : t -> string -> unit = "cmsat_start_proof"
+
 let to_lit sign v = match sign with
   | Sh.Pos -> v + v
   | Sh.Neg -> v + v + 1
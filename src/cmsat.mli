@@ -9,9 +9,89 @@ type var = int
 
 type lit = private int
 
+(** Configuration profiles. *)
+type profile =
+  | Default
+  (** Default configuration of CryptoMiniSat. *)
+  | Incremental
+  (** Lightweight configuration for many incremental calls.
+     Simplifications whose results are invalidated by the clauses
+     added later (BVA, variable elimination, probing, implication cache)
+     are turned off.
+  *)
+  | Aggressive
+  (** Full inprocessing at each call to {!solve}. *)
+  | Low_memory
+  (** Smaller limits for the implication cache, occurrence lists
+     and learnt clauses.
+  *)
+
+type restart =
+  | Restart_glue
+  | Restart_glue_agility
+  | Restart_geom
+  | Restart_agility
+  | Restart_never
+  | Restart_auto
+
+(** Which learnt clauses are kept when the clause database is cleaned. *)
+type clean =
+  | Clean_glue
+  | Clean_size
+  | Clean_activity
+
+(** Profile and overrides of its individual fields.
+   [None] means that the value from the profile is used.
+*)
+type config = {
+  profile : profile;
+  bva : bool option;
+  var_elim : bool option;
+  probe : bool option;
+  cache : bool option;
+  max_cache_size_mb : int option;
+  restart : restart option;
+  clean : clean option;
+  max_mem_mb : int option;
+  stats_db : string option;
+  (** SQLite database where the statistics of each call to {!solve}
+     are written. Requires CryptoMiniSat compiled with SQLite support
+     (see README), otherwise {!create_with_config} raises [Failure].
+  *)
+  proof : bool;
+  (** Enables {!start_proof}. Bounded variable addition,
+     renumbering of variables, component handling and XOR finding
+     are disabled since they aren't written to the proof.
+  *)
+}
+
+(** Default profile without overrides. *)
+val default_config : config
+
+(** Names of the profiles. *)
+val profiles : (string * profile) list
+
+(** [override config "key=value"] sets the field [key] of [config].
+   Keys are: [bva], [var-elim], [probe], [cache] (values [true], [false]),
+   [max-cache-size-mb] (non-negative integer), [restart] (values [glue], [glue-agility],
+   [geom], [agility], [never], [auto]), [clean] (values [glue],
+   [size], [activity]) and [max-mem-mb] (positive integer).
+
+   When [max-mem-mb] is set and the memory used by the process
+   approaches it, the solver gradually turns off the implication cache,
+   stamping, occurrence based simplification and finally cleans
+   learnt clauses more often.
+
+   Raises [Failure] when the key or the value is invalid.
+*)
+val override : config -> string -> config
+
 (** Creates a new solver. *)
 external create : unit -> t = "cmsat_create"
 
+(** Creates a new solver with the given configuration. *)
+external create_with_config : config -> t = "cmsat_create_with_config"
+
 (** Creates a new variable. *)
 external new_var : t -> var = "cmsat_new_var"
 
@@ -21,15 +101,98 @@ external new_var : t -> var = "cmsat_new_var"
 external add_clause : t -> (lit, [> `R]) Earray.t -> int -> bool =
   "cmsat_add_clause"
 
+(** [add_at_most_one_clause s lits] adds the binary clause containing
+   the first two literals from [lits].
+   Cliques of such clauses are detected when the solver is started
+   and propagated as at-most-one constraints over the negated literals
+   instead of as binary clauses.
+*)
+external add_at_most_one_clause : t -> (lit, [> `R]) Earray.t -> bool =
+  "cmsat_add_at_most_one_clause"
+
 (** Starts the solver with the assumptions.
    All variables are assigned if the model is found.
 *)
 external solve : t -> (lit, [> `R]) Earray.t -> Sh.lbool = "cmsat_solve"
 
+(** Sets the preferred value of the variable for the decision heuristic.
+   The solver may change it later (e.g. by phase saving).
+*)
+external set_phase : t -> var -> bool -> unit = "cmsat_set_phase"
+
+(** Returns the preferred value of the variable. *)
+external get_phase : t -> var -> bool = "cmsat_get_phase"
+
+(** Sets the activity of the variable for the decision heuristic. *)
+external set_activity : t -> var -> float -> unit = "cmsat_set_activity"
+
+(** Returns the activity of the variable. *)
+external get_activity : t -> var -> float = "cmsat_get_activity"
+
+(** [add_learnt s lits n] adds the clause containing the first [n] literals
+   from [lits] as a learnt clause. The clause must be implied
+   by the clauses of the solver. Unlike {!add_clause} the clause
+   may be removed when the solver reduces its learnt clauses.
+   The clause is ignored when DRUP proof is being produced.
+*)
+external add_learnt : t -> (lit, [> `R]) Earray.t -> int -> bool =
+  "cmsat_add_learnt"
+
+(** [export_learnts s max_len max_glue] returns the learnt clauses
+   with at most [max_len] literals and glue at most [max_glue]
+   and the literals assigned at decision level 0 as unit clauses.
+   Equivalent literals are exported as pairs of binary clauses.
+   Clauses with variables introduced by BVA are not exported.
+*)
+external export_learnts : t -> int -> int -> (lit, [`R]) Earray.t list =
+  "cmsat_export_learnts"
+
+(** Frozen variables are never eliminated by the simplifier.
+   Variables which may appear in future clauses should be frozen,
+   otherwise they are uneliminated when they appear in a new clause
+   which is expensive.
+*)
+external set_frozen : t -> var -> bool -> unit = "cmsat_set_frozen"
+
 external model_value : t -> var -> Sh.lbool = "cmsat_model_value"
 
 external interrupt : t -> unit = "cmsat_interrupt"
 
+external clear_interrupt : t -> unit = "cmsat_clear_interrupt"
+
+external poll_progress : t -> Sh.progress list = "cmsat_poll_progress"
+
+(** [add_stats_tag s name tag] sets the tag [name] which is written
+   with the statistics to the database [stats_db].
+   The tags [config_name], [problem] and [max_size] identify
+   the rows of the statistics.
+*)
+external add_stats_tag : t -> string -> string -> unit =
+  "cmsat_add_stats_tag"
+
+(** Returns whether CryptoMiniSat was compiled with SQLite support
+   which is required by [stats_db].
+*)
+external stats_supported : unit -> bool = "cmsat_stats_supported"
+
+(** [delete_stats db config_name problem] deletes the statistics
+   tagged by [config_name] and [problem] from the database [db].
+   Statistics of the next run then replace those of the previous runs.
+
+   Raises [Failure] when the statistics can't be deleted
+   or when SQLite support is missing.
+*)
+external delete_stats : string -> string -> string -> unit =
+  "cmsat_delete_stats"
+
+(** [start_proof s prefix] finishes the current part of the proof
+   and starts a new part with the path prefix [prefix]
+   (see {!Sat_solver.proof_part}). The solver must be created
+   with [proof] set. Clauses added by {!add_learnt} are ignored
+   since they can't be derived in the proof.
+*)
+external start_proof : t -> string -> unit = "cmsat_start_proof"
+
 val to_lit : Sh.sign -> var -> lit
 
 val to_var : lit -> var
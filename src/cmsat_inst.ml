@@ -1,18 +1,43 @@
 (* Copyright (c) 2013 Radek Micek *)
 
+let config = ref Cmsat.default_config
+
+let stats_tags = ref []
+
+let proof_dir = ref None
+
 module Cmsat_ex : Sat_inst.Solver = struct
   include Cmsat
 
+  let start_proof s n =
+    BatOption.may
+      (fun dir -> Cmsat.start_proof s (Sat_solver.proof_part dir n))
+      !proof_dir
+
+  let create () =
+    let s =
+      Cmsat.create_with_config
+        { !config with Cmsat.proof = !proof_dir <> None } in
+    List.iter (fun (name, tag) -> Cmsat.add_stats_tag s name tag) !stats_tags;
+    start_proof s 0;
+    s
+
+  let set_max_size s n =
+    Cmsat.add_stats_tag s "max_size" (string_of_int n);
+    start_proof s n
+
   let new_false_var = Cmsat.new_var
 
   let add_symmetry_clause = Cmsat.add_clause
 
   let add_at_least_one_val_clause = Cmsat.add_clause
 
-  let add_at_most_one_val_clause s lits = Cmsat.add_clause s lits 2
+  let add_at_most_one_val_clause = Cmsat.add_at_most_one_clause
 
   let remove_clauses_with_lit s lit =
     ignore (Cmsat.add_clause s (Earray.singleton lit) 1)
+
+  let shared_totality_clauses = true
 end
 
 module Inst = Sat_inst.Make (Cmsat_ex)
@@ -2,6 +2,21 @@
 
 (** Instantiation for CryptoMiniSat. *)
 
+(** Configuration of the solvers created by {!Inst.create}. *)
+val config : Cmsat.config ref
+
+(** Tags of the statistics of the solvers created by {!Inst.create}
+   (see {!Cmsat.add_stats_tag}). The tag [max_size] is set
+   by the instantiation.
+*)
+val stats_tags : (string * string) list ref
+
+(** Directory where the solvers created by {!Inst.create} write
+   the proofs of unsatisfiability for each maximum domain size
+   (see {!Sat_solver.proof_part}). [None] means no proofs.
+*)
+val proof_dir : string option ref
+
 (** CryptoMiniSat solver. *)
 module Cmsat_ex : Sat_inst.Solver
 
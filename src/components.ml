@@ -0,0 +1,136 @@
+(* Copyright (c) 2015 Radek Micek *)
+
+module T = Term
+module L = Lit
+module C = Clause2
+
+type t = {
+  prob : [`R] Prob.t;
+  sorts : Sorts.t;
+}
+
+let symbs_in_clause cl =
+  let symbs = ref Symb.Set.empty in
+  List.iter
+    (fun (L.Lit (_, s, _) as lit) ->
+      if s <> Symb.sym_eq then
+        symbs := Symb.Set.add s !symbs;
+      L.iter
+        (function
+        | T.Var _ -> ()
+        | T.Func (f, _) -> symbs := Symb.Set.add f !symbs)
+        lit)
+    cl.C.cl_lits;
+  BatList.of_enum (Symb.Set.enum !symbs)
+
+let restrict_sorts sorts symbs =
+  let symb_sorts = Hashtbl.create (List.length symbs) in
+  List.iter
+    (fun s -> Hashtbl.add symb_sorts s (Hashtbl.find sorts.Sorts.symb_sorts s))
+    symbs;
+  {
+    Sorts.symb_sorts;
+    Sorts.var_sorts = sorts.Sorts.var_sorts;
+    Sorts.adeq_sizes = sorts.Sorts.adeq_sizes;
+    Sorts.consts =
+      Earray.map
+        (fun consts ->
+          Earray.read_only (Earray.filter (Hashtbl.mem symb_sorts) consts))
+        sorts.Sorts.consts;
+    Sorts.only_consts =
+      List.for_all
+        (fun s ->
+          let arity = Symb.arity s in
+          arity = 0 ||
+          Earray.length (Hashtbl.find symb_sorts s) = arity)
+        symbs;
+  }
+
+let split prob sorts =
+  let prob = Prob.read_only prob in
+  let whole = [{ prob; sorts }] in
+  if not (Symb.Set.is_empty (Symb.distinct_consts prob.Prob.symbols)) then
+    whole
+  else begin
+    (* Sort to make the order of the components deterministic. *)
+    let symbs =
+      sorts.Sorts.symb_sorts
+      |> BatHashtbl.keys
+      |> BatList.of_enum
+      |> BatList.sort compare in
+    let equiv = Equiv.create () in
+    let items = Hashtbl.create 20 in
+    List.iter (fun s -> Hashtbl.add items s (Equiv.add_item equiv)) symbs;
+
+    (* Symbols with a common sort are in the same component. *)
+    let sort_owners = Hashtbl.create 20 in
+    List.iter
+      (fun s ->
+        Earray.iter
+          (fun sort ->
+            try
+              Equiv.union equiv
+                (Hashtbl.find items s)
+                (Hashtbl.find items (Hashtbl.find sort_owners sort))
+            with Not_found -> Hashtbl.add sort_owners sort s)
+          (Hashtbl.find sorts.Sorts.symb_sorts s))
+      symbs;
+
+    (* Symbols in the same clause are in the same component. *)
+    let clause_symbs =
+      BatDynArray.map symbs_in_clause prob.Prob.clauses in
+    BatDynArray.iter
+      (function
+        | [] -> ()
+        | s :: cl_symbs ->
+            let item = Hashtbl.find items s in
+            List.iter
+              (fun s' -> Equiv.union equiv item (Hashtbl.find items s'))
+              cl_symbs)
+      clause_symbs;
+
+    (* Block ids in the order of the smallest symbols. *)
+    let blocks =
+      let seen = Hashtbl.create 10 in
+      BatList.filter_map
+        (fun s ->
+          let b = Equiv.find equiv (Hashtbl.find items s) in
+          if Hashtbl.mem seen b then
+            None
+          else begin
+            Hashtbl.add seen b ();
+            Some b
+          end)
+        symbs in
+    match blocks with
+      | [] | [_] -> whole
+      | first :: _ ->
+          let comp_clauses = Hashtbl.create 10 in
+          let comp_symbs = Hashtbl.create 10 in
+          List.iter
+            (fun b ->
+              Hashtbl.add comp_clauses b (BatDynArray.create ());
+              Hashtbl.add comp_symbs b [])
+            blocks;
+          List.iter
+            (fun s ->
+              let b = Equiv.find equiv (Hashtbl.find items s) in
+              Hashtbl.replace comp_symbs b (s :: Hashtbl.find comp_symbs b))
+            symbs;
+          BatDynArray.iteri
+            (fun i cl ->
+              let cl_symbs = BatDynArray.get clause_symbs i in
+              let b =
+                match cl_symbs with
+                  | [] -> first
+                  | s :: _ -> Equiv.find equiv (Hashtbl.find items s) in
+              BatDynArray.add (Hashtbl.find comp_clauses b) cl)
+            prob.Prob.clauses;
+          List.map
+            (fun b ->
+              {
+                prob = { prob with Prob.clauses = Hashtbl.find comp_clauses b };
+                sorts = restrict_sorts sorts (Hashtbl.find comp_symbs b);
+              })
+            blocks
+  end
@@ -0,0 +1,22 @@
+(* Copyright (c) 2015 Radek Micek *)
+
+(** Decomposition of a problem into independent components. *)
+
+(** A component is a subset of the clauses together with the sorts
+   of their symbols. The problem of the component shares the symbol
+   database with the original problem.
+*)
+type t = {
+  prob : [`R] Prob.t;
+  sorts : Sorts.t;
+}
+
+(** Splits the problem into components whose clauses share no symbols
+   and no sorts. A model of the problem is the union of the models
+   of the components with the same domain size.
+
+   Clauses without symbols (e.g. [x = y]) belong to the first component.
+   The problem is not split when it contains distinct constants
+   since symmetry reduction assigns them together.
+*)
+val split : [> `R] Prob.t -> Sorts.t -> t list
@@ -3,6 +3,11 @@
 module type Inst_sig = sig
   type solver
   type t
+  type compiled
+
+  val compile : [> `R] Prob.t -> Sorts.t -> compiled
+
+  val instantiate : ?nthreads:int -> compiled -> int -> t
 
   val create : ?nthreads:int -> [> `R] Prob.t -> Sorts.t -> int -> t
 
@@ -14,6 +19,8 @@ module type Inst_sig = sig
 
   val construct_model : t -> Ms_model.t
 
+  val poll_progress : t -> Sh.progress list
+
   val get_solver : t -> solver
 end
 
@@ -56,165 +63,216 @@ struct
     (* Arrays of CSP variables for int_element constraint. *)
     funcs : (S.id, int Solv.var_array) Hashtbl.t;
 
-    (* Maps the result of x1 * c1 + x2 * c2 + x3 * c3 + ... + c to variable y.
-       Variables xi in polynomial are sorted and unique.
-    *)
-    linear : ((int Solv.var * int, [`R]) Earray.t * int, int Solv.var)
-      Hashtbl.t;
-
     bool_element : (S.id * int Solv.var, bool Solv.var) Hashtbl.t;
 
     int_element : (S.id * int Solv.var, int Solv.var) Hashtbl.t;
 
+    (* Maps the symbol and the index x1 * c1 + x2 * c2 + ... + c
+       to variable y. Variables xi in polynomial are sorted and unique.
+    *)
+    bool_matrix_element :
+      (S.id * (int Solv.var * int, [`R]) Earray.t * int, bool Solv.var)
+      Hashtbl.t;
+
+    int_matrix_element :
+      (S.id * (int Solv.var * int, [`R]) Earray.t * int, int Solv.var)
+      Hashtbl.t;
+
     (* Variables in equality are sorted. *)
     eq_var_var : (int Solv.var * int Solv.var, bool Solv.var) Hashtbl.t;
 
     eq_var_const : (int Solv.var * int, bool Solv.var) Hashtbl.t;
 
+    (* Clauses compiled to extensional constraints. Maps sorted
+       CSP variables to their domain sizes and to the flags
+       of the allowed tuples indexed by the values of the variables
+       (the last variable is least significant).
+    *)
+    extensional :
+      ((int Solv.var, [`R]) Earray.t,
+       (int, [`R]) Earray.t * (bool, [`R|`W]) Earray.t)
+      Hashtbl.t;
+
     mutable can_construct_model : bool;
   }
 
+  (* Argument of a function term or of a predicate in a compiled clause. *)
+  type arg =
+    | A_var of T.var
+    (* Function term given by its index in [cc_nodes]. *)
+    | A_node of int
+
+  (* Function term of a compiled clause. *)
+  type node = {
+    n_symb : S.id;
+    n_args : (arg, [`R]) Earray.t;
+    (* Sorted variables of the term. Their values determine
+       the CSP variable of the term.
+    *)
+    n_vars : (T.var, [`R]) Earray.t;
+  }
+
+  (* Symbol whose CSP variables are created before the clause
+     is instantiated.
+  *)
+  type used_symb =
+    | U_pred of S.id
+    | U_func of S.id
+
+  (* Part of the instantiation of a clause which doesn't depend
+     on the domain size.
+  *)
+  type compiled_clause = {
+    cc_symbs : (used_symb, [`R]) Earray.t;
+
+    (* Adequate domain sizes for variables from the clause. *)
+    cc_var_adeq_sizes : (int, [`R]) Earray.t;
+
+    cc_var_eqs : (T.var * T.var, [`R]) Earray.t;
+    cc_var_ineqs : (T.var * T.var, [`R]) Earray.t;
+    cc_pos_eq_lits : (T.t * T.t, [`R]) Earray.t;
+    cc_neg_eq_lits : (T.t * T.t, [`R]) Earray.t;
+    cc_pos_noneq_lits : (S.id * (T.t, [`R]) Earray.t, [`R]) Earray.t;
+    cc_neg_noneq_lits : (S.id * (T.t, [`R]) Earray.t, [`R]) Earray.t;
+
+    (* Distinct function terms of the clause. Subterms are shared
+       so each term is instantiated at most once for each assignment.
+    *)
+    cc_nodes : (node, [`R]) Earray.t;
+
+    (* Literals [cc_pos_eq_lits] .. [cc_neg_noneq_lits] where
+       the function terms are replaced by the nodes.
+    *)
+    cc_pos_eqs : (arg * arg, [`R]) Earray.t;
+    cc_neg_eqs : (arg * arg, [`R]) Earray.t;
+    cc_pos_preds : (S.id * (arg, [`R]) Earray.t, [`R]) Earray.t;
+    cc_neg_preds : (S.id * (arg, [`R]) Earray.t, [`R]) Earray.t;
+  }
+
+  type compiled = {
+    c_symbols : [`R] Symb.db;
+    c_sorts : Sorts.t;
+    c_distinct_consts : (S.id, [`R]) Earray.t;
+    c_clauses : (compiled_clause, [`R]) Earray.t;
+  }
+
   let dummy_bool_var : bool Solv.var = Obj.magic 0
 
+  let dummy_int_var : int Solv.var = Obj.magic 0
+
   let get_var = function
     | T.Var x -> x
     | T.Func _ -> failwith "get_var"
 
+  let get_arg_var = function
+    | A_var x -> x
+    | A_node _ -> failwith "get_arg_var"
+
+  let is_arg_var = function
+    | A_var _ -> true
+    | A_node _ -> false
+
   type index =
     | I_const of int
     | I_var of int Solv.var
+    (* x1 * c1 + x2 * c2 + ... + c where variables xi are sorted
+       and unique.
+    *)
+    | I_matrix of (int Solv.var * int, [`R]) Earray.t * int
 
   (* Computes index into the array representing a symbol table.
-     [a] is assignment of variables.
+     [a] is assignment of variables and [node_var k] returns
+     the CSP variable of the node [k].
 
      [dom_sizes] contains domain sizes of [args].
   *)
-  let rec index
-      (inst : t)
+  let index
       (a : (int, [> `R]) Earray.t)
+      (node_var : int -> int Solv.var)
       (dom_sizes : (int, [> `R]) Earray.t)
-      (args : (T.t, [> `R]) Earray.t) : index =
+      (args : (arg, [> `R]) Earray.t) : index =
 
     (* Index can be computed statically. *)
-    if Earray.for_all T.is_var args then
+    if Earray.for_all is_arg_var args then
       I_const (Earray.fold_lefti
-                 (fun acc i x -> acc * dom_sizes.(i) + a.(get_var x))
+                 (fun acc i x -> acc * dom_sizes.(i) + a.(get_arg_var x))
                  0 args)
     else begin
       (* Maps CSP variables for cells to their coefficients. *)
       let vars = ref BatMap.empty in
-      (* Maps CSP variables for cells to their domain sizes.
-         These size are used when computing [max_idx].
-      *)
-      let var_dom_sizes = ref BatMap.empty in
       let c, _ =
         Earray.fold_righti
           (fun i arg (c, mult) ->
             match arg with
-              | T.Var x -> (c + a.(x) * mult, mult * dom_sizes.(i))
-              | T.Func (s, _) ->
+              | A_var x -> (c + a.(x) * mult, mult * dom_sizes.(i))
+              | A_node k ->
                   (* Get CSP variable for cell [arg]. *)
-                  let y = var_for_func_term inst a arg in
+                  let y = node_var k in
                   vars :=
                     BatMap.modify_def 0 y (fun coef -> coef + mult) !vars;
-                  (* Domain size of the CSP variable [y] is the size of the
-                     result sort of [arg] which is the size of [i]-th argument
-                     sort which is [dom_sizes.(i)].
-                  *)
-                  var_dom_sizes :=
-                    BatMap.add y dom_sizes.(i) !var_dom_sizes;
                   (c, mult * dom_sizes.(i)))
           args (0, 1) in
       let vars = BatMap.enum !vars |> Earray.of_enum in
-      let var_dom_sizes =
-        (* [BatMap.values] is not used since its documentation
-           doesn't guarantee that the values are in increasing order
-           by their keys.
-        *)
-        BatMap.enum !var_dom_sizes
-        |> BatEnum.map snd
-        |> Earray.of_enum in
-      let nvars = Earray.length vars in
       match%earr vars with
         (* Single variable x with coefficient 1 and no constant term -
-           we don't need linear constraint.
+           we don't need matrix element constraint.
         *)
         | [| x, 1 |] when c = 0 -> I_var x
-        | _ ->
-            let key = (vars, c) in
-            (* Variable satisfying linear constraint. *)
-            try
-              I_var (Hashtbl.find inst.linear key)
-            with
-              | Not_found ->
-                  (* Maximal value of CSP variable [y]. *)
-                  let max_idx =
-                    Earray.fold_lefti
-                      (fun max_idx i (_, coef) ->
-                        let max_el = var_dom_sizes.(i) - 1 in
-                        max_idx + max_el * coef)
-                      c
-                      vars in
-                  let dom_size = max_idx + 1 in
-                  let y = Solv.new_tmp_int_var inst.solver dom_size in
-                  (* Post c(0) * x(0) + c(1) * x(1) + ... + c = y as
-                          c(0) * x(0) + c(1) * x(1) + ... - y = -c.
-                     x(i) is (fst vars.(i)) and
-                     c(i) is (snd vars.(i)).
-                  *)
-                  Solv.linear
-                    inst.solver
-                    (Earray.init (nvars + 1)
-                       (fun i -> if i < nvars then fst vars.(i) else y))
-                    (Earray.init (nvars + 1)
-                       (fun i -> if i < nvars then snd vars.(i) else ~-1))
-                    ~-c;
-                  Hashtbl.add inst.linear key y;
-                  I_var y
+        | _ -> I_matrix (vars, c)
     end
 
-  (* [a] is assignment of variables. *)
-  and var_for_func_term
-      (inst : t)
-      (a : (int, [> `R]) Earray.t) : T.t -> int Solv.var = function
-
-    | T.Var _ -> failwith "var_for_func_term"
-    | T.Func (s, args) ->
-        let dom_sizes = BatMap.find s inst.dom_sizes in
-        match index inst a dom_sizes args with
-          | I_const i ->
-              (Hashtbl.find inst.func_arrays s).(i)
-          | I_var i ->
-              let key = (s, i) in
-              (* Variable satisfying int_element constraint. *)
-              try
-                Hashtbl.find inst.int_element key
-              with
-                | Not_found ->
-                    let dom_size = dom_sizes.(Symb.arity s) in
-                    let y = Solv.new_tmp_int_var inst.solver dom_size in
-                    Solv.int_element
-                      inst.solver
-                      (Hashtbl.find inst.funcs s) i y;
-                    Hashtbl.add inst.int_element key y;
-                    y
+  (* CSP variable for the cell of the function [s] given by the index. *)
+  let var_for_func_index (inst : t) (s : S.id) : index -> int Solv.var =
+    function
+    | I_const i ->
+        (Hashtbl.find inst.func_arrays s).(i)
+    | I_var i ->
+        let key = (s, i) in
+        (* Variable satisfying int_element constraint. *)
+        (try
+          Hashtbl.find inst.int_element key
+        with
+          | Not_found ->
+              let dom_size = (BatMap.find s inst.dom_sizes).(Symb.arity s) in
+              let y = Solv.new_tmp_int_var inst.solver dom_size in
+              Solv.int_element
+                inst.solver
+                (Hashtbl.find inst.funcs s) i y;
+              Hashtbl.add inst.int_element key y;
+              y)
+    | I_matrix (vars, c) ->
+        let key = (s, vars, c) in
+        (* Variable satisfying int_matrix_element constraint. *)
+        try
+          Hashtbl.find inst.int_matrix_element key
+        with
+          | Not_found ->
+              let dom_size = (BatMap.find s inst.dom_sizes).(Symb.arity s) in
+              let y = Solv.new_tmp_int_var inst.solver dom_size in
+              Solv.int_matrix_element
+                inst.solver
+                (Hashtbl.find inst.funcs s)
+                (Earray.map fst vars) (Earray.map snd vars) c y;
+              Hashtbl.add inst.int_matrix_element key y;
+              y
 
   (* [a] is assignment of variables. *)
   let var_for_noneq_atom
       (inst : t)
       (a : (int, [> `R]) Earray.t)
+      (node_var : int -> int Solv.var)
       (s : S.id)
-      (args : (T.t, [> `R]) Earray.t) : bool Solv.var =
+      (args : (arg, [> `R]) Earray.t) : bool Solv.var =
 
     assert (s <> S.sym_eq);
     let dom_sizes = BatMap.find s inst.dom_sizes in
-    match index inst a dom_sizes args with
+    match index a node_var dom_sizes args with
       | I_const i ->
           (Hashtbl.find inst.pred_arrays s).(i)
       | I_var i ->
           let key = (s, i) in
           (* Variable satisfying bool_element constraint. *)
-          try
+          (try
             Hashtbl.find inst.bool_element key
           with
             | Not_found ->
@@ -223,20 +281,35 @@ struct
                   inst.solver
                   (Hashtbl.find inst.preds s) i y;
                 Hashtbl.add inst.bool_element key y;
+                y)
+      | I_matrix (vars, c) ->
+          let key = (s, vars, c) in
+          (* Variable satisfying bool_matrix_element constraint. *)
+          try
+            Hashtbl.find inst.bool_matrix_element key
+          with
+            | Not_found ->
+                let y = Solv.new_tmp_bool_var inst.solver in
+                Solv.bool_matrix_element
+                  inst.solver
+                  (Hashtbl.find inst.preds s)
+                  (Earray.map fst vars) (Earray.map snd vars) c y;
+                Hashtbl.add inst.bool_matrix_element key y;
                 y
 
   (* [a] is assignment of variables. *)
   let var_for_eq_atom
       (inst : t)
       (a : (int, [> `R]) Earray.t)
-      (l : T.t)
-      (r : T.t) : bool Solv.var =
+      (node_var : int -> int Solv.var)
+      (l : arg)
+      (r : arg) : bool Solv.var =
 
     match l, r with
-      | T.Var _, T.Var _ -> failwith "var_for_eq_atom"
-      | (T.Func _ as f), T.Var x
-      | T.Var x, (T.Func _ as f) ->
-          let v = var_for_func_term inst a f in
+      | A_var _, A_var _ -> failwith "var_for_eq_atom"
+      | A_node k, A_var x
+      | A_var x, A_node k ->
+          let v = node_var k in
           let key = (v, a.(x)) in
           (try
              Hashtbl.find inst.eq_var_const key
@@ -249,9 +322,9 @@ struct
                    y;
                  Hashtbl.add inst.eq_var_const key y;
                  y)
-      | (T.Func _ as f), (T.Func _ as g) ->
-          let v = var_for_func_term inst a f in
-          let v' = var_for_func_term inst a g in
+      | A_node k, A_node k' ->
+          let v = node_var k in
+          let v' = node_var k' in
           let key = if v <= v' then (v, v') else (v', v) in
           (* Variable satisfying eq_var_var constraint. *)
           (try
@@ -266,62 +339,341 @@ struct
                  Hashtbl.add inst.eq_var_var key y;
                  y)
 
-  (* [var_adeq_sizes] are adequate domain sizes for variables
-     from the clause.
-  *)
-  let instantiate_clause
-      (inst : t)
-      (var_adeq_sizes : (int, [> `R]) Earray.t)
-      (var_eqs : (T.var * T.var, [> `R]) Earray.t)
-      (var_ineqs : (T.var * T.var, [> `R]) Earray.t)
-      (pos_eq_lits : (T.t * T.t, [> `R]) Earray.t)
-      (neg_eq_lits : (T.t * T.t, [> `R]) Earray.t)
-      (pos_noneq_lits : (S.id * (T.t, [> `R]) Earray.t, [> `R]) Earray.t)
-      (neg_noneq_lits : (S.id * (T.t, [> `R]) Earray.t, [> `R]) Earray.t)
-      : unit =
-
-    let nvars = Earray.length var_adeq_sizes in
+  (* Domain sizes of the variables from the clause. *)
+  let var_dom_sizes inst cl =
+    Earray.map
+      (fun adeq_size ->
+        if adeq_size = 0 || adeq_size >= inst.n
+        then inst.n
+        else adeq_size)
+      cl.cc_var_adeq_sizes
+
+  let instantiate_clause (inst : t) (cl : compiled_clause) : unit =
+    let nvars = Earray.length cl.cc_var_adeq_sizes in
+    let var_sizes = var_dom_sizes inst cl in
+    let var_eqs = cl.cc_var_eqs in
+    let var_ineqs = cl.cc_var_ineqs in
+    let nodes = cl.cc_nodes in
+    let nnodes = Earray.length nodes in
+
+    (* CSP variables of the nodes and the assignments for which
+       they were computed.
+    *)
+    let node_vars = Earray.make nnodes dummy_int_var in
+    let node_stamps = Earray.make nnodes (-1) in
+    let stamp = ref 0 in
+    (* CSP variables of the nested terms indexed by the values
+       of their variables. CSP variables of the shallow terms
+       are found in [func_arrays].
+    *)
+    let caches =
+      Earray.map
+        (fun node ->
+          if Earray.for_all is_arg_var node.n_args then
+            None
+          else
+            let size =
+              Earray.fold_left
+                (fun acc x -> acc * var_sizes.(x)) 1 node.n_vars in
+            Some (Earray.make size None))
+        nodes in
+
+    let rec node_var a k =
+      if node_stamps.(k) = !stamp then
+        node_vars.(k)
+      else begin
+        let node = nodes.(k) in
+        let compute () =
+          let dom_sizes = BatMap.find node.n_symb inst.dom_sizes in
+          var_for_func_index inst node.n_symb
+            (index a (node_var a) dom_sizes node.n_args) in
+        let v =
+          match caches.(k) with
+            | None -> compute ()
+            | Some cache ->
+                let rank =
+                  Earray.fold_left
+                    (fun acc x -> acc * var_sizes.(x) + a.(x)) 0 node.n_vars in
+                match cache.(rank) with
+                  | Some v -> v
+                  | None ->
+                      let v = compute () in
+                      cache.(rank) <- Some v;
+                      v in
+        node_vars.(k) <- v;
+        node_stamps.(k) <- !stamp;
+        v
+      end in
 
     (* Arrays for literals. *)
     let pos =
       Earray.make
-        (Earray.length pos_eq_lits + Earray.length pos_noneq_lits)
+        (Earray.length cl.cc_pos_eqs + Earray.length cl.cc_pos_preds)
         dummy_bool_var in
     let neg =
       Earray.make
-        (Earray.length neg_eq_lits + Earray.length neg_noneq_lits)
+        (Earray.length cl.cc_neg_eqs + Earray.length cl.cc_neg_preds)
         dummy_bool_var in
 
-    Assignment.each (Earray.make nvars 0) 0 nvars var_adeq_sizes inst.n
+    Assignment.each (Earray.make nvars 0) 0 nvars cl.cc_var_adeq_sizes inst.n
       (fun a ->
         (* If no (in)equality of variables is satisfied. *)
         if
           Earray.for_all (fun (x, x') -> a.(x) <> a.(x')) var_eqs &&
           Earray.for_all (fun (x, x') -> a.(x) = a.(x')) var_ineqs
         then begin
+          incr stamp;
+          let node_var = node_var a in
+
           (* Positive literals. *)
           Earray.iteri
-            (fun i (l, r) -> pos.(i) <- var_for_eq_atom inst a l r)
-            pos_eq_lits;
-          let skip = Earray.length pos_eq_lits in
+            (fun i (l, r) -> pos.(i) <- var_for_eq_atom inst a node_var l r)
+            cl.cc_pos_eqs;
+          let skip = Earray.length cl.cc_pos_eqs in
           Earray.iteri
             (fun i (s, args) ->
-              pos.(skip + i) <- var_for_noneq_atom inst a s args)
-            pos_noneq_lits;
+              pos.(skip + i) <- var_for_noneq_atom inst a node_var s args)
+            cl.cc_pos_preds;
 
           (* Negative literals. *)
           Earray.iteri
-            (fun i (l, r) -> neg.(i) <- var_for_eq_atom inst a l r)
-            neg_eq_lits;
-          let skip = Earray.length neg_eq_lits in
+            (fun i (l, r) -> neg.(i) <- var_for_eq_atom inst a node_var l r)
+            cl.cc_neg_eqs;
+          let skip = Earray.length cl.cc_neg_eqs in
           Earray.iteri
             (fun i (s, args) ->
-              neg.(skip + i) <- var_for_noneq_atom inst a s args)
-            neg_noneq_lits;
+              neg.(skip + i) <- var_for_noneq_atom inst a node_var s args)
+            cl.cc_neg_preds;
 
           Solv.clause inst.solver pos neg
         end)
 
+  (* Cell [s(args)] of a lifted clause. Raises [Exit]
+     when some argument is not a variable.
+  *)
+  let lifted_cell inst table s args =
+    if not (Earray.for_all T.is_var args) then
+      raise Exit;
+    let dom_sizes = BatMap.find s inst.dom_sizes in
+    {
+      Csp_solver.table = table;
+      Csp_solver.args = Earray.map get_var args;
+      Csp_solver.arg_sizes = Earray.sub dom_sizes 0 (Symb.arity s);
+    }
+
+  let lifted_eq_atom inst (l, r) =
+    let cell = function
+      | T.Var _ -> failwith "lifted_eq_atom"
+      | T.Func (s, args) ->
+          lifted_cell inst (Hashtbl.find inst.funcs s) s args in
+    match l, r with
+      | T.Var _, T.Var _ -> failwith "lifted_eq_atom"
+      | (T.Func _ as f), T.Var x
+      | T.Var x, (T.Func _ as f) ->
+          Csp_solver.Lifted_eq_var (cell f, x)
+      | T.Func _, T.Func _ ->
+          Csp_solver.Lifted_eq_cells (cell l, cell r)
+
+  let lifted_noneq_atom inst (s, args) =
+    Csp_solver.Lifted_pred
+      (lifted_cell inst (Hashtbl.find inst.preds s) s args)
+
+  (* Posts the clause by [Solv.lifted_clause] and returns [true]
+     when the solver supports lifted clauses and all atoms are shallow
+     (i.e. their arguments are variables). Otherwise returns [false].
+
+     Parameters are the fields of [compiled_clause].
+  *)
+  let lift_clause
+      (inst : t)
+      (var_adeq_sizes : (int, [> `R]) Earray.t)
+      (var_eqs : (T.var * T.var, [> `R]) Earray.t)
+      (var_ineqs : (T.var * T.var, [> `R]) Earray.t)
+      (pos_eq_lits : (T.t * T.t, [> `R]) Earray.t)
+      (neg_eq_lits : (T.t * T.t, [> `R]) Earray.t)
+      (pos_noneq_lits : (S.id * (T.t, [> `R]) Earray.t, [> `R]) Earray.t)
+      (neg_noneq_lits : (S.id * (T.t, [> `R]) Earray.t, [> `R]) Earray.t)
+      : bool =
+
+    let natoms =
+      Earray.length pos_eq_lits + Earray.length neg_eq_lits +
+      Earray.length pos_noneq_lits + Earray.length neg_noneq_lits in
+    if natoms = 0 || not (Solv.lifted_clauses inst.solver) then
+      false
+    else begin
+      try
+        let pos =
+          Earray.append
+            (Earray.map (lifted_eq_atom inst) pos_eq_lits)
+            (Earray.map (lifted_noneq_atom inst) pos_noneq_lits) in
+        let neg =
+          Earray.append
+            (Earray.map (lifted_eq_atom inst) neg_eq_lits)
+            (Earray.map (lifted_noneq_atom inst) neg_noneq_lits) in
+        let var_sizes =
+          Earray.map
+            (fun adeq_size ->
+              if adeq_size = 0 || adeq_size >= inst.n
+              then inst.n
+              else adeq_size)
+            var_adeq_sizes in
+        Solv.lifted_clause inst.solver var_sizes var_eqs var_ineqs pos neg;
+        true
+      with Exit -> false
+    end
+
+  (* Maximal number of tuples of an extensional constraint. *)
+  let max_tuples = 1024
+
+  (* Side of an equality in an instance of a tabulated clause. *)
+  type side =
+    | Side_const of int
+    (* CSP variable of the cell and its domain size. *)
+    | Side_cell of int Solv.var * int
+
+  (* Sets [values] to the tuple with the given rank. *)
+  let unrank_tuple dom_sizes rank values =
+    let rank = ref rank in
+    for i = Earray.length values - 1 downto 0 do
+      values.(i) <- !rank mod dom_sizes.(i);
+      rank := !rank / dom_sizes.(i)
+    done
+
+  (* Compiles the clause to extensional constraints and returns [true]
+     when the solver supports them, the clause contains only
+     equalities of shallow terms (i.e. their arguments are variables)
+     and at most two different function terms with small domains.
+     Otherwise returns [false].
+
+     The constraints are posted by [post_extensional]. Instances
+     of the clauses which contain the same cells share one constraint.
+
+     Parameters are the fields of [compiled_clause].
+  *)
+  let tabulate_clause
+      (inst : t)
+      (var_adeq_sizes : (int, [> `R]) Earray.t)
+      (var_eqs : (T.var * T.var, [> `R]) Earray.t)
+      (var_ineqs : (T.var * T.var, [> `R]) Earray.t)
+      (pos_eq_lits : (T.t * T.t, [> `R]) Earray.t)
+      (neg_eq_lits : (T.t * T.t, [> `R]) Earray.t)
+      (pos_noneq_lits : (S.id * (T.t, [> `R]) Earray.t, [> `R]) Earray.t)
+      (neg_noneq_lits : (S.id * (T.t, [> `R]) Earray.t, [> `R]) Earray.t)
+      : bool =
+
+    let func_terms =
+      Earray.fold_left
+        (fun acc (l, r) -> l :: r :: acc)
+        []
+        (Earray.append pos_eq_lits neg_eq_lits)
+      |> List.filter (function T.Func _ -> true | T.Var _ -> false)
+      |> BatList.sort_unique compare in
+    let shallow = function
+      | T.Var _ -> true
+      | T.Func (_, args) -> Earray.for_all T.is_var args in
+    let result_size = function
+      | T.Var _ -> failwith "result_size"
+      | T.Func (s, _) -> (BatMap.find s inst.dom_sizes).(Symb.arity s) in
+    let ntuples =
+      List.fold_left (fun n f -> n * result_size f) 1 func_terms in
+    if
+      not (Solv.extensional_clauses inst.solver) ||
+      not (Earray.is_empty pos_noneq_lits) ||
+      not (Earray.is_empty neg_noneq_lits) ||
+      func_terms = [] ||
+      List.length func_terms > 2 ||
+      not (List.for_all shallow func_terms) ||
+      ntuples > max_tuples
+    then
+      false
+    else begin
+      let nvars = Earray.length var_adeq_sizes in
+      let side a = function
+        | T.Var x -> Side_const a.(x)
+        | T.Func (s, args) as f ->
+            let dom_sizes = BatMap.find s inst.dom_sizes in
+            let i =
+              Earray.fold_lefti
+                (fun acc i x -> acc * dom_sizes.(i) + a.(get_var x))
+                0 args in
+            Side_cell ((Hashtbl.find inst.func_arrays s).(i), result_size f) in
+      let sides a = Earray.map (fun (l, r) -> side a l, side a r) in
+      Assignment.each (Earray.make nvars 0) 0 nvars var_adeq_sizes inst.n
+        (fun a ->
+          (* If no (in)equality of variables is satisfied. *)
+          if
+            Earray.for_all (fun (x, x') -> a.(x) <> a.(x')) var_eqs &&
+            Earray.for_all (fun (x, x') -> a.(x) = a.(x')) var_ineqs
+          then begin
+            let pos = sides a pos_eq_lits in
+            let neg = sides a neg_eq_lits in
+            (* Cells of the instance sorted by their CSP variables. *)
+            let cells =
+              Earray.fold_left
+                (fun acc (l, r) -> l :: r :: acc)
+                []
+                (Earray.append pos neg)
+              |> BatList.filter_map
+                  (function
+                  | Side_cell (v, size) -> Some (v, size)
+                  | Side_const _ -> None)
+              |> BatList.sort_unique compare
+              |> Earray.of_list in
+            let vars = Earray.map fst cells in
+            let dom_sizes, allowed =
+              try
+                Hashtbl.find inst.extensional vars
+              with
+                | Not_found ->
+                    let dom_sizes = Earray.map snd cells in
+                    let allowed =
+                      Earray.make (Earray.fold_left ( * ) 1 dom_sizes) true in
+                    Hashtbl.add inst.extensional vars (dom_sizes, allowed);
+                    dom_sizes, allowed in
+            let values = Earray.make (Earray.length vars) 0 in
+            let value = function
+              | Side_const c -> c
+              | Side_cell (v, _) -> values.(Earray.findi (( = ) v) vars) in
+            (* Forbid the tuples which falsify the instance. *)
+            Earray.iteri
+              (fun rank ok ->
+                if ok then begin
+                  unrank_tuple dom_sizes rank values;
+                  if
+                    Earray.for_all (fun (l, r) -> value l <> value r) pos &&
+                    Earray.for_all (fun (l, r) -> value l = value r) neg
+                  then
+                    allowed.(rank) <- false
+                end)
+              allowed
+          end);
+      true
+    end
+
+  (* Posts the constraints of the clauses compiled by [tabulate_clause]. *)
+  let post_extensional inst =
+    let constraints =
+      inst.extensional
+      |> BatHashtbl.enum
+      |> Earray.of_enum in
+    Earray.sort compare constraints;
+    Earray.iter
+      (fun (vars, (dom_sizes, allowed)) ->
+        (* Every tuple is allowed when all instances are tautologies. *)
+        if not (Earray.for_all (fun ok -> ok) allowed) then begin
+          let tuples = BatDynArray.create () in
+          let values = Earray.make (Earray.length vars) 0 in
+          Earray.iteri
+            (fun rank ok ->
+              if ok then begin
+                unrank_tuple dom_sizes rank values;
+                Earray.iter (BatDynArray.add tuples) values
+              end)
+            allowed;
+          Solv.extensional inst.solver vars (Earray.of_dyn_array tuples)
+        end)
+      constraints
+
   (* Create CSP variables for symbol. *)
   let add_symb
       (solver : Solv.t)
@@ -398,23 +750,26 @@ struct
       Hashtbl.add inst.funcs s vars
     end
 
-  let each_clause inst clause_id lits =
+  (* Splits the literals of the clause and shares its function terms.
+     Doesn't depend on the domain size.
+  *)
+  let compile_clause sorts clause_id lits =
     (* Adequate domain sizes for variables from the clause. *)
     let var_adeq_sizes =
       let nvars = Sh.IntSet.cardinal (Clause.vars lits) in
       Earray.init
         nvars
         (fun x ->
-          let sort = Hashtbl.find inst.sorts.Sorts.var_sorts (clause_id, x) in
-          inst.sorts.Sorts.adeq_sizes.(sort)) in
+          let sort = Hashtbl.find sorts.Sorts.var_sorts (clause_id, x) in
+          sorts.Sorts.adeq_sizes.(sort)) in
+    let symbs = BatDynArray.create () in
     let add_funcs_in_term =
       T.iter
         (function
         | T.Var _ -> ()
-        | T.Func (s, _) ->
-            add_func inst s) in
+        | T.Func (s, _) -> BatDynArray.add symbs (U_func s)) in
 
-    (* Split literals and create CSP variables for new symbols. *)
+    (* Split literals and collect symbols. *)
     let var_eqs = BatDynArray.create () in
     let var_ineqs = BatDynArray.create () in
     let pos_eq_lits = BatDynArray.create () in
@@ -438,7 +793,7 @@ struct
               | Sh.Neg -> neg_eq_lits)
             (l, r)
       | L.Lit (sign, s, args) ->
-          add_pred inst s;
+          BatDynArray.add symbs (U_pred s);
           Earray.iter add_funcs_in_term args;
           BatDynArray.add
             (match sign with
@@ -448,15 +803,70 @@ struct
       )
       lits;
 
-    instantiate_clause
-      inst
-      var_adeq_sizes
-      (Earray.of_dyn_array var_eqs)
-      (Earray.of_dyn_array var_ineqs)
-      (Earray.of_dyn_array pos_eq_lits)
-      (Earray.of_dyn_array neg_eq_lits)
-      (Earray.of_dyn_array pos_noneq_lits)
-      (Earray.of_dyn_array neg_noneq_lits)
+    (* Function terms. *)
+    let nodes = BatDynArray.create () in
+    let node_ids = Hashtbl.create 16 in
+    let rec arg_of_term = function
+      | T.Var x -> A_var x
+      | T.Func (s, args) as term ->
+          try
+            A_node (Hashtbl.find node_ids term)
+          with
+            | Not_found ->
+                let n_args = Earray.map arg_of_term args in
+                let n_vars =
+                  T.vars term |> Sh.IntSet.elements |> Earray.of_list in
+                let k = BatDynArray.length nodes in
+                BatDynArray.add nodes { n_symb = s; n_args; n_vars };
+                Hashtbl.add node_ids term k;
+                A_node k in
+    let eqs =
+      Earray.map (fun (l, r) ->
+        let l = arg_of_term l in
+        let r = arg_of_term r in
+        (l, r)) in
+    let preds = Earray.map (fun (s, args) -> s, Earray.map arg_of_term args) in
+
+    let pos_eq_lits = Earray.of_dyn_array pos_eq_lits in
+    let neg_eq_lits = Earray.of_dyn_array neg_eq_lits in
+    let pos_noneq_lits = Earray.of_dyn_array pos_noneq_lits in
+    let neg_noneq_lits = Earray.of_dyn_array neg_noneq_lits in
+    let cc_pos_eqs = eqs pos_eq_lits in
+    let cc_neg_eqs = eqs neg_eq_lits in
+    let cc_pos_preds = preds pos_noneq_lits in
+    let cc_neg_preds = preds neg_noneq_lits in
+    {
+      cc_symbs = Earray.of_dyn_array symbs;
+      cc_var_adeq_sizes = var_adeq_sizes;
+      cc_var_eqs = Earray.of_dyn_array var_eqs;
+      cc_var_ineqs = Earray.of_dyn_array var_ineqs;
+      cc_pos_eq_lits = pos_eq_lits;
+      cc_neg_eq_lits = neg_eq_lits;
+      cc_pos_noneq_lits = pos_noneq_lits;
+      cc_neg_noneq_lits = neg_noneq_lits;
+      cc_nodes = Earray.of_dyn_array nodes;
+      cc_pos_eqs;
+      cc_neg_eqs;
+      cc_pos_preds;
+      cc_neg_preds;
+    }
+
+  let each_clause inst cl =
+    (* Create CSP variables for new symbols. *)
+    Earray.iter
+      (function
+      | U_pred s -> add_pred inst s
+      | U_func s -> add_func inst s)
+      cl.cc_symbs;
+    let posted =
+      tabulate_clause inst cl.cc_var_adeq_sizes cl.cc_var_eqs cl.cc_var_ineqs
+        cl.cc_pos_eq_lits cl.cc_neg_eq_lits
+        cl.cc_pos_noneq_lits cl.cc_neg_noneq_lits ||
+      lift_clause inst cl.cc_var_adeq_sizes cl.cc_var_eqs cl.cc_var_ineqs
+        cl.cc_pos_eq_lits cl.cc_neg_eq_lits
+        cl.cc_pos_noneq_lits cl.cc_neg_noneq_lits in
+    if not posted then
+      instantiate_clause inst cl
 
   (* Computes domain size of the sort [sort]. *)
   let dsize ~n ~sorts sort =
@@ -733,9 +1143,42 @@ struct
       end in
     BatEnum.unfold blocked_sorts pick_sort
 
-  let create ?(nthreads = 1) prob sorts n =
+  (* Declares the tables of the interpreted function symbols
+     so the solver can break the symmetries of all sorts at once.
+     LNH breaks only the symmetries of the sorts which aren't blocked.
+  *)
+  let declare_symmetric_tables inst =
+    let funcs =
+      inst.func_arrays
+      |> BatHashtbl.enum
+      |> BatEnum.filter (fun (s, _) -> not (Symb.auxiliary inst.symbols s))
+      |> Earray.of_enum in
+    Earray.sort compare funcs;
+    Earray.iter
+      (fun (s, vars) ->
+        Solv.symmetric_table inst.solver vars
+          (Hashtbl.find inst.sorts.Sorts.symb_sorts s)
+          (BatMap.find s inst.dom_sizes))
+      funcs
+
+  let compile prob sorts =
     let prob = Prob.read_only prob in
+    let symbols = prob.Prob.symbols in
+    {
+      c_symbols = symbols;
+      c_sorts = sorts;
+      c_distinct_consts =
+        Symb.distinct_consts symbols |> Symb.Set.enum |> Earray.of_enum;
+      c_clauses =
+        prob.Prob.clauses
+        |> BatDynArray.enum
+        |> BatEnum.map
+            (fun cl -> compile_clause sorts cl.Clause2.cl_id cl.Clause2.cl_lits)
+        |> Earray.of_enum;
+    }
 
+  let instantiate ?(nthreads = 1) compiled n =
+    let sorts = compiled.c_sorts in
     let dom_sizes =
       BatHashtbl.fold
         (fun symb sorts' m ->
@@ -745,7 +1188,7 @@ struct
         BatMap.empty in
     let inst = {
       solver = Solv.create nthreads;
-      symbols = prob.Prob.symbols;
+      symbols = compiled.c_symbols;
       sorts;
       n;
       dom_sizes;
@@ -753,34 +1196,39 @@ struct
       func_arrays = Hashtbl.create 20;
       preds = Hashtbl.create 20;
       funcs = Hashtbl.create 20;
-      linear = Hashtbl.create (2 * n * n);
       bool_element = Hashtbl.create (n * n);
       int_element = Hashtbl.create (n * n);
+      bool_matrix_element = Hashtbl.create (n * n);
+      int_matrix_element = Hashtbl.create (n * n);
       eq_var_var = Hashtbl.create (n * n);
       eq_var_const = Hashtbl.create (n * n);
+      extensional = Hashtbl.create (n * n);
       can_construct_model = true;
     } in
     (* Distinct constants. *)
-    let distinct_consts = Symb.distinct_consts prob.Prob.symbols in
-    BatEnum.iter (add_func inst) (Symb.Set.enum distinct_consts);
-    if Symb.Set.is_empty distinct_consts |> not then
+    let distinct_consts = compiled.c_distinct_consts in
+    Earray.iter (add_func inst) distinct_consts;
+    if Earray.is_empty distinct_consts |> not then
       distinct_consts
-      |> Symb.Set.enum
-      |> Earray.of_enum
       |> Earray.map (fun s -> (Hashtbl.find inst.func_arrays s).(0))
       |> Solv.all_different inst.solver;
     (* Clauses. *)
-    BatDynArray.iter
-      (fun cl -> each_clause inst cl.Clause2.cl_id cl.Clause2.cl_lits)
-      prob.Prob.clauses;
-    (* LNH. *)
-    sorts
-    |> order_sorts_for_lnh
-    |> BatEnum.iter (fun sort -> lnh inst sort);
+    Earray.iter (each_clause inst) compiled.c_clauses;
+    post_extensional inst;
+    (* Symmetry breaking. *)
+    if Solv.symmetric_tables inst.solver then
+      declare_symmetric_tables inst
+    else
+      sorts
+      |> order_sorts_for_lnh
+      |> BatEnum.iter (fun sort -> lnh inst sort);
     (* Hints. *)
     use_hints inst;
     inst
 
+  let create ?nthreads prob sorts n =
+    instantiate ?nthreads (compile prob sorts) n
+
   let destroy inst = Solv.destroy inst.solver
 
   let solve inst =
@@ -821,6 +1269,8 @@ struct
       Ms_model.symbs = !symbs;
     }
 
+  let poll_progress inst = Solv.poll_progress inst.solver
+
   let get_solver inst = inst.solver
 
 end
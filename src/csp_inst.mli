@@ -7,6 +7,22 @@ module type Inst_sig = sig
   type solver
   type t
 
+  (** Part of the instantiation which doesn't depend on the domain size. *)
+  type compiled
+
+  (** [compile prob sorts] splits the literals of the clauses
+     and shares their function terms. The result can be instantiated
+     for several domain sizes. The problem must not be changed
+     while the result is used.
+  *)
+  val compile : [> `R] Prob.t -> Sorts.t -> compiled
+
+  (** [instantiate ~nthreads compiled n] instantiates the compiled
+     problem for the domain size [n].
+     [nthreads] is the number of threads to use when solving.
+  *)
+  val instantiate : ?nthreads:int -> compiled -> int -> t
+
   (** [create ~nthreads prob n] instantiates
      the problem [prob] for the domain size [n].
      [nthreads] is the number of threads to use when solving.
@@ -21,6 +37,12 @@ module type Inst_sig = sig
 
   val construct_model : t -> Ms_model.t
 
+  (** Returns the progress snapshots published by the solver
+     since the previous call. Can be called from another thread
+     while {!solve} or {!solve_timed} runs.
+  *)
+  val poll_progress : t -> Sh.progress list
+
   val get_solver : t -> solver
 end
 
@@ -0,0 +1,327 @@
+(* Copyright (c) 2015 Radek Micek *)
+
+let channel = ref None
+
+module Make (Solv : Csp_solver.S) = struct
+  include Solv
+
+  let record name add_args =
+    match !channel with
+      | None -> ()
+      | Some oc ->
+          let buf = Buffer.create 64 in
+          Buffer.add_string buf name;
+          add_args buf;
+          Buffer.add_char buf '\n';
+          Buffer.output_buffer oc buf
+
+  let add_int buf i =
+    Buffer.add_char buf ' ';
+    Buffer.add_string buf (string_of_int i)
+
+  let add_var buf (x : 'a var) = add_int buf (x :> int)
+
+  let add_var_array buf (arr : 'a var_array) = add_int buf (arr :> int)
+
+  let add_array add buf arr =
+    add_int buf (Earray.length arr);
+    Earray.iter (add buf) arr
+
+  let add_cell buf cell =
+    add_var_array buf cell.Csp_solver.table;
+    add_array add_int buf cell.Csp_solver.args;
+    add_array add_int buf cell.Csp_solver.arg_sizes
+
+  let add_atom buf = function
+    | Csp_solver.Lifted_pred c ->
+        Buffer.add_string buf " p";
+        add_cell buf c
+    | Csp_solver.Lifted_eq_var (c, x) ->
+        Buffer.add_string buf " v";
+        add_cell buf c;
+        add_int buf x
+    | Csp_solver.Lifted_eq_cells (c, c') ->
+        Buffer.add_string buf " c";
+        add_cell buf c;
+        add_cell buf c'
+
+  let create nthreads =
+    record "create" (fun buf -> add_int buf nthreads);
+    Solv.create nthreads
+
+  let new_bool_var s =
+    let x = Solv.new_bool_var s in
+    record "bool_var" (fun buf -> add_var buf x);
+    x
+
+  let new_int_var s dom_size =
+    let x = Solv.new_int_var s dom_size in
+    record "int_var" (fun buf -> add_int buf dom_size; add_var buf x);
+    x
+
+  let new_tmp_bool_var s =
+    let x = Solv.new_tmp_bool_var s in
+    record "tmp_bool_var" (fun buf -> add_var buf x);
+    x
+
+  let new_tmp_int_var s dom_size =
+    let x = Solv.new_tmp_int_var s dom_size in
+    record "tmp_int_var" (fun buf -> add_int buf dom_size; add_var buf x);
+    x
+
+  let new_bool_var_array s vars =
+    let arr = Solv.new_bool_var_array s vars in
+    record "bool_var_array"
+      (fun buf -> add_var_array buf arr; add_array add_var buf vars);
+    arr
+
+  let new_int_var_array s vars =
+    let arr = Solv.new_int_var_array s vars in
+    record "int_var_array"
+      (fun buf -> add_var_array buf arr; add_array add_var buf vars);
+    arr
+
+  let bool_element s arr idx y =
+    record "bool_element"
+      (fun buf -> add_var_array buf arr; add_var buf idx; add_var buf y);
+    Solv.bool_element s arr idx y
+
+  let int_element s arr idx y =
+    record "int_element"
+      (fun buf -> add_var_array buf arr; add_var buf idx; add_var buf y);
+    Solv.int_element s arr idx y
+
+  let bool_matrix_element s arr idxs coefs c y =
+    record "bool_matrix_element"
+      (fun buf ->
+        add_var_array buf arr;
+        add_array add_var buf idxs;
+        add_array add_int buf coefs;
+        add_int buf c;
+        add_var buf y);
+    Solv.bool_matrix_element s arr idxs coefs c y
+
+  let int_matrix_element s arr idxs coefs c y =
+    record "int_matrix_element"
+      (fun buf ->
+        add_var_array buf arr;
+        add_array add_var buf idxs;
+        add_array add_int buf coefs;
+        add_int buf c;
+        add_var buf y);
+    Solv.int_matrix_element s arr idxs coefs c y
+
+  let eq_var_var s x x' y =
+    record "eq_var_var"
+      (fun buf -> add_var buf x; add_var buf x'; add_var buf y);
+    Solv.eq_var_var s x x' y
+
+  let eq_var_const s x c y =
+    record "eq_var_const"
+      (fun buf -> add_var buf x; add_int buf c; add_var buf y);
+    Solv.eq_var_const s x c y
+
+  let lower_eq s x c =
+    record "lower_eq" (fun buf -> add_var buf x; add_int buf c);
+    Solv.lower_eq s x c
+
+  let precede s xs cs =
+    record "precede"
+      (fun buf -> add_array add_var buf xs; add_array add_int buf cs);
+    Solv.precede s xs cs
+
+  let clause s pos neg =
+    record "clause"
+      (fun buf -> add_array add_var buf pos; add_array add_var buf neg);
+    Solv.clause s pos neg
+
+  let all_different s xs =
+    record "all_different" (fun buf -> add_array add_var buf xs);
+    Solv.all_different s xs
+
+  let extensional s vars tuples =
+    record "extensional"
+      (fun buf -> add_array add_var buf vars; add_array add_int buf tuples);
+    Solv.extensional s vars tuples
+
+  let lifted_clause s var_sizes var_eqs var_ineqs pos neg =
+    let add_pair buf (x, y) = add_int buf x; add_int buf y in
+    record "lifted_clause"
+      (fun buf ->
+        add_array add_int buf var_sizes;
+        add_array add_pair buf var_eqs;
+        add_array add_pair buf var_ineqs;
+        add_array add_atom buf pos;
+        add_array add_atom buf neg);
+    Solv.lifted_clause s var_sizes var_eqs var_ineqs pos neg
+
+  let symmetric_table s cells sorts dom_sizes =
+    record "symmetric_table"
+      (fun buf ->
+        add_array add_var buf cells;
+        add_array add_int buf sorts;
+        add_array add_int buf dom_sizes);
+    Solv.symmetric_table s cells sorts dom_sizes
+
+  let solve s =
+    BatOption.may flush !channel;
+    Solv.solve s
+end
+
+module Replay (Solv : Csp_solver.S) = struct
+  let each_model ic f =
+    let ib = Scanf.Scanning.from_channel ic in
+    let int () = Scanf.bscanf ib " %d" (fun i -> i) in
+    let name () = Scanf.bscanf ib " %s" (fun s -> s) in
+    let array read =
+      let n = int () in
+      Earray.init n (fun _ -> read ()) in
+
+    (* Map the recorded ids to the variables of the solver. *)
+    let bool_vars = Hashtbl.create 1024 in
+    let int_vars = Hashtbl.create 1024 in
+    let bool_arrays = Hashtbl.create 64 in
+    let int_arrays = Hashtbl.create 64 in
+    let find tbl () =
+      let id = int () in
+      try Hashtbl.find tbl id
+      with Not_found ->
+        failwith ("Csp_record: unknown id: " ^ string_of_int id) in
+    let bool_var = find bool_vars in
+    let int_var = find int_vars in
+    let bool_array = find bool_arrays in
+    let int_array = find int_arrays in
+
+    let cell table =
+      let table = table () in
+      let args = array int in
+      let arg_sizes = array int in
+      { Csp_solver.table; Csp_solver.args; Csp_solver.arg_sizes } in
+    let atom () =
+      match name () with
+        | "p" -> Csp_solver.Lifted_pred (cell bool_array)
+        | "v" ->
+            let c = cell int_array in
+            let x = int () in
+            Csp_solver.Lifted_eq_var (c, x)
+        | "c" ->
+            let c = cell int_array in
+            let c' = cell int_array in
+            Csp_solver.Lifted_eq_cells (c, c')
+        | a -> failwith ("Csp_record: unknown atom: " ^ a) in
+    let pair () =
+      let x = int () in
+      let y = int () in
+      (x, y) in
+
+    let replay_call s = function
+      | "bool_var" -> Hashtbl.replace bool_vars (int ()) (Solv.new_bool_var s)
+      | "int_var" ->
+          let dom_size = int () in
+          Hashtbl.replace int_vars (int ()) (Solv.new_int_var s dom_size)
+      | "tmp_bool_var" ->
+          Hashtbl.replace bool_vars (int ()) (Solv.new_tmp_bool_var s)
+      | "tmp_int_var" ->
+          let dom_size = int () in
+          Hashtbl.replace int_vars (int ()) (Solv.new_tmp_int_var s dom_size)
+      | "bool_var_array" ->
+          let id = int () in
+          let vars = array bool_var in
+          Hashtbl.replace bool_arrays id (Solv.new_bool_var_array s vars)
+      | "int_var_array" ->
+          let id = int () in
+          let vars = array int_var in
+          Hashtbl.replace int_arrays id (Solv.new_int_var_array s vars)
+      | "bool_element" ->
+          let arr = bool_array () in
+          let idx = int_var () in
+          let y = bool_var () in
+          Solv.bool_element s arr idx y
+      | "int_element" ->
+          let arr = int_array () in
+          let idx = int_var () in
+          let y = int_var () in
+          Solv.int_element s arr idx y
+      | "bool_matrix_element" ->
+          let arr = bool_array () in
+          let idxs = array int_var in
+          let coefs = array int in
+          let c = int () in
+          let y = bool_var () in
+          Solv.bool_matrix_element s arr idxs coefs c y
+      | "int_matrix_element" ->
+          let arr = int_array () in
+          let idxs = array int_var in
+          let coefs = array int in
+          let c = int () in
+          let y = int_var () in
+          Solv.int_matrix_element s arr idxs coefs c y
+      | "eq_var_var" ->
+          let x = int_var () in
+          let x' = int_var () in
+          let y = bool_var () in
+          Solv.eq_var_var s x x' y
+      | "eq_var_const" ->
+          let x = int_var () in
+          let c = int () in
+          let y = bool_var () in
+          Solv.eq_var_const s x c y
+      | "lower_eq" ->
+          let x = int_var () in
+          let c = int () in
+          Solv.lower_eq s x c
+      | "precede" ->
+          let xs = array int_var in
+          let cs = array int in
+          Solv.precede s xs cs
+      | "clause" ->
+          let pos = array bool_var in
+          let neg = array bool_var in
+          Solv.clause s pos neg
+      | "all_different" -> Solv.all_different s (array int_var)
+      | "extensional" ->
+          let vars = array int_var in
+          let tuples = array int in
+          Solv.extensional s vars tuples
+      | "lifted_clause" ->
+          let var_sizes = array int in
+          let var_eqs = array pair in
+          let var_ineqs = array pair in
+          let pos = array atom in
+          let neg = array atom in
+          Solv.lifted_clause s var_sizes var_eqs var_ineqs pos neg
+      | "symmetric_table" ->
+          let cells = array int_var in
+          let sorts = array int in
+          let dom_sizes = array int in
+          Solv.symmetric_table s cells sorts dom_sizes
+      | call -> failwith ("Csp_record: unknown call: " ^ call) in
+
+    (* Reads the arguments of the call create whose name has been read. *)
+    let create () =
+      let nthreads = int () in
+      Hashtbl.clear bool_vars;
+      Hashtbl.clear int_vars;
+      Hashtbl.clear bool_arrays;
+      Hashtbl.clear int_arrays;
+      Solv.create nthreads in
+
+    let rec loop i solver =
+      Scanf.bscanf ib " " ();
+      let eof = Scanf.Scanning.end_of_input ib in
+      let call = if eof then "" else name () in
+      match solver with
+        | Some s when eof || call = "create" ->
+            BatPervasives.finally (fun () -> Solv.destroy s) (f i) s;
+            if not eof then
+              loop (i + 1) (Some (create ()))
+        | _ when eof -> ()
+        | None when call = "create" -> loop i (Some (create ()))
+        | None -> failwith ("Csp_record: call before create: " ^ call)
+        | Some s ->
+            begin try replay_call s call
+            with e -> Solv.destroy s; raise e
+            end;
+            loop i solver in
+    loop 0 None
+end
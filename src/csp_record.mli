@@ -0,0 +1,35 @@
+(* Copyright (c) 2015 Radek Micek *)
+
+(** Recording of CSP models.
+
+   The calls which build a model are written as lines of integers
+   prefixed by the name of the call. Arrays are written as their length
+   followed by their elements. CSP variables and their arrays are written
+   as the ids returned by the recorded solver. Each model starts
+   with the line [create nthreads].
+*)
+
+(** Channel where {!Make} writes the calls. Nothing is recorded
+   when [None]. Models must be built one after another.
+*)
+val channel : out_channel option ref
+
+(** [Make (Solv)] behaves as [Solv] and records the calls
+   to {!channel}. The channel is flushed by [solve].
+*)
+module Make (Solv : Csp_solver.S) : Csp_solver.S
+  with type t = Solv.t
+  and type 'a var = 'a Solv.var
+  and type 'a var_array = 'a Solv.var_array
+
+(** Rebuilding of the recorded models. *)
+module Replay (Solv : Csp_solver.S) : sig
+  (** [each_model ic f] reads the recorded models from [ic],
+     builds each of them in a new solver and calls [f i solver]
+     where [i] is the index of the model (starting from [0]).
+     The solver is destroyed after [f] returns.
+
+     Raises [Failure] when the recording is invalid.
+  *)
+  val each_model : in_channel -> (int -> Solv.t -> unit) -> unit
+end
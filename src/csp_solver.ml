@@ -1,5 +1,16 @@
 (* Copyright (c) 2013 Radek Micek *)
 
+type 'tbl lifted_cell = {
+  table : 'tbl;
+  args : (int, [`R]) Earray.t;
+  arg_sizes : (int, [`R]) Earray.t;
+}
+
+type ('b, 'i) lifted_atom =
+  | Lifted_pred of 'b lifted_cell
+  | Lifted_eq_var of 'i lifted_cell * int
+  | Lifted_eq_cells of 'i lifted_cell * 'i lifted_cell
+
 module type S = sig
   type t
   type 'a var = private int
@@ -17,12 +28,14 @@ module type S = sig
   val new_bool_var_array : t -> (bool var, [> `R]) Earray.t -> bool var_array
   val new_int_var_array : t -> (int var, [> `R]) Earray.t -> int var_array
 
-  val linear : t -> (int var, [> `R]) Earray.t -> (int, [> `R]) Earray.t ->
-    int -> unit
-
   val bool_element : t -> bool var_array -> int var -> bool var -> unit
   val int_element : t -> int var_array -> int var -> int var -> unit
 
+  val bool_matrix_element : t -> bool var_array -> (int var, [> `R]) Earray.t ->
+    (int, [> `R]) Earray.t -> int -> bool var -> unit
+  val int_matrix_element : t -> int var_array -> (int var, [> `R]) Earray.t ->
+    (int, [> `R]) Earray.t -> int -> int var -> unit
+
   val eq_var_var : t -> int var -> int var -> bool var -> unit
   val eq_var_const : t -> int var -> int -> bool var -> unit
 
@@ -36,10 +49,29 @@ module type S = sig
 
   val all_different : t -> (int var, [> `R]) Earray.t -> unit
 
+  val extensional : t -> (int var, [> `R]) Earray.t ->
+    (int, [> `R]) Earray.t -> unit
+
+  val extensional_clauses : t -> bool
+
+  val lifted_clause : t -> (int, [> `R]) Earray.t ->
+    (int * int, [> `R]) Earray.t -> (int * int, [> `R]) Earray.t ->
+    ((bool var_array, int var_array) lifted_atom, [> `R]) Earray.t ->
+    ((bool var_array, int var_array) lifted_atom, [> `R]) Earray.t -> unit
+
+  val lifted_clauses : t -> bool
+
+  val symmetric_table : t -> (int var, [> `R]) Earray.t ->
+    (int, [> `R]) Earray.t -> (int, [> `R]) Earray.t -> unit
+
+  val symmetric_tables : t -> bool
+
   val solve : t -> Sh.lbool
 
   val interrupt : t -> unit
 
+  val poll_progress : t -> Sh.progress list
+
   val bool_value : t -> bool var -> int
   val int_value : t -> int var -> int
 end
@@ -2,6 +2,32 @@
 
 (** CSP solver. *)
 
+(** Cell [s(x_0, ..., x_k)] of a lifted clause where [x_i]
+   are clause variables.
+*)
+type 'tbl lifted_cell = {
+  table : 'tbl;
+  (** Array of the CSP variables of all cells of [s]. The cell
+     for the arguments [a] is at the index
+     [(..(a.(0) * arg_sizes.(1) + a.(1)) * arg_sizes.(2) + ..) + a.(k)].
+  *)
+  args : (int, [`R]) Earray.t;
+  (** Indices of the clause variables [x_i]. *)
+  arg_sizes : (int, [`R]) Earray.t;
+  (** Domain sizes of the arguments of [s]. *)
+}
+
+(** Atom of a lifted clause. *)
+type ('b, 'i) lifted_atom =
+  | Lifted_pred of 'b lifted_cell
+  (** [p(x_0, ..., x_k)]. *)
+  | Lifted_eq_var of 'i lifted_cell * int
+  (** [f(x_0, ..., x_k) = y] where [y] is the index
+     of a clause variable.
+  *)
+  | Lifted_eq_cells of 'i lifted_cell * 'i lifted_cell
+  (** [f(x_0, ..., x_k) = g(y_0, ..., y_l)]. *)
+
 module type S = sig
   (** CSP solver. *)
   type t
@@ -46,19 +72,25 @@ module type S = sig
   (** Creates an array of integral CSP variables. *)
   val new_int_var_array : t -> (int var, [> `R]) Earray.t -> int var_array
 
-  (** [linear s vars coefs c] posts constraint
-     [vars.(0) * coefs.(0) + vars.(1) * coefs.(1) + ... = c].
-     Arrays [vars] and [coefs] must have same length.
-  *)
-  val linear : t -> (int var, [> `R]) Earray.t -> (int, [> `R]) Earray.t ->
-    int -> unit
-
   (** [bool_element s vars idx x] posts constraint [vars.(idx) = x]. *)
   val bool_element : t -> bool var_array -> int var -> bool var -> unit
 
   (** [int_element s vars idx x] posts constraint [vars.(idx) = x]. *)
   val int_element : t -> int var_array -> int var -> int var -> unit
 
+  (** [bool_matrix_element s vars idxs coefs c x] posts constraint
+     [vars.(idxs.(0) * coefs.(0) + idxs.(1) * coefs.(1) + ... + c) = x].
+     Arrays [idxs] and [coefs] must have same length.
+     Unlike [bool_element] with an index computed from [idxs]
+     the constraint propagates directly between [idxs] and [x].
+  *)
+  val bool_matrix_element : t -> bool var_array -> (int var, [> `R]) Earray.t ->
+    (int, [> `R]) Earray.t -> int -> bool var -> unit
+
+  (** Same as [bool_matrix_element] but for integral CSP variables. *)
+  val int_matrix_element : t -> int var_array -> (int var, [> `R]) Earray.t ->
+    (int, [> `R]) Earray.t -> int -> int var -> unit
+
   (** [eq_var_var s x x' b] posts constraint [(x = x') <=> b]. *)
   val eq_var_var : t -> int var -> int var -> bool var -> unit
 
@@ -92,6 +124,58 @@ module type S = sig
   *)
   val all_different : t -> (int var, [> `R]) Earray.t -> unit
 
+  (** [extensional s vars tuples] posts constraint that the values
+     of [vars] form one of the tuples. [tuples] contains the tuples
+     one after another so its length is a multiple of the length
+     of [vars]. No tuple means that the constraint is unsatisfiable.
+  *)
+  val extensional : t -> (int var, [> `R]) Earray.t ->
+    (int, [> `R]) Earray.t -> unit
+
+  (** Whether {!Csp_inst} posts clauses with at most two different
+     shallow function terms, no predicates and small domains
+     with [extensional]. Instances of the clauses with the same cells
+     are combined into one constraint.
+  *)
+  val extensional_clauses : t -> bool
+
+  (** [lifted_clause s var_sizes var_eqs var_ineqs pos neg] posts
+     the clause [pos.(0) || ... || ~neg.(0) || ...] for every assignment [a]
+     of the clause variables where [0 <= a.(x) < var_sizes.(x)],
+     [a.(x) <> a.(y)] for each [(x, y)] in [var_eqs]
+     and [a.(x) = a.(y)] for each [(x, y)] in [var_ineqs].
+
+     Unlike [clause] the instances are not posted one by one.
+     The solver checks an instance only when one of its cells changes.
+  *)
+  val lifted_clause : t -> (int, [> `R]) Earray.t ->
+    (int * int, [> `R]) Earray.t -> (int * int, [> `R]) Earray.t ->
+    ((bool var_array, int var_array) lifted_atom, [> `R]) Earray.t ->
+    ((bool var_array, int var_array) lifted_atom, [> `R]) Earray.t -> unit
+
+  (** Whether {!Csp_inst} posts clauses with [lifted_clause]. *)
+  val lifted_clauses : t -> bool
+
+  (** [symmetric_table s cells sorts dom_sizes] declares the table [cells]
+     of a function symbol (the last argument is the least significant).
+     [sorts] contains the sorts of the arguments and of the result
+     and [dom_sizes] their domain sizes.
+
+     The caller guarantees that permuting the elements of a sort
+     in the values and in the arguments of all declared tables
+     maps solutions to solutions and that every non-temporary integral
+     CSP variable is a cell of a declared table.
+     The solver may use this to skip symmetric parts of the search space
+     so it can find fewer solutions.
+  *)
+  val symmetric_table : t -> (int var, [> `R]) Earray.t ->
+    (int, [> `R]) Earray.t -> (int, [> `R]) Earray.t -> unit
+
+  (** Whether {!Csp_inst} declares the tables with [symmetric_table]
+     instead of posting LNH constraints.
+  *)
+  val symmetric_tables : t -> bool
+
   (** {b Important:} After calling [solve] you must not create CSP variables,
      create arrays of CSP variables, post constraints.
   *)
@@ -99,6 +183,13 @@ module type S = sig
 
   val interrupt : t -> unit
 
+  (** Returns the snapshots which were published since the previous call,
+     the oldest first. The solver publishes a snapshot periodically
+     during the search and at the end of each call to [solve].
+     Can be called from another thread while [solve] is running.
+  *)
+  val poll_progress : t -> Sh.progress list
+
   (** Returns the value of the given non-temporary boolean CSP variable.
 
      Can be used only when the last call to [solve] returned [Sh.Ltrue].
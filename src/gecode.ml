@@ -4,8 +4,115 @@ type t
 type 'a var = int
 type 'a var_array = int
 
+type restart =
+  | Restart_none
+  | Restart_luby
+  | Restart_geom
+
+type branching =
+  | Branch_size
+  | Branch_afc
+  | Branch_activity
+  | Branch_lnh
+
+type stats = {
+  fails : int;
+  nodes : int;
+  propagations : int;
+  max_depth : int;
+  restarts : int;
+  nogoods : int;
+}
+
+type config = {
+  restart : restart;
+  restart_scale : int;
+  restart_base : float;
+  nogoods_limit : int;
+  branching : branching;
+  decay : float;
+  lifted : bool;
+  ldsb : bool;
+  commit_distance : int;
+  adaptive_distance : int;
+  extensional : bool;
+}
+
+(* Search::Config::c_d and Search::Config::a_d. *)
+external default_distances : unit -> int * int = "gecode_default_distances"
+
+let default_config =
+  let commit_distance, adaptive_distance = default_distances () in
+  {
+    restart = Restart_none;
+    restart_scale = 100;
+    restart_base = 1.5;
+    nogoods_limit = 128;
+    branching = Branch_size;
+    decay = 1.;
+    lifted = true;
+    ldsb = false;
+    commit_distance;
+    adaptive_distance;
+    extensional = false;
+  }
+
+let override config opt =
+  let key, v =
+    try BatString.split opt "="
+    with Not_found -> failwith ("Gecode.override: missing value: " ^ opt) in
+  let invalid () =
+    failwith (Printf.sprintf "Gecode.override: invalid value for %s: %s"
+                key v) in
+  let parse_enum values =
+    try List.assoc v values
+    with Not_found -> invalid () in
+  let parse_int min =
+    match (try Some (int_of_string v) with Failure _ -> None) with
+      | Some i when i >= min -> i
+      | _ -> invalid () in
+  let parse_float valid =
+    match (try Some (float_of_string v) with Failure _ -> None) with
+      | Some f when valid f -> f
+      | _ -> invalid () in
+  match key with
+    | "restart" ->
+        let restarts = [
+          "none", Restart_none;
+          "luby", Restart_luby;
+          "geom", Restart_geom;
+        ] in
+        { config with restart = parse_enum restarts }
+    | "restart-scale" -> { config with restart_scale = parse_int 1 }
+    | "restart-base" ->
+        { config with restart_base = parse_float (fun f -> f > 1.) }
+    | "nogoods-limit" -> { config with nogoods_limit = parse_int 0 }
+    | "branching" ->
+        let branchings = [
+          "size", Branch_size;
+          "afc", Branch_afc;
+          "activity", Branch_activity;
+          "lnh", Branch_lnh;
+        ] in
+        { config with branching = parse_enum branchings }
+    | "decay" ->
+        { config with decay = parse_float (fun f -> f > 0. && f <= 1.) }
+    | "lifted" ->
+        { config with lifted = parse_enum ["true", true; "false", false] }
+    | "ldsb" ->
+        { config with ldsb = parse_enum ["true", true; "false", false] }
+    | "commit-distance" -> { config with commit_distance = parse_int 1 }
+    | "adaptive-distance" -> { config with adaptive_distance = parse_int 0 }
+    | "extensional" ->
+        { config with
+          extensional = parse_enum ["true", true; "false", false] }
+    | _ -> failwith ("Gecode.override: unknown option: " ^ key)
+
 external create : int -> t = "gecode_create"
 
+external create_with_config : int -> config -> t =
+  "gecode_create_with_config"
+
 external destroy : t -> unit = "gecode_destroy"
 
 external new_bool_var : t -> bool var = "gecode_new_bool_var"
@@ -31,6 +138,14 @@ external bool_element : t -> bool var_array -> int var -> bool var -> unit =
 external int_element : t -> int var_array -> int var -> int var -> unit =
     "gecode_int_element"
 
+external bool_matrix_element : t -> bool var_array ->
+  (int var, [> `R]) Earray.t -> (int, [> `R]) Earray.t -> int -> bool var ->
+  unit = "gecode_bool_matrix_element_bytecode" "gecode_bool_matrix_element"
+
+external int_matrix_element : t -> int var_array ->
+  (int var, [> `R]) Earray.t -> (int, [> `R]) Earray.t -> int -> int var ->
+  unit = "gecode_int_matrix_element_bytecode" "gecode_int_matrix_element"
+
 external eq_var_var : t -> int var -> int var -> bool var -> unit =
     "gecode_eq_var_var"
 
@@ -49,10 +164,39 @@ external clause : t -> (bool var, [> `R]) Earray.t ->
 external all_different : t -> (int var, [> `R]) Earray.t -> unit =
     "gecode_all_different"
 
+external extensional : t -> (int var, [> `R]) Earray.t ->
+  (int, [> `R]) Earray.t -> unit = "gecode_extensional"
+
+external extensional_clauses : t -> bool = "gecode_extensional_clauses"
+
+external lifted_clause : t -> (int, [> `R]) Earray.t ->
+  (int * int, [> `R]) Earray.t -> (int * int, [> `R]) Earray.t ->
+  ((bool var_array, int var_array) Csp_solver.lifted_atom, [> `R]) Earray.t ->
+  ((bool var_array, int var_array) Csp_solver.lifted_atom, [> `R]) Earray.t ->
+  unit = "gecode_lifted_clause_bytecode" "gecode_lifted_clause"
+
+external lifted_clauses : t -> bool = "gecode_lifted_clauses"
+
+external symmetric_table : t -> (int var, [> `R]) Earray.t ->
+  (int, [> `R]) Earray.t -> (int, [> `R]) Earray.t -> unit =
+    "gecode_symmetric_table"
+
+external symmetric_tables : t -> bool = "gecode_symmetric_tables"
+
 external solve : t -> Sh.lbool = "gecode_solve"
 
 external interrupt : t -> unit = "gecode_interrupt"
 
+external poll_progress : t -> Sh.progress list = "gecode_poll_progress"
+
+external last_stats : t -> stats = "gecode_last_stats"
+
+let stats_to_string stats =
+  Printf.sprintf
+    "%d fails, %d nodes, %d propagations, depth %d, %d restarts, %d nogoods"
+    stats.fails stats.nodes stats.propagations
+    stats.max_depth stats.restarts stats.nogoods
+
 external bool_value : t -> bool var -> int = "gecode_bool_value"
 
 external int_value : t -> int var -> int = "gecode_int_value"
@@ -9,8 +9,123 @@ type t
 type 'a var = private int
 type 'a var_array = private int
 
+(** Cutoff sequence of the restart-based search.
+   The cutoff is the number of failures after which the search
+   is restarted.
+*)
+type restart =
+  | Restart_none
+  (** Depth-first search without restarts. *)
+  | Restart_luby
+  (** Luby sequence multiplied by [restart_scale]. *)
+  | Restart_geom
+  (** Geometric sequence [restart_scale * restart_base ^ i]. *)
+
+(** Branching strategy. Variables of the interpreted symbols
+   are assigned before the variables of the auxiliary symbols
+   and the smallest value is tried first.
+*)
+type branching =
+  | Branch_size
+  (** Variable with the smallest domain. *)
+  | Branch_afc
+  (** Variable with the largest accumulated failure count
+     divided by the domain size.
+  *)
+  | Branch_activity
+  (** Variable with the largest activity divided by the domain size. *)
+  | Branch_lnh
+  (** Variables restricted by LNH ({!Csp_inst}) in the order
+     in which LNH processed them, then [Branch_size].
+  *)
+
+(** Statistics of one call to [solve]. The counters are summed
+   over all threads and restarts.
+*)
+type stats = {
+  fails : int;
+  nodes : int;
+  propagations : int;
+  max_depth : int;
+  (** Maximal depth of the search stack since the engine was created. *)
+  restarts : int;
+  nogoods : int;
+}
+
+type config = {
+  restart : restart;
+  restart_scale : int;
+  restart_base : float;
+  nogoods_limit : int;
+  (** No-goods are extracted from the search path up to this depth
+     at each restart and posted to the restarted search.
+     Zero disables no-goods. Ignored when the solver has more than
+     one thread because no-goods from parallel search lose solutions.
+  *)
+  branching : branching;
+  decay : float;
+  (** Decay factor of the failure counts and activities
+     applied after each failure. [1.] means no decay.
+  *)
+  lifted : bool;
+  (** Post clauses with [lifted_clause] instead of grounding them. *)
+  ldsb : bool;
+  (** Break the symmetries of the sorts with lightweight dynamic
+     symmetry breaking instead of LNH. {!Csp_inst} declares the tables
+     with [symmetric_table] and the branching on the variables
+     of the interpreted symbols skips the assignments which are
+     symmetric to the already refuted ones. Unlike LNH
+     no sort is blocked by another sort.
+  *)
+  commit_distance : int;
+  (** The search engine clones a space after every [commit_distance]
+     branching decisions. Other spaces are recomputed by replaying
+     the decisions. Larger values save the clones which are expensive
+     for big models, smaller values make the stealing of work
+     by parallel search cheaper.
+  *)
+  adaptive_distance : int;
+  (** During recomputation the engine clones an intermediate space
+     when it has to replay more than [adaptive_distance] decisions.
+  *)
+  extensional : bool;
+  (** {!Csp_inst} compiles the clauses with one or two small cells
+     into tuple sets which are posted as extensional constraints.
+     They propagate better than the clauses of reified equalities.
+  *)
+}
+
+(** Depth-first search without restarts, [Branch_size] branching,
+   lifted clauses, LNH, the default recomputation distances
+   of Gecode ([Search::Config::c_d] and [Search::Config::a_d])
+   and no extensional constraints.
+*)
+val default_config : config
+
+(** [override config "key=value"] sets the field [key] of [config].
+   Keys are: [restart] (values [none], [luby], [geom]),
+   [restart-scale] (positive integer), [restart-base] (float greater
+   than 1), [nogoods-limit] (non-negative integer),
+   [branching] (values [size], [afc], [activity], [lnh]),
+   [decay] (float in the interval (0, 1]), [lifted]
+   and [ldsb] (values [true], [false]), [commit-distance]
+   (positive integer), [adaptive-distance] (non-negative integer)
+   and [extensional] (values [true], [false]).
+
+   Raises [Failure] when the key or the value is invalid.
+*)
+val override : config -> string -> config
+
 external create : int -> t = "gecode_create"
 
+(** [create_with_config nthreads config] creates a solver
+   with the given search configuration. When [nthreads] is greater
+   than one, restart-based search restarts parallel search
+   but records no no-goods (see [nogoods_limit]).
+*)
+external create_with_config : int -> config -> t =
+  "gecode_create_with_config"
+
 external destroy : t -> unit = "gecode_destroy"
 
 external new_bool_var : t -> bool var = "gecode_new_bool_var"
@@ -27,6 +142,10 @@ external new_bool_var_array : t -> (bool var, [> `R]) Earray.t ->
 external new_int_var_array : t -> (int var, [> `R]) Earray.t ->
   int var_array = "gecode_new_int_var_array"
 
+(** [linear s vars coefs c] posts constraint
+   [vars.(0) * coefs.(0) + vars.(1) * coefs.(1) + ... = c].
+   Not part of {!Csp_solver.S} since {!Csp_inst} doesn't need it.
+*)
 external linear : t -> (int var, [> `R]) Earray.t -> (int, [> `R]) Earray.t ->
   int -> unit = "gecode_linear"
 
@@ -36,6 +155,14 @@ external bool_element : t -> bool var_array -> int var -> bool var -> unit =
 external int_element : t -> int var_array -> int var -> int var -> unit =
     "gecode_int_element"
 
+external bool_matrix_element : t -> bool var_array ->
+  (int var, [> `R]) Earray.t -> (int, [> `R]) Earray.t -> int -> bool var ->
+  unit = "gecode_bool_matrix_element_bytecode" "gecode_bool_matrix_element"
+
+external int_matrix_element : t -> int var_array ->
+  (int var, [> `R]) Earray.t -> (int, [> `R]) Earray.t -> int -> int var ->
+  unit = "gecode_int_matrix_element_bytecode" "gecode_int_matrix_element"
+
 external eq_var_var : t -> int var -> int var -> bool var -> unit =
     "gecode_eq_var_var"
 
@@ -54,10 +181,43 @@ external clause : t -> (bool var, [> `R]) Earray.t ->
 external all_different : t -> (int var, [> `R]) Earray.t -> unit =
     "gecode_all_different"
 
+external extensional : t -> (int var, [> `R]) Earray.t ->
+  (int, [> `R]) Earray.t -> unit = "gecode_extensional"
+
+(** Returns the field [extensional] of the configuration. *)
+external extensional_clauses : t -> bool = "gecode_extensional_clauses"
+
+(** One propagator checks all instances of the clause. *)
+external lifted_clause : t -> (int, [> `R]) Earray.t ->
+  (int * int, [> `R]) Earray.t -> (int * int, [> `R]) Earray.t ->
+  ((bool var_array, int var_array) Csp_solver.lifted_atom, [> `R]) Earray.t ->
+  ((bool var_array, int var_array) Csp_solver.lifted_atom, [> `R]) Earray.t ->
+  unit = "gecode_lifted_clause_bytecode" "gecode_lifted_clause"
+
+external lifted_clauses : t -> bool = "gecode_lifted_clauses"
+
+(** Symmetries are broken by LDSB when the field [ldsb]
+   of the configuration is set.
+*)
+external symmetric_table : t -> (int var, [> `R]) Earray.t ->
+  (int, [> `R]) Earray.t -> (int, [> `R]) Earray.t -> unit =
+    "gecode_symmetric_table"
+
+(** Returns the field [ldsb] of the configuration. *)
+external symmetric_tables : t -> bool = "gecode_symmetric_tables"
+
 external solve : t -> Sh.lbool = "gecode_solve"
 
 external interrupt : t -> unit = "gecode_interrupt"
 
+external poll_progress : t -> Sh.progress list = "gecode_poll_progress"
+
+(** Returns the statistics of the last call to {!solve}. *)
+external last_stats : t -> stats = "gecode_last_stats"
+
+(** Formats the statistics for the verbose output. *)
+val stats_to_string : stats -> string
+
 external bool_value : t -> bool var -> int = "gecode_bool_value"
 
 external int_value : t -> int var -> int = "gecode_int_value"
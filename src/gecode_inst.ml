@@ -1,3 +1,11 @@
 (* Copyright (c) 2013 Radek Micek *)
 
-module Inst = Csp_inst.Make (Gecode)
+let config = ref Gecode.default_config
+
+module Gecode_ex = Csp_record.Make (struct
+  include Gecode
+
+  let create nthreads = Gecode.create_with_config nthreads !config
+end)
+
+module Inst = Csp_inst.Make (Gecode_ex)
@@ -2,5 +2,10 @@
 
 (** Instantiation for Gecode. *)
 
-(** Instantiation for Gecode. *)
+(** Search configuration of the solvers created by {!Inst.create}. *)
+val config : Gecode.config ref
+
+(** Instantiation for Gecode. The models are recorded
+   to {!Csp_record.channel}.
+*)
 module Inst : Csp_inst.Inst_sig with type solver = Gecode.t
@@ -15,12 +15,34 @@ external add_clause : t -> (lit, [> `R]) Earray.t -> int -> bool =
 
 external solve : t -> (lit, [> `R]) Earray.t -> Sh.lbool = "josat_solve"
 
+external set_conf_budget : t -> int -> unit = "josat_set_conf_budget"
+
+external set_prop_budget : t -> int -> unit = "josat_set_prop_budget"
+
+external last_stats : t -> Sat_solver.stats = "josat_last_stats"
+
+external set_phase : t -> var -> bool -> unit = "josat_set_phase"
+
+external get_phase : t -> var -> bool = "josat_get_phase"
+
+external set_activity : t -> var -> float -> unit = "josat_set_activity"
+
+external get_activity : t -> var -> float = "josat_get_activity"
+
+external add_learnt : t -> (lit, [> `R]) Earray.t -> int -> bool =
+  "josat_add_learnt"
+
+external export_learnts : t -> int -> int -> (lit, [`R]) Earray.t list =
+  "josat_export_learnts"
+
 external model_value : t -> var -> Sh.lbool = "josat_model_value"
 
 external interrupt : t -> unit = "josat_interrupt"
 
 external clear_interrupt : t -> unit = "josat_clear_interrupt"
 
+external poll_progress : t -> Sh.progress list = "josat_poll_progress"
+
 let to_lit sign v = match sign with
   | Sh.Pos -> v + v
   | Sh.Neg -> v + v + 1
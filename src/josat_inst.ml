@@ -23,6 +23,14 @@ module Josat_ex : Sat_inst.Solver = struct
     *)
     remove_clauses_with_lit' s lit
 
+  (* No variable elimination. *)
+  let set_frozen _ _ _ = ()
+
+  let set_max_size _ _ = ()
+
+  (* Value variables can't be shared by single value constraints. *)
+  let shared_totality_clauses = false
+
 end
 
 module Inst = Sat_inst.Make (Josat_ex)
@@ -452,6 +452,8 @@ let generate_lemmas_by_e
 type solver_config = {
   nthreads : int;
   all_models : bool;
+  (* Solve independent components of the problem separately. *)
+  components : bool;
   n_from : int;
   n_to : int;
   in_file : string;
@@ -459,6 +461,12 @@ type solver_config = {
   output_file : string option;
   start_ms : int;
   max_ms : int option;
+  (* Learnt clauses from an earlier run. *)
+  learnts_in : Sat_inst.learnts;
+  (* File where the learnt clauses are saved for another run. *)
+  learnts_out : string option;
+  (* Print progress of the solver while solving. *)
+  progress : bool;
 }
 
 let with_output ?(append = false) cfg f =
@@ -526,23 +534,57 @@ let print_with_time cfg str =
   Printf.fprintf stderr "%s (%d ms)\n" str (Timer.get_ms () - cfg.start_ms);
   flush stderr
 
-let call_solver cfg inst solve solve_timed =
-  match remaining_ms cfg with
-    | None ->
-        begin match solve inst with
-          | Sh.Ltrue -> Sh.Ltrue
-          | Sh.Lfalse -> Sh.Lfalse
-          | Sh.Lundef ->
-              failwith "unexpected result from the solver"
-        end
-    | Some ms ->
-        begin match solve_timed inst ms with
-          | _, true -> Sh.Lundef
-          | Sh.Ltrue, _ -> Sh.Ltrue
-          | Sh.Lfalse, _ -> Sh.Lfalse
-          | Sh.Lundef, _ ->
-              failwith "unexpected result from the solver"
-        end
+let progress_ms = 1000
+
+(* Prints the last snapshot. *)
+let print_progress cfg progress =
+  match List.rev progress with
+    | [] -> ()
+    | p :: _ ->
+        print_with_time cfg
+          (Printf.sprintf "Progress: %d conflicts, %d decisions, depth %d"
+             p.Sh.conflicts p.Sh.decisions p.Sh.depth)
+
+let call_solver cfg inst solve solve_timed poll_progress =
+  let call () =
+    match remaining_ms cfg with
+      | None ->
+          begin match solve inst with
+            | Sh.Ltrue -> Sh.Ltrue
+            | Sh.Lfalse -> Sh.Lfalse
+            | Sh.Lundef ->
+                failwith "unexpected result from the solver"
+          end
+      | Some ms ->
+          begin match solve_timed inst ms with
+            | _, true -> Sh.Lundef
+            | Sh.Ltrue, _ -> Sh.Ltrue
+            | Sh.Lfalse, _ -> Sh.Lfalse
+            | Sh.Lundef, _ ->
+                failwith "unexpected result from the solver"
+          end in
+  if cfg.progress then begin
+    (* Discard snapshots of the previous calls. *)
+    ignore (poll_progress inst);
+    Timer.with_periodic progress_ms
+      (fun () -> print_progress cfg (poll_progress inst))
+      call
+  end else
+    call ()
+
+(* Only short learnt clauses with low glue are saved. *)
+let learnt_max_len = 8
+let learnt_max_glue = 5
+
+(* Models can't be blocked when the problem is decomposed
+   so all models are searched without decomposition.
+*)
+let with_components cfg (module Inst : Sat_inst.Inst_sig) =
+  if cfg.components && not cfg.all_models then
+    let module Comp_inst = Sat_inst.Make_components (Inst) in
+    (module Comp_inst : Sat_inst.Inst_sig)
+  else
+    (module Inst : Sat_inst.Inst_sig)
 
 let sat_solve (module Inst : Sat_inst.Inst_sig) tp sorts cfg =
   let print_instantiating dsize =
@@ -563,6 +605,15 @@ let sat_solve (module Inst : Sat_inst.Inst_sig) tp sorts cfg =
   let inst = Inst.create ~nthreads:cfg.nthreads p sorts in
   let model_cnt = ref 0 in
 
+  (* Learnt clauses are imported when the domain size is big enough. *)
+  let learnts_in = ref cfg.learnts_in in
+  let import_learnts () =
+    let n = Inst.import_learnts inst !learnts_in in
+    if n > 0 then begin
+      print_with_time cfg (Printf.sprintf "Imported %d learnt clauses" n);
+      learnts_in := Sat_inst.no_learnts
+    end in
+
   for dsize = 1 to cfg.n_from - 1 do
     print_instantiating dsize;
     Inst.incr_max_size inst
@@ -572,6 +623,7 @@ let sat_solve (module Inst : Sat_inst.Inst_sig) tp sorts cfg =
     let dsize = cfg.n_from in
     print_instantiating dsize;
     Inst.incr_max_size inst;
+    import_learnts ();
     if dsize < (Symb.distinct_consts p.Prob.symbols |> Symb.Set.cardinal) then
       let () = write_summary cfg S_gave_up in
       Printf.fprintf stderr "\n"
@@ -586,7 +638,8 @@ let sat_solve (module Inst : Sat_inst.Inst_sig) tp sorts cfg =
           let () = write_summary S_timeout in
           print_with_time cfg "\nTime out"
         else begin
-          match call_solver cfg inst Inst.solve Inst.solve_timed with
+          match call_solver cfg inst Inst.solve Inst.solve_timed
+                  Inst.poll_progress with
             | Sh.Ltrue ->
                 write_summary S_satisfiable;
                 incr tot_ms_model_cnt;
@@ -630,6 +683,7 @@ let sat_solve (module Inst : Sat_inst.Inst_sig) tp sorts cfg =
       else begin
         print_instantiating dsize;
         Inst.incr_max_size inst;
+        import_learnts ();
         let result =
           if
             dsize < (Symb.distinct_consts p.Prob.symbols |> Symb.Set.cardinal)
@@ -637,7 +691,8 @@ let sat_solve (module Inst : Sat_inst.Inst_sig) tp sorts cfg =
             Sh.Lfalse
           else
             let _ = print_with_time cfg "Solving" in
-            call_solver cfg inst Inst.solve Inst.solve_timed in
+            call_solver cfg inst Inst.solve Inst.solve_timed
+              Inst.poll_progress in
         match result with
           | Sh.Ltrue ->
               write_summary cfg S_satisfiable;
@@ -657,6 +712,19 @@ let sat_solve (module Inst : Sat_inst.Inst_sig) tp sorts cfg =
     loop cfg.n_from
   end;
 
+  BatOption.may
+    (fun file ->
+      let learnts =
+        Inst.export_learnts inst learnt_max_len learnt_max_glue in
+      BatPervasives.with_dispose
+        ~dispose:close_out
+        (fun out -> Marshal.to_channel out learnts [])
+        (open_out_bin file);
+      print_with_time cfg
+        (Printf.sprintf "Exported %d learnt clauses"
+           (Sat_inst.learnt_count learnts)))
+    cfg.learnts_out;
+
   match !model_cnt with
     | 0 -> print_with_time cfg "No model found"
     | 1 -> print_with_time cfg "1 model found"
@@ -667,7 +735,8 @@ let sat_solve (module Inst : Sat_inst.Inst_sig) tp sorts cfg =
 
 let minisat_solver =
   let s_func tp sorts cfg =
-    sat_solve (module Minisat_inst.Inst : Sat_inst.Inst_sig) tp sorts cfg in
+    let inst = with_components cfg (module Minisat_inst.Inst : Sat_inst.Inst_sig) in
+    sat_solve inst tp sorts cfg in
   {
     s_func;
     s_only_flat_clauses = true;
@@ -679,7 +748,8 @@ let minisat_solver =
 
 let cmsat_solver =
   let s_func tp sorts cfg =
-    sat_solve (module Cmsat_inst.Inst : Sat_inst.Inst_sig) tp sorts cfg in
+    let inst = with_components cfg (module Cmsat_inst.Inst : Sat_inst.Inst_sig) in
+    sat_solve inst tp sorts cfg in
   {
     s_func;
     s_only_flat_clauses = true;
@@ -691,7 +761,8 @@ let cmsat_solver =
 
 let josat_solver =
   let s_func tp sorts cfg =
-    sat_solve (module Josat_inst.Inst : Sat_inst.Inst_sig) tp sorts cfg in
+    let inst = with_components cfg (module Josat_inst.Inst : Sat_inst.Inst_sig) in
+    sat_solve inst tp sorts cfg in
   {
     s_func;
     s_only_flat_clauses = true;
@@ -710,20 +781,23 @@ module Csp_inst_to_sat_inst (C : Csp_inst.Inst_sig) :
   type solver = C.solver
 
   type t = {
-    prob : [`R] Prob.t;
-    sorts : Sorts.t;
+    (* Compiled when the first domain size is instantiated
+       and shared by all domain sizes.
+    *)
+    compiled : C.compiled Lazy.t;
     nthreads : int option;
     mutable n : int;
     mutable csp_inst : C.t option;
   }
 
-  let create ?nthreads prob sorts = {
-    prob = Prob.read_only prob;
-    sorts;
-    nthreads;
-    n = 0;
-    csp_inst = None;
-  }
+  let create ?nthreads prob sorts =
+    let prob = Prob.read_only prob in
+    {
+      compiled = lazy (C.compile prob sorts);
+      nthreads;
+      n = 0;
+      csp_inst = None;
+    }
 
   let incr_max_size inst =
     inst.n <- inst.n + 1;
@@ -732,7 +806,9 @@ module Csp_inst_to_sat_inst (C : Csp_inst.Inst_sig) :
   let get_csp_inst inst =
     let csp_inst =
       begin match inst.csp_inst with
-        | None -> C.create ?nthreads:inst.nthreads inst.prob inst.sorts inst.n
+        | None ->
+            C.instantiate ?nthreads:inst.nthreads
+              (Lazy.force inst.compiled) inst.n
         | Some csp_inst -> csp_inst
       end in
     inst.csp_inst <- Some csp_inst;
@@ -746,6 +822,15 @@ module Csp_inst_to_sat_inst (C : Csp_inst.Inst_sig) :
     let csp_inst = get_csp_inst inst in
     C.solve_timed csp_inst ms
 
+  let interrupt _ = failwith "Csp_inst_to_sat_inst.interrupt"
+
+  let clear_interrupt _ = failwith "Csp_inst_to_sat_inst.clear_interrupt"
+
+  let poll_progress inst =
+    match inst.csp_inst with
+      | None -> []
+      | Some csp_inst -> C.poll_progress csp_inst
+
   let construct_model inst =
     match inst.csp_inst with
       | None -> failwith "Csp_inst_to_sat_inst.construct_model"
@@ -753,16 +838,42 @@ module Csp_inst_to_sat_inst (C : Csp_inst.Inst_sig) :
 
   let block_model _ _ = ()
 
+  let export_learnts _ _ _ = Sat_inst.no_learnts
+
+  let import_learnts _ _ = 0
+
   let get_solver _ = failwith "Csp_inst_to_sat_inst.get_solver"
 
   let get_max_size inst = inst.n
 end
 
-module Gecode_inst = Csp_inst_to_sat_inst (Gecode_inst.Inst)
+(* Print statistics of each call to Gecode. *)
+let gecode_stats = ref false
+
+module Gecode_sat_inst = Csp_inst_to_sat_inst (struct
+  include Gecode_inst.Inst
+
+  let print_stats inst =
+    if !gecode_stats then begin
+      let stats = Gecode.last_stats (get_solver inst) in
+      Printf.fprintf stderr "Gecode: %s\n" (Gecode.stats_to_string stats);
+      flush stderr
+    end
+
+  let solve inst =
+    let result = Gecode_inst.Inst.solve inst in
+    print_stats inst;
+    result
+
+  let solve_timed inst ms =
+    let result = Gecode_inst.Inst.solve_timed inst ms in
+    print_stats inst;
+    result
+end)
 
 let gecode_solver =
   let s_func tp sorts cfg =
-    sat_solve (module Gecode_inst : Sat_inst.Inst_sig) tp sorts cfg in
+    sat_solve (module Gecode_sat_inst : Sat_inst.Inst_sig) tp sorts cfg in
   {
     s_func;
     s_only_flat_clauses = false;
@@ -835,9 +946,19 @@ let find_model
     detect_commutativity_from_lemmas
     transforms
     solver
+    cmsat_profile
+    cmsat_opts
+    gecode_opts
+    record_csp
+    solver_stats
+    solver_stats_config
+    proof_dir
+    learnts_in
+    learnts_out
     n_from
     n_to
     all_models
+    no_components
     nthreads
     max_secs
     disable_sort_inference
@@ -866,9 +987,39 @@ let find_model
         | C_e -> Eprover.clausify clausifier_exe clausifier_opts
     end else
       fun _ -> failwith "No clausifier specified" in
+  if
+    proof_dir <> None &&
+    not (List.mem solver [Solv_cmsat; Solv_minisat])
+  then
+    failwith "Proofs are supported only by cryptominisat and minisat.";
+  if solver_stats <> None && not (Cmsat.stats_supported ()) then
+    failwith "Solver statistics require CryptoMiniSat with SQLite support.";
+  (* Statistics of this run replace those of the previous runs. *)
+  BatOption.may
+    (fun db -> Cmsat.delete_stats db solver_stats_config in_file)
+    solver_stats;
   let tptp_prob = Tptp_prob.of_file clausify base_dir in_file in
   let p = tptp_prob.Tptp_prob.prob in
   let solver = List.assoc solver all_solvers in
+  Cmsat_inst.config :=
+    List.fold_left
+      Cmsat.override
+      {
+        Cmsat.default_config with
+          Cmsat.profile = cmsat_profile;
+          Cmsat.stats_db = solver_stats;
+      }
+      cmsat_opts;
+  Cmsat_inst.stats_tags := [
+    "config_name", solver_stats_config;
+    "problem", in_file;
+  ];
+  Cmsat_inst.proof_dir := proof_dir;
+  gecode_stats := verbose >= 2;
+  Gecode_inst.config :=
+    List.fold_left Gecode.override Gecode.default_config gecode_opts;
+  Csp_record.channel := BatOption.map open_out record_csp;
+  Minisat_inst.proof_dir := proof_dir;
   let transforms =
     match transforms with
       | [] -> solver.s_default_transforms
@@ -927,6 +1078,8 @@ let find_model
   let cfg = {
     nthreads;
     all_models;
+    (* Each solver writes its own proof. *)
+    components = not no_components && proof_dir = None;
     n_from;
     n_to;
     in_file;
@@ -934,6 +1087,17 @@ let find_model
     output_file;
     start_ms;
     max_ms = BatOption.map (fun secs -> secs * 1000) max_secs;
+    learnts_in =
+      BatOption.map_default
+        (fun file ->
+          BatPervasives.with_dispose
+            ~dispose:close_in
+            (fun inp -> (Marshal.from_channel inp : Sat_inst.learnts))
+            (open_in_bin file))
+        Sat_inst.no_learnts
+        learnts_in;
+    learnts_out;
+    progress = verbose >= 2;
   } in
   if contains_empty_clause p then
     let () = write_summary cfg S_unsatisfiable in
@@ -1037,7 +1201,10 @@ let detect_commutativity_from_lemmas =
            ~docv:"BOOL" ~doc ~docs:"LEMMA GENERATION")
 
 let verbose =
-  let doc = "Verbosity level of the program. $(docv) can be: 0, 1, 2, 3." in
+  let doc =
+    "Verbosity level of the program. $(docv) can be: 0, 1, 2, 3. " ^
+    "Level 2 and higher prints progress of the solver every second " ^
+    "and statistics of each call to Gecode." in
   Arg.(value & opt int 1 & info ["v"; "verbose"] ~docv:"N" ~doc)
 
 let disable_sort_inference =
@@ -1068,6 +1235,12 @@ let all_models =
   let doc = "Find all models." in
   Arg.(value & flag & info ["all-models"] ~doc)
 
+let no_components =
+  let doc =
+    "Don't split the problem into independent components " ^
+    "which are solved separately. Only SAT solvers split the problem." in
+  Arg.(value & flag & info ["no-components"] ~doc)
+
 let solver =
   let doc =
     "$(docv) can be: cryptominisat, minisat, josat, gecode, only-preproc." in
@@ -1081,6 +1254,96 @@ let solver =
   Arg.(value & opt (enum values) Solv_cmsat &
          info ["solver"] ~docv:"SOLVER" ~doc)
 
+let cmsat_profile =
+  let doc =
+    "Configuration profile for CryptoMiniSat. " ^
+    "$(docv) can be: default, incremental, aggressive, low-memory." in
+  Arg.(value & opt (enum Cmsat.profiles) Cmsat.Default &
+         info ["cmsat-profile"] ~docv:"PROFILE" ~doc ~docs:"CRYPTOMINISAT")
+
+(* Option KEY=VALUE which is accepted by [override default]. *)
+let override_opt override default =
+  let parse opt =
+    try
+      ignore (override default opt);
+      `Ok opt
+    with
+      | Failure msg -> `Error msg in
+  parse, Format.pp_print_string
+
+let cmsat_opts =
+  let doc =
+    "Override the field of the CryptoMiniSat profile. " ^
+    "$(docv) is KEY=VALUE where KEY can be: bva, var-elim, probe, cache, " ^
+    "max-cache-size-mb, restart, clean, max-mem-mb." in
+  let opt = override_opt Cmsat.override Cmsat.default_config in
+  Arg.(value & opt_all opt [] &
+         info ["cmsat-opt"] ~docv:"OPTION" ~doc ~docs:"CRYPTOMINISAT")
+
+let gecode_opts =
+  let doc =
+    "Set the field of the Gecode search configuration. " ^
+    "$(docv) is KEY=VALUE where KEY can be: restart (none, luby, geom), " ^
+    "restart-scale, restart-base, nogoods-limit, " ^
+    "branching (size, afc, activity, lnh), decay, lifted (true, false), " ^
+    "ldsb (true, false), commit-distance, adaptive-distance, " ^
+    "extensional (true, false). " ^
+    "With $(b,--threads) greater than 1, restart-based search " ^
+    "records no no-goods and nogoods-limit is ignored." in
+  let opt = override_opt Gecode.override Gecode.default_config in
+  Arg.(value & opt_all opt [] &
+         info ["gecode-opt"] ~docv:"OPTION" ~doc ~docs:"GECODE")
+
+let record_csp =
+  let doc =
+    "Record the CSP models given to Gecode to $(docv). " ^
+    "The models can be solved again by replay_csp." in
+  Arg.(value & opt (some string) None &
+         info ["record-csp"] ~docv:"FILE" ~doc ~docs:"GECODE")
+
+let solver_stats =
+  let doc =
+    "Write statistics of CryptoMiniSat for each domain size " ^
+    "(propagations, conflicts, glue distribution, time of simplifications) " ^
+    "to the SQLite database $(docv). The database may be a report " ^
+    "of the benchmark scripts. CryptoMiniSat must be compiled " ^
+    "with SQLite support." in
+  Arg.(value & opt (some string) None &
+         info ["solver-stats"] ~docv:"DB" ~doc ~docs:"CRYPTOMINISAT")
+
+let solver_stats_config =
+  let doc =
+    "Configuration name under which the statistics are written " ^
+    "by $(b,--solver-stats)." in
+  Arg.(value & opt string "" &
+         info ["solver-stats-config"] ~docv:"NAME" ~doc ~docs:"CRYPTOMINISAT")
+
+let proof_dir =
+  let doc =
+    "Write proofs of nonexistence of models to the directory $(docv). " ^
+    "For each domain size without a model the clauses and assumptions " ^
+    "given to the SAT solver and a binary DRAT proof are written. " ^
+    "The proofs can be checked by scripts/check_proofs. " ^
+    "Supported by cryptominisat and minisat. Implies $(b,--no-components), " ^
+    "imported learnt clauses are ignored." in
+  Arg.(value & opt (some dir) None &
+         info ["proof-dir"] ~docv:"DIR" ~doc)
+
+let learnts_in =
+  let doc =
+    "Import learnt clauses saved by $(b,--export-learnts). " ^
+    "The problem and the preprocessing must be the same " ^
+    "but the SAT solver may differ." in
+  Arg.(value & opt (some non_dir_file) None &
+         info ["import-learnts"] ~docv:"FILE" ~doc)
+
+let learnts_out =
+  let doc =
+    "Save short learnt clauses of the SAT solver to $(docv) " ^
+    "when the search ends." in
+  Arg.(value & opt (some string) None &
+         info ["export-learnts"] ~docv:"FILE" ~doc)
+
 let transforms =
   let flags = [
     T_detect_commutativity,
@@ -1114,10 +1377,11 @@ let find_model_t =
           lemma_gen $ lemma_gen_exe $ lemma_gen_opts $ lemma_gen_max_secs $
           max_vars $ max_symbs $ max_vars_when_flat $ max_lits_when_flat $
           max_lemmas $ detect_commutativity_from_lemmas $
-          transforms $ solver $
-          n_from $ n_to $ all_models $
-          nthreads $ max_secs $ disable_sort_inference $ verbose $
-          output_file $ base_dir $ in_file)
+          transforms $ solver $ cmsat_profile $ cmsat_opts $
+          gecode_opts $ record_csp $ solver_stats $ solver_stats_config $
+          proof_dir $ learnts_in $ learnts_out $ n_from $ n_to $ all_models $
+          no_components $ nthreads $ max_secs $ disable_sort_inference $
+          verbose $ output_file $ base_dir $ in_file)
 
 let info =
   let doc = "finite model finder" in
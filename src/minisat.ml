@@ -15,12 +15,36 @@ external add_clause : t -> (lit, [> `R]) Earray.t -> int -> bool =
 
 external solve : t -> (lit, [> `R]) Earray.t -> Sh.lbool = "minisat_solve"
 
+external set_conf_budget : t -> int -> unit = "minisat_set_conf_budget"
+
+external set_prop_budget : t -> int -> unit = "minisat_set_prop_budget"
+
+external last_stats : t -> Sat_solver.stats = "minisat_last_stats"
+
+external set_phase : t -> var -> bool -> unit = "minisat_set_phase"
+
+external get_phase : t -> var -> bool = "minisat_get_phase"
+
+external set_activity : t -> var -> float -> unit = "minisat_set_activity"
+
+external get_activity : t -> var -> float = "minisat_get_activity"
+
+external add_learnt : t -> (lit, [> `R]) Earray.t -> int -> bool =
+  "minisat_add_learnt"
+
+external export_learnts : t -> int -> int -> (lit, [`R]) Earray.t list =
+  "minisat_export_learnts"
+
 external model_value : t -> var -> Sh.lbool = "minisat_model_value"
 
 external interrupt : t -> unit = "minisat_interrupt"
 
 external clear_interrupt : t -> unit = "minisat_clear_interrupt"
 
+external poll_progress : t -> Sh.progress list = "minisat_poll_progress"
+
+external start_proof : t -> string -> unit = "minisat_start_proof"
+
 let to_lit sign v = match sign with
   | Sh.Pos -> v + v
   | Sh.Neg -> v + v + 1
@@ -26,12 +26,66 @@ external add_clause : t -> (lit, [> `R]) Earray.t -> int -> bool =
 *)
 external solve : t -> (lit, [> `R]) Earray.t -> Sh.lbool = "minisat_solve"
 
+(** Limits the number of conflicts in each subsequent call to {!solve}.
+   When the limit is reached {!solve} returns [Lundef].
+   Negative value removes the limit.
+*)
+external set_conf_budget : t -> int -> unit = "minisat_set_conf_budget"
+
+(** Limits the number of propagations in each subsequent call
+   to {!solve}. Negative value removes the limit.
+*)
+external set_prop_budget : t -> int -> unit = "minisat_set_prop_budget"
+
+(** Returns the statistics of the last call to {!solve}. *)
+external last_stats : t -> Sat_solver.stats = "minisat_last_stats"
+
+(** Sets the preferred value of the variable for the decision heuristic.
+   The solver may change it later (e.g. by phase saving).
+*)
+external set_phase : t -> var -> bool -> unit = "minisat_set_phase"
+
+(** Returns the preferred value of the variable. *)
+external get_phase : t -> var -> bool = "minisat_get_phase"
+
+(** Sets the activity of the variable for the decision heuristic. *)
+external set_activity : t -> var -> float -> unit = "minisat_set_activity"
+
+(** Returns the activity of the variable. *)
+external get_activity : t -> var -> float = "minisat_get_activity"
+
+(** [add_learnt s lits n] adds the clause containing the first [n] literals
+   from [lits] as a learnt clause. The clause must be implied
+   by the clauses of the solver. Unlike {!add_clause} the clause
+   may be removed when the solver reduces its learnt clauses.
+*)
+external add_learnt : t -> (lit, [> `R]) Earray.t -> int -> bool =
+  "minisat_add_learnt"
+
+(** [export_learnts s max_len max_glue] returns the learnt clauses
+   with at most [max_len] literals and glue at most [max_glue]
+   and the literals assigned at decision level 0 as unit clauses.
+   MiniSat doesn't compute glue so the length of the clause is used.
+*)
+external export_learnts : t -> int -> int -> (lit, [`R]) Earray.t list =
+  "minisat_export_learnts"
+
 external model_value : t -> var -> Sh.lbool = "minisat_model_value"
 
 external interrupt : t -> unit = "minisat_interrupt"
 
 external clear_interrupt : t -> unit = "minisat_clear_interrupt"
 
+external poll_progress : t -> Sh.progress list = "minisat_poll_progress"
+
+(** [start_proof s prefix] finishes the current part of the proof
+   and starts a new part with the path prefix [prefix]
+   (see {!Sat_solver.proof_part}). The first part must be started
+   before any variable is created. After that clauses added
+   by {!add_learnt} are ignored since they can't be derived in the proof.
+*)
+external start_proof : t -> string -> unit = "minisat_start_proof"
+
 val to_lit : Sh.sign -> var -> lit
 
 val to_var : lit -> var
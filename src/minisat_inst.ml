@@ -1,8 +1,20 @@
 (* Copyright (c) 2013 Radek Micek *)
 
+let proof_dir = ref None
+
 module Minisat_ex : Sat_inst.Solver = struct
   include Minisat
 
+  let start_proof s n =
+    BatOption.may
+      (fun dir -> Minisat.start_proof s (Sat_solver.proof_part dir n))
+      !proof_dir
+
+  let create () =
+    let s = Minisat.create () in
+    start_proof s 0;
+    s
+
   let new_false_var = Minisat.new_var
 
   let add_symmetry_clause = Minisat.add_clause
@@ -13,6 +25,13 @@ module Minisat_ex : Sat_inst.Solver = struct
 
   let remove_clauses_with_lit s lit =
     ignore (Minisat.add_clause s (Earray.singleton lit) 1)
+
+  (* No variable elimination. *)
+  let set_frozen _ _ _ = ()
+
+  let set_max_size = start_proof
+
+  let shared_totality_clauses = true
 end
 
 module Inst = Sat_inst.Make (Minisat_ex)
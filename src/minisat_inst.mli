@@ -2,6 +2,12 @@
 
 (** Instantiation for MiniSat. *)
 
+(** Directory where the solvers created by {!Inst.create} write
+   the proofs of unsatisfiability for each maximum domain size
+   (see {!Sat_solver.proof_part}). [None] means no proofs.
+*)
+val proof_dir : string option ref
+
 (** MiniSat solver. *)
 module Minisat_ex : Sat_inst.Solver
 
@@ -0,0 +1,71 @@
+(* Copyright (c) 2015 Radek Micek *)
+
+open Cmdliner
+
+let replay gecode_opts nthreads max_secs in_file =
+  if nthreads < 0 then
+    failwith "Invalid number of threads.";
+  let config =
+    List.fold_left Gecode.override Gecode.default_config gecode_opts in
+  let module Replay = Csp_record.Replay (struct
+    include Gecode
+
+    (* The recorded number of threads is ignored. *)
+    let create _ = Gecode.create_with_config nthreads config
+  end) in
+  let solve i s =
+    let start_ms = Timer.get_ms () in
+    let result, _ =
+      match max_secs with
+        | None -> Gecode.solve s, false
+        | Some secs ->
+            Timer.with_timer (secs * 1000)
+              (fun () -> Gecode.interrupt s)
+              (fun () -> Gecode.solve s) in
+    let ms = Timer.get_ms () - start_ms in
+    let result =
+      match result with
+        | Sh.Ltrue -> "sat"
+        | Sh.Lfalse -> "unsat"
+        | Sh.Lundef -> "unknown" in
+    let stats = Gecode.last_stats s in
+    Printf.printf "model %d: %s (%d ms, %s)\n%!"
+      i result ms (Gecode.stats_to_string stats) in
+  let ic = open_in in_file in
+  BatPervasives.finally
+    (fun () -> close_in ic)
+    (Replay.each_model ic) solve
+
+let in_file =
+  let doc = "File with CSP models recorded by $(b,crossbow --record-csp)." in
+  Arg.(required & pos 0 (some non_dir_file) None & info [] ~docv:"INPUT" ~doc)
+
+let gecode_opts =
+  let doc =
+    "Set the field of the Gecode search configuration. " ^
+    "$(docv) is KEY=VALUE with the same keys as in " ^
+    "$(b,crossbow --gecode-opt)." in
+  Arg.(value & opt_all string [] &
+         info ["gecode-opt"] ~docv:"OPTION" ~doc)
+
+let nthreads =
+  let doc =
+    "Number of threads. Zero means as many threads as processing units." in
+  Arg.(value & opt int 0 & info ["threads"] ~docv:"N" ~doc)
+
+let max_secs =
+  let doc = "Stop search of each model after $(docv) seconds." in
+  Arg.(value & opt (some int) None &
+         info ["max-secs"] ~docv:"N" ~doc)
+
+let replay_t =
+  Term.(pure replay $ gecode_opts $ nthreads $ max_secs $ in_file)
+
+let info =
+  let doc = "solve recorded CSP models by Gecode" in
+  Term.info "replay_csp" ~version:"0.1" ~doc
+
+let () =
+  match Term.eval (replay_t, info) with
+    | `Error _ -> exit 2
+    | _ -> exit 0
@@ -12,8 +12,37 @@ module type Solver = sig
   val add_at_most_one_val_clause : t -> (lit, [> `R]) Earray.t -> bool
 
   val remove_clauses_with_lit : t -> lit -> unit
+
+  val set_frozen : t -> var -> bool -> unit
+
+  val set_max_size : t -> int -> unit
+
+  val shared_totality_clauses : bool
 end
 
+(* Sign, symbol, maximal element (-1 for nullary predicates)
+   and position of the variable in the block.
+*)
+type learnt_lit = Sh.sign * Symb.id * int * int
+
+(* Learnt clauses of one instance. *)
+type learnts_part = {
+  (* Identifies the problem and its sorts. *)
+  lt_fingerprint : Digest.t;
+
+  lt_max_size : int;
+
+  lt_clauses : (learnt_lit, [`R]) Earray.t list;
+}
+
+(* Instances of the components of a problem export one part each. *)
+type learnts = learnts_part list
+
+let no_learnts = []
+
+let learnt_count learnts =
+  List.fold_left (fun n part -> n + List.length part.lt_clauses) 0 learnts
+
 module type Inst_sig = sig
   type solver
 
@@ -27,10 +56,20 @@ module type Inst_sig = sig
 
   val solve_timed : t -> int -> Sh.lbool * bool
 
+  val interrupt : t -> unit
+
+  val clear_interrupt : t -> unit
+
+  val poll_progress : t -> Sh.progress list
+
   val construct_model : t -> Ms_model.t
 
   val block_model : t -> Ms_model.t -> unit
 
+  val export_learnts : t -> int -> int -> learnts
+
+  val import_learnts : t -> learnts -> int
+
   val get_solver : t -> solver
 
   val get_max_size : t -> int
@@ -94,6 +133,17 @@ struct
     (* Propositional variables for symbols (except nullary predicates). *)
     pvars : (Symb.id, pvar BatDynArray.t) Hashtbl.t;
 
+    (* Blocks of the propositional variables of the symbols
+       in the order of creation. Block (first_pvar, cnt, symb, max_el)
+       contains the variables for the symbol [symb] and the maximal
+       element [max_el]. Nullary predicates have max_el = -1.
+       Used for exporting learnt clauses.
+    *)
+    pvar_blocks : (pvar * int * Symb.id * int) BatDynArray.t;
+
+    (* Digest of the problem and its sorts. *)
+    fingerprint : Digest.t;
+
     (* Except nullary predicates. *)
     adeq_sizes : (Symb.id, ((int, [`R]) Earray.t * commutative)) BatMap.t;
 
@@ -118,6 +168,23 @@ struct
     *)
     mutable totality_clauses_switch : pvar option;
 
+    (* Activation literal of the shared totality clauses together with
+       the domain size for which it was created. Totality clauses
+       of the cells which may get bigger values are implied
+       by the negation of the activation literal.
+    *)
+    mutable totality_act : (int * pvar) option;
+
+    (* Tails of the shared totality clauses. For each cell
+       (symb_id, rank, max_el) whose values may grow the table contains
+       the variable which is true when the cell has a value bigger than
+       the biggest value in its totality clauses and that value.
+    *)
+    totality_tails : (Symb.id * int * int, pvar * int) Hashtbl.t;
+
+    (* Cells whose chain of the shared totality clauses is closed. *)
+    closed_totality_cells : (Symb.id * int * int, unit) Hashtbl.t;
+
     (* Current maximal domain size. *)
     mutable max_size : int;
 
@@ -131,6 +198,9 @@ struct
     mutable assig_by_symred_list : (Symred.cell * (int * int)) list;
 
     mutable can_construct_model : bool;
+
+    (* Learnt clauses may depend on the clauses blocking models. *)
+    mutable models_blocked : bool;
   }
 
   let create ?nthreads prob sorts =
@@ -147,10 +217,15 @@ struct
 
     (* Create propositional variables for nullary predicates. *)
     let nullary_pred_pvars = Hashtbl.create 20 in
+    let pvar_blocks = BatDynArray.create () in
     List.iter
       (fun (symb, sorts) ->
-        if Earray.length sorts = 0 then
-          Hashtbl.add nullary_pred_pvars symb (Solv.new_var solver))
+        if Earray.length sorts = 0 then begin
+          let pvar = Solv.new_var solver in
+          Solv.set_frozen solver pvar true;
+          Hashtbl.add nullary_pred_pvars symb pvar;
+          BatDynArray.add pvar_blocks (pvar, 1, symb, -1)
+        end)
       sorted_symb_sorts;
 
     (* Prepare hashtable with propositional variables of symbols. *)
@@ -277,6 +352,18 @@ struct
         sorts.Sorts.symb_sorts
         0 in
 
+    let fingerprint =
+      let cls =
+        BatDynArray.to_list prob.Prob.clauses
+        |> List.map (fun cl -> cl.Clause2.cl_lits) in
+      let symbs =
+        List.map
+          (fun (symb, sorts) ->
+            symb, sorts, Symb.commutative prob.Prob.symbols symb)
+          sorted_symb_sorts in
+      Digest.string
+        (Marshal.to_string (cls, symbs, sorts.Sorts.adeq_sizes) []) in
+
     {
       symred;
       solver;
@@ -285,6 +372,8 @@ struct
       lnh = true;
       nullary_pred_pvars;
       pvars;
+      pvar_blocks;
+      fingerprint;
       adeq_sizes;
       funcs = Earray.of_dyn_array funcs;
       clauses = Earray.of_dyn_array clauses;
@@ -292,13 +381,21 @@ struct
       max_symb_size;
       min_size = Symb.distinct_consts prob.Prob.symbols |> Symb.Set.cardinal;
       totality_clauses_switch = None;
+      totality_act = None;
+      totality_tails = Hashtbl.create 50;
+      closed_totality_cells = Hashtbl.create 50;
       max_size = 0;
       assig_by_symred = Hashtbl.create 50;
       assig_by_symred_list = [];
       can_construct_model = false;
+      models_blocked = false;
     }
 
-  (* Add propositional variables for predicate and function symbols. *)
+  (* Add propositional variables for predicate and function symbols.
+
+     The variables are frozen since they may appear in the clauses
+     added for bigger domain sizes and in the clauses blocking models.
+  *)
   let add_prop_vars inst =
     BatMap.iter
       (fun symb (adeq_sizes, commutative) ->
@@ -310,9 +407,13 @@ struct
           count 0 (Earray.length adeq_sizes) adeq_sizes inst.max_size in
         if cnt > 0 then begin
           let pvars = Hashtbl.find inst.pvars symb in
-          BatDynArray.add pvars (Solv.new_var inst.solver);
+          let first = Solv.new_var inst.solver in
+          Solv.set_frozen inst.solver first true;
+          BatDynArray.add pvars first;
+          BatDynArray.add
+            inst.pvar_blocks (first, cnt, symb, inst.max_size - 1);
           for i = 2 to cnt do
-            ignore (Solv.new_var inst.solver)
+            Solv.set_frozen inst.solver (Solv.new_var inst.solver) true
           done
         end)
       inst.adeq_sizes
@@ -322,6 +423,53 @@ struct
     let pvar = r + BatDynArray.get pvars a.(max_el_idx) in
     pvar
 
+  (* Seeds the phases and the activities of the variables created
+     for the new maximal element [e] from the variables of the element [e-1].
+     The new element is treated as a copy of the element [e-1]:
+     the variable for [f(.., e, ..) = v] gets the phase and the activity
+     of the variable for [f(.., e-1, ..) = v].
+     Variables for [f(..) = e] keep the default phase.
+
+     The phases of the old variables come from the last assignment
+     found by the solver, so satisfiable domain sizes often start
+     with an extension of the last model.
+  *)
+  let seed_new_vars inst =
+    let e = inst.max_size - 1 in
+    if e >= 1 then
+      BatMap.iter
+        (fun symb (adeq_sizes, commutative) ->
+          let pvars = Hashtbl.find inst.pvars symb in
+          let len = Earray.length adeq_sizes in
+          let nargs =
+            if len = Symb.arity symb + 1
+            then len - 1
+            else len in
+          let each, rank =
+            if commutative
+            then Assignment.each_comm_me, Assignment.rank_comm_me
+            else Assignment.each_me, Assignment.rank_me in
+          let a = Earray.copy adeq_sizes in
+          let a' = Earray.copy adeq_sizes in
+          each a 0 len adeq_sizes inst.max_size
+            (fun a ->
+              let e_in_args = ref false in
+              for i = 0 to nargs - 1 do
+                if a.(i) = e then e_in_args := true
+              done;
+              if !e_in_args && (nargs = len || a.(nargs) <> e) then begin
+                for i = 0 to len - 1 do
+                  a'.(i) <- if a.(i) = e then e - 1 else a.(i)
+                done;
+                let pvar = assig_to_pvar a len adeq_sizes rank pvars in
+                let pvar' = assig_to_pvar a' len adeq_sizes rank pvars in
+                Solv.set_phase inst.solver pvar
+                  (Solv.get_phase inst.solver pvar');
+                Solv.set_activity inst.solver pvar
+                  (Solv.get_activity inst.solver pvar')
+              end))
+        inst.adeq_sizes
+
   let symmetry_reduction inst pclause =
     let assigned_cells = Symred.incr_max_size inst.symred in
     List.iter
@@ -532,8 +680,10 @@ struct
   let incr_max_size inst =
     inst.max_size <- inst.max_size + 1;
     inst.can_construct_model <- false;
+    Solv.set_max_size inst.solver inst.max_size;
 
     add_prop_vars inst;
+    seed_new_vars inst;
 
     (* Disable old "at least one value" clauses. *)
     begin match inst.totality_clauses_switch with
@@ -541,6 +691,7 @@ struct
       | Some pvar ->
           let plit = Solv.to_lit Sh.Pos pvar in
           Solv.remove_clauses_with_lit inst.solver plit;
+          Solv.set_frozen inst.solver pvar false;
           inst.totality_clauses_switch <- None;
     end;
 
@@ -557,9 +708,58 @@ struct
     add_at_most_one_val_clauses inst pclause;
     instantiate_clauses inst pclause
 
+  (* Calls [fn cell res_max_el val_lit] for each cell of the function [f]
+     which isn't assigned by symmetry reduction.
+     [val_lit result] is the literal which is true iff the cell
+     has the value [result].
+  *)
+  let iter_unassigned_cells inst f fn =
+    let adeq_sizes, commutative = BatMap.find f inst.adeq_sizes in
+    let pvars = Hashtbl.find inst.pvars f in
+    let arity = Earray.length adeq_sizes - 1 in
+    let res_max_el =
+      if
+        adeq_sizes.(arity) = 0 ||
+        adeq_sizes.(arity) >= inst.max_size
+      then inst.max_size - 1
+      else adeq_sizes.(arity) - 1 in
+    let each, rank =
+      if commutative
+      then Assignment.each_comm_me, Assignment.rank_comm_me
+      else Assignment.each_me, Assignment.rank_me in
+    (* Process argument vector. *)
+    let proc_arg_vec a =
+      let cell =
+        if arity = 0 then
+          (f, 0, -1)
+        else
+          let r, max_el_idx = rank a 0 arity adeq_sizes in
+          (f, r, a.(max_el_idx)) in
+      (* Skip cells assigned by symmetry reduction. *)
+      if not (Hashtbl.mem inst.assig_by_symred cell) then begin
+        let val_lit result =
+          a.(arity) <- result;
+          let pvar = assig_to_pvar a (arity+1) adeq_sizes rank pvars in
+          Solv.to_lit Sh.Pos pvar in
+        fn cell res_max_el val_lit
+      end in
+
+    let a = Earray.copy adeq_sizes in
+
+    (* Constants are processed separately since both each_me
+       and each_comm_me don't produce any assignment.
+    *)
+    if arity = 0 then
+      proc_arg_vec a
+    else
+      for max_size = 1 to inst.max_size do
+        each a 0 arity adeq_sizes max_size proc_arg_vec
+      done
+
   let add_at_least_one_val_clauses inst =
     if inst.totality_clauses_switch = None then begin
       let switch = Solv.new_false_var inst.solver in
+      Solv.set_frozen inst.solver switch true;
       inst.totality_clauses_switch <- Some switch;
 
       let pclause =
@@ -570,77 +770,127 @@ struct
 
       Earray.iter
         (fun f ->
-          let adeq_sizes, commutative = BatMap.find f inst.adeq_sizes in
-          let pvars = Hashtbl.find inst.pvars f in
-          let arity = Earray.length adeq_sizes - 1 in
-          let res_max_el =
-            if
-              adeq_sizes.(arity) = 0 ||
-              adeq_sizes.(arity) >= inst.max_size
-            then inst.max_size - 1
-            else adeq_sizes.(arity) - 1 in
-          let each, rank =
-            if commutative
-            then Assignment.each_comm_me, Assignment.rank_comm_me
-            else Assignment.each_me, Assignment.rank_me in
-          (* Process argument vector. *)
-          let proc_arg_vec a =
-            let assig_by_symred =
-              if arity = 0 then
-                Hashtbl.mem inst.assig_by_symred (f, 0, -1)
-              else
-                let r, max_el_idx = rank a 0 arity adeq_sizes in
-                Hashtbl.mem inst.assig_by_symred (f, r, a.(max_el_idx)) in
-            (* Skip cells assigned by symmetry reduction. *)
-            if not assig_by_symred then begin
+          iter_unassigned_cells inst f
+            (fun _ res_max_el val_lit ->
               for result = 0 to res_max_el  do
-                a.(arity) <- result;
-                let pvar = assig_to_pvar a (arity+1) adeq_sizes rank pvars in
-                let plit = Solv.to_lit Sh.Pos pvar in
-                pclause.(result) <- plit
+                pclause.(result) <- val_lit result
               done;
               pclause.(res_max_el + 1) <- Solv.to_lit Sh.Pos switch;
               ignore (Solv.add_at_least_one_val_clause
                         inst.solver
                         pclause
-                        (res_max_el + 2))
-            end in
-
-          let a = Earray.copy adeq_sizes in
-
-          (* Constants are processed separately since both each_me
-             and each_comm_me don't produce any assignment.
-          *)
-          if arity = 0 then
-            proc_arg_vec a
-          else
-            for max_size = 1 to inst.max_size do
-              each a 0 arity adeq_sizes max_size proc_arg_vec
-            done)
+                        (res_max_el + 2))))
         inst.funcs
     end
 
+  (* Extends the shared totality clauses to the current domain size.
+     Returns the activation literal for the current domain size.
+
+     The totality clauses of a cell form a chain
+     [v_0 | ... | v_m1 | t1], [~t1 | v_m1+1 | ... | v_m2 | t2], ...
+     where the tail [t_i] means that the value of the cell is bigger
+     than [m_i]. Each tail is implied by the activation literal
+     of the domain size for which it was created: [~t_i | act_i].
+     When the range of the values of the cell is final the chain
+     is closed by a clause without a tail and the cell is skipped
+     afterwards.
+
+     Only the last tail of each cell and the current activation literal
+     may appear in future clauses so the older ones are not frozen.
+  *)
+  let add_shared_totality_clauses inst =
+    let act =
+      match inst.totality_act with
+        | Some (max_size, act) when max_size = inst.max_size -> act
+        | old ->
+            BatOption.may
+              (fun (_, old_act) -> Solv.set_frozen inst.solver old_act false)
+              old;
+            let act = Solv.new_var inst.solver in
+            Solv.set_frozen inst.solver act true;
+            inst.totality_act <- Some (inst.max_size, act);
+            act in
+
+    let pclause =
+      Earray.make
+        (* + 2 is for the tails. *)
+        (inst.max_size + 2)
+        (Solv.to_lit Sh.Pos 0) in
+
+    Earray.iter
+      (fun f ->
+        let adeq_sizes, _ = BatMap.find f inst.adeq_sizes in
+        let res_adeq_size = adeq_sizes.(Earray.length adeq_sizes - 1) in
+        (* Values of the cells can't grow. *)
+        let final = res_adeq_size > 0 && res_adeq_size <= inst.max_size in
+        iter_unassigned_cells inst f
+          (fun cell res_max_el val_lit ->
+            if not (Hashtbl.mem inst.closed_totality_cells cell) then begin
+              let len, lo =
+                try
+                  let tail, max_el = Hashtbl.find inst.totality_tails cell in
+                  pclause.(0) <- Solv.to_lit Sh.Neg tail;
+                  1, max_el + 1
+                with Not_found -> 0, 0 in
+              if lo <= res_max_el || (final && len = 1) then begin
+                (* Old tail won't appear in future clauses. *)
+                if len = 1 then
+                  Solv.set_frozen inst.solver (Solv.to_var pclause.(0)) false;
+                for result = lo to res_max_el do
+                  pclause.(len + result - lo) <- val_lit result
+                done;
+                let len = len + max 0 (res_max_el - lo + 1) in
+                if final then begin
+                  Hashtbl.remove inst.totality_tails cell;
+                  Hashtbl.add inst.closed_totality_cells cell ();
+                  ignore (Solv.add_clause inst.solver pclause len)
+                end else begin
+                  let tail = Solv.new_var inst.solver in
+                  Solv.set_frozen inst.solver tail true;
+                  Hashtbl.replace inst.totality_tails cell (tail, res_max_el);
+                  pclause.(len) <- Solv.to_lit Sh.Pos tail;
+                  ignore (Solv.add_clause inst.solver pclause (len + 1));
+                  pclause.(0) <- Solv.to_lit Sh.Neg tail;
+                  pclause.(1) <- Solv.to_lit Sh.Pos act;
+                  ignore (Solv.add_clause inst.solver pclause 2)
+                end
+              end
+            end))
+      inst.funcs;
+    act
+
   let solve inst =
     if inst.max_size < 1 then
       failwith "solve: max_size must be at least 1";
     if inst.max_size < inst.min_size then
       failwith "solve: max_size is too small";
     ban_values_eliminated_by_symmetry_reduction inst;
-    add_at_least_one_val_clauses inst;
-    match inst.totality_clauses_switch with
-      | None -> failwith "solve: impossible"
-      | Some switch ->
-          let result =
-            Solv.solve inst.solver
-              (Earray.of_array [| Solv.to_lit Sh.Neg switch |]) in
-          inst.can_construct_model <- result = Sh.Ltrue;
-          result
+    let switch =
+      if Solv.shared_totality_clauses then
+        add_shared_totality_clauses inst
+      else begin
+        add_at_least_one_val_clauses inst;
+        match inst.totality_clauses_switch with
+          | None -> failwith "solve: impossible"
+          | Some switch -> switch
+      end in
+    let result =
+      Solv.solve inst.solver
+        (Earray.of_array [| Solv.to_lit Sh.Neg switch |]) in
+    inst.can_construct_model <- result = Sh.Ltrue;
+    result
 
   let solve_timed inst ms =
     Timer.with_timer ms
       (fun () -> Solv.interrupt inst.solver)
       (fun () -> solve inst)
 
+  let interrupt inst = Solv.interrupt inst.solver
+
+  let clear_interrupt inst = Solv.clear_interrupt inst.solver
+
+  let poll_progress inst = Solv.poll_progress inst.solver
+
   let construct_model inst =
     if not inst.can_construct_model then
       failwith "construct_model: no model";
@@ -796,10 +1046,220 @@ struct
       model.Ms_model.symbs;
 
     let pclause = Earray.of_dyn_array pclause in
+    inst.models_blocked <- true;
     ignore (Solv.add_clause inst.solver pclause (Earray.length pclause))
 
+  (* Raises [Not_found] when the variable of [plit] isn't a variable
+     of a symbol.
+  *)
+  let to_learnt_lit inst plit =
+    let pvar = Solv.to_var plit in
+    let blocks = inst.pvar_blocks in
+    (* Index of the last block which starts at or before pvar. *)
+    let rec find lo hi =
+      if lo >= hi then
+        lo - 1
+      else
+        let mid = (lo + hi) / 2 in
+        let first, _, _, _ = BatDynArray.get blocks mid in
+        if first <= pvar
+        then find (mid + 1) hi
+        else find lo mid in
+    let i = find 0 (BatDynArray.length blocks) in
+    if i < 0 then
+      raise Not_found;
+    let first, cnt, symb, max_el = BatDynArray.get blocks i in
+    if pvar >= first + cnt then
+      raise Not_found;
+    let sign =
+      if plit = Solv.to_lit Sh.Pos pvar
+      then Sh.Pos
+      else Sh.Neg in
+    (sign, symb, max_el, pvar - first)
+
+  let of_learnt_lit inst (sign, symb, max_el, pos) =
+    let pvar =
+      if max_el < 0
+      then Hashtbl.find inst.nullary_pred_pvars symb
+      else BatDynArray.get (Hashtbl.find inst.pvars symb) max_el + pos in
+    Solv.to_lit sign pvar
+
+  let export_learnts inst max_len max_glue =
+    let lt_clauses =
+      (* Closed totality clauses contain no auxiliary variable
+         so the learnt clauses derived from them can't be recognized.
+      *)
+      if
+        inst.models_blocked ||
+        Hashtbl.length inst.closed_totality_cells > 0
+      then
+        []
+      else
+        Solv.export_learnts inst.solver max_len max_glue
+        |> BatList.filter_map
+            (fun pclause ->
+              try Some (Earray.map (to_learnt_lit inst) pclause)
+              with Not_found -> None) in
+    [{
+      lt_fingerprint = inst.fingerprint;
+      lt_max_size = inst.max_size;
+      lt_clauses;
+    }]
+
+  let import_learnts inst learnts =
+    let parts =
+      List.filter
+        (fun part -> part.lt_fingerprint = inst.fingerprint)
+        learnts in
+    if learnts <> [] && parts = [] then
+      failwith "import_learnts: different problem";
+    List.fold_left
+      (fun n part ->
+        if inst.max_size < part.lt_max_size then
+          n
+        else
+          List.fold_left
+            (fun n cl ->
+              let pclause = Earray.map (of_learnt_lit inst) cl in
+              ignore
+                (Solv.add_learnt inst.solver pclause (Earray.length pclause));
+              n + 1)
+            n part.lt_clauses)
+      0 parts
+
   let get_solver inst = inst.solver
 
   let get_max_size inst = inst.max_size
 
 end
+
+module Make_components (Inst : Inst_sig) :
+  Inst_sig with type solver = Inst.solver list =
+struct
+  type solver = Inst.solver list
+
+  type t = {
+    insts : Inst.t list;
+    mutable max_size : int;
+  }
+
+  let create ?nthreads prob sorts =
+    {
+      insts =
+        Components.split prob sorts
+        |> List.map
+            (fun c -> Inst.create ?nthreads c.Components.prob c.Components.sorts);
+      max_size = 0;
+    }
+
+  let incr_max_size inst =
+    inst.max_size <- inst.max_size + 1;
+    List.iter Inst.incr_max_size inst.insts
+
+  (* Each component is solved in its own thread.
+     Only the search runs in parallel since the solvers release
+     the runtime system while searching.
+
+     When [is_unsat] holds for the result of some component
+     the other components are interrupted since their results
+     don't matter.
+  *)
+  let solve_each inst solve is_unsat =
+    match inst.insts with
+      | [i] -> [solve i]
+      | insts ->
+          let interrupted = ref false in
+          let threads =
+            List.map
+              (fun i ->
+                let result = ref None in
+                let error = ref None in
+                let th =
+                  Thread.create
+                    (fun () ->
+                      try
+                        let res = solve i in
+                        result := Some res;
+                        if is_unsat res then begin
+                          interrupted := true;
+                          List.iter Inst.interrupt insts
+                        end
+                      with e -> error := Some e)
+                    () in
+                th, result, error)
+              insts in
+          List.iter (fun (th, _, _) -> Thread.join th) threads;
+          (* Interrupts of the solvers which have already finished
+             would stop the next call to [solve].
+          *)
+          if !interrupted then
+            List.iter Inst.clear_interrupt insts;
+          List.iter (fun (_, _, error) -> BatOption.may raise !error) threads;
+          List.map (fun (_, result, _) -> BatOption.get !result) threads
+
+  let combine results =
+    if List.mem Sh.Lfalse results then
+      Sh.Lfalse
+    else if List.for_all (fun res -> res = Sh.Ltrue) results then
+      Sh.Ltrue
+    else
+      Sh.Lundef
+
+  let solve inst =
+    combine (solve_each inst Inst.solve (fun res -> res = Sh.Lfalse))
+
+  let solve_timed inst ms =
+    let results =
+      solve_each inst
+        (fun i -> Inst.solve_timed i ms)
+        (fun (res, _) -> res = Sh.Lfalse) in
+    let result = combine (List.map fst results) in
+    (* Unsatisfiable component decides even when others were interrupted. *)
+    result, result = Sh.Lundef && List.exists snd results
+
+  let interrupt inst = List.iter Inst.interrupt inst.insts
+
+  let clear_interrupt inst = List.iter Inst.clear_interrupt inst.insts
+
+  let poll_progress inst =
+    List.concat (List.map Inst.poll_progress inst.insts)
+
+  let construct_model inst =
+    let symbs = ref Symb.Map.empty in
+    List.iter
+      (fun i ->
+        Symb.Map.iter
+          (fun s table -> symbs := Symb.Map.add s table !symbs)
+          (Inst.construct_model i).Ms_model.symbs)
+      inst.insts;
+    {
+      Ms_model.max_size = inst.max_size;
+      Ms_model.symbs = !symbs;
+    }
+
+  let block_model inst model =
+    match inst.insts with
+      | [i] -> Inst.block_model i model
+      | _ ->
+          (* Blocking clause would contain literals from all components. *)
+          failwith "block_model: problem has more components"
+
+  let export_learnts inst max_len max_glue =
+    List.concat
+      (List.map (fun i -> Inst.export_learnts i max_len max_glue) inst.insts)
+
+  let import_learnts inst learnts =
+    let imported =
+      List.map
+        (fun i ->
+          try Some (Inst.import_learnts i learnts)
+          with Failure _ -> None)
+        inst.insts in
+    if learnts <> [] && List.for_all (fun n -> n = None) imported then
+      failwith "import_learnts: different problem";
+    List.fold_left (fun n cnt -> n + BatOption.default 0 cnt) 0 imported
+
+  let get_solver inst = List.map Inst.get_solver inst.insts
+
+  let get_max_size inst = inst.max_size
+end
@@ -20,8 +20,57 @@ module type Solver = sig
   val add_at_most_one_val_clause : t -> (lit, [> `R]) Earray.t -> bool
 
   val remove_clauses_with_lit : t -> lit -> unit
+
+  (** Marks the variable which may (or may not) appear in future clauses.
+     Solvers with variable elimination shouldn't eliminate frozen variables.
+  *)
+  val set_frozen : t -> var -> bool -> unit
+
+  (** Informs the solver that the maximum domain size was increased.
+     Solvers may use it to label their statistics.
+  *)
+  val set_max_size : t -> int -> unit
+
+  (** [true] if totality clauses are shared by all domain sizes.
+
+     Shared totality clauses are ordinary clauses which are never removed.
+     When the domain size is increased the totality clause of each cell
+     is extended by a clause containing the new values.
+     Each domain size has its own activation literal which is assumed
+     to be false. Since no clause is removed, learnt clauses,
+     activities and phases remain valid for bigger domain sizes.
+
+     Otherwise the "at least one value" clauses for each domain size
+     are marked by a variable from {!new_false_var} and they are removed
+     by {!remove_clauses_with_lit} when the domain size is increased.
+     This is necessary for solvers where each value variable
+     can occur in at most one "at least one value" clause.
+  *)
+  val shared_totality_clauses : bool
 end
 
+(** Learnt clauses of a SAT solver which contain only
+   the propositional variables of the symbols. The variables are identified
+   by the symbol, the maximal element and the position in the block
+   of the variables for the symbol and the maximal element
+   (not by the numbering of the solver), so the clauses can be
+   imported into an instance of the same problem with a different solver.
+
+   The learnt clauses are implied by the clauses of the instance
+   without "at least one value" clauses (see {!Inst_sig.export_learnts}).
+   Since these clauses only grow with the maximum domain size,
+   the learnt clauses are valid for all bigger domain sizes.
+
+   The value can be marshalled.
+*)
+type learnts
+
+(** No learnt clauses. *)
+val no_learnts : learnts
+
+(** Number of the learnt clauses. *)
+val learnt_count : learnts -> int
+
 (** Instantiation for SAT solvers. *)
 module type Inst_sig = sig
   type solver
@@ -44,7 +93,8 @@ module type Inst_sig = sig
   (** Increases the maximum domain size:
 
      - Creates propositional variables.
-     - Removes old "at least one value" clauses.
+     - Removes old "at least one value" clauses
+       (unless {!Solver.shared_totality_clauses} is set).
      - Adds symmetry reduction clauses.
      - Adds "at most one value" clauses.
      - Instantiates the clauses with variables.
@@ -70,6 +120,21 @@ module type Inst_sig = sig
   *)
   val solve_timed : t -> int -> Sh.lbool * bool
 
+  (** Interrupts {!solve} or {!solve_timed} running in another thread.
+     Can be called before they start.
+  *)
+  val interrupt : t -> unit
+
+  (** Cancels {!interrupt} which wasn't noticed by the solver. *)
+  val clear_interrupt : t -> unit
+
+  (** Returns the progress snapshots published by the solver
+     since the previous call. Can be called from another thread
+     while {!solve} or {!solve_timed} runs. The snapshots
+     of the solvers of {!Make_components} are concatenated.
+  *)
+  val poll_progress : t -> Sh.progress list
+
   (** Constructs a multi-sorted model for all constants, non-auxiliary
      functions and non-auxiliary predicates.
 
@@ -82,6 +147,30 @@ module type Inst_sig = sig
   (** Blocks every model which is an extension of the given model. *)
   val block_model : t -> Ms_model.t -> unit
 
+  (** [export_learnts inst max_len max_glue] returns the learnt clauses
+     of the solver with at most [max_len] literals and glue
+     at most [max_glue]. Clauses with auxiliary variables
+     (e.g. activation literals of the totality clauses) are skipped.
+
+     Returns no learnt clauses after {!block_model} since they
+     may depend on the blocked models. Returns no learnt clauses
+     after a chain of the shared totality clauses was closed
+     since they may depend on its last clause which contains
+     no activation literal.
+  *)
+  val export_learnts : t -> int -> int -> learnts
+
+  (** Adds the learnt clauses exported from an instance of the same problem
+     to the solver. Returns the number of the added clauses.
+
+     The clauses are added only when the current maximum domain size
+     is at least the maximum domain size of the instance which exported
+     them, otherwise nothing is added and 0 is returned.
+     Raises [Failure] when the clauses were exported from an instance
+     of a different problem.
+  *)
+  val import_learnts : t -> learnts -> int
+
   (** Returns the solver instance. *)
   val get_solver : t -> solver
 
@@ -91,3 +180,13 @@ end
 
 module Make (Solv : Solver) :
   Inst_sig with type solver = Solv.t
+
+(** Instantiation which splits the problem into independent components
+   by {!Components.split} and instantiates each component separately.
+   When there are more components, they are solved in parallel threads.
+
+   The result is unsatisfiable iff some component is unsatisfiable.
+   Model blocking is supported only when there is a single component.
+*)
+module Make_components (Inst : Inst_sig) :
+  Inst_sig with type solver = Inst.solver list
@@ -1,5 +1,17 @@
 (* Copyright (c) 2013 Radek Micek *)
 
+type stats = {
+  conflicts : int;
+  decisions : int;
+  propagations : int;
+  learnt_lits : int;
+  restarts : int;
+  wall_time : float;
+}
+
+let proof_part dir max_size =
+  Filename.concat dir (Printf.sprintf "size-%d" max_size)
+
 module type S = sig
   type t
 
@@ -15,10 +27,26 @@ module type S = sig
 
   val solve : t -> (lit, [> `R]) Earray.t -> Sh.lbool
 
+  val set_phase : t -> var -> bool -> unit
+
+  val get_phase : t -> var -> bool
+
+  val set_activity : t -> var -> float -> unit
+
+  val get_activity : t -> var -> float
+
+  val add_learnt : t -> (lit, [> `R]) Earray.t -> int -> bool
+
+  val export_learnts : t -> int -> int -> (lit, [`R]) Earray.t list
+
   val model_value : t -> var -> Sh.lbool
 
   val interrupt : t -> unit
 
+  val clear_interrupt : t -> unit
+
+  val poll_progress : t -> Sh.progress list
+
   val to_lit : Sh.sign -> var -> lit
 
   val to_var : lit -> var
@@ -1,5 +1,31 @@
 (* Copyright (c) 2013 Radek Micek *)
 
+(** Statistics of one call to [solve]. *)
+type stats = {
+  conflicts : int;
+  decisions : int;
+  propagations : int;
+  (** Number of literals in the learnt clauses (after minimization). *)
+  learnt_lits : int;
+  restarts : int;
+  (** Wall-clock time in seconds. *)
+  wall_time : float;
+}
+
+(** [proof_part dir max_size] is the path prefix of the part
+   of the proof of unsatisfiability which is written by a solver
+   while the maximum domain size is [max_size]. Part [0] contains
+   the clauses added before the first domain size.
+
+   Each part consists of the files [prefix.cnf] with the clauses added
+   to the solver, [prefix.drat] with the clauses derived and deleted
+   by the solver in binary DRAT format and, if the solver found
+   that there's no model, [prefix.assumptions] with the assumptions
+   of the unsuccessful call to [solve] as unit clauses.
+   The proof for [max_size] consists of the parts [0] to [max_size].
+*)
+val proof_part : string -> int -> string
+
 module type S = sig
   type t
 
@@ -18,10 +44,47 @@ module type S = sig
   (** Starts the solver with the given assumptions. *)
   val solve : t -> (lit, [> `R]) Earray.t -> Sh.lbool
 
+  (** Sets the preferred value of the variable for the decision heuristic.
+     It's only a hint, the solver may change it later.
+  *)
+  val set_phase : t -> var -> bool -> unit
+
+  val get_phase : t -> var -> bool
+
+  (** Sets the activity of the variable for the decision heuristic. *)
+  val set_activity : t -> var -> float -> unit
+
+  val get_activity : t -> var -> float
+
+  (** Adds the clause which is implied by the clauses of the solver.
+     The solver may remove it later.
+  *)
+  val add_learnt : t -> (lit, [> `R]) Earray.t -> int -> bool
+
+  (** [export_learnts s max_len max_glue] returns the learnt clauses
+     with at most [max_len] literals and glue at most [max_glue]
+     and the literals assigned at decision level 0 as unit clauses.
+     Solvers which don't compute glue use the length of the clause.
+  *)
+  val export_learnts : t -> int -> int -> (lit, [`R]) Earray.t list
+
   val model_value : t -> var -> Sh.lbool
 
   val interrupt : t -> unit
 
+  (** Cancels {!interrupt} which wasn't noticed by [solve].
+     Otherwise the next call to [solve] is interrupted immediately.
+  *)
+  val clear_interrupt : t -> unit
+
+  (** Returns the snapshots which were published since the previous call,
+     the oldest first. The solver publishes a snapshot periodically
+     during the search and at the end of each call to [solve].
+     Only the newest snapshots are kept when nobody polls them.
+     Can be called from another thread while [solve] is running.
+  *)
+  val poll_progress : t -> Sh.progress list
+
   val to_lit : Sh.sign -> var -> lit
 
   val to_var : lit -> var
@@ -13,5 +13,11 @@ type lbool =
   | Lfalse
   | Lundef
 
+type progress = {
+  conflicts : int;
+  decisions : int;
+  depth : int;
+}
+
 module IntSet = BatSet.Make (BatInt)
 module IntMap = BatMap.Make (BatInt)
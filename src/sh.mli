@@ -13,5 +13,19 @@ type lbool =
   | Lfalse
   | Lundef
 
+(** Snapshot of the search published by a solver while it's solving.
+   The counters are totals since the solver was created.
+   CSP solvers report failed nodes as conflicts and expanded nodes
+   as decisions.
+*)
+type progress = {
+  conflicts : int;
+  decisions : int;
+  (** Decision level of a SAT solver, maximum depth of the search
+     stack of a CSP solver.
+  *)
+  depth : int;
+}
+
 module IntSet : BatSet.S with type elt = int
 module IntMap : BatMap.S with type key = int
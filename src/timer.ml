@@ -4,42 +4,66 @@ let get_ms () =
   let ns = Int64.to_int (Oclock.gettime Oclock.monotonic_raw) in
   ns / 1000000
 
-let with_timer ms callback f =
-  let max_ms = get_ms () + ms in
-  let callback_called = ref false in
+(* [with_thread loop f] runs [loop finished wait] in another thread
+   while [f] runs. [finished ()] tells whether [f] has finished
+   and [wait secs] waits at most [secs] seconds or until [f] finishes.
+*)
+let with_thread loop f =
   let finished = ref false in
   let m = Mutex.create () in
   let p_read, p_write = Unix.pipe () in
 
-  let callback_thread =
-    let rec loop () =
+  let is_finished () =
+    Mutex.lock m;
+    let fin = !finished in
+    Mutex.unlock m;
+    fin in
+  (* Waiting can be interrupted by writing to a pipe. *)
+  let wait secs = ignore (Unix.select [p_read] [] [] secs) in
+  let thread = Thread.create (fun () -> loop is_finished wait) () in
+
+  BatPervasives.with_dispose
+    ~dispose:(fun () ->
       Mutex.lock m;
-      let fin = !finished in
+      finished := true;
       Mutex.unlock m;
-      if fin then
-        ()
-      else if get_ms () > max_ms then begin
-        callback_called := true;
-        callback ()
-      end else begin
-        (* Waiting can be interrupted by writing to a pipe. *)
-        let _ = Unix.select [p_read] [] [] 0.4 in
-        loop ()
-      end in
-    Thread.create loop () in
-
-  let result =
-    BatPervasives.with_dispose
-      ~dispose:(fun () ->
-        Mutex.lock m;
-        finished := true;
-        Mutex.unlock m;
-        (* Interrupt waiting. *)
-        let _ = Unix.write p_write "x" 0 1 in
-        Thread.join callback_thread;
-        Unix.close p_write;
-        Unix.close p_read)
-      f
-      () in
+      (* Interrupt waiting. *)
+      let _ = Unix.write p_write "x" 0 1 in
+      Thread.join thread;
+      Unix.close p_write;
+      Unix.close p_read)
+    f
+    ()
 
+let with_timer ms callback f =
+  let max_ms = get_ms () + ms in
+  let callback_called = ref false in
+
+  let rec loop finished wait =
+    if finished () then
+      ()
+    else if get_ms () > max_ms then begin
+      callback_called := true;
+      callback ()
+    end else begin
+      wait 0.4;
+      loop finished wait
+    end in
+
+  let result = with_thread loop f in
   result, !callback_called
+
+let with_periodic ms callback f =
+  let rec loop next_ms finished wait =
+    let now = get_ms () in
+    if finished () then
+      ()
+    else if now >= next_ms then begin
+      callback ();
+      loop (next_ms + ms) finished wait
+    end else begin
+      wait (float (next_ms - now) /. 1000.);
+      loop next_ms finished wait
+    end in
+
+  with_thread (loop (get_ms () + ms)) f
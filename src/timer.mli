@@ -13,3 +13,11 @@ val get_ms : unit -> int
    [callback] must not raise exception.
 *)
 val with_timer : int -> (unit -> unit) -> (unit -> 'a) -> 'a * bool
+
+(** [with_periodic ms callback action] starts [action] and
+   calls [callback] in another thread every [ms] miliseconds
+   until [action] finishes. Returns the result of [action].
+
+   [callback] must not raise exception.
+*)
+val with_periodic : int -> (unit -> unit) -> (unit -> 'a) -> 'a
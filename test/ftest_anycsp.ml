@@ -8,24 +8,6 @@ module Make (Solv : Csp_solver.S) : sig
   val suite : string -> test
 end = struct
 
-  let test_linear () =
-    let s = Solv.create 1 in
-    let x = Solv.new_int_var s 6 in
-    Solv.linear s [| x |] [| 3 |] 12;
-    assert_equal Sh.Ltrue (Solv.solve s);
-    assert_equal 4 (Solv.int_value s x);
-    assert_equal Sh.Lfalse (Solv.solve s)
-
-  let test_linear2 () =
-    let s = Solv.create 1 in
-    let x = Solv.new_int_var s 7 in
-    let y = Solv.new_int_var s 7 in
-    Solv.linear s [| x; y |] [| ~-1; 5 |] 13;
-    assert_equal Sh.Ltrue (Solv.solve s);
-    assert_equal 2 (Solv.int_value s x);
-    assert_equal 3 (Solv.int_value s y);
-    assert_equal Sh.Lfalse (Solv.solve s)
-
   let test_bool_element () =
     let s = Solv.create 1 in
     let x = Solv.new_bool_var s in
@@ -64,12 +46,58 @@ end = struct
     Solv.eq_var_const s j 1 b';
     Solv.clause s [| b' |] [| |];
     Solv.int_element s arr j x1;
-    Solv.linear s [| y1; y2 |] [| 7; 3 |] 31;
+    let yes = Solv.new_tmp_bool_var s in
+    Solv.clause s [| yes |] [| |];
+    Solv.eq_var_const s y1 4 yes;
+    Solv.eq_var_const s y2 1 yes;
     assert_equal Sh.Ltrue (Solv.solve s);
     assert_equal 4 (Solv.int_value s x1);
     assert_equal 1 (Solv.int_value s x2);
     assert_equal Sh.Lfalse (Solv.solve s)
 
+  let test_bool_matrix_element () =
+    let s = Solv.create 1 in
+    (* Table 2 x 3 where only the cell (1, 2) is true. *)
+    let vars = Earray.init 6 (fun _ -> Solv.new_bool_var s) in
+    Earray.iteri
+      (fun k y ->
+        if k = 5
+        then Solv.clause s [| y |] [| |]
+        else Solv.clause s [| |] [| y |])
+      vars;
+    let arr = Solv.new_bool_var_array s vars in
+    let i = Solv.new_int_var s 2 in
+    let j = Solv.new_int_var s 3 in
+    let x = Solv.new_tmp_bool_var s in
+    Solv.clause s [| x |] [| |];
+    Solv.bool_matrix_element s arr [| i; j |] [| 3; 1 |] 0 x;
+    assert_equal Sh.Ltrue (Solv.solve s);
+    assert_equal 1 (Solv.int_value s i);
+    assert_equal 2 (Solv.int_value s j);
+    assert_equal Sh.Lfalse (Solv.solve s)
+
+  let test_int_matrix_element () =
+    let s = Solv.create 1 in
+    (* Table [| 3; 2; 1; 0 |]. *)
+    let vars = Earray.init 4 (fun _ -> Solv.new_int_var s 4) in
+    Earray.iteri
+      (fun k y ->
+        let b = Solv.new_tmp_bool_var s in
+        Solv.eq_var_const s y (3 - k) b;
+        Solv.clause s [| b |] [| |])
+      vars;
+    let arr = Solv.new_int_var_array s vars in
+    (* Index 2 * i + 1 is outside of the table for i = 2. *)
+    let i = Solv.new_int_var s 3 in
+    let x = Solv.new_tmp_int_var s 4 in
+    Solv.int_matrix_element s arr [| i |] [| 2 |] 1 x;
+    let b = Solv.new_tmp_bool_var s in
+    Solv.eq_var_const s x 0 b;
+    Solv.clause s [| b |] [| |];
+    assert_equal Sh.Ltrue (Solv.solve s);
+    assert_equal 1 (Solv.int_value s i);
+    assert_equal Sh.Lfalse (Solv.solve s)
+
   let test_eq_var_var_eq_var_const () =
     let s = Solv.create 1 in
     let yes = Solv.new_tmp_bool_var s in
@@ -101,9 +129,17 @@ end = struct
     let x = Solv.new_int_var s 5 in
     let y = Solv.new_int_var s 5 in
     Solv.lower_eq s y 3;
-    Solv.linear s [| x; y |] [| 1; 1 |] 7;
+    (* x = y, x >= 3. *)
+    let yes = Solv.new_tmp_bool_var s in
+    Solv.clause s [| yes |] [| |];
+    Solv.eq_var_var s x y yes;
+    let x3 = Solv.new_tmp_bool_var s in
+    let x4 = Solv.new_tmp_bool_var s in
+    Solv.eq_var_const s x 3 x3;
+    Solv.eq_var_const s x 4 x4;
+    Solv.clause s [| x3; x4 |] [| |];
     assert_equal Sh.Ltrue (Solv.solve s);
-    assert_equal 4 (Solv.int_value s x);
+    assert_equal 3 (Solv.int_value s x);
     assert_equal 3 (Solv.int_value s y);
     assert_equal Sh.Lfalse (Solv.solve s)
 
@@ -112,7 +148,12 @@ end = struct
     let x = Solv.new_int_var s 4 in
     let y = Solv.new_int_var s 4 in
     Solv.precede s [| x; y |] [| 1; 2; 3 |];
-    Solv.linear s [| x; y |] [| 1; 1 |] 3;
+    (* x <> y, x <> 0, y <> 0. *)
+    let no = Solv.new_tmp_bool_var s in
+    Solv.clause s [| |] [| no |];
+    Solv.eq_var_var s x y no;
+    Solv.eq_var_const s x 0 no;
+    Solv.eq_var_const s y 0 no;
     assert_equal Sh.Ltrue (Solv.solve s);
     assert_equal 1 (Solv.int_value s x);
     assert_equal 2 (Solv.int_value s y);
@@ -169,58 +210,127 @@ end = struct
     assert_equal 3 (Solv.int_value s x3);
     assert_equal Sh.Lfalse (Solv.solve s)
 
-  let test_pythagorean_triples () =
+  let test_extensional () =
     let s = Solv.create 1 in
-    let yes = Solv.new_tmp_bool_var s in
-    Solv.clause s [| yes |] [| |];
-    let n = 10 in
-    let sq_dom = n * n + 1 in
-    (* Variables equal to squares of positive numbers 1..n. *)
-    let sq_vars =
-      Earray.init n (fun i ->
-        let x = Solv.new_tmp_int_var s sq_dom in
-        Solv.eq_var_const s x ((i + 1) * (i + 1)) yes;
-        x) in
-    let sq_arr = Solv.new_int_var_array s sq_vars in
-    (* x, y, z are squares of positive numbers. *)
-    let i = Solv.new_int_var s n in
-    let x = Solv.new_int_var s sq_dom in
-    Solv.int_element s sq_arr i x;
-    let j = Solv.new_int_var s n in
-    let y = Solv.new_int_var s sq_dom in
-    Solv.int_element s sq_arr j y;
-    let k = Solv.new_int_var s n in
-    let z = Solv.new_int_var s sq_dom in
-    Solv.int_element s sq_arr k z;
-    (* x <= y (i.e. j - i - tmp = 0). *)
-    let tmp = Solv.new_tmp_int_var s n in
-    Solv.linear s [| i; j; tmp |] [| ~-1; 1; ~-1 |] 0;
-    (* x + y = z. *)
-    Solv.linear s [| x; y; z |] [| 1; 1; ~-1 |] 0;
+    let x = Solv.new_int_var s 3 in
+    let y = Solv.new_int_var s 3 in
+    let z = Solv.new_tmp_int_var s 3 in
+    (* x < y and y = z + 1. *)
+    Solv.extensional s [| x; y |] [| 0; 1; 0; 2; 1; 2 |];
+    Solv.extensional s [| y; z |] [| 1; 0; 2; 1 |];
+    let rec collect acc =
+      match Solv.solve s with
+        | Sh.Ltrue ->
+            collect ((Solv.int_value s x, Solv.int_value s y) :: acc)
+        | Sh.Lfalse -> List.sort compare acc
+        | Sh.Lundef -> failwith "collect" in
+    assert_equal [0, 1; 0, 2; 1, 2] (collect []);
+    (* No tuple. *)
+    let s = Solv.create 1 in
+    let x = Solv.new_int_var s 2 in
+    Solv.extensional s [| x |] [| |];
+    assert_equal Sh.Lfalse (Solv.solve s)
+
+  let test_lifted_clause () =
+    let s = Solv.create 1 in
+    let f = Earray.init 3 (fun _ -> Solv.new_int_var s 3) in
+    let p = Earray.init 3 (fun _ -> Solv.new_bool_var s) in
+    let f_arr = Solv.new_int_var_array s f in
+    let p_arr = Solv.new_bool_var_array s p in
+    let cell table x =
+      {
+        Csp_solver.table = table;
+        Csp_solver.args = [| x |];
+        Csp_solver.arg_sizes = [| 3 |];
+      } in
+    (* f(x) = f(y) -> x = y *)
+    Solv.lifted_clause s [| 3; 3 |] [| 0, 1 |] [| |] [| |]
+      [| Csp_solver.Lifted_eq_cells (cell f_arr 0, cell f_arr 1) |];
+    (* f(x) <> x *)
+    Solv.lifted_clause s [| 3 |] [| |] [| |] [| |]
+      [| Csp_solver.Lifted_eq_var (cell f_arr 0, 0) |];
+    (* p(x) -> f(x) = y when x = y *)
+    Solv.lifted_clause s [| 3; 3 |] [| |] [| 0, 1 |]
+      [| Csp_solver.Lifted_eq_var (cell f_arr 0, 1) |]
+      [| Csp_solver.Lifted_pred (cell p_arr 0) |];
+    (* f is one of the two derangements of 3 elements. *)
+    let rec count_models n =
+      match Solv.solve s with
+        | Sh.Ltrue ->
+            let values = Earray.map (Solv.int_value s) f in
+            assert_bool "" (values = [| 1; 2; 0 |] || values = [| 2; 0; 1 |]);
+            Earray.iter (fun x -> assert_equal 0 (Solv.bool_value s x)) p;
+            count_models (n + 1)
+        | _ -> n in
+    assert_equal 2 (count_models 0)
+
+  let test_symmetric_table () =
+    let s = Solv.create 1 in
+    let f = Earray.init 3 (fun _ -> Solv.new_int_var s 3) in
+    ignore (Solv.new_int_var_array s f);
+    Solv.symmetric_table s f [| 0; 0 |] [| 3; 3 |];
+    Solv.all_different s f;
+    let perms = [
+      [| 0; 1; 2 |]; [| 0; 2; 1 |]; [| 1; 0; 2 |];
+      [| 1; 2; 0 |]; [| 2; 0; 1 |]; [| 2; 1; 0 |];
+    ] in
+    (* The smallest function isomorphic to [values]. *)
+    let canonical values =
+      let module Array = Earray.Array in
+      perms
+      |> List.map (fun pi ->
+        let g = Earray.make 3 0 in
+        Earray.iteri (fun x y -> g.(pi.(x)) <- pi.(y)) values;
+        g)
+      |> List.fold_left min [| 3; 3; 3 |] in
+    (* The solver may skip permutations of the same cycle type. *)
+    let rec collect n canons =
+      match Solv.solve s with
+        | Sh.Ltrue ->
+            let values = Earray.map (Solv.int_value s) f in
+            assert_bool "" (List.exists (fun pi -> pi = values) perms);
+            collect (n + 1) (BatSet.add (canonical values) canons)
+        | _ -> n, canons in
+    let n, canons = collect 0 BatSet.empty in
+    assert_bool "" (n >= 3 && n <= 6);
+    assert_equal
+      (BatSet.of_list [[| 0; 1; 2 |]; [| 0; 2; 1 |]; [| 1; 2; 0 |]])
+      canons
+
+  let test_poll_progress () =
+    let s = Solv.create 1 in
+    let xs = Earray.init 4 (fun _ -> Solv.new_int_var s 4) in
+    Solv.all_different s xs;
+    assert_equal [] (Solv.poll_progress s);
     assert_equal Sh.Ltrue (Solv.solve s);
-    assert_equal 9 (Solv.int_value s x);
-    assert_equal 16 (Solv.int_value s y);
-    assert_equal 25 (Solv.int_value s z);
+    (* The last snapshot is published when solve returns. *)
+    let snap =
+      match Solv.poll_progress s with
+        | [] -> assert_failure "no snapshot"
+        | snaps -> BatList.last snaps in
+    assert_bool "" (snap.Sh.decisions > 0);
+    assert_equal [] (Solv.poll_progress s);
     assert_equal Sh.Ltrue (Solv.solve s);
-    assert_equal 36 (Solv.int_value s x);
-    assert_equal 64 (Solv.int_value s y);
-    assert_equal 100 (Solv.int_value s z);
-    assert_equal Sh.Lfalse (Solv.solve s)
+    let snap2 = BatList.last (Solv.poll_progress s) in
+    assert_bool "" (snap2.Sh.decisions >= snap.Sh.decisions)
 
   let suite name =
     (name ^ " suite") >:::
       [
-        "linear" >:: test_linear;
-        "linear 2" >:: test_linear2;
         "bool_element" >:: test_bool_element;
         "int_element" >:: test_int_element;
+        "bool_matrix_element" >:: test_bool_matrix_element;
+        "int_matrix_element" >:: test_int_matrix_element;
         "eq_var_var, eq_var_const" >:: test_eq_var_var_eq_var_const;
         "lower_eq" >:: test_lower_eq;
         "precede" >:: test_precede;
         "clause - empty" >:: test_clause_empty;
         "clause" >:: test_clause;
         "all_different" >:: test_all_different;
-        "pythagorean triples" >:: test_pythagorean_triples;
+        "extensional" >:: test_extensional;
+        "lifted clause" >:: test_lifted_clause;
+        "symmetric table" >:: test_symmetric_table;
+        "poll progress" >:: test_poll_progress;
       ]
 
 end
@@ -4,6 +4,49 @@ open OUnit
 
 let (|>) = BatPervasives.(|>)
 
+(* Pigeonhole problem. *)
+module Php (Solv : Sat_solver.S) = struct
+
+  let lit = Solv.to_lit Sh.Pos
+  let neg_lit = Solv.to_lit Sh.Neg
+
+  let generate_php s pigeons holes =
+    let module Array = Earray.Array in
+    (* phs.(p).(h) tells whether the pigeon p is in the hole h. *)
+    let phs =
+      Earray.init pigeons
+        (fun _ -> Earray.init holes (fun _ -> Solv.new_var s)) in
+    (* Each pigeon is in at least one hole. *)
+    Earray.iter
+      (fun ph ->
+        assert_bool "" (Solv.add_clause s (Earray.map lit ph) holes))
+      phs;
+    (* Each pigeon is in at most one hole. *)
+    Earray.iter
+      (fun ph ->
+        for h = 0 to holes-1 do
+          for i = h+1 to holes-1 do
+            assert_bool
+              ""
+              (Solv.add_clause s [| neg_lit ph.(h); neg_lit ph.(i) |] 2)
+          done
+        done)
+      phs;
+    (* Each hole contains at most one pigeon. *)
+    for h = 0 to holes-1 do
+      for p = 0 to pigeons-1 do
+        for q = p+1 to pigeons-1 do
+          assert_bool
+            ""
+            (Solv.add_clause s
+               [| neg_lit phs.(p).(h); neg_lit phs.(q).(h); |] 2)
+        done
+      done
+    done;
+    phs
+
+end
+
 module Make (Solv : Sat_solver.S) : sig
   val suite : string -> test
 end = struct
@@ -125,40 +168,72 @@ end = struct
     assert_bool "" (not (Solv.add_clause s [| neg_lit a |] 1));
     assert_equal Sh.Lfalse (Solv.solve s [| |])
 
-  let generate_php s pigeons holes =
-    let module Array = Earray.Array in
-    (* phs.(p).(h) tells whether the pigeon p is in the hole h. *)
-    let phs =
-      Earray.init pigeons
-        (fun _ -> Earray.init holes (fun _ -> Solv.new_var s)) in
-    (* Each pigeon is in at least one hole. *)
-    Earray.iter
-      (fun ph ->
-        assert_bool "" (Solv.add_clause s (Earray.map lit ph) holes))
-      phs;
-    (* Each pigeon is in at most one hole. *)
-    Earray.iter
-      (fun ph ->
-        for h = 0 to holes-1 do
-          for i = h+1 to holes-1 do
-            assert_bool
-              ""
-              (Solv.add_clause s [| neg_lit ph.(h); neg_lit ph.(i) |] 2)
-          done
-        done)
-      phs;
-    (* Each hole contains at most one pigeon. *)
-    for h = 0 to holes-1 do
-      for p = 0 to pigeons-1 do
-        for q = p+1 to pigeons-1 do
-          assert_bool
-            ""
-            (Solv.add_clause s
-               [| neg_lit phs.(p).(h); neg_lit phs.(q).(h); |] 2)
-        done
-      done
-    done;
-    phs
+  (* Clause trimmed to two literals at decision level 0 must still
+     propagate and must be removed correctly when it's satisfied.
+  *)
+  let test_clause_trimmed_to_binary () =
+    let s = Solv.create () in
+    let a = Solv.new_var s in
+    let b = Solv.new_var s in
+    let c = Solv.new_var s in
+    let d = Solv.new_var s in
+    (* a, b, c, d *)
+    assert_bool "" (Solv.add_clause s [| lit a; lit b; lit c; lit d |] 4);
+    (* ~c *)
+    assert_bool "" (Solv.add_clause s [| neg_lit c |] 1);
+    (* ~d *)
+    assert_bool "" (Solv.add_clause s [| neg_lit d |] 1);
+    (* Simplification trims the first clause to a, b. *)
+    assert_equal Sh.Ltrue (Solv.solve s [| |]);
+    assert_equal Sh.Lfalse (Solv.solve s [| neg_lit a; neg_lit b |]);
+    assert_equal Sh.Ltrue (Solv.solve s [| neg_lit a |]);
+    assert_equal Sh.Ltrue (Solv.model_value s b);
+    (* Simplification removes the trimmed clause. *)
+    assert_bool "" (Solv.add_clause s [| lit a |] 1);
+    assert_equal Sh.Ltrue (Solv.solve s [| neg_lit b |]);
+    assert_equal Sh.Lfalse (Solv.model_value s b);
+    (* ~a *)
+    assert_bool "" (not (Solv.add_clause s [| neg_lit a |] 1));
+    assert_equal Sh.Lfalse (Solv.solve s [| |])
+
+  let test_phase_and_activity () =
+    let s = Solv.create () in
+    let a = Solv.new_var s in
+    let b = Solv.new_var s in
+    Solv.set_phase s a true;
+    Solv.set_phase s b false;
+    Solv.set_activity s a 2.5;
+    assert_bool "" (Solv.get_phase s a);
+    assert_bool "" (not (Solv.get_phase s b));
+    assert_equal 2.5 (Solv.get_activity s a);
+    assert_equal 0. (Solv.get_activity s b);
+    assert_equal Sh.Ltrue (Solv.solve s [| |])
+
+  let test_export_and_import_learnts () =
+    let s = Solv.create () in
+    let a = Solv.new_var s in
+    let b = Solv.new_var s in
+    let c = Solv.new_var s in
+    assert_bool "" (Solv.add_clause s [| lit a |] 1);
+    assert_bool "" (Solv.add_clause s [| neg_lit a; lit b |] 2);
+    assert_bool "" (Solv.add_clause s [| lit b; lit c |] 2);
+    assert_equal Sh.Ltrue (Solv.solve s [| |]);
+    let learnts = Solv.export_learnts s 10 10 in
+    assert_bool "" (List.mem [| lit b |] learnts);
+    (* Import into a solver without the original clauses. *)
+    let s2 = Solv.create () in
+    let _ = Solv.new_var s2 in
+    let b2 = Solv.new_var s2 in
+    let _ = Solv.new_var s2 in
+    List.iter
+      (fun cl -> assert_bool "" (Solv.add_learnt s2 cl (Earray.length cl)))
+      learnts;
+    assert_equal Sh.Lfalse (Solv.solve s2 [| neg_lit b2 |]);
+    assert_equal Sh.Ltrue (Solv.solve s2 [| |])
+
+  module P = Php (Solv)
+
+  let generate_php = P.generate_php
 
   let test_unsat () =
     let s = Solv.create () in
@@ -217,6 +292,36 @@ end = struct
     assert_equal Sh.Lfalse result;
     assert_bool "" (not interrupted)
 
+  let test_poll_progress () =
+    let solver = of_cnf_file (base_dir ^ "sgen1-unsat-145-100.cnf") in
+    assert_equal [] (Solv.poll_progress solver);
+    (* Snapshots are polled while the solver is searching. *)
+    let during = ref [] in
+    let result, interrupted =
+      Timer.with_timer 1000
+        (fun () ->
+          during := Solv.poll_progress solver;
+          Solv.interrupt solver)
+        (fun () -> Solv.solve solver [| |]) in
+    assert_equal Sh.Lundef result;
+    assert_bool "" interrupted;
+    assert_bool "" (!during <> []);
+    (* The last snapshot is published when solve returns. *)
+    let after = Solv.poll_progress solver in
+    assert_bool "" (after <> []);
+    let snaps = !during @ after in
+    ignore
+      (List.fold_left
+         (fun prev snap ->
+           assert_bool "" (snap.Sh.conflicts >= prev.Sh.conflicts);
+           assert_bool "" (snap.Sh.decisions >= prev.Sh.decisions);
+           assert_bool "" (snap.Sh.depth >= 0);
+           snap)
+         (List.hd snaps) snaps);
+    assert_bool "" ((BatList.last snaps).Sh.conflicts > 0);
+    (* Snapshots are returned only once. *)
+    assert_equal [] (Solv.poll_progress solver)
+
   let suite name =
     (name ^ " suite") >:::
       [
@@ -227,6 +332,9 @@ end = struct
           test_all_vars_assigned_when_model_found;
         "unsatisfiable by empty clause" >:: test_unsat_empty_clause;
         "unsatisfiable at zero decision level" >:: test_unsat_zero_dec_level;
+        "clause trimmed to binary" >:: test_clause_trimmed_to_binary;
+        "phase and activity" >:: test_phase_and_activity;
+        "export and import learnts" >:: test_export_and_import_learnts;
         "unsat" >:: test_unsat;
         "sat" >:: test_sat;
         "unsat with assumptions" >:: test_unsat_with_assumpts;
@@ -234,6 +342,192 @@ end = struct
         "interrupt" >:: test_interrupt;
         "interrupt - sat" >:: test_interrupt_sat;
         "interrupt - unsat" >:: test_interrupt_unsat;
+        "poll progress" >:: test_poll_progress;
+      ]
+
+end
+
+(* Tests for solvers with budgets and statistics. *)
+module type S_with_budget = sig
+  include Sat_solver.S
+
+  val set_conf_budget : t -> int -> unit
+
+  val set_prop_budget : t -> int -> unit
+
+  val last_stats : t -> Sat_solver.stats
+end
+
+module Make_budget (Solv : S_with_budget) : sig
+  val suite : string -> test
+end = struct
+
+  module P = Php (Solv)
+
+  (* Unsatisfiable pigeonhole problem which needs many conflicts. *)
+  let generate_php s pigeons holes = ignore (P.generate_php s pigeons holes)
+
+  let test_conf_budget () =
+    let s = Solv.create () in
+    generate_php s 8 7;
+    Solv.set_conf_budget s 10;
+    assert_equal Sh.Lundef (Solv.solve s [| |]);
+    let stats = Solv.last_stats s in
+    assert_bool "" (stats.Sat_solver.conflicts >= 10);
+    assert_bool "" (stats.Sat_solver.propagations > 0);
+    (* Budget is renewed for each call. *)
+    assert_equal Sh.Lundef (Solv.solve s [| |]);
+    assert_bool "" ((Solv.last_stats s).Sat_solver.conflicts >= 10);
+    (* No budget. *)
+    Solv.set_conf_budget s ~-1;
+    assert_equal Sh.Lfalse (Solv.solve s [| |]);
+    let stats = Solv.last_stats s in
+    assert_bool "" (stats.Sat_solver.conflicts > 10);
+    assert_bool "" (stats.Sat_solver.decisions > 0);
+    assert_bool "" (stats.Sat_solver.learnt_lits > 0);
+    assert_bool "" (stats.Sat_solver.wall_time >= 0.)
+
+  let test_prop_budget () =
+    let s = Solv.create () in
+    generate_php s 8 7;
+    Solv.set_prop_budget s 100;
+    assert_equal Sh.Lundef (Solv.solve s [| |]);
+    Solv.set_prop_budget s ~-1;
+    assert_equal Sh.Lfalse (Solv.solve s [| |])
+
+  let suite name =
+    (name ^ " budget suite") >:::
+      [
+        "conflict budget" >:: test_conf_budget;
+        "propagation budget" >:: test_prop_budget;
+      ]
+
+end
+
+(* Tests for solvers which write proofs. *)
+module type S_with_proof = sig
+  include Sat_solver.S
+
+  (** Creates a solver which can write a proof. *)
+  val create_with_proof : unit -> t
+
+  val start_proof : t -> string -> unit
+end
+
+module Make_proof (Solv : S_with_proof) : sig
+  val suite : string -> test
+end = struct
+
+  let lit = Solv.to_lit Sh.Pos
+  let neg_lit = Solv.to_lit Sh.Neg
+
+  let file_size file =
+    let ch = open_in_bin file in
+    let size = in_channel_length ch in
+    close_in ch;
+    size
+
+  let with_prefix f =
+    let prefix = Filename.temp_file "proof" "" in
+    let files =
+      List.map (( ^ ) prefix) [""; ".cnf"; ".drat"; ".assumptions"] in
+    let remove_files () =
+      List.iter
+        (fun file -> if Sys.file_exists file then Sys.remove file)
+        files in
+    BatPervasives.finally remove_files f prefix
+
+  (* Pigeonhole problem where the clauses of the pigeons contain
+     the literal [act].
+  *)
+  let generate_php s act pigeons holes =
+    let phs =
+      Array.init pigeons
+        (fun _ -> Array.init holes (fun _ -> Solv.new_var s)) in
+    Array.iter
+      (fun ph ->
+        let lits = Earray.of_list (act :: Array.to_list (Array.map lit ph)) in
+        assert_bool "" (Solv.add_clause s lits (holes + 1)))
+      phs;
+    for h = 0 to holes-1 do
+      for p = 0 to pigeons-1 do
+        for q = p+1 to pigeons-1 do
+          assert_bool
+            ""
+            (Solv.add_clause s
+               [| neg_lit phs.(p).(h); neg_lit phs.(q).(h); |] 2)
+        done
+      done
+    done
+
+  let test_unsat_with_assumpts () =
+    with_prefix (fun prefix ->
+      let s = Solv.create_with_proof () in
+      Solv.start_proof s prefix;
+      let act = Solv.new_var s in
+      generate_php s (lit act) 6 5;
+      assert_equal Sh.Lfalse (Solv.solve s [| neg_lit act |]);
+      (* 6 clauses for pigeons and 5 * 15 clauses for holes. *)
+      assert_equal
+        81
+        (BatFile.lines_of (prefix ^ ".cnf") |> BatEnum.count);
+      assert_bool "" (file_size (prefix ^ ".drat") > 0);
+      assert_equal
+        ["-1 0"]
+        (BatFile.lines_of (prefix ^ ".assumptions") |> BatList.of_enum))
+
+  (* drat-trim is taken from the environment variable DRAT_TRIM
+     or from PATH.
+  *)
+  let drat_trim =
+    try Sys.getenv "DRAT_TRIM" with Not_found -> "drat-trim"
+
+  let test_proof_verified () =
+    skip_if
+      (Sys.command
+         ("command -v " ^ Filename.quote drat_trim ^ " > /dev/null") <> 0)
+      "drat-trim not found";
+    let dir = Filename.temp_file "proof" "" in
+    Sys.remove dir;
+    Unix.mkdir dir 0o700;
+    let prefix = Filename.concat dir "size-0" in
+    let remove_dir () =
+      List.iter
+        (fun ext ->
+          let file = prefix ^ ext in
+          if Sys.file_exists file then Sys.remove file)
+        [""; ".cnf"; ".drat"; ".assumptions"];
+      Unix.rmdir dir in
+    BatPervasives.finally remove_dir (fun () ->
+      let s = Solv.create_with_proof () in
+      Solv.start_proof s prefix;
+      let act = Solv.new_var s in
+      generate_php s (lit act) 6 5;
+      assert_equal Sh.Lfalse (Solv.solve s [| neg_lit act |]);
+      assert_equal
+        0
+        (Sys.command
+           (String.concat " "
+              (List.map Filename.quote
+                 ["scripts/check_proofs"; dir; drat_trim]) ^
+            " > /dev/null")))
+      ()
+
+  let test_sat () =
+    with_prefix (fun prefix ->
+      let s = Solv.create_with_proof () in
+      Solv.start_proof s prefix;
+      let act = Solv.new_var s in
+      generate_php s (lit act) 6 5;
+      assert_equal Sh.Ltrue (Solv.solve s [| lit act |]);
+      assert_bool "" (not (Sys.file_exists (prefix ^ ".assumptions"))))
+
+  let suite name =
+    (name ^ " proof suite") >:::
+      [
+        "unsat with assumptions" >:: test_unsat_with_assumpts;
+        "proof verified" >:: test_proof_verified;
+        "sat" >:: test_sat;
       ]
 
 end
@@ -265,6 +265,28 @@ end = struct
       done
     done
 
+  (* f(x) <> x *)
+  let test_poll_progress () =
+    let prob = Prob.create () in
+    let db = prob.Prob.symbols in
+    let fsymb = Symb.add_func db 1 in
+    let x = T.var 0 in
+    let clause = {
+      C.cl_id = Prob.fresh_id prob;
+      C.cl_lits = [ L.mk_ineq (T.func (fsymb, [| x |])) x ];
+    } in
+    BatDynArray.add prob.Prob.clauses clause;
+    let sorts = Sorts.of_problem prob in
+
+    let i = Inst.create prob sorts in
+    Inst.incr_max_size i;
+    assert_equal Sh.Lfalse (Inst.solve i);
+    Inst.incr_max_size i;
+    assert_equal Sh.Ltrue (Inst.solve i);
+    (* The solver publishes a snapshot at the end of the search. *)
+    assert_bool "" (Inst.poll_progress i <> []);
+    assert_equal [] (Inst.poll_progress i)
+
   (* couples:
      f(x) <> x
      f(x) = y -> f(y) = x
@@ -451,6 +473,7 @@ end = struct
         "only nullary preds" >:: test_only_nullary_preds;
         "symmetric predicate" >:: test_symmetric_pred;
         "latin square" >:: test_latin_square;
+        "poll progress" >:: test_poll_progress;
         "finite models of even size" >:: test_fin_models_even_size;
         "abelian groups" >:: test_abelian_groups;
         "abelian groups 2" >:: test_abelian_groups2;
@@ -18,11 +18,13 @@ let suite =
       Test_splitting.suite;
       Test_tptp_prob.suite;
       Test_sorts.suite;
+      Test_components.suite;
       Test_assignment.suite;
       Test_minisat.suite;
       Test_cmsat.suite;
       Test_josat.suite;
       Test_gecode.suite;
+      Test_csp_record.suite;
       Test_bliss.suite;
       Test_symred.suite;
       Test_lnh.suite;
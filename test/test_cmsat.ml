@@ -1,5 +1,142 @@
 (* Copyright (c) 2013 Radek Micek *)
 
+open OUnit
+
 module S = Ftest_anysat.Make (Cmsat)
 
-let suite = S.suite "Cmsat"
+module P = Ftest_anysat.Make_proof (struct
+  include Cmsat
+
+  let create_with_proof () =
+    Cmsat.create_with_config { Cmsat.default_config with Cmsat.proof = true }
+end)
+
+let test_override () =
+  let config =
+    List.fold_left
+      Cmsat.override
+      Cmsat.default_config
+      ["bva=false"; "max-cache-size-mb=100"; "restart=geom"; "clean=glue";
+       "max-mem-mb=512"] in
+  assert_equal
+    {
+      Cmsat.default_config with
+        Cmsat.bva = Some false;
+        Cmsat.max_cache_size_mb = Some 100;
+        Cmsat.restart = Some Cmsat.Restart_geom;
+        Cmsat.clean = Some Cmsat.Clean_glue;
+        Cmsat.max_mem_mb = Some 512;
+    }
+    config;
+  List.iter
+    (fun opt ->
+      assert_raises
+        ~msg:opt
+        (Failure "")
+        (fun () ->
+          try ignore (Cmsat.override config opt)
+          with Failure _ -> failwith ""))
+    ["bva"; "bva=yes"; "max-cache-size-mb=x"; "max-cache-size-mb=-1";
+     "restart=none"; "max-mem-mb=-512"; "max-mem-mb=0"; "unknown=1"]
+
+let test_profiles () =
+  let lit = Cmsat.to_lit Sh.Pos in
+  let neg_lit = Cmsat.to_lit Sh.Neg in
+  List.iter
+    (fun (_, profile) ->
+      let s =
+        Cmsat.create_with_config
+          { Cmsat.default_config with Cmsat.profile } in
+      let a = Cmsat.new_var s in
+      let b = Cmsat.new_var s in
+      assert_bool "" (Cmsat.add_clause s [| lit a; lit b |] 2);
+      assert_bool "" (Cmsat.add_clause s [| neg_lit a; lit b |] 2);
+      assert_equal Sh.Ltrue (Cmsat.solve s [| |]);
+      assert_equal Sh.Ltrue (Cmsat.model_value s b);
+      (* Incremental call. *)
+      ignore (Cmsat.add_clause s [| lit a; neg_lit b |] 2);
+      ignore (Cmsat.add_clause s [| neg_lit a; neg_lit b |] 2);
+      assert_equal Sh.Lfalse (Cmsat.solve s [| |]))
+    Cmsat.profiles
+
+(* Pigeonhole problem with the given number of pigeons and holes. *)
+let pigeonhole s pigeons holes =
+  let lit = Cmsat.to_lit Sh.Pos in
+  let neg_lit = Cmsat.to_lit Sh.Neg in
+  let vars =
+    Array.init pigeons (fun _ -> Array.init holes (fun _ -> Cmsat.new_var s)) in
+  (* Each pigeon is in some hole. *)
+  Array.iter
+    (fun hs ->
+      let lits = Earray.of_array (Array.map lit hs) in
+      ignore (Cmsat.add_clause s lits holes))
+    vars;
+  (* No two pigeons are in the same hole. *)
+  for h = 0 to holes - 1 do
+    for p = 0 to pigeons - 1 do
+      for p' = p + 1 to pigeons - 1 do
+        let lits = [| neg_lit vars.(p).(h); neg_lit vars.(p').(h) |] in
+        ignore (Cmsat.add_clause s lits 2)
+      done
+    done
+  done
+
+(* The process uses more than 1 MiB so the solver degrades
+   all the way to the more frequent cleaning of learnt clauses.
+*)
+let test_max_mem () =
+  let config =
+    Cmsat.override
+      { Cmsat.default_config with Cmsat.profile = Cmsat.Aggressive }
+      "max-mem-mb=1" in
+  let s = Cmsat.create_with_config config in
+  pigeonhole s 8 7;
+  assert_equal Sh.Lfalse (Cmsat.solve s [| |]);
+  let s = Cmsat.create_with_config config in
+  pigeonhole s 7 7;
+  assert_equal Sh.Ltrue (Cmsat.solve s [| |])
+
+let test_at_most_one () =
+  let lit = Cmsat.to_lit Sh.Pos in
+  let neg_lit = Cmsat.to_lit Sh.Neg in
+  let s = Cmsat.create () in
+  let vars = Array.init 4 (fun _ -> Cmsat.new_var s) in
+  let at_most_one i j =
+    assert_bool ""
+      (Cmsat.add_at_most_one_clause s [| neg_lit vars.(i); neg_lit vars.(j) |])
+  in
+  (* At most one of the first three variables is true. *)
+  at_most_one 0 1;
+  at_most_one 0 2;
+  at_most_one 1 2;
+  assert_equal Sh.Ltrue (Cmsat.solve s [| lit vars.(0) |]);
+  assert_equal Sh.Lfalse (Cmsat.model_value s vars.(1));
+  assert_equal Sh.Lfalse (Cmsat.model_value s vars.(2));
+  assert_equal Sh.Lfalse (Cmsat.solve s [| lit vars.(1); lit vars.(2) |]);
+  (* The constraint is extended by the fourth variable. *)
+  at_most_one 3 0;
+  at_most_one 3 1;
+  at_most_one 3 2;
+  assert_equal Sh.Lfalse (Cmsat.solve s [| lit vars.(2); lit vars.(3) |]);
+  assert_equal Sh.Ltrue (Cmsat.solve s [| lit vars.(3) |]);
+  Array.iteri
+    (fun i v ->
+      if i < 3 then assert_equal Sh.Lfalse (Cmsat.model_value s v))
+    vars;
+  (* Clause which forces two of the variables. *)
+  assert_bool "" (Cmsat.add_clause s [| lit vars.(1) |] 1);
+  assert_bool "" (Cmsat.add_clause s [| lit vars.(0); lit vars.(3) |] 2);
+  assert_equal Sh.Lfalse (Cmsat.solve s [| |])
+
+let suite =
+  TestList [
+    S.suite "Cmsat";
+    P.suite "Cmsat";
+    "Cmsat config suite" >:::
+      [
+        "override" >:: test_override;
+        "profiles" >:: test_profiles;
+        "max mem" >:: test_max_mem;
+        "at most one" >:: test_at_most_one;
+      ];
+  ]
@@ -0,0 +1,124 @@
+(* Copyright (c) 2015 Radek Micek *)
+
+open OUnit
+
+module S = Symb
+module T = Term
+module L = Lit
+module C = Clause2
+
+(* p(x) | ~p(c) and q(x) | q(d) *)
+let create_prob () =
+  let prob = Prob.create () in
+  let db = prob.Prob.symbols in
+  let p = S.add_pred db 1 in
+  let q = S.add_pred db 1 in
+  let c = S.add_func db 0 in
+  let d = S.add_func db 0 in
+  let x = T.var 0 in
+  let add_clause lits =
+    BatDynArray.add prob.Prob.clauses
+      { C.cl_id = Prob.fresh_id prob; C.cl_lits = lits } in
+  add_clause [
+    L.lit (Sh.Pos, p, [| x |]);
+    L.lit (Sh.Neg, p, [| T.func (c, [| |]) |]);
+  ];
+  add_clause [
+    L.lit (Sh.Pos, q, [| x |]);
+    L.lit (Sh.Pos, q, [| T.func (d, [| |]) |]);
+  ];
+  prob, p, q, c, d
+
+let comp_symbs comp =
+  comp.Components.sorts.Sorts.symb_sorts
+  |> BatHashtbl.keys
+  |> BatList.of_enum
+  |> List.sort compare
+
+let test_independent_clauses () =
+  let prob, p, q, c, d = create_prob () in
+  let sorts = Sorts.of_problem prob in
+  match Components.split prob sorts with
+    | [comp; comp2] ->
+        assert_equal 1 (BatDynArray.length comp.Components.prob.Prob.clauses);
+        assert_equal 1 (BatDynArray.length comp2.Components.prob.Prob.clauses);
+        assert_equal (List.sort compare [p; c]) (comp_symbs comp);
+        assert_equal (List.sort compare [q; d]) (comp_symbs comp2);
+        let c_sort = (Hashtbl.find sorts.Sorts.symb_sorts c).(0) in
+        let d_sort = (Hashtbl.find sorts.Sorts.symb_sorts d).(0) in
+        assert_equal [| c |] comp.Components.sorts.Sorts.consts.(c_sort);
+        assert_equal [| |] comp.Components.sorts.Sorts.consts.(d_sort);
+        assert_equal [| d |] comp2.Components.sorts.Sorts.consts.(d_sort)
+    | _ -> assert_failure "two components expected"
+
+let test_clause_connects_components () =
+  let prob, p, q, c, d = create_prob () in
+  (* p(c) | q(d) *)
+  BatDynArray.add prob.Prob.clauses {
+    C.cl_id = Prob.fresh_id prob;
+    C.cl_lits = [
+      L.lit (Sh.Pos, p, [| T.func (c, [| |]) |]);
+      L.lit (Sh.Pos, q, [| T.func (d, [| |]) |]);
+    ];
+  };
+  let sorts = Sorts.of_problem prob in
+  match Components.split prob sorts with
+    | [comp] ->
+        assert_equal 3 (BatDynArray.length comp.Components.prob.Prob.clauses)
+    | _ -> assert_failure "one component expected"
+
+let test_distinct_consts () =
+  let prob, _, _, c, d = create_prob () in
+  S.set_distinct_constant prob.Prob.symbols c true;
+  S.set_distinct_constant prob.Prob.symbols d true;
+  let sorts = Sorts.of_problem prob in
+  assert_equal 1 (List.length (Components.split prob sorts))
+
+module Comp_inst = Sat_inst.Make_components (Minisat_inst.Inst)
+
+(* Adds f(x) <> x which has no model of size 1. *)
+let add_no_fixpoint prob =
+  let f = S.add_func prob.Prob.symbols 1 in
+  let x = T.var 0 in
+  BatDynArray.add prob.Prob.clauses {
+    C.cl_id = Prob.fresh_id prob;
+    C.cl_lits = [ L.mk_ineq (T.func (f, [| x |])) x ];
+  };
+  f
+
+let test_sat_components () =
+  let prob, p, q, _, _ = create_prob () in
+  let sorts = Sorts.of_problem prob in
+  let inst = Comp_inst.create prob sorts in
+  assert_equal 2 (List.length (Comp_inst.get_solver inst));
+  Comp_inst.incr_max_size inst;
+  assert_equal Sh.Ltrue (Comp_inst.solve inst);
+  let model = Comp_inst.construct_model inst in
+  assert_bool "" (Symb.Map.mem p model.Ms_model.symbs);
+  assert_bool "" (Symb.Map.mem q model.Ms_model.symbs)
+
+let test_unsat_component () =
+  let prob, p, q, _, _ = create_prob () in
+  let f = add_no_fixpoint prob in
+  let sorts = Sorts.of_problem prob in
+  let inst = Comp_inst.create prob sorts in
+  assert_equal 3 (List.length (Comp_inst.get_solver inst));
+  Comp_inst.incr_max_size inst;
+  assert_equal Sh.Lfalse (Comp_inst.solve inst);
+  (* Components interrupted at the previous size must be solved again. *)
+  Comp_inst.incr_max_size inst;
+  assert_equal Sh.Ltrue (Comp_inst.solve inst);
+  let model = Comp_inst.construct_model inst in
+  List.iter
+    (fun s -> assert_bool "" (Symb.Map.mem s model.Ms_model.symbs))
+    [p; q; f]
+
+let suite =
+  "Components suite" >:::
+    [
+      "independent clauses" >:: test_independent_clauses;
+      "clause connects components" >:: test_clause_connects_components;
+      "distinct constants" >:: test_distinct_consts;
+      "satisfiable components" >:: test_sat_components;
+      "unsatisfiable component" >:: test_unsat_component;
+    ]
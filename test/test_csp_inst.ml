@@ -15,13 +15,22 @@ module Solver = struct
     | Enew_int_var_array of int var Earray.rt * int var_array
     | Ebool_element of bool var_array * int var * bool var
     | Eint_element of int var_array * int var * int var
-    | Elinear of int var Earray.rt * int Earray.rt * int
+    | Ebool_matrix_element of
+        bool var_array * int var Earray.rt * int Earray.rt * int * bool var
+    | Eint_matrix_element of
+        int var_array * int var Earray.rt * int Earray.rt * int * int var
     | Eeq_var_var of int var * int var * bool var
     | Eeq_var_const of int var * int * bool var
     | Elower_eq of int var * int
     | Eprecede of int var Earray.rt * int Earray.rt
     | Eclause of bool var Earray.rt * bool var Earray.rt
     | Eall_different of int var Earray.rt
+    | Eextensional of int var Earray.rt * int Earray.rt
+    | Elifted_clause of
+        int Earray.rt * (int * int) Earray.rt * (int * int) Earray.rt *
+        (bool var_array, int var_array) Csp_solver.lifted_atom Earray.rt *
+        (bool var_array, int var_array) Csp_solver.lifted_atom Earray.rt
+    | Esymmetric_table of int var Earray.rt * int Earray.rt * int Earray.rt
 
   type t = {
     log : event BatDynArray.t;
@@ -84,9 +93,15 @@ module Solver = struct
   let int_element s arr i y =
     BatDynArray.add s.log (Eint_element (arr, i, y))
 
-  let linear s vars coefs c =
+  let bool_matrix_element s arr idxs coefs c y =
     BatDynArray.add s.log
-      (Elinear (Earray.read_only vars, Earray.read_only coefs, c))
+      (Ebool_matrix_element
+         (arr, Earray.read_only idxs, Earray.read_only coefs, c, y))
+
+  let int_matrix_element s arr idxs coefs c y =
+    BatDynArray.add s.log
+      (Eint_matrix_element
+         (arr, Earray.read_only idxs, Earray.read_only coefs, c, y))
 
   let eq_var_var s x x' y =
     BatDynArray.add s.log (Eeq_var_var (x, x', y))
@@ -108,10 +123,33 @@ module Solver = struct
   let all_different s vars =
     BatDynArray.add s.log (Eall_different (Earray.copy vars))
 
+  let extensional s vars tuples =
+    BatDynArray.add s.log
+      (Eextensional (Earray.copy vars, Earray.copy tuples))
+
+  let extensional_clauses _ = false
+
+  let lifted_clause s var_sizes var_eqs var_ineqs pos neg =
+    BatDynArray.add s.log
+      (Elifted_clause
+         (Earray.copy var_sizes, Earray.copy var_eqs, Earray.copy var_ineqs,
+          Earray.copy pos, Earray.copy neg))
+
+  let lifted_clauses _ = false
+
+  let symmetric_table s cells sorts dom_sizes =
+    BatDynArray.add s.log
+      (Esymmetric_table
+         (Earray.copy cells, Earray.copy sorts, Earray.copy dom_sizes))
+
+  let symmetric_tables _ = false
+
   let solve s = Sh.Lundef
 
   let interrupt _ = failwith "Not implemented"
 
+  let poll_progress _ = []
+
   let bool_value _ _ = failwith "Not implemented"
   let int_value _ _ = failwith "Not implemented"
 end
@@ -119,6 +157,24 @@ end
 module Inst = Csp_inst.Make (Solver)
 module Solv = Solver
 
+module Lifted_inst = Csp_inst.Make (struct
+  include Solver
+
+  let lifted_clauses _ = true
+end)
+
+module Symmetric_inst = Csp_inst.Make (struct
+  include Solver
+
+  let symmetric_tables _ = true
+end)
+
+module Extensional_inst = Csp_inst.Make (struct
+  include Solver
+
+  let extensional_clauses _ = true
+end)
+
 let assert_log i exp_log =
   let log = BatDynArray.to_list (Inst.get_solver i).Solver.log in
   assert_equal exp_log log;
@@ -152,9 +208,12 @@ let print_log i =
     | Solv.Eint_element (arr, x, y) ->
         Printf.printf "int element: %d %d %d\n"
           arr x y
-    | Solv.Elinear (vars, coefs, c) ->
-        Printf.printf "linear: %s %s %d\n"
-          (int_arr_to_str vars) (int_arr_to_str coefs) c
+    | Solv.Ebool_matrix_element (arr, idxs, coefs, c, y) ->
+        Printf.printf "bool matrix element: %d %s %s %d %d\n"
+          arr (int_arr_to_str idxs) (int_arr_to_str coefs) c y
+    | Solv.Eint_matrix_element (arr, idxs, coefs, c, y) ->
+        Printf.printf "int matrix element: %d %s %s %d %d\n"
+          arr (int_arr_to_str idxs) (int_arr_to_str coefs) c y
     | Solv.Eeq_var_var (x, x', y) ->
         Printf.printf "eq_var_var: %d %d %d\n" x x' y
     | Solv.Eeq_var_const (x, c, y) ->
@@ -169,7 +228,17 @@ let print_log i =
           (int_arr_to_str pos) (int_arr_to_str neg)
     | Solv.Eall_different vars ->
         Printf.printf "all_different: %s\n"
-          (int_arr_to_str vars))
+          (int_arr_to_str vars)
+    | Solv.Eextensional (vars, tuples) ->
+        Printf.printf "extensional: %s %s\n"
+          (int_arr_to_str vars) (int_arr_to_str tuples)
+    | Solv.Elifted_clause (var_sizes, _, _, pos, neg) ->
+        Printf.printf "lifted_clause: %s %d %d\n"
+          (int_arr_to_str var_sizes) (Earray.length pos) (Earray.length neg)
+    | Solv.Esymmetric_table (cells, sorts, dom_sizes) ->
+        Printf.printf "symmetric_table: %s %s %s\n"
+          (int_arr_to_str cells) (int_arr_to_str sorts)
+          (int_arr_to_str dom_sizes))
     (Inst.get_solver i).Solver.log
 
 module S = Symb
@@ -415,10 +484,8 @@ let test_nested () =
     Solv.Eint_element (0, 1, ~-1);
     (* f(0, c) shares variable with f(c, 0) *)
     (* p(f(0, c), 0, f(c, 0)) *)
-    Solv.Enew_tmp_int_var (1, ~-2);
-    Solv.Elinear ([| ~-1; ~-2 |], [| 2; ~-1 |], 0);
     Solv.Enew_tmp_bool_var ~-1;
-    Solv.Ebool_element (0, ~-2, ~-1);
+    Solv.Ebool_matrix_element (0, [| ~-1 |], [| 2 |], 0, ~-1);
     Solv.Eclause ([| |], [| ~-1 |]);
   ];
 
@@ -441,34 +508,24 @@ let test_nested () =
     Solv.Enew_int_var (2, 4); (* c *)
     Solv.Enew_int_var_array ([| 4 |], 1);
     (* f(c, 0) *)
-    Solv.Enew_tmp_int_var (3, ~-1);
-    Solv.Elinear ([| 4; ~-1 |], [| 2; ~-1 |], 0);
-    Solv.Enew_tmp_int_var (2, ~-2);
-    Solv.Eint_element (0, ~-1, ~-2);
+    Solv.Enew_tmp_int_var (2, ~-1);
+    Solv.Eint_matrix_element (0, [| 4 |], [| 2 |], 0, ~-1);
     (* f(0, c) *)
-    Solv.Enew_tmp_int_var (2, ~-3);
-    Solv.Eint_element (0, 4, ~-3);
+    Solv.Enew_tmp_int_var (2, ~-2);
+    Solv.Eint_element (0, 4, ~-2);
     (* p(f(0, c), 0, f(c, 0)) *)
-    Solv.Enew_tmp_int_var (6, ~-4);
-    Solv.Elinear ([| ~-3; ~-2; ~-4 |], [| 4; 1; ~-1 |], 0);
     Solv.Enew_tmp_bool_var ~-1;
-    Solv.Ebool_element (0, ~-4, ~-1);
+    Solv.Ebool_matrix_element (0, [| ~-2; ~-1 |], [| 4; 1 |], 0, ~-1);
     Solv.Eclause ([| |], [| ~-1 |]);
     (* f(c, 1) *)
-    Solv.Enew_tmp_int_var (4, ~-5);
-    Solv.Elinear ([| 4; ~-5 |], [| 2; ~-1 |], ~-1);
-    Solv.Enew_tmp_int_var (2, ~-6);
-    Solv.Eint_element (0, ~-5, ~-6);
+    Solv.Enew_tmp_int_var (2, ~-3);
+    Solv.Eint_matrix_element (0, [| 4 |], [| 2 |], 1, ~-3);
     (* f(1, c) *)
-    Solv.Enew_tmp_int_var (4, ~-7);
-    Solv.Elinear ([| 4; ~-7 |], [| 1; ~-1 |], ~-2);
-    Solv.Enew_tmp_int_var (2, ~-8);
-    Solv.Eint_element (0, ~-7, ~-8);
+    Solv.Enew_tmp_int_var (2, ~-4);
+    Solv.Eint_matrix_element (0, [| 4 |], [| 1 |], 2, ~-4);
     (* p(f(1, c), 1, f(c, 1)) *)
-    Solv.Enew_tmp_int_var (8, ~-9);
-    Solv.Elinear ([| ~-8; ~-6; ~-9 |], [| 4; 1; ~-1 |], ~-2);
     Solv.Enew_tmp_bool_var ~-2;
-    Solv.Ebool_element (0, ~-9, ~-2);
+    Solv.Ebool_matrix_element (0, [| ~-4; ~-3 |], [| 4; 1 |], 2, ~-2);
     Solv.Eclause ([| |], [| ~-2 |]);
     Solv.Elower_eq (4, 0);
   ]
@@ -528,28 +585,24 @@ let test_nested_comm_func () =
     Solv.Enew_int_var (2, 5); (* c *)
     Solv.Enew_int_var_array ([| 5 |], 2);
     (* f(c, 0) *)
-    Solv.Enew_tmp_int_var (3, ~-1);
-    Solv.Elinear ([| 5; ~-1 |], [| 2; ~-1 |], 0);
-    Solv.Enew_tmp_int_var (2, ~-2);
-    Solv.Eint_element (1, ~-1, ~-2);
+    Solv.Enew_tmp_int_var (2, ~-1);
+    Solv.Eint_matrix_element (1, [| 5 |], [| 2 |], 0, ~-1);
     (* g(f(c, 0)) *)
-    Solv.Enew_tmp_int_var (2, ~-3);
-    Solv.Eint_element (0, ~-2, ~-3);
+    Solv.Enew_tmp_int_var (2, ~-2);
+    Solv.Eint_element (0, ~-1, ~-2);
     (* p(g(f(c, 0))) *)
     Solv.Enew_tmp_bool_var ~-1;
-    Solv.Ebool_element (0, ~-3, ~-1);
+    Solv.Ebool_element (0, ~-2, ~-1);
     Solv.Eclause ([| ~-1 |], [| |]);
     (* f(c, 1) *)
-    Solv.Enew_tmp_int_var (4, ~-4);
-    Solv.Elinear ([| 5; ~-4 |], [| 2; ~-1 |], ~-1);
-    Solv.Enew_tmp_int_var (2, ~-5);
-    Solv.Eint_element (1, ~-4, ~-5);
+    Solv.Enew_tmp_int_var (2, ~-3);
+    Solv.Eint_matrix_element (1, [| 5 |], [| 2 |], 1, ~-3);
     (* g(f(c, 1)) *)
-    Solv.Enew_tmp_int_var (2, ~-6);
-    Solv.Eint_element (0, ~-5, ~-6);
+    Solv.Enew_tmp_int_var (2, ~-4);
+    Solv.Eint_element (0, ~-3, ~-4);
     (* p(g(f(c, 1))) *)
     Solv.Enew_tmp_bool_var ~-2;
-    Solv.Ebool_element (0, ~-6, ~-2);
+    Solv.Ebool_element (0, ~-4, ~-2);
     Solv.Eclause ([| ~-2 |], [| |]);
     Solv.Elower_eq (5, 0);
   ];
@@ -574,40 +627,34 @@ let test_nested_comm_func () =
     Solv.Enew_int_var (3, 9); (* c *)
     Solv.Enew_int_var_array ([| 9 |], 2);
     (* f(c, 0) *)
-    Solv.Enew_tmp_int_var (7, ~-1);
-    Solv.Elinear ([| 9; ~-1 |], [| 3; ~-1 |], 0);
-    Solv.Enew_tmp_int_var (3, ~-2);
-    Solv.Eint_element (1, ~-1, ~-2);
+    Solv.Enew_tmp_int_var (3, ~-1);
+    Solv.Eint_matrix_element (1, [| 9 |], [| 3 |], 0, ~-1);
     (* g(f(c, 0)) *)
-    Solv.Enew_tmp_int_var (3, ~-3);
-    Solv.Eint_element (0, ~-2, ~-3);
+    Solv.Enew_tmp_int_var (3, ~-2);
+    Solv.Eint_element (0, ~-1, ~-2);
     (* p(g(f(c, 0))) *)
     Solv.Enew_tmp_bool_var ~-1;
-    Solv.Ebool_element (0, ~-3, ~-1);
+    Solv.Ebool_element (0, ~-2, ~-1);
     Solv.Eclause ([| ~-1 |], [| |]);
     (* f(c, 1) *)
-    Solv.Enew_tmp_int_var (8, ~-4);
-    Solv.Elinear ([| 9; ~-4 |], [| 3; ~-1 |], ~-1);
-    Solv.Enew_tmp_int_var (3, ~-5);
-    Solv.Eint_element (1, ~-4, ~-5);
+    Solv.Enew_tmp_int_var (3, ~-3);
+    Solv.Eint_matrix_element (1, [| 9 |], [| 3 |], 1, ~-3);
     (* g(f(c, 1)) *)
-    Solv.Enew_tmp_int_var (3, ~-6);
-    Solv.Eint_element (0, ~-5, ~-6);
+    Solv.Enew_tmp_int_var (3, ~-4);
+    Solv.Eint_element (0, ~-3, ~-4);
     (* p(g(f(c, 1))) *)
     Solv.Enew_tmp_bool_var ~-2;
-    Solv.Ebool_element (0, ~-6, ~-2);
+    Solv.Ebool_element (0, ~-4, ~-2);
     Solv.Eclause ([| ~-2 |], [| |]);
     (* f(c, 2) *)
-    Solv.Enew_tmp_int_var (9, ~-7);
-    Solv.Elinear ([| 9; ~-7 |], [| 3; ~-1 |], ~-2);
-    Solv.Enew_tmp_int_var (3, ~-8);
-    Solv.Eint_element (1, ~-7, ~-8);
+    Solv.Enew_tmp_int_var (3, ~-5);
+    Solv.Eint_matrix_element (1, [| 9 |], [| 3 |], 2, ~-5);
     (* g(f(c, 2)) *)
-    Solv.Enew_tmp_int_var (3, ~-9);
-    Solv.Eint_element (0, ~-8, ~-9);
+    Solv.Enew_tmp_int_var (3, ~-6);
+    Solv.Eint_element (0, ~-5, ~-6);
     (* p(g(f(c, 2))) *)
     Solv.Enew_tmp_bool_var ~-3;
-    Solv.Ebool_element (0, ~-9, ~-3);
+    Solv.Ebool_element (0, ~-6, ~-3);
     Solv.Eclause ([| ~-3 |], [| |]);
     Solv.Elower_eq (9, 0);
     Solv.Elower_eq (3, 1);
@@ -673,7 +720,7 @@ let test_var_eqs_and_ineqs () =
     Solv.Elower_eq (0, 1);
   ]
 
-let test_shared_linear () =
+let test_shared_matrix_element () =
   let prob = Prob.create () in
   let db = prob.Prob.symbols in
   let f = Symb.add_func db 2 in
@@ -714,76 +761,70 @@ let test_shared_linear () =
     Solv.Enew_int_var (3, 18); (* f(2, 2) *)
     Solv.Enew_int_var_array ([| 10; 11; 12; 13; 14; 15; 16; 17; 18 |], 2);
     (* g(c, 0) *)
-    Solv.Enew_tmp_int_var (7, ~-1);
-    Solv.Elinear ([| 9; ~-1 |], [| 3; ~-1 |], 0);
-    Solv.Enew_tmp_int_var (3, ~-2);
-    Solv.Eint_element (0, ~-1, ~-2);
+    Solv.Enew_tmp_int_var (3, ~-1);
+    Solv.Eint_matrix_element (0, [| 9 |], [| 3 |], 0, ~-1);
     (* f(c, 0) *)
-    Solv.Enew_tmp_int_var (3, ~-3);
-    Solv.Eint_element (2, ~-1, ~-3);
+    Solv.Enew_tmp_int_var (3, ~-2);
+    Solv.Eint_matrix_element (2, [| 9 |], [| 3 |], 0, ~-2);
     (* g(c, 0) <> f(c, 0) *)
     Solv.Enew_tmp_bool_var ~-1;
-    Solv.Eeq_var_var (~-3, ~-2, ~-1);
+    Solv.Eeq_var_var (~-2, ~-1, ~-1);
     Solv.Eclause ([| |], [| ~-1 |]);
     (* g(c, 0) *)
     (* f(c, 1) *)
-    Solv.Enew_tmp_int_var (8, ~-4);
-    Solv.Elinear ([| 9; ~-4 |], [| 3; ~-1 |], ~-1);
-    Solv.Enew_tmp_int_var (3, ~-5);
-    Solv.Eint_element (2, ~-4, ~-5);
+    Solv.Enew_tmp_int_var (3, ~-3);
+    Solv.Eint_matrix_element (2, [| 9 |], [| 3 |], 1, ~-3);
     (* g(c, 0) <> f(c, 1) *)
     Solv.Enew_tmp_bool_var ~-2;
-    Solv.Eeq_var_var (~-5, ~-2, ~-2);
+    Solv.Eeq_var_var (~-3, ~-1, ~-2);
     Solv.Eclause ([| |], [| ~-2 |]);
     (* g(c, 0) *)
     (* f(c, 2) *)
-    Solv.Enew_tmp_int_var (9, ~-6);
-    Solv.Elinear ([| 9; ~-6 |], [| 3; ~-1 |], ~-2);
-    Solv.Enew_tmp_int_var (3, ~-7);
-    Solv.Eint_element (2, ~-6, ~-7);
+    Solv.Enew_tmp_int_var (3, ~-4);
+    Solv.Eint_matrix_element (2, [| 9 |], [| 3 |], 2, ~-4);
     (* g(c, 0) <> f(c, 2) *)
     Solv.Enew_tmp_bool_var ~-3;
-    Solv.Eeq_var_var (~-7, ~-2, ~-3);
+    Solv.Eeq_var_var (~-4, ~-1, ~-3);
     Solv.Eclause ([| |], [| ~-3 |]);
     (* g(c, 1) *)
-    Solv.Enew_tmp_int_var (3, ~-8);
-    Solv.Eint_element (0, ~-4, ~-8);
+    Solv.Enew_tmp_int_var (3, ~-5);
+    Solv.Eint_matrix_element (0, [| 9 |], [| 3 |], 1, ~-5);
     (* f(c, 0) *)
     (* g(c, 1) <> f(c, 0) *)
     Solv.Enew_tmp_bool_var ~-4;
-    Solv.Eeq_var_var (~-8, ~-3, ~-4);
+    Solv.Eeq_var_var (~-5, ~-2, ~-4);
     Solv.Eclause ([| |], [| ~-4 |]);
     (* g(c, 1) *)
     (* f(c, 1) *)
     (* g(c, 1) <> f(c, 1) *)
     Solv.Enew_tmp_bool_var ~-5;
-    Solv.Eeq_var_var (~-8, ~-5, ~-5);
+    Solv.Eeq_var_var (~-5, ~-3, ~-5);
     Solv.Eclause ([| |], [| ~-5 |]);
     (* g(c, 1) *)
     (* f(c, 2) *)
     (* g(c, 1) <> f(c, 2) *)
     Solv.Enew_tmp_bool_var ~-6;
-    Solv.Eeq_var_var (~-8, ~-7, ~-6);
+    Solv.Eeq_var_var (~-5, ~-4, ~-6);
     Solv.Eclause ([| |], [| ~-6 |]);
     (* g(c, 2) *)
-    Solv.Enew_tmp_int_var (3, ~-9);
-    Solv.Eint_element (0, ~-6, ~-9);
+    Solv.Enew_tmp_int_var (3, ~-6);
+    Solv.Eint_matrix_element (0, [| 9 |], [| 3 |], 2, ~-6);
     (* f(c, 0) *)
     (* g(c, 2) <> f(c, 0) *)
     Solv.Enew_tmp_bool_var ~-7;
-    Solv.Eeq_var_var (~-9, ~-3, ~-7);
+    Solv.Eeq_var_var (~-6, ~-2, ~-7);
     Solv.Eclause ([| |], [| ~-7 |]);
     (* g(c, 2) *)
     (* f(c, 1) *)
     (* g(c, 2) <> f(c, 1) *)
     Solv.Enew_tmp_bool_var ~-8;
-    Solv.Eeq_var_var (~-9, ~-5, ~-8);
+    Solv.Eeq_var_var (~-6, ~-3, ~-8);
     Solv.Eclause ([| |], [| ~-8 |]);
     (* g(c, 2) *)
     (* f(c, 2) *)
     (* g(c, 2) <> f(c, 2) *)
     Solv.Enew_tmp_bool_var ~-9;
-    Solv.Eeq_var_var (~-9, ~-7, ~-9);
+    Solv.Eeq_var_var (~-6, ~-4, ~-9);
     Solv.Eclause ([| |], [| ~-9 |]);
     Solv.Elower_eq (9, 0);
     Solv.Elower_eq (10, 1);
@@ -1002,7 +1043,8 @@ let test_distinct_consts () =
     Solv.Eprecede ([| 3; 0; 1; 2 |], [| 0; 1 |]);
   ]
 
-let test_hints () =
+(* Problem with hints. *)
+let hints_prob () =
   let prob = Prob.create () in
   let db = prob.Prob.symbols in
   let c = Symb.add_func db 0 in
@@ -1016,10 +1058,11 @@ let test_hints () =
     C2.cl_lits = [ L.mk_eq (T.func (g, [| c |])) (T.func (f, [| c; c |])) ];
   } in
   BatDynArray.add prob.Prob.clauses clause;
-  let sorts = infer_single_sort prob in
+  prob, infer_single_sort prob
 
-  let i4 = Inst.create prob sorts 4 in
-  assert_log i4 [
+(* Log of the problem with hints for domain size 4. *)
+let hints_log4 =
+  [
     Solv.Enew_int_var (4, 0); (* g(0) *)
     Solv.Enew_int_var (4, 1); (* g(1) *)
     Solv.Enew_int_var (4, 2); (* g(2) *)
@@ -1048,13 +1091,11 @@ let test_hints () =
     Solv.Enew_tmp_int_var (4, ~-1);
     Solv.Eint_element (0, 4, ~-1);
     (* f(c, c) *)
-    Solv.Enew_tmp_int_var (16, ~-2);
-    Solv.Elinear ([| 4; ~-2 |], [| 5; ~-1 |], 0);
-    Solv.Enew_tmp_int_var (4, ~-3);
-    Solv.Eint_element (2, ~-2, ~-3);
+    Solv.Enew_tmp_int_var (4, ~-2);
+    Solv.Eint_matrix_element (2, [| 4 |], [| 5 |], 0, ~-2);
     (* g(c) = f(c, c) *)
     Solv.Enew_tmp_bool_var ~-1;
-    Solv.Eeq_var_var (~-3, ~-1, ~-1);
+    Solv.Eeq_var_var (~-2, ~-1, ~-1);
     Solv.Eclause ([| ~-1 |], [| |]);
     Solv.Elower_eq (4, 0); (* c <= 0 *)
     Solv.Elower_eq (5, 1); (* f(0, 0) <= 1 *)
@@ -1075,6 +1116,10 @@ let test_hints () =
     Solv.Eall_different [| 0; 1; 2; 3 |];
   ]
 
+let test_hints () =
+  let prob, sorts = hints_prob () in
+  assert_log (Inst.create prob sorts 4) hints_log4
+
 let test_more_sorts () =
   let prob = Prob.create () in
   let db = prob.Prob.symbols in
@@ -1132,12 +1177,10 @@ let test_more_sorts () =
     Solv.Enew_bool_var_array ([| 4; 5; 6; 7 |], 1);
     (* clause (assignment x = 0, y = 0) *)
     (* -1 for literal f(c, 0, d) = 0 *)
-    Solv.Enew_tmp_int_var (6, ~-1);
-    Solv.Elinear ([| 8; 9; ~-1 |], [| 4; 1; ~-1 |], 0);
-    Solv.Enew_tmp_int_var (2, ~-2);
-    Solv.Eint_element (0, ~-1, ~-2);
+    Solv.Enew_tmp_int_var (2, ~-1);
+    Solv.Eint_matrix_element (0, [| 8; 9 |], [| 4; 1 |], 0, ~-1);
     Solv.Enew_tmp_bool_var ~-1; (* f(c, 0, d) = 0 *)
-    Solv.Eeq_var_const (~-2, 0, ~-1);
+    Solv.Eeq_var_const (~-1, 0, ~-1);
     (* -2 for literal c = d *)
     Solv.Enew_tmp_bool_var ~-2; (* c = d *)
     Solv.Eeq_var_var (8, 9, ~-2);
@@ -1149,12 +1192,10 @@ let test_more_sorts () =
     Solv.Eclause ([| ~-1; ~-2; 0 |], [| ~-3; 4 |]);
     (* clause (assignment x = 0, y = 1) *)
     (* -4 for literal f(c, 1, d) = 1 *)
-    Solv.Enew_tmp_int_var (8, ~-3);
-    Solv.Elinear ([| 8; 9; ~-3 |], [| 4; 1; ~-1 |], ~-2);
-    Solv.Enew_tmp_int_var (2, ~-4);
-    Solv.Eint_element (0, ~-3, ~-4);
+    Solv.Enew_tmp_int_var (2, ~-2);
+    Solv.Eint_matrix_element (0, [| 8; 9 |], [| 4; 1 |], 2, ~-2);
     Solv.Enew_tmp_bool_var ~-4; (* f(c, 1, d) = 1 *)
-    Solv.Eeq_var_const (~-4, 1, ~-4);
+    Solv.Eeq_var_const (~-2, 1, ~-4);
     (* -2 for literal c = d *)
     (* 1 for literal p(0, 1) *)
     (* -3 for literal c <> 0 *)
@@ -1217,12 +1258,10 @@ let test_more_sorts () =
     Solv.Enew_bool_var_array (Earray.init 6 (fun i -> i + 6), 1);
     (* clause (assignment x = 0, y = 0) *)
     (* -1 for literal f(c, 0, d) = 0 *)
-    Solv.Enew_tmp_int_var (8, ~-1);
-    Solv.Elinear ([| 12; 13; ~-1 |], [| 6; 1; ~-1 |], 0);
-    Solv.Enew_tmp_int_var (3, ~-2);
-    Solv.Eint_element (0, ~-1, ~-2);
+    Solv.Enew_tmp_int_var (3, ~-1);
+    Solv.Eint_matrix_element (0, [| 12; 13 |], [| 6; 1 |], 0, ~-1);
     Solv.Enew_tmp_bool_var ~-1; (* f(c, 0, d) = 0 *)
-    Solv.Eeq_var_const (~-2, 0, ~-1);
+    Solv.Eeq_var_const (~-1, 0, ~-1);
     (* -2 for literal c = d *)
     Solv.Enew_tmp_bool_var ~-2; (* c = d *)
     Solv.Eeq_var_var (12, 13, ~-2);
@@ -1234,12 +1273,10 @@ let test_more_sorts () =
     Solv.Eclause ([| ~-1; ~-2; 0 |], [| ~-3; 6 |]);
     (* clause (assignment x = 0, y = 1) *)
     (* -4 for literal f(c, 1, d) = 1 *)
-    Solv.Enew_tmp_int_var (10, ~-3);
-    Solv.Elinear ([| 12; 13; ~-3 |], [| 6; 1; ~-1 |], ~-2);
-    Solv.Enew_tmp_int_var (3, ~-4);
-    Solv.Eint_element (0, ~-3, ~-4);
+    Solv.Enew_tmp_int_var (3, ~-2);
+    Solv.Eint_matrix_element (0, [| 12; 13 |], [| 6; 1 |], 2, ~-2);
     Solv.Enew_tmp_bool_var ~-4; (* f(c, 1, d) = 1 *)
-    Solv.Eeq_var_const (~-4, 1, ~-4);
+    Solv.Eeq_var_const (~-2, 1, ~-4);
     (* -2 for literal c = d *)
     (* 1 for literal p(0, 1) *)
     (* -3 for literal c <> 0 *)
@@ -1247,12 +1284,10 @@ let test_more_sorts () =
     Solv.Eclause ([| ~-4; ~-2; 1 |], [| ~-3; 8 |]);
     (* clause (assignment x = 0, y = 2) *)
     (* -5 for literal f(c, 2, d) = 2 *)
-    Solv.Enew_tmp_int_var (12, ~-5);
-    Solv.Elinear ([| 12; 13; ~-5 |], [| 6; 1; ~-1 |], ~-4);
-    Solv.Enew_tmp_int_var (3, ~-6);
-    Solv.Eint_element (0, ~-5, ~-6);
+    Solv.Enew_tmp_int_var (3, ~-3);
+    Solv.Eint_matrix_element (0, [| 12; 13 |], [| 6; 1 |], 4, ~-3);
     Solv.Enew_tmp_bool_var ~-5; (* f(c, 2, d) = 2 *)
-    Solv.Eeq_var_const (~-6, 2, ~-5);
+    Solv.Eeq_var_const (~-3, 2, ~-5);
     (* -2 for literal c = d *)
     (* 2 for literal p(0, 2) *)
     (* -3 for literal c <> 0 *)
@@ -1464,6 +1499,233 @@ let test_more_sorts_lnh_blocked_sort () =
     *)
   ]
 
+(* Same problem as in [test_more_sorts_lnh_blocked_sort]. *)
+let test_more_sorts_symmetric_tables () =
+  let prob = Prob.create () in
+  let db = prob.Prob.symbols in
+  let f = Symb.add_func db 1 in
+  let f a = T.func (f, [| a |]) in
+  let g = Symb.add_func db 1 in
+  let g a = T.func (g, [| a |]) in
+  let c = Symb.add_func db 0 in
+  let c = T.func (c, [| |]) in
+  let d = Symb.add_func db 0 in
+  let d = T.func (d, [| |]) in
+  let clause = {
+    C2.cl_id = Prob.fresh_id prob;
+    C2.cl_lits = [
+      L.mk_eq (f c) d;
+      L.mk_eq (g d) c;
+    ];
+  } in
+  BatDynArray.add prob.Prob.clauses clause;
+  (* No sort has adequate size. *)
+  let sorts = Sorts.of_problem prob in
+
+  let i2 = Symmetric_inst.create prob sorts 2 in
+  let log = BatDynArray.to_list (Symmetric_inst.get_solver i2).Solver.log in
+  let tables =
+    List.filter (function Solv.Esymmetric_table _ -> true | _ -> false) log in
+  (* Tables of both sorts are declared. *)
+  assert_equal
+    [
+      Solv.Esymmetric_table ([| 0; 1 |], [| 0; 1 |], [| 2; 2 |]); (* f *)
+      Solv.Esymmetric_table ([| 4; 5 |], [| 1; 0 |], [| 2; 2 |]); (* g *)
+      Solv.Esymmetric_table ([| 2 |], [| 0 |], [| 2 |]); (* c *)
+      Solv.Esymmetric_table ([| 3 |], [| 1 |], [| 2 |]); (* d *)
+    ]
+    tables;
+  (* No LNH. *)
+  List.iter
+    (function
+    | Solv.Elower_eq _
+    | Solv.Eprecede _ -> assert_failure "LNH"
+    | _ -> ())
+    log
+
+let test_lifted_flat () =
+  let prob = Prob.create () in
+  let db = prob.Prob.symbols in
+  let p = Symb.add_pred db 3 in
+  let f = Symb.add_func db 2 in
+  let c = Symb.add_func db 0 in
+  let x, y = T.var 0, T.var 1 in
+  let clause = {
+    C2.cl_id = Prob.fresh_id prob;
+    C2.cl_lits = [
+      L.lit (Sh.Neg, p, [| y; x; y |]);
+      L.mk_eq (T.func (f, [| x; y |])) (T.func (c, [| |]));
+      L.mk_eq (T.func (f, [| y; y |])) x;
+      L.mk_eq x y;
+    ];
+  } in
+  BatDynArray.add prob.Prob.clauses clause;
+  let sorts = infer_single_sort prob in
+
+  let i = Lifted_inst.create prob sorts 2 in
+  let log = BatDynArray.to_list (Lifted_inst.get_solver i).Solver.log in
+  let lifted =
+    List.filter (function Solv.Elifted_clause _ -> true | _ -> false) log in
+  let cell table args arg_sizes =
+    { Csp_solver.table; Csp_solver.args; Csp_solver.arg_sizes } in
+  assert_equal
+    [
+      Solv.Elifted_clause (
+        [| 2; 2 |],
+        [| 0, 1 |],
+        [| |],
+        [|
+          (* f(x, y) = c *)
+          Csp_solver.Lifted_eq_cells
+            (cell 0 [| 0; 1 |] [| 2; 2 |], cell 1 [| |] [| |]);
+          (* f(y, y) = x *)
+          Csp_solver.Lifted_eq_var (cell 0 [| 1; 1 |] [| 2; 2 |], 0);
+        |],
+        [|
+          (* p(y, x, y) *)
+          Csp_solver.Lifted_pred (cell 0 [| 1; 0; 1 |] [| 2; 2; 2 |]);
+        |]);
+    ]
+    lifted;
+  (* No ground clauses and no auxiliary variables. *)
+  List.iter
+    (function
+    | Solv.Eclause _
+    | Solv.Enew_tmp_bool_var _
+    | Solv.Enew_tmp_int_var _ -> assert_failure "ground clause"
+    | _ -> ())
+    log
+
+(* Clauses with nested terms are grounded. *)
+let test_lifted_nested () =
+  let prob = Prob.create () in
+  let db = prob.Prob.symbols in
+  let f = Symb.add_func db 1 in
+  let f a = T.func (f, [| a |]) in
+  let p = Symb.add_pred db 1 in
+  let c = Symb.add_func db 0 in
+  let c = T.func (c, [| |]) in
+  let x = T.var 0 in
+  let clause = {
+    C2.cl_id = Prob.fresh_id prob;
+    C2.cl_lits = [
+      L.mk_eq (f (f x)) c;
+      L.lit (Sh.Pos, p, [| x |]);
+    ];
+  } in
+  BatDynArray.add prob.Prob.clauses clause;
+  let sorts = infer_single_sort prob in
+
+  for max_size = 1 to 3 do
+    let i = Inst.create prob sorts max_size in
+    let i' = Lifted_inst.create prob sorts max_size in
+    assert_equal
+      (BatDynArray.to_list (Inst.get_solver i).Solver.log)
+      (BatDynArray.to_list (Lifted_inst.get_solver i').Solver.log)
+  done
+
+(* Problem whose clauses are compiled to extensional constraints. *)
+let extensional_prob () =
+  let prob = Prob.create () in
+  let db = prob.Prob.symbols in
+  let f = Symb.add_func db 2 in
+  let f a b = T.func (f, [| a; b |]) in
+  let x, y = T.var 0, T.var 1 in
+  let clause = {
+    C2.cl_id = Prob.fresh_id prob;
+    C2.cl_lits = [L.mk_eq (f x x) x];
+  } in
+  let clause2 = {
+    C2.cl_id = Prob.fresh_id prob;
+    C2.cl_lits = [L.mk_eq (f x y) (f y x)];
+  } in
+  List.iter (BatDynArray.add prob.Prob.clauses) [clause; clause2];
+  prob, infer_single_sort prob
+
+(* Extensional constraints of the problem for domain size 2. *)
+let extensional_log2 =
+  [
+    Solv.Eextensional ([| 0 |], [| 0 |]); (* f(0, 0) = 0 *)
+    Solv.Eextensional ([| 3 |], [| 1 |]); (* f(1, 1) = 1 *)
+    (* f(0, 1) = f(1, 0) from two instances. *)
+    Solv.Eextensional ([| 1; 2 |], [| 0; 0; 1; 1 |]);
+  ]
+
+let test_extensional () =
+  let prob, sorts = extensional_prob () in
+  let i = Extensional_inst.create prob sorts 2 in
+  let log = BatDynArray.to_list (Extensional_inst.get_solver i).Solver.log in
+  let extensional =
+    List.filter (function Solv.Eextensional _ -> true | _ -> false) log in
+  assert_equal extensional_log2 extensional;
+  (* No reified equalities and no clauses. *)
+  List.iter
+    (function
+    | Solv.Eeq_var_var _
+    | Solv.Eeq_var_const _
+    | Solv.Eclause _ -> assert_failure "clause"
+    | _ -> ())
+    log
+
+(* Compiled problem can be instantiated for more domain sizes. *)
+let test_compile () =
+  let prob = Prob.create () in
+  let db = prob.Prob.symbols in
+  let f = Symb.add_func db 2 in
+  let f a b = T.func (f, [| a; b |]) in
+  let g = Symb.add_func db 1 in
+  let g a = T.func (g, [| a |]) in
+  let p = Symb.add_pred db 2 in
+  let x, y = T.var 0, T.var 1 in
+  let clause = {
+    C2.cl_id = Prob.fresh_id prob;
+    C2.cl_lits = [
+      L.mk_eq (f (g x) y) (g (g x));
+      L.lit (Sh.Neg, p, [| g x; f (g x) x |]);
+    ];
+  } in
+  BatDynArray.add prob.Prob.clauses clause;
+  let sorts = infer_single_sort prob in
+
+  let compiled = Inst.compile prob sorts in
+  for max_size = 1 to 4 do
+    let i = Inst.create prob sorts max_size in
+    let i' = Inst.instantiate compiled max_size in
+    assert_equal
+      (BatDynArray.to_list (Inst.get_solver i).Solver.log)
+      (BatDynArray.to_list (Inst.get_solver i').Solver.log)
+  done;
+
+  (* Hints are used by each instance. *)
+  let prob, sorts = hints_prob () in
+  let compiled = Inst.compile prob sorts in
+  List.iter
+    (fun max_size ->
+      let i = Inst.instantiate compiled max_size in
+      if max_size = 4 then
+        assert_log i hints_log4)
+    [4; 1; 2; 3; 4];
+
+  (* Clauses are tabulated by each instance. *)
+  let prob, sorts = extensional_prob () in
+  let compiled = Extensional_inst.compile prob sorts in
+  let get_log i =
+    BatDynArray.to_list (Extensional_inst.get_solver i).Solver.log in
+  List.iter
+    (fun max_size ->
+      let log =
+        get_log (Extensional_inst.instantiate compiled max_size) in
+      assert_equal
+        (get_log (Extensional_inst.create prob sorts max_size))
+        log;
+      if max_size = 2 then
+        assert_equal
+          extensional_log2
+          (List.filter
+             (function Solv.Eextensional _ -> true | _ -> false)
+             log))
+    [2; 1; 3; 2]
+
 let suite =
   "Csp_inst suite" >:::
     [
@@ -1474,7 +1736,7 @@ let suite =
       "nested" >:: test_nested;
       "nested comm func" >:: test_nested_comm_func;
       "variable (in)equalities" >:: test_var_eqs_and_ineqs;
-      "shared linear" >:: test_shared_linear;
+      "shared matrix element" >:: test_shared_matrix_element;
       "shared bool_element" >:: test_shared_bool_element;
       "shared int_element" >:: test_shared_int_element;
       "shared eq_var_var" >:: test_shared_eq_var_var;
@@ -1486,4 +1748,9 @@ let suite =
       "more sorts - comm func" >:: test_more_sorts_comm_func;
       "more sorts - one sort blocked from LNH" >::
         test_more_sorts_lnh_blocked_sort;
+      "more sorts - symmetric tables" >:: test_more_sorts_symmetric_tables;
+      "lifted flat clause" >:: test_lifted_flat;
+      "lifted nested clause" >:: test_lifted_nested;
+      "compile" >:: test_compile;
+      "extensional" >:: test_extensional;
     ]
@@ -0,0 +1,104 @@
+(* Copyright (c) 2015 Radek Micek *)
+
+open OUnit
+
+module Recorded = Csp_record.Make (Gecode)
+
+module S = Ftest_anycsp.Make (Recorded)
+
+module Replay = Csp_record.Replay (Gecode)
+
+let rec count_models int_value s xs acc =
+  match Gecode.solve s with
+    | Sh.Ltrue ->
+        count_models int_value s xs (Earray.map (int_value s) xs :: acc)
+    | Sh.Lfalse -> List.rev acc
+    | Sh.Lundef -> failwith "count_models"
+
+(* Derangements of 3 elements where f(0) is given by an element constraint
+   and a lifted clause.
+*)
+let build_derangements () =
+  let s = Recorded.create 1 in
+  let f = Earray.init 3 (fun _ -> Recorded.new_int_var s 3) in
+  let f_arr = Recorded.new_int_var_array s f in
+  let cell x =
+    {
+      Csp_solver.table = f_arr;
+      Csp_solver.args = [| x |];
+      Csp_solver.arg_sizes = [| 3 |];
+    } in
+  Recorded.all_different s f;
+  (* f(x) <> x *)
+  Recorded.lifted_clause s [| 3 |] [| |] [| |] [| |]
+    [| Csp_solver.Lifted_eq_var (cell 0, 0) |];
+  (* f(f(0)) = 0 is false. *)
+  let y = Recorded.new_tmp_int_var s 3 in
+  Recorded.int_element s f_arr (Earray.get f 0) y;
+  let b = Recorded.new_tmp_bool_var s in
+  Recorded.eq_var_const s y 0 b;
+  Recorded.clause s [| |] [| b |];
+  s, f
+
+(* Four pigeons in three holes. *)
+let build_pigeons () =
+  let s = Recorded.create 1 in
+  let xs = Earray.init 4 (fun _ -> Recorded.new_int_var s 3) in
+  Recorded.precede s xs [| 0; 1; 2 |];
+  Recorded.all_different s xs;
+  s, xs
+
+let test_replay () =
+  let file, oc = Filename.open_temp_file "crossbow" ".csp" in
+  let expected =
+    BatPervasives.finally
+      (fun () -> Csp_record.channel := None; close_out oc)
+      (fun () ->
+        Csp_record.channel := Some oc;
+        List.map
+          (fun build ->
+            let s, xs = build () in
+            let models = count_models Recorded.int_value s xs [] in
+            Recorded.destroy s;
+            models)
+          [build_derangements; build_pigeons])
+      () in
+  assert_equal 2 (List.length (List.hd expected));
+  let replayed = ref [] in
+  BatPervasives.finally
+    (fun () -> Sys.remove file)
+    (fun () ->
+      let ic = open_in file in
+      Replay.each_model ic
+        (fun i s ->
+          let n = List.length (count_models Gecode.int_value s [| |] []) in
+          replayed := (i, n) :: !replayed);
+      close_in ic)
+    ();
+  assert_equal
+    (List.mapi (fun i models -> i, List.length models) expected)
+    (List.rev !replayed)
+
+let test_invalid () =
+  let file, oc = Filename.open_temp_file "crossbow" ".csp" in
+  output_string oc "create 1\nbool_var 0\nclause 1 1 0\n";
+  close_out oc;
+  BatPervasives.finally
+    (fun () -> Sys.remove file)
+    (fun () ->
+      let ic = open_in file in
+      assert_raises
+        (Failure "Csp_record: unknown id: 1")
+        (fun () -> Replay.each_model ic (fun _ _ -> ()));
+      close_in ic)
+    ()
+
+let suite =
+  TestList [
+    S.suite "Csp_record";
+    "Csp_record replay suite" >:::
+      [
+        "replay" >:: test_replay;
+        "invalid" >:: test_invalid;
+      ];
+  ]
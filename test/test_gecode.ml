@@ -1,5 +1,314 @@
 (* Copyright (c) 2013 Radek Micek *)
 
+open OUnit
+
 module S = Ftest_anycsp.Make (Gecode)
 
-let suite = S.suite "Gecode"
+let test_linear () =
+  let s = Gecode.create 1 in
+  let x = Gecode.new_int_var s 6 in
+  Gecode.linear s [| x |] [| 3 |] 12;
+  assert_equal Sh.Ltrue (Gecode.solve s);
+  assert_equal 4 (Gecode.int_value s x);
+  assert_equal Sh.Lfalse (Gecode.solve s)
+
+let test_linear2 () =
+  let s = Gecode.create 1 in
+  let x = Gecode.new_int_var s 7 in
+  let y = Gecode.new_int_var s 7 in
+  Gecode.linear s [| x; y |] [| ~-1; 5 |] 13;
+  assert_equal Sh.Ltrue (Gecode.solve s);
+  assert_equal 2 (Gecode.int_value s x);
+  assert_equal 3 (Gecode.int_value s y);
+  assert_equal Sh.Lfalse (Gecode.solve s)
+
+let test_pythagorean_triples () =
+  let s = Gecode.create 1 in
+  let yes = Gecode.new_tmp_bool_var s in
+  Gecode.clause s [| yes |] [| |];
+  let n = 10 in
+  let sq_dom = n * n + 1 in
+  (* Variables equal to squares of positive numbers 1..n. *)
+  let sq_vars =
+    Earray.init n (fun i ->
+      let x = Gecode.new_tmp_int_var s sq_dom in
+      Gecode.eq_var_const s x ((i + 1) * (i + 1)) yes;
+      x) in
+  let sq_arr = Gecode.new_int_var_array s sq_vars in
+  (* x, y, z are squares of positive numbers. *)
+  let i = Gecode.new_int_var s n in
+  let x = Gecode.new_int_var s sq_dom in
+  Gecode.int_element s sq_arr i x;
+  let j = Gecode.new_int_var s n in
+  let y = Gecode.new_int_var s sq_dom in
+  Gecode.int_element s sq_arr j y;
+  let k = Gecode.new_int_var s n in
+  let z = Gecode.new_int_var s sq_dom in
+  Gecode.int_element s sq_arr k z;
+  (* x <= y (i.e. j - i - tmp = 0). *)
+  let tmp = Gecode.new_tmp_int_var s n in
+  Gecode.linear s [| i; j; tmp |] [| ~-1; 1; ~-1 |] 0;
+  (* x + y = z. *)
+  Gecode.linear s [| x; y; z |] [| 1; 1; ~-1 |] 0;
+  assert_equal Sh.Ltrue (Gecode.solve s);
+  assert_equal 9 (Gecode.int_value s x);
+  assert_equal 16 (Gecode.int_value s y);
+  assert_equal 25 (Gecode.int_value s z);
+  assert_equal Sh.Ltrue (Gecode.solve s);
+  assert_equal 36 (Gecode.int_value s x);
+  assert_equal 64 (Gecode.int_value s y);
+  assert_equal 100 (Gecode.int_value s z);
+  assert_equal Sh.Lfalse (Gecode.solve s)
+
+module With_config (C : sig val config : Gecode.config end) = struct
+  include Gecode
+
+  let create nthreads = Gecode.create_with_config nthreads C.config
+end
+
+let config_suite name config =
+  let module M =
+    Ftest_anycsp.Make (With_config (struct let config = config end)) in
+  M.suite name
+
+(* Restarts after every failure. *)
+let luby =
+  {
+    Gecode.default_config with
+      Gecode.restart = Gecode.Restart_luby;
+      Gecode.restart_scale = 1;
+  }
+
+let geom =
+  {
+    Gecode.default_config with
+      Gecode.restart = Gecode.Restart_geom;
+      Gecode.restart_scale = 2;
+      Gecode.nogoods_limit = 0;
+  }
+
+let afc =
+  {
+    Gecode.default_config with
+      Gecode.branching = Gecode.Branch_afc;
+      Gecode.decay = 0.95;
+  }
+
+(* Activity is most useful with restarts. *)
+let activity =
+  {
+    luby with
+      Gecode.branching = Gecode.Branch_activity;
+      Gecode.decay = 0.9;
+  }
+
+let lnh = { Gecode.default_config with Gecode.branching = Gecode.Branch_lnh }
+
+(* Clauses are grounded. *)
+let ground = { Gecode.default_config with Gecode.lifted = false }
+
+let ldsb = { Gecode.default_config with Gecode.ldsb = true }
+
+(* Clones are rare and recomputation is long. *)
+let recomputation =
+  {
+    Gecode.default_config with
+      Gecode.commit_distance = 64;
+      Gecode.adaptive_distance = 0;
+  }
+
+let pigeonhole s pigeons holes =
+  let xs = Array.init pigeons (fun _ -> Gecode.new_int_var s holes) in
+  for i = 0 to pigeons - 1 do
+    for j = i + 1 to pigeons - 1 do
+      let eq = Gecode.new_tmp_bool_var s in
+      Gecode.eq_var_var s xs.(i) xs.(j) eq;
+      Gecode.clause s [| |] [| eq |]
+    done
+  done
+
+(* Statistics of the unsuccessful search for five pigeons in four holes. *)
+let pigeonhole_stats config =
+  let s = Gecode.create_with_config 1 config in
+  pigeonhole s 5 4;
+  assert_equal Sh.Lfalse (Gecode.solve s);
+  let stats = Gecode.last_stats s in
+  Gecode.destroy s;
+  stats
+
+let test_restarts () =
+  assert_equal 0 (pigeonhole_stats Gecode.default_config).Gecode.restarts;
+  assert_bool "" ((pigeonhole_stats luby).Gecode.restarts > 0);
+  assert_bool "" ((pigeonhole_stats geom).Gecode.restarts > 0)
+
+let test_nogoods () =
+  assert_bool "" ((pigeonhole_stats luby).Gecode.nogoods > 0);
+  (* Limit 0 disables no-goods. *)
+  assert_equal 0 (pigeonhole_stats geom).Gecode.nogoods
+
+(* Recomputation doesn't change the search tree. *)
+let test_recomputation () =
+  let stats = pigeonhole_stats Gecode.default_config in
+  let stats2 = pigeonhole_stats recomputation in
+  assert_equal stats.Gecode.nodes stats2.Gecode.nodes;
+  assert_equal stats.Gecode.fails stats2.Gecode.fails
+
+(* Returns the values of [x] and [y] in the first model where
+   [x] has domain size 3 and 4 propagators, [y] has domain size 2
+   and 1 propagator, [x <> y] and [x] is restricted by LNH.
+   The smallest value is tried first so the variable which is
+   branched first gets 0.
+*)
+let first_model config =
+  let s = Gecode.create_with_config 1 config in
+  let x = Gecode.new_int_var s 3 in
+  let y = Gecode.new_int_var s 2 in
+  let eq = Gecode.new_tmp_bool_var s in
+  Gecode.eq_var_var s x y eq;
+  Gecode.clause s [| |] [| eq |];
+  for c = 0 to 2 do
+    Gecode.eq_var_const s x c (Gecode.new_tmp_bool_var s)
+  done;
+  Gecode.lower_eq s x 2;
+  assert_equal Sh.Ltrue (Gecode.solve s);
+  let model = Gecode.int_value s x, Gecode.int_value s y in
+  Gecode.destroy s;
+  model
+
+let test_branching_order () =
+  (* Smallest domain first. *)
+  assert_equal (1, 0) (first_model Gecode.default_config);
+  (* Highest AFC per domain size first. *)
+  assert_equal (0, 1) (first_model afc);
+  (* Activities are zero before the first failure
+     so the first variable is selected.
+  *)
+  assert_equal (0, 1) (first_model activity);
+  (* Variables restricted by LNH first. *)
+  assert_equal (0, 1) (first_model lnh)
+
+(* Unary function which is a permutation of its domain. *)
+let count_permutations config =
+  let s = Gecode.create_with_config 1 config in
+  let f = Earray.init 3 (fun _ -> Gecode.new_int_var s 3) in
+  ignore (Gecode.new_int_var_array s f);
+  Gecode.symmetric_table s f [| 0; 0 |] [| 3; 3 |];
+  Gecode.all_different s f;
+  let rec count n =
+    match Gecode.solve s with
+      | Sh.Ltrue -> count (n + 1)
+      | _ -> n in
+  let n = count 0 in
+  Gecode.destroy s;
+  n
+
+let test_ldsb () =
+  assert_equal 6 (count_permutations Gecode.default_config);
+  assert_bool "" (count_permutations ldsb < 6)
+
+let test_lifted () =
+  let lifted_clauses config =
+    let s = Gecode.create_with_config 1 config in
+    let res = Gecode.lifted_clauses s in
+    Gecode.destroy s;
+    res in
+  assert_bool "" (lifted_clauses Gecode.default_config);
+  assert_bool "" (not (lifted_clauses ground))
+
+let test_last_stats () =
+  let s = Gecode.create 1 in
+  pigeonhole s 4 3;
+  assert_equal Sh.Lfalse (Gecode.solve s);
+  let stats = Gecode.last_stats s in
+  assert_bool "" (stats.Gecode.fails > 0);
+  assert_bool "" (stats.Gecode.nodes > stats.Gecode.fails);
+  assert_bool "" (stats.Gecode.propagations > 0);
+  assert_bool "" (stats.Gecode.max_depth > 0);
+  assert_equal 0 stats.Gecode.restarts;
+  assert_equal 0 stats.Gecode.nogoods;
+  Gecode.destroy s
+
+let test_last_stats_per_call () =
+  let s = Gecode.create 1 in
+  let xs = Earray.init 3 (fun _ -> Gecode.new_int_var s 3) in
+  Gecode.all_different s xs;
+  let rec count_models n =
+    match Gecode.solve s with
+      | Sh.Ltrue ->
+          (* Counters don't grow with the number of calls. *)
+          assert_bool "" ((Gecode.last_stats s).Gecode.nodes <= 4);
+          count_models (n + 1)
+      | Sh.Lfalse -> n
+      | Sh.Lundef -> failwith "count_models" in
+  assert_equal 6 (count_models 0);
+  Gecode.destroy s
+
+let test_override () =
+  let config =
+    List.fold_left
+      Gecode.override
+      Gecode.default_config
+      ["restart=geom"; "restart-scale=50"; "restart-base=2.0";
+       "nogoods-limit=0"; "branching=activity"; "decay=0.5";
+       "lifted=false"; "ldsb=true"; "commit-distance=1";
+       "adaptive-distance=0"; "extensional=true"] in
+  assert_equal
+    {
+      Gecode.restart = Gecode.Restart_geom;
+      Gecode.restart_scale = 50;
+      Gecode.restart_base = 2.0;
+      Gecode.nogoods_limit = 0;
+      Gecode.branching = Gecode.Branch_activity;
+      Gecode.decay = 0.5;
+      Gecode.lifted = false;
+      Gecode.ldsb = true;
+      Gecode.commit_distance = 1;
+      Gecode.adaptive_distance = 0;
+      Gecode.extensional = true;
+    }
+    config;
+  List.iter
+    (fun opt ->
+      assert_raises
+        (Failure "")
+        (fun () ->
+          try ignore (Gecode.override config opt)
+          with Failure _ -> failwith ""))
+    ["restart"; "restart=glue"; "restart-scale=0"; "restart-base=1";
+     "nogoods-limit=-1"; "branching=random"; "decay=0"; "decay=1.5";
+     "lifted=yes"; "ldsb=1"; "commit-distance=0"; "adaptive-distance=-1";
+     "extensional=no"; "unknown=1"]
+
+let suite =
+  TestList [
+    S.suite "Gecode";
+    "Gecode linear suite" >:::
+      [
+        "linear" >:: test_linear;
+        "linear 2" >:: test_linear2;
+        "pythagorean triples" >:: test_pythagorean_triples;
+      ];
+    config_suite "Gecode Luby restarts" luby;
+    config_suite "Gecode geometric restarts" geom;
+    config_suite "Gecode AFC branching" afc;
+    config_suite "Gecode activity branching" activity;
+    config_suite "Gecode LNH branching" lnh;
+    config_suite "Gecode ground clauses" ground;
+    config_suite "Gecode LDSB" ldsb;
+    config_suite "Gecode recomputation" recomputation;
+    "Gecode config suite" >:::
+      [
+        "override" >:: test_override;
+        "restarts" >:: test_restarts;
+        "nogoods" >:: test_nogoods;
+        "recomputation" >:: test_recomputation;
+        "branching order" >:: test_branching_order;
+        "ldsb" >:: test_ldsb;
+        "lifted" >:: test_lifted;
+      ];
+    "Gecode statistics suite" >:::
+      [
+        "last stats" >:: test_last_stats;
+        "last stats per call" >:: test_last_stats_per_call;
+      ];
+  ]
@@ -2,4 +2,31 @@
 
 module S = Ftest_anycsp_inst.Make (Gecode_inst.Inst)
 
-let suite = S.suite "Gecode_inst"
+(* Instances are created with the configuration changed by [C.change]. *)
+module With_config (C : sig val change : Gecode.config -> Gecode.config end) =
+struct
+  include Gecode_inst.Inst
+
+  let create ?nthreads prob sorts n =
+    let config = !Gecode_inst.config in
+    Gecode_inst.config := C.change config;
+    BatPervasives.finally
+      (fun () -> Gecode_inst.config := config)
+      (fun () -> Gecode_inst.Inst.create ?nthreads prob sorts n) ()
+end
+
+let config_suite name change =
+  let module M =
+    Ftest_anycsp_inst.Make (With_config (struct let change = change end)) in
+  M.suite name
+
+let suite =
+  OUnit.TestList [
+    S.suite "Gecode_inst";
+    (* Symmetries are broken by LDSB instead of LNH. *)
+    config_suite "Gecode_inst LDSB"
+      (fun config -> { config with Gecode.ldsb = true });
+    (* Small clauses are compiled to extensional constraints. *)
+    config_suite "Gecode_inst extensional"
+      (fun config -> { config with Gecode.extensional = true });
+  ]
@@ -2,4 +2,6 @@
 
 module S = Ftest_anysat.Make (Josat)
 
-let suite = S.suite "Josat"
+module B = Ftest_anysat.Make_budget (Josat)
+
+let suite = OUnit.TestList [S.suite "Josat"; B.suite "Josat"]
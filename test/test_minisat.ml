@@ -2,4 +2,13 @@
 
 module S = Ftest_anysat.Make (Minisat)
 
-let suite = S.suite "Minisat"
+module B = Ftest_anysat.Make_budget (Minisat)
+
+module P = Ftest_anysat.Make_proof (struct
+  include Minisat
+
+  let create_with_proof = Minisat.create
+end)
+
+let suite =
+  OUnit.TestList [S.suite "Minisat"; B.suite "Minisat"; P.suite "Minisat"]
@@ -17,16 +17,26 @@ module Solver = struct
     | Eadd_at_most_one_val_clause of lit Earray.rt
     | Eremove_clauses_with_lit of lit
     | Esolve of lit Earray.rt
+    | Eadd_learnt of lit Earray.rt
 
   type t = {
     log : event BatDynArray.t;
     mutable nvars : int;
+    phases : (var, bool) Hashtbl.t;
+    activities : (var, float) Hashtbl.t;
+    frozen : (var, bool) Hashtbl.t;
+    (* Returned by [export_learnts]. *)
+    mutable learnts : lit Earray.rt list;
   }
 
   let create () =
     {
       log = BatDynArray.create ();
       nvars = 0;
+      phases = Hashtbl.create 20;
+      activities = Hashtbl.create 20;
+      frozen = Hashtbl.create 20;
+      learnts = [];
     }
 
   let new_var s =
@@ -64,14 +74,40 @@ module Solver = struct
   let remove_clauses_with_lit s l =
     BatDynArray.add s.log (Eremove_clauses_with_lit l)
 
+  let set_frozen s v frozen = Hashtbl.replace s.frozen v frozen
+
+  let set_max_size _ _ = ()
+
+  let is_frozen s v = try Hashtbl.find s.frozen v with Not_found -> false
+
   let solve s assumpts =
     BatDynArray.add s.log (Esolve (Earray.copy assumpts));
     Sh.Lundef
 
+  let set_phase s v phase = Hashtbl.replace s.phases v phase
+
+  let get_phase s v = try Hashtbl.find s.phases v with Not_found -> false
+
+  let set_activity s v act = Hashtbl.replace s.activities v act
+
+  let get_activity s v =
+    try Hashtbl.find s.activities v with Not_found -> 0.
+
+  let add_learnt s lits len =
+    let cl = Earray.sub lits 0 len in
+    BatDynArray.add s.log (Eadd_learnt cl);
+    true
+
+  let export_learnts s _ _ = s.learnts
+
   let model_value _ _ = failwith "Not implemented"
 
   let interrupt _ = failwith "not implemented"
 
+  let clear_interrupt _ = ()
+
+  let poll_progress _ = []
+
   let to_lit sign v = match sign with
     | Sh.Pos -> v + v
     | Sh.Neg -> v + v + 1
@@ -80,10 +116,20 @@ module Solver = struct
     if lit mod 2 = 0 then Sh.Pos else Sh.Neg
 
   let to_var lit = lit / 2
+
+  let shared_totality_clauses = false
 end
 
 module Inst = Sat_inst.Make (Solver)
 
+module Solver_shared = struct
+  include Solver
+
+  let shared_totality_clauses = true
+end
+
+module Inst_shared = Sat_inst.Make (Solver_shared)
+
 let assert_log i exp_log =
   let log = BatDynArray.to_list (Inst.get_solver i).Solver.log in
   assert_equal exp_log log;
@@ -796,6 +842,274 @@ let test_commutative_func () =
       Solver.Esolve [| lit' 20 |];
     ]
 
+let test_shared_totality_clauses () =
+  let prob = Prob.create () in
+  let db = prob.Prob.symbols in
+  let f =
+    let s = Symb.add_func db 2 in
+    Symb.set_commutative db s true;
+    fun a b -> T.func (s, [| a; b |]) in
+  let x = T.var 0 in
+  let y = T.var 1 in
+  let clause = {
+    C.cl_id = Prob.fresh_id prob;
+    (* f(x, y) = y *)
+    C.cl_lits = [ L.mk_eq (f x y) y ];
+  } in
+  BatDynArray.add prob.Prob.clauses clause;
+  let sorts = Sorts.of_problem prob in
+
+  let i = Inst_shared.create prob sorts in
+  let assert_log exp_log =
+    let log = BatDynArray.to_list (Inst_shared.get_solver i).Solver.log in
+    assert_equal exp_log log;
+    BatDynArray.clear (Inst_shared.get_solver i).Solver.log in
+  assert_log [];
+
+  Inst_shared.incr_max_size i;
+  assert_log
+    [
+      Solver.Enew_var 0; (* For: f(0, 0) = 0 *)
+      Solver.Eadd_clause [| lit 0 |];
+    ];
+  assert_equal Sh.Lundef (Inst_shared.solve i);
+  assert_log
+    [
+      Solver.Enew_var 1; (* Activation literal. *)
+      (* f(0, 0) *)
+      Solver.Enew_var 2;
+      Solver.Eadd_clause [| lit 0; lit 2 |];
+      Solver.Eadd_clause [| lit' 2; lit 1 |];
+      Solver.Esolve [| lit' 1 |];
+    ];
+
+  (* Same domain size - nothing is added. *)
+  assert_equal Sh.Lundef (Inst_shared.solve i);
+  assert_log [ Solver.Esolve [| lit' 1 |] ];
+
+  Inst_shared.incr_max_size i;
+  (* Old totality clauses are not removed. *)
+  assert_log
+    [
+      Solver.Enew_var 3; (* For: f(0, 1) = 0 *)
+      Solver.Enew_var 4; (* For: f(0, 1) = 1 *)
+      Solver.Enew_var 5; (* For: f(1, 1) = 0 *)
+      Solver.Enew_var 6; (* For: f(1, 1) = 1 *)
+      Solver.Enew_var 7; (* For: f(0, 0) = 1 *)
+      (* f(0, 0) = 0, f(0, 0) = 1 *)
+      Solver.Eadd_symmetry_clause [| lit 0; lit 7 |];
+      Solver.Eadd_at_most_one_val_clause [| lit' 7; lit' 0 |]; (* f(0, 0) *)
+      Solver.Eadd_at_most_one_val_clause [| lit' 3; lit' 4 |]; (* f(0, 1) *)
+      Solver.Eadd_at_most_one_val_clause [| lit' 5; lit' 6 |]; (* f(1, 1) *)
+      Solver.Eadd_clause [| lit 3 |]; (* x = 1, y = 0 *)
+      Solver.Eadd_clause [| lit 6 |]; (* x = 1, y = 1 *)
+      Solver.Eadd_clause [| lit 4 |]; (* x = 0, y = 1 *)
+    ];
+  assert_equal Sh.Lundef (Inst_shared.solve i);
+  assert_log
+    [
+      Solver.Enew_var 8; (* Activation literal. *)
+      (* f(0, 1) *)
+      Solver.Enew_var 9;
+      Solver.Eadd_clause [| lit 3; lit 4; lit 9 |];
+      Solver.Eadd_clause [| lit' 9; lit 8 |];
+      (* f(1, 1) *)
+      Solver.Enew_var 10;
+      Solver.Eadd_clause [| lit 5; lit 6; lit 10 |];
+      Solver.Eadd_clause [| lit' 10; lit 8 |];
+      Solver.Esolve [| lit' 8 |];
+    ];
+
+  Inst_shared.incr_max_size i;
+  (* Vars 11 - 22 are for the new values and cells:
+     f(0, 2) = 0..2 are 11..13, f(1, 2) = 0..2 are 14..16,
+     f(2, 2) = 0..2 are 17..19, f(0, 0) = 2 is 20,
+     f(0, 1) = 2 is 21, f(1, 1) = 2 is 22.
+  *)
+  BatDynArray.clear (Inst_shared.get_solver i).Solver.log;
+  assert_equal Sh.Lundef (Inst_shared.solve i);
+  assert_log
+    [
+      (* Eliminated by symmetry reduction. *)
+      Solver.Eadd_clause [| lit' 20 |]; (* f(0, 0) != 2 *)
+      Solver.Enew_var 23; (* Activation literal. *)
+      (* f(1, 1) - extends the old totality clause. *)
+      Solver.Enew_var 24;
+      Solver.Eadd_clause [| lit' 10; lit 22; lit 24 |];
+      Solver.Eadd_clause [| lit' 24; lit 23 |];
+      (* f(0, 2) *)
+      Solver.Enew_var 25;
+      Solver.Eadd_clause [| lit 11; lit 12; lit 13; lit 25 |];
+      Solver.Eadd_clause [| lit' 25; lit 23 |];
+      (* f(1, 2) *)
+      Solver.Enew_var 26;
+      Solver.Eadd_clause [| lit 14; lit 15; lit 16; lit 26 |];
+      Solver.Eadd_clause [| lit' 26; lit 23 |];
+      (* f(2, 2) *)
+      Solver.Enew_var 27;
+      Solver.Eadd_clause [| lit 17; lit 18; lit 19; lit 27 |];
+      Solver.Eadd_clause [| lit' 27; lit 23 |];
+      Solver.Esolve [| lit' 23 |];
+    ];
+
+  (* Variables which may appear in future clauses are frozen. *)
+  let s = Inst_shared.get_solver i in
+  List.iter
+    (fun v -> assert_bool "" (Solver.is_frozen s v))
+    [0; 3; 7; 11; 22; 23; 24; 25; 26; 27];
+  (* Old activation literals and replaced tails. *)
+  List.iter
+    (fun v -> assert_bool "" (not (Solver.is_frozen s v)))
+    [1; 8; 10]
+
+let test_closed_totality_clauses () =
+  let prob = Prob.create () in
+  let db = prob.Prob.symbols in
+  let f =
+    let s = Symb.add_func db 1 in
+    fun a -> T.func (s, [| a |]) in
+  let x = T.var 0 in
+  let clause = {
+    C.cl_id = Prob.fresh_id prob;
+    (* f(x) = x *)
+    C.cl_lits = [ L.mk_eq (f x) x ];
+  } in
+  BatDynArray.add prob.Prob.clauses clause;
+  let sorts =
+    let sorts = Sorts.of_problem prob in
+    (* Values of f are final for domain size 2. *)
+    let adeq_sizes = Earray.map (fun _ -> 2) sorts.Sorts.adeq_sizes in
+    { sorts with Sorts.adeq_sizes } in
+
+  let i = Inst_shared.create prob sorts in
+  let s = Inst_shared.get_solver i in
+  (* Counts the totality clauses added by [solve]. *)
+  let count_totality_clauses () =
+    BatDynArray.clear s.Solver.log;
+    assert_equal Sh.Lundef (Inst_shared.solve i);
+    let cnt =
+      BatDynArray.fold_left
+        (fun cnt e -> match e with
+          | Solver.Eadd_clause lits when Earray.length lits > 1 -> cnt + 1
+          | _ -> cnt)
+        0 s.Solver.log in
+    BatDynArray.clear s.Solver.log;
+    cnt in
+
+  Inst_shared.incr_max_size i;
+  Inst_shared.incr_max_size i;
+  (* f(0) is assigned by symmetry reduction, the chain of f(1)
+     is closed immediately.
+  *)
+  assert_equal 1 (count_totality_clauses ());
+  (* Closed chains are not added again. *)
+  assert_equal 0 (count_totality_clauses ());
+  Inst_shared.incr_max_size i;
+  assert_equal 0 (count_totality_clauses ());
+
+  (* Learnt clauses may depend on the closed chains. *)
+  s.Solver.learnts <- [ [| Solver.to_lit Sh.Neg 0 |] ];
+  assert_equal 0 (Sat_inst.learnt_count (Inst_shared.export_learnts i 10 10))
+
+let test_seed_new_vars () =
+  let prob = Prob.create () in
+  let db = prob.Prob.symbols in
+  let f =
+    let s = Symb.add_func db 1 in
+    fun a -> T.func (s, [| a |]) in
+  let x = T.var 0 in
+  let clause = {
+    C.cl_id = Prob.fresh_id prob;
+    (* f(x) = x *)
+    C.cl_lits = [ L.mk_eq (f x) x ];
+  } in
+  BatDynArray.add prob.Prob.clauses clause;
+  let sorts = Sorts.of_problem prob in
+
+  let i = Inst.create prob sorts in
+  Inst.incr_max_size i;
+  let s = Inst.get_solver i in
+  assert_equal 1 s.Solver.nvars;
+  (* f(0) = 0 *)
+  Solver.set_phase s 0 true;
+  Solver.set_activity s 0 3.;
+
+  Inst.incr_max_size i;
+  assert_equal 4 s.Solver.nvars;
+  (* f(1) = 0 and f(1) = 1 are seeded from f(0) = 0,
+     f(0) = 1 keeps the default phase and activity.
+  *)
+  let new_vars = [1; 2; 3] in
+  assert_equal
+    [false; true; true]
+    (BatList.sort compare (List.map (Solver.get_phase s) new_vars));
+  assert_equal
+    [0.; 3.; 3.]
+    (BatList.sort compare (List.map (Solver.get_activity s) new_vars))
+
+let test_export_and_import_learnts () =
+  let prob = Prob.create () in
+  let db = prob.Prob.symbols in
+  let f =
+    let s = Symb.add_func db 1 in
+    fun a -> T.func (s, [| a |]) in
+  let x = T.var 0 in
+  let clause = {
+    C.cl_id = Prob.fresh_id prob;
+    (* f(x) = x *)
+    C.cl_lits = [ L.mk_eq (f x) x ];
+  } in
+  BatDynArray.add prob.Prob.clauses clause;
+  let sorts = Sorts.of_problem prob in
+
+  let i = Inst.create prob sorts in
+  Inst.incr_max_size i;
+  Inst.incr_max_size i;
+  ignore (Inst.solve i);
+  let s = Inst.get_solver i in
+  let switch = s.Solver.nvars - 1 in
+  (* Variables 1, 2, 3 are for f(1) = 0, f(0) = 1, f(1) = 1
+     (in some order).
+  *)
+  s.Solver.learnts <- [
+    [| Solver.to_lit Sh.Neg 0; Solver.to_lit Sh.Pos 3 |];
+    (* Contains the switch of the totality clauses. *)
+    [| Solver.to_lit Sh.Pos 1; Solver.to_lit Sh.Pos switch |];
+  ];
+  let learnts = Inst.export_learnts i 10 10 in
+  assert_equal 1 (Sat_inst.learnt_count learnts);
+
+  (* Import into an instance with a different numbering. *)
+  let i2 = Inst_shared.create prob sorts in
+  Inst_shared.incr_max_size i2;
+  ignore (Inst_shared.solve i2);
+  assert_equal 0 (Inst_shared.import_learnts i2 learnts);
+  Inst_shared.incr_max_size i2;
+  let s2 = Inst_shared.get_solver i2 in
+  let first = s2.Solver.nvars - 3 in
+  assert_bool "" (first > 1);
+  BatDynArray.clear s2.Solver.log;
+  assert_equal 1 (Inst_shared.import_learnts i2 learnts);
+  assert_equal
+    [Solver.Eadd_learnt
+       [| Solver.to_lit Sh.Neg 0; Solver.to_lit Sh.Pos (first + 2) |]]
+    (BatDynArray.to_list s2.Solver.log);
+
+  (* Different problem. *)
+  BatDynArray.add prob.Prob.clauses { clause with C.cl_id = Prob.fresh_id prob };
+  let sorts = Sorts.of_problem prob in
+  let i3 = Inst.create prob sorts in
+  Inst.incr_max_size i3;
+  Inst.incr_max_size i3;
+  assert_raises
+    (Failure "import_learnts: different problem")
+    (fun () -> Inst.import_learnts i3 learnts);
+
+  (* No learnt clauses after blocking a model. *)
+  Inst.block_model i
+    { Ms_model.max_size = 1; Ms_model.symbs = Symb.Map.empty };
+  assert_equal 0 (Sat_inst.learnt_count (Inst.export_learnts i 10 10))
+
 let test_symmetric_pred () =
   let prob = Prob.create () in
   let db = prob.Prob.symbols in
@@ -1021,6 +1335,10 @@ let suite =
       "unary func" >:: test_unary_func;
       "unary pred" >:: test_unary_pred;
       "commutative_func" >:: test_commutative_func;
+      "shared totality clauses" >:: test_shared_totality_clauses;
+      "closed totality clauses" >:: test_closed_totality_clauses;
+      "seed new vars" >:: test_seed_new_vars;
+      "export and import learnts" >:: test_export_and_import_learnts;
       "symmetric_pred" >:: test_symmetric_pred;
       "block_model" >:: test_block_model;
     ]
@@ -34,6 +34,23 @@ let test_with_timer_callback_exn () =
                 (fun () -> ())
                 (fun () -> Thread.delay 1.; failwith "x")))
 
+let test_with_periodic () =
+  let calls = ref 0 in
+  let res =
+    Timer.with_periodic 400
+      (fun () -> incr calls)
+      (fun () -> Thread.delay 1.; "res") in
+  assert_equal "res" res;
+  assert_equal 2 !calls
+
+let test_with_periodic_exn () =
+  assert_raises
+    (Failure "x")
+    (fun () ->
+      Timer.with_periodic 100
+        (fun () -> ())
+        (fun () -> Thread.delay 0.3; failwith "x"))
+
 let suite =
   "Timer suite" >:::
     [
@@ -41,4 +58,6 @@ let suite =
       "with_timer - no callback, exn" >:: test_with_timer_no_callback_exn;
       "with_timer - callback" >:: test_with_timer_callback;
       "with_timer - callback, exn" >:: test_with_timer_callback_exn;
+      "with_periodic" >:: test_with_periodic;
+      "with_periodic - exn" >:: test_with_periodic_exn;
     ]